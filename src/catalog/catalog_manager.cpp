@@ -557,6 +557,28 @@ namespace kizuna::catalog
             throw QueryException::table_not_found(std::to_string(table_id));
         }
         it->root_page_id = root_page_id;
+        it->tail_page_id = 0;
+        it->fsm_root_page_id = 0;
+        rewrite_tables_page(tables_cache_);
+    }
+
+    void CatalogManager::set_table_storage(table_id_t table_id, page_id_t tail_page_id, page_id_t fsm_root_page_id)
+    {
+        ensure_catalog_pages();
+        load_tables_cache();
+        auto it = std::find_if(tables_cache_.begin(), tables_cache_.end(), [table_id](const TableCatalogEntry &entry) {
+            return entry.table_id == table_id;
+        });
+        if (it == tables_cache_.end())
+        {
+            throw QueryException::table_not_found(std::to_string(table_id));
+        }
+        if (it->tail_page_id == tail_page_id && it->fsm_root_page_id == fsm_root_page_id)
+        {
+            return;
+        }
+        it->tail_page_id = tail_page_id;
+        it->fsm_root_page_id = fsm_root_page_id;
         rewrite_tables_page(tables_cache_);
     }
 
@@ -618,6 +640,24 @@ namespace kizuna::catalog
         rewrite_indexes_page(indexes_cache_);
     }
 
+    void CatalogManager::set_index_key_format(index_id_t index_id, IndexKeyFormat key_format)
+    {
+        load_indexes_cache();
+        auto it = std::find_if(indexes_cache_.begin(), indexes_cache_.end(), [index_id](const IndexCatalogEntry &entry) {
+            return entry.index_id == index_id;
+        });
+        if (it == indexes_cache_.end())
+        {
+            KIZUNA_THROW_INDEX(StatusCode::INDEX_NOT_FOUND, "Index not found", std::to_string(index_id));
+        }
+        if (it->key_format == key_format)
+        {
+            return;
+        }
+        it->key_format = key_format;
+        rewrite_indexes_page(indexes_cache_);
+    }
+
     bool CatalogManager::drop_index(std::string_view name)
     {
         load_indexes_cache();
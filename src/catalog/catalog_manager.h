@@ -33,8 +33,11 @@ namespace kizuna::catalog
 
         IndexCatalogEntry create_index(IndexCatalogEntry entry);
         void set_index_root(index_id_t index_id, page_id_t root_page_id);
+        void set_index_key_format(index_id_t index_id, IndexKeyFormat key_format);
         bool drop_index(std::string_view name);
+        // Replacing the root starts a new chain, so the stored tail and free-space map are cleared.
         void set_table_root(table_id_t table_id, page_id_t root_page_id);
+        void set_table_storage(table_id_t table_id, page_id_t tail_page_id, page_id_t fsm_root_page_id);
 
 
         TableCatalogEntry create_table(TableDef def,
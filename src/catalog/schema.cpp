@@ -92,7 +92,7 @@ namespace kizuna::catalog
             KIZUNA_THROW_QUERY(StatusCode::INVALID_ARGUMENT, "table name too long", name);
         }
         std::vector<uint8_t> out;
-        out.reserve(16 + name.size() + create_sql.size());
+        out.reserve(32 + name.size() + create_sql.size());
         write_u32(out, static_cast<uint32_t>(table_id));
         write_u32(out, static_cast<uint32_t>(root_page_id));
         write_u16(out, static_cast<uint16_t>(name.size()));
@@ -101,6 +101,8 @@ namespace kizuna::catalog
         out.insert(out.end(), create_sql.begin(), create_sql.end());
         write_u32(out, schema_version);
         write_u32(out, static_cast<uint32_t>(next_column_id));
+        write_u32(out, static_cast<uint32_t>(tail_page_id));
+        write_u32(out, static_cast<uint32_t>(fsm_root_page_id));
         return out;
     }
 
@@ -133,6 +135,13 @@ namespace kizuna::catalog
         if (read_u32(data, size, offset, next_column_raw))
         {
             entry.next_column_id = static_cast<column_id_t>(next_column_raw);
+            uint32_t tail_raw = 0;
+            uint32_t fsm_raw = 0;
+            if (read_u32(data, size, offset, tail_raw) && read_u32(data, size, offset, fsm_raw))
+            {
+                entry.tail_page_id = static_cast<page_id_t>(tail_raw);
+                entry.fsm_root_page_id = static_cast<page_id_t>(fsm_raw);
+            }
         }
     }
 
@@ -273,6 +282,7 @@ namespace kizuna::catalog
         out.insert(out.end(), name.begin(), name.end());
         write_u16(out, static_cast<uint16_t>(create_sql.size()));
         out.insert(out.end(), create_sql.begin(), create_sql.end());
+        out.push_back(static_cast<uint8_t>(key_format));
         return out;
     }
 
@@ -318,6 +328,15 @@ namespace kizuna::catalog
             KIZUNA_THROW_RECORD(StatusCode::INVALID_RECORD_FORMAT, "index catalog truncated", "sql_len");
         if (!read_bytes(data, size, offset, sql_len, entry.create_sql))
             KIZUNA_THROW_RECORD(StatusCode::INVALID_RECORD_FORMAT, "index catalog truncated", "sql");
+        // Entries written before the key format byte existed hold record-encoded keys.
+        entry.key_format = IndexKeyFormat::RECORD;
+        if (offset < size)
+        {
+            uint8_t format_raw = data[offset++];
+            if (format_raw > static_cast<uint8_t>(IndexKeyFormat::MEMCOMPARABLE_NULLS_LAST))
+                KIZUNA_THROW_RECORD(StatusCode::INVALID_RECORD_FORMAT, "index catalog key format unknown", std::to_string(format_raw));
+            entry.key_format = static_cast<IndexKeyFormat>(format_raw);
+        }
 
         entry.index_id = static_cast<index_id_t>(index_raw);
         entry.table_id = static_cast<table_id_t>(table_raw);
@@ -25,6 +25,8 @@ namespace kizuna::catalog
         column_id_t next_column_id{1};
         std::string name;          // user-visible table name
         std::string create_sql;    // raw CREATE TABLE statement
+        page_id_t tail_page_id{0};     // last page of the heap chain (0 = unknown, walk from root)
+        page_id_t fsm_root_page_id{0}; // free-space map root (0 = none yet)
 
         TableDef to_table_def() const;
         static TableCatalogEntry from_table_def(const TableDef &def, page_id_t root_page, std::string create_sql = {});
@@ -46,6 +48,22 @@ namespace kizuna::catalog
         static ColumnCatalogEntry deserialize(const uint8_t *data, size_t size, size_t &consumed);
     };
 
+    // How an index encodes its keys. RECORD is the legacy record::encode V1
+    // layout whose byte order does not match value order. MEMCOMPARABLE keys of
+    // non-unique indexes end with the row's record id, so equal values stay
+    // separate entries; MEMCOMPARABLE sorts NULLs first and
+    // MEMCOMPARABLE_NULLS_LAST (index::KeyEncoder today) sorts them last.
+    // Indexes in an older format are rebuilt once on first use.
+    enum class IndexKeyFormat : uint8_t
+    {
+        RECORD = 0,
+        MEMCOMPARABLE = 1,
+        MEMCOMPARABLE_NULLS_LAST = 2
+    };
+
+    // Format of keys written by index::KeyEncoder.
+    inline constexpr IndexKeyFormat CURRENT_INDEX_KEY_FORMAT = IndexKeyFormat::MEMCOMPARABLE_NULLS_LAST;
+
     struct IndexCatalogEntry
     {
         index_id_t index_id{0};
@@ -56,6 +74,7 @@ namespace kizuna::catalog
         std::string name;
         std::vector<column_id_t> column_ids;
         std::string create_sql;
+        IndexKeyFormat key_format{CURRENT_INDEX_KEY_FORMAT};
 
         std::vector<uint8_t> serialize() const;
         static IndexCatalogEntry deserialize(const uint8_t *data, size_t size, size_t &consumed);
@@ -6,8 +6,10 @@
 #include <cctype>
 #include <cstring>
 #include <filesystem>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <optional>
 #include <sstream>
 #include <string_view>
@@ -40,6 +42,47 @@ namespace
         return out;
     }
 
+    // Parses "4096", "512K", "64MB", "1g" ... into bytes.
+    std::optional<std::size_t> parse_byte_size(std::string_view text)
+    {
+        std::size_t pos = 0;
+        std::size_t value = 0;
+        while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos])))
+        {
+            value = value * 10 + static_cast<std::size_t>(text[pos] - '0');
+            ++pos;
+        }
+        if (pos == 0 || pos > 12)
+            return std::nullopt;
+        const std::string unit = to_upper(text.substr(pos));
+        unsigned shift = 0;
+        if (unit == "K" || unit == "KB")
+            shift = 10;
+        else if (unit == "M" || unit == "MB")
+            shift = 20;
+        else if (unit == "G" || unit == "GB")
+            shift = 30;
+        else if (!unit.empty() && unit != "B")
+            return std::nullopt;
+        if (value > (std::numeric_limits<std::size_t>::max() >> shift))
+            return std::nullopt;
+        return value << shift;
+    }
+
+    std::string format_bytes(std::size_t bytes)
+    {
+        std::ostringstream out;
+        if (bytes >= (std::size_t{1} << 30) && bytes % (std::size_t{1} << 30) == 0)
+            out << (bytes >> 30) << " GB";
+        else if (bytes >= (std::size_t{1} << 20) && bytes % (std::size_t{1} << 20) == 0)
+            out << (bytes >> 20) << " MB";
+        else if (bytes >= (std::size_t{1} << 10))
+            out << std::fixed << std::setprecision(bytes % 1024 == 0 ? 0 : 1) << (static_cast<double>(bytes) / 1024.0) << " KB";
+        else
+            out << bytes << " B";
+        return out.str();
+    }
+
     std::string sanitize_cell_text(std::string_view text)
     {
         std::string out;
@@ -155,6 +198,8 @@ namespace
 namespace kizuna
 {
     Repl::Repl()
+        : buffer_pool_(std::make_unique<BufferPool>(BufferPool::frames_for_budget(config::DEFAULT_BUFFER_POOL_MEMORY))),
+          bgwriter_(std::make_unique<BackgroundWriter>(*buffer_pool_))
     {
         init_handlers();
         db_path_ = (config::default_db_dir() / (std::string("demo") + config::DB_FILE_EXTENSION)).string();
@@ -182,6 +227,10 @@ namespace kizuna
         { cmd_loglevel(args); };
         handlers_["freepage"] = [this](auto const &args)
         { cmd_freepage(args); };
+        handlers_["bufferpool"] = [this](auto const &args)
+        { cmd_bufferpool(args); };
+        handlers_["checkpoint"] = [this](auto const &args)
+        { cmd_checkpoint(args); };
     }
 
     void Repl::print_help() const
@@ -198,6 +247,8 @@ namespace kizuna
                   << "  read_demo <page_id> <slot>- read and display a demo record\n"
                   << "  freepage <page_id>        - free a page (adds to free list)\n"
                   << "  loglevel <DEBUG|INFO|...> - set log verbosity\n"
+                  << "  bufferpool [size]         - show or resize the buffer pool budget (e.g. 64MB)\n"
+                  << "  checkpoint                - write all dirty pages to disk now\n"
                   << "  exit/quit                 - leave\n"
                   << "\nSQL DDL (V0.2):\n"
                   << "  CREATE TABLE <name>(...) [;]     - add a table to the catalog (INT, FLOAT, VARCHAR(n))\n"
@@ -210,6 +261,7 @@ namespace kizuna
                   << "  SELECT * FROM <table>;                            - scan entire table\n"
                   << "  DELETE FROM <table>;                              - delete all rows\n"
                   << "  TRUNCATE TABLE <table>;                            - wipe the table fast\n"
+                  << "  VACUUM <table>;                                    - compact pages and free empty ones\n"
                   << "\nSQL DML (V0.4 additions):\n"
                   << "  INSERT INTO <table> [(col,...)] VALUES (...);      - column-targeted inserts\n"
                   << "  SELECT col[, ...] FROM <table> [WHERE ...] [LIMIT n]; - projection + filtering\n"
@@ -284,6 +336,7 @@ namespace kizuna
         catch (...)
         {
         }
+        load_settings();
 
         std::string line;
         while (true)
@@ -376,14 +429,96 @@ namespace kizuna
 
         fm_ = std::make_unique<FileManager>(db_path_, /*create_if_missing*/ true);
         fm_->open();
-        pm_ = std::make_unique<PageManager>(*fm_, /*capacity*/ 64);
+        pm_ = std::make_unique<PageManager>(*fm_, *buffer_pool_);
+        pm_->enable_async_io();
         catalog_ = std::make_unique<catalog::CatalogManager>(*pm_, *fm_);
-        index_manager_ = std::make_unique<index::IndexManager>();
+        index_manager_ = std::make_unique<index::IndexManager>(config::default_index_dir(), buffer_pool_.get());
         ddl_executor_ = std::make_unique<engine::DDLExecutor>(*catalog_, *pm_, *fm_, *index_manager_);
         dml_executor_ = std::make_unique<engine::DMLExecutor>(*catalog_, *pm_, *fm_, *index_manager_);
         Logger::instance().info("Opened DB ", db_path_);
     }
 
+    void Repl::load_settings()
+    {
+        std::ifstream in(config::settings_file());
+        if (!in)
+            return;
+        std::string line;
+        std::size_t line_no = 0;
+        while (std::getline(in, line))
+        {
+            ++line_no;
+            const auto hash = line.find('#');
+            if (hash != std::string::npos)
+                line.erase(hash);
+            const std::string entry = trim_copy(line);
+            if (entry.empty())
+                continue;
+            const auto eq = entry.find('=');
+            const std::string key = eq == std::string::npos ? entry : trim_copy(std::string_view(entry).substr(0, eq));
+            const std::string value = eq == std::string::npos ? std::string() : trim_copy(std::string_view(entry).substr(eq + 1));
+            if (key == "buffer_pool_memory")
+            {
+                const auto bytes = parse_byte_size(value);
+                if (bytes && *bytes >= config::MIN_BUFFER_POOL_MEMORY)
+                {
+                    buffer_pool_->set_memory_budget(*bytes);
+                    continue;
+                }
+            }
+            Logger::instance().warn("Ignoring setting on line ", line_no, " of ", config::settings_file().string(), ": ", entry);
+        }
+        Logger::instance().info("Buffer pool budget ", format_bytes(buffer_pool_->memory_bytes()));
+    }
+
+    void Repl::cmd_bufferpool(const std::vector<std::string> &args)
+    {
+        if (args.size() > 2)
+        {
+            std::cout << "Usage: bufferpool [size]   (e.g. 256K, 64MB, 1G)\n";
+            return;
+        }
+        if (args.size() == 2)
+        {
+            const auto bytes = parse_byte_size(args[1]);
+            if (!bytes)
+            {
+                std::cout << "Invalid size: " << args[1] << "\n";
+                return;
+            }
+            if (*bytes < config::MIN_BUFFER_POOL_MEMORY)
+            {
+                std::cout << "Buffer pool needs at least " << format_bytes(config::MIN_BUFFER_POOL_MEMORY) << "\n";
+                return;
+            }
+            const auto evictions_before = buffer_pool_->stats().evictions;
+            buffer_pool_->set_memory_budget(*bytes);
+            const auto evicted = buffer_pool_->stats().evictions - evictions_before;
+            if (buffer_pool_->memory_bytes() > BufferPool::frames_for_budget(*bytes) * config::PAGE_SIZE)
+                std::cout << "Some frames are pinned; the pool stopped short of the new budget\n";
+            if (evicted != 0)
+                std::cout << "Evicted " << evicted << " page(s)\n";
+        }
+        std::cout << "Buffer pool: " << format_bytes(buffer_pool_->memory_bytes()) << " ("
+                  << buffer_pool_->capacity() << " frames, " << buffer_pool_->shard_count() << " shard(s)), mapped "
+                  << format_bytes(buffer_pool_->mapped_bytes());
+        if (buffer_pool_->huge_page_bytes() != 0)
+            std::cout << ", " << format_bytes(buffer_pool_->huge_page_bytes()) << " in huge pages";
+        std::cout << "\n";
+    }
+
+    void Repl::cmd_checkpoint(const std::vector<std::string> &args)
+    {
+        if (args.size() != 1)
+        {
+            std::cout << "Usage: checkpoint\n";
+            return;
+        }
+        const auto before = buffer_pool_->stats().checkpoint_writes;
+        bgwriter_->request_checkpoint();
+        std::cout << "Checkpoint wrote " << (buffer_pool_->stats().checkpoint_writes - before) << " page(s)\n";
+    }
+
     void Repl::cmd_status(const std::vector<std::string> &[[maybe_unused]] args)
     {
         std::cout << "DB: " << (fm_ ? db_path_ : std::string("<not open>")) << "\n";
@@ -401,6 +536,17 @@ namespace kizuna
             std::cout << ", tables: " << tables.size();
         }
         std::cout << "\n";
+        if (pm_)
+        {
+            const auto stats = pm_->stats();
+            std::cout << "  cache: " << pm_->capacity() << " frames shared by " << pm_->pool().file_count()
+                      << " file(s) (" << replacement_policy_to_string(pm_->policy())
+                      << "), hits: " << stats.hits << ", misses: " << stats.misses
+                      << ", evictions: " << stats.evictions << ", prefetched: " << stats.prefetched << "\n";
+            std::cout << "  writes: " << stats.foreground_writes << " by queries, " << stats.background_writes
+                      << " by the background writer, " << stats.checkpoint_writes << " in " << stats.checkpoints
+                      << " checkpoint(s)\n";
+        }
     }
 
     void Repl::cmd_schema(const std::vector<std::string> &args)
@@ -586,7 +732,7 @@ namespace kizuna
         std::vector<record::Field> fields;
         fields.push_back(record::from_int32(42));
         fields.push_back(record::from_string("hello world"));
-        auto payload = record::encode(fields);
+        auto payload = record::encode(fields, record::ROW_FORMAT);
         slot_id_t slot{};
         if (!page.insert(payload.data(), static_cast<uint16_t>(payload.size()), slot))
         {
@@ -860,7 +1006,7 @@ namespace kizuna
         if (!(iss >> keyword))
             return false;
         std::string upper = to_upper(keyword);
-        static const std::array<std::string, 7> sql_keywords = {"CREATE", "DROP", "ALTER", "TRUNCATE", "INSERT", "SELECT", "DELETE"};
+        static const std::array<std::string, 8> sql_keywords = {"CREATE", "DROP", "ALTER", "TRUNCATE", "VACUUM", "INSERT", "SELECT", "DELETE"};
         return std::find(sql_keywords.begin(), sql_keywords.end(), upper) != sql_keywords.end();
     }
 
@@ -907,7 +1053,8 @@ namespace kizuna
 
         auto is_dml_keyword = [&](const std::string &kw)
         {
-            return kw == "INSERT" || kw == "SELECT" || kw == "DELETE" || kw == "UPDATE" || kw == "TRUNCATE";
+            return kw == "INSERT" || kw == "SELECT" || kw == "DELETE" || kw == "UPDATE" || kw == "TRUNCATE" ||
+                   kw == "VACUUM";
         };
 
         try
@@ -951,6 +1098,17 @@ namespace kizuna
                     std::cout << "[rows=" << result.rows_updated << "] updated [time="
                               << format_duration_ms(elapsed_ms) << " ms]\n";
                 }
+                else if (upper == "VACUUM")
+                {
+                    auto start = Clock::now();
+                    auto stmt = sql::parse_vacuum(trimmed);
+                    auto result = dml_executor_->vacuum(stmt);
+                    double elapsed_ms =
+                        std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+                    std::cout << "[pages=" << result.pages_scanned << "] compacted=" << result.pages_compacted
+                              << " freed=" << result.pages_freed << " reclaimed=" << result.bytes_reclaimed
+                              << " bytes [time=" << format_duration_ms(elapsed_ms) << " ms]\n";
+                }
                 else
                 {
                     auto start = Clock::now();
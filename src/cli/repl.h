@@ -10,6 +10,7 @@
 #include "common/config.h"
 #include "common/logger.h"
 #include "common/exception.h"
+#include "storage/background_writer.h"
 #include "storage/file_manager.h"
 #include "storage/page_manager.h"
 #include "storage/record.h"
@@ -27,6 +28,8 @@ namespace kizuna
         int run();
 
     private:
+        std::unique_ptr<BufferPool> buffer_pool_; // shared by the database file and its indexes
+        std::unique_ptr<BackgroundWriter> bgwriter_; // cleans and checkpoints buffer_pool_
         std::unique_ptr<FileManager> fm_;
         std::unique_ptr<PageManager> pm_;
         std::unique_ptr<catalog::CatalogManager> catalog_;
@@ -45,6 +48,7 @@ namespace kizuna
         bool ensure_valid_data_page(page_id_t id, bool must_exist) const;
         bool looks_like_sql(const std::string &line) const;
         void dispatch_sql(const std::string &line);
+        void load_settings();
 
         // Command handlers
         void cmd_open(const std::vector<std::string> &args);
@@ -56,6 +60,8 @@ namespace kizuna
         void cmd_read_demo(const std::vector<std::string> &args);
         void cmd_loglevel(const std::vector<std::string> &args);
         void cmd_freepage(const std::vector<std::string> &args);
+        void cmd_bufferpool(const std::vector<std::string> &args);
+        void cmd_checkpoint(const std::vector<std::string> &args);
 
         void print_select_result(const engine::SelectResult &result) const;
     };
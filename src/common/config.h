@@ -31,6 +31,46 @@ namespace kizuna
         /// Maximum page cache size
         constexpr size_t MAX_CACHE_SIZE = 10000;
 
+        /// Open index handles an IndexManager keeps cached (least recently used close first)
+        constexpr size_t INDEX_HANDLE_CACHE_SIZE = 64;
+
+        /// Memory budget of the buffer pool an open database shares with all of its index files
+        /// (overridable at runtime or through settings_file())
+        constexpr size_t DEFAULT_BUFFER_POOL_MEMORY = 4 * 1024 * 1024;
+
+        /// Smallest buffer pool budget the REPL accepts
+        constexpr size_t MIN_BUFFER_POOL_MEMORY = 64 * 1024;
+
+        /// Frames per buffer pool arena chunk (2 MB of 4 KB pages, one huge page)
+        constexpr size_t BUFFER_POOL_CHUNK_FRAMES = 512;
+
+        /// Default number of buffer pool shards (1 = single latch, classic LRU behaviour)
+        constexpr size_t BUFFER_POOL_DEFAULT_SHARDS = 1;
+
+        /// Upper bound on buffer pool shards for multi-threaded workloads
+        constexpr size_t BUFFER_POOL_MAX_SHARDS = 64;
+
+        /// Frames in a bulk-read buffer ring (sequential scans recycle these instead of the shared cache)
+        constexpr size_t BULKREAD_RING_SIZE = 32;
+
+        /// Pause between background writer rounds
+        constexpr uint32_t BGWRITER_DELAY_MS = 200;
+
+        /// Most dirty pages the background writer cleans per round
+        constexpr size_t BGWRITER_MAX_PAGES = 100;
+
+        /// The background writer looks at the coldest (shard frames / this) pages of each shard
+        constexpr size_t BGWRITER_LOOKAHEAD_DIVISOR = 4;
+
+        /// Interval between checkpoints taken by the background writer
+        constexpr uint32_t CHECKPOINT_INTERVAL_MS = 30000; // 30 seconds
+
+        /// A heap scan switches to a private ring after touching capacity / this many pages
+        constexpr size_t BULKREAD_SCAN_THRESHOLD_DIVISOR = 4;
+
+        /// Granularity of free-space map categories (bytes of free space per category step)
+        constexpr size_t FSM_CATEGORY_BYTES = 16;
+
         /// Page alignment for direct I/O (must be power of 2)
         constexpr size_t PAGE_ALIGNMENT = 4096;
 
@@ -142,6 +182,13 @@ namespace kizuna
             return path;
         }
 
+        /// key = value settings read when the REPL starts (e.g. buffer_pool_memory = 64MB)
+        inline const std::filesystem::path &settings_file()
+        {
+            static const std::filesystem::path path = database_root_dir() / "kizuna.conf";
+            return path;
+        }
+
         inline std::filesystem::path default_log_file()
         {
             return logs_dir() / "kizuna.log";
@@ -170,6 +217,9 @@ namespace kizuna
         /// Sync frequency - pages written before forcing sync
         constexpr size_t SYNC_FREQUENCY = 100;
 
+        /// Default number of in-flight requests for the asynchronous I/O engine
+        constexpr size_t ASYNC_IO_QUEUE_DEPTH = 32;
+
         // ==================== B+ TREE CONFIGURATION ====================
 
         /// Default B+ tree node size (should fit in one page)
@@ -184,6 +234,13 @@ namespace kizuna
         /// Maximum key length for B+ tree indexes
         constexpr size_t MAX_KEY_LENGTH = 255;
 
+        /// Share of node space a bulk-built B+ tree fills, leaving room for later inserts
+        constexpr double BTREE_BULK_FILL_FACTOR = 0.9;
+
+        /// Bytes of (key, record id) pairs an index build sorts in memory before
+        /// spilling sorted runs to temp_dir()
+        constexpr size_t INDEX_BUILD_SORT_MEMORY = 64 * 1024 * 1024;
+
         // ==================== STRING CONFIGURATION ====================
 
         /// Maximum VARCHAR length
@@ -209,6 +266,21 @@ namespace kizuna
         /// Checkpoint frequency - transactions between checkpoints
         constexpr uint32_t CHECKPOINT_FREQUENCY = 1000;
 
+        /// Memory a hash join may hold for its inputs before partitioning them to temp_dir()
+        constexpr size_t HASH_JOIN_MEMORY = 16 * 1024 * 1024; // 16MB
+
+        /// Partition files a spilling hash join writes per input
+        constexpr size_t HASH_JOIN_PARTITIONS = 16;
+
+        /// Partitioning levels before an oversized partition is joined in memory anyway
+        constexpr size_t HASH_JOIN_MAX_DEPTH = 3;
+
+        /// Outer rows up to which a join probes an inner index regardless of the index size
+        constexpr size_t INDEX_JOIN_MAX_OUTER_ROWS = 64;
+
+        /// Rows a column batch gathers before a vectorized filter runs over it
+        constexpr size_t VECTOR_BATCH_ROWS = 1024;
+
 // ==================== DEBUGGING CONFIGURATION ====================
 
 /// Enable debug mode (extra validation, slower performance)
@@ -23,6 +23,8 @@ namespace kizuna
     using table_id_t = uint32_t;   // mirrors SQLite root page ids for tables
     using column_id_t = uint32_t;  // one entry per column in __columns__
     using index_id_t = uint32_t;   // future-proofing for __indexes__ catalog
+    using file_id_t = uint32_t;    // file registered with a BufferPool
+    using page_key_t = uint64_t;   // buffer pool key: high 32 file_id, low 32 page_id
 
     // ENUMS
     enum class PageType : uint8_t
@@ -32,7 +34,8 @@ namespace kizuna
         INDEX = 2,      // B+ tree index page
         OVERFLOW_PAGE = 3, // For records too large for one page
         METADATA = 4,   // Database metadata (catalog)
-        FREE = 5        // Page is in the free list
+        FREE = 5,       // Page is in the free list
+        FSM = 6         // Free-space map for a table heap
     };
 
     enum class RecordType : uint8_t
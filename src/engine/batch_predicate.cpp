@@ -0,0 +1,300 @@
+#include "engine/batch_predicate.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <string_view>
+#include <utility>
+
+#include "common/exception.h"
+
+namespace kizuna::engine
+{
+    namespace
+    {
+        using Storage = ColumnVector::Storage;
+
+        // The loops below keep to plain arrays and branch-free bodies so the compiler can
+        // vectorize them; TRUE is 2, so a comparison result shifted left by one is its truth.
+        template <typename Cmp, typename L, typename R>
+        void compare_arrays(const L *lhs, const R *rhs, std::size_t rows, std::uint8_t *out, Cmp cmp)
+        {
+            for (std::size_t i = 0; i < rows; ++i)
+                out[i] = static_cast<std::uint8_t>(cmp(lhs[i], rhs[i]) << 1);
+        }
+
+        template <typename Cmp, typename L, typename R>
+        void compare_with(const L *lhs, R constant, std::size_t rows, std::uint8_t *out, Cmp cmp)
+        {
+            for (std::size_t i = 0; i < rows; ++i)
+                out[i] = static_cast<std::uint8_t>(cmp(lhs[i], constant) << 1);
+        }
+
+        template <typename T>
+        void non_zero(const T *values, std::size_t rows, std::uint8_t *out)
+        {
+            for (std::size_t i = 0; i < rows; ++i)
+                out[i] = static_cast<std::uint8_t>((values[i] != T{}) << 1);
+        }
+
+        // compare() ranks anything neither equal nor less as Greater, NaN included, so
+        // x > NaN and NaN >= x hold on the row path; std::greater would make them false.
+        struct GreaterThan
+        {
+            template <typename L, typename R>
+            bool operator()(const L &l, const R &r) const
+            {
+                return !(l < r) && !(l == r);
+            }
+        };
+
+        struct GreaterOrEqual
+        {
+            template <typename L, typename R>
+            bool operator()(const L &l, const R &r) const
+            {
+                return !(l < r);
+            }
+        };
+
+        // Compares with the operands swapped: constant <op> column. Mirroring the operator
+        // instead would be wrong for NaN, which compare() ranks Greater from either side.
+        template <typename Cmp>
+        struct Swapped
+        {
+            Cmp cmp;
+
+            template <typename L, typename R>
+            bool operator()(const L &l, const R &r) const
+            {
+                return cmp(r, l);
+            }
+        };
+
+        // Calls fn with the functor for a comparison operator, answering as compare() does.
+        template <typename Fn>
+        void with_comparison(sql::BinaryOperator op, Fn &&fn)
+        {
+            switch (op)
+            {
+            case sql::BinaryOperator::EQUAL:
+                fn(std::equal_to<>{});
+                return;
+            case sql::BinaryOperator::NOT_EQUAL:
+                fn(std::not_equal_to<>{});
+                return;
+            case sql::BinaryOperator::LESS:
+                fn(std::less<>{});
+                return;
+            case sql::BinaryOperator::LESS_EQUAL:
+                fn(std::less_equal<>{});
+                return;
+            case sql::BinaryOperator::GREATER:
+                fn(GreaterThan{});
+                return;
+            case sql::BinaryOperator::GREATER_EQUAL:
+                fn(GreaterOrEqual{});
+                return;
+            case sql::BinaryOperator::AND:
+            case sql::BinaryOperator::OR:
+                break;
+            }
+            throw DBException(StatusCode::INTERNAL_ERROR, "Not a comparison operator", "batch predicate");
+        }
+
+        // Calls fn with the column's typed array. Strings are handled by the caller.
+        template <typename Fn>
+        void with_array(const ColumnVector &column, Fn &&fn)
+        {
+            switch (column.storage())
+            {
+            case Storage::BOOL:
+                fn(column.bools());
+                return;
+            case Storage::INT32:
+                fn(column.int32s());
+                return;
+            case Storage::INT64:
+                fn(column.int64s());
+                return;
+            case Storage::DOUBLE:
+                fn(column.doubles());
+                return;
+            case Storage::STRING:
+            case Storage::NONE:
+                break;
+            }
+            throw DBException(StatusCode::INTERNAL_ERROR, "Column has no numeric array", "batch predicate");
+        }
+
+        // A comparison with a NULL operand is UNKNOWN.
+        void mark_nulls(const ColumnVector &column, std::size_t rows, std::uint8_t *out)
+        {
+            if (column.null_count() == 0)
+                return;
+            const std::uint64_t *words = column.null_words();
+            for (std::size_t i = 0; i < rows; ++i)
+            {
+                const bool is_null = (words[i >> 6] >> (i & 63)) & 1u;
+                out[i] = is_null ? BatchPredicate::kUnknown : out[i];
+            }
+        }
+    }
+
+    std::size_t BatchPredicate::add(Node node)
+    {
+        nodes_.push_back(std::move(node));
+        return nodes_.size() - 1;
+    }
+
+    void BatchPredicate::require(std::size_t column, DataType type)
+    {
+        auto it = std::lower_bound(columns_.begin(), columns_.end(), column);
+        if (it != columns_.end() && *it == column)
+            return;
+        const auto offset = it - columns_.begin();
+        columns_.insert(it, column);
+        column_types_.insert(column_types_.begin() + offset, type);
+    }
+
+    void BatchPredicate::evaluate(const ColumnBatch &batch, std::vector<std::uint8_t> &truth) const
+    {
+        for (std::size_t i = 0; i < columns_.size(); ++i)
+        {
+            const std::size_t index = columns_[i];
+            if (index >= batch.column_count() ||
+                batch.column(index).storage() != ColumnVector::storage_of(column_types_[i]) ||
+                batch.column(index).size() < batch.size())
+            {
+                throw DBException(StatusCode::SCHEMA_MISMATCH, "Batch does not contain column",
+                                  std::to_string(index));
+            }
+        }
+        truth.resize(batch.size());
+        if (batch.size() == 0 || nodes_.empty())
+            return;
+        evaluate_node(nodes_.size() - 1, batch, truth.data());
+    }
+
+    void BatchPredicate::select(const ColumnBatch &batch, SelectionVector &selection) const
+    {
+        std::vector<std::uint8_t> truth;
+        evaluate(batch, truth);
+        selection.clear();
+        for (std::size_t i = 0; i < truth.size(); ++i)
+        {
+            if (truth[i] == kTrue)
+                selection.push_back(static_cast<std::uint32_t>(i));
+        }
+    }
+
+    void BatchPredicate::evaluate_node(std::size_t index, const ColumnBatch &batch, std::uint8_t *out) const
+    {
+        const Node &node = nodes_[index];
+        const std::size_t rows = batch.size();
+        switch (node.kind)
+        {
+        case NodeKind::CONSTANT:
+            std::memset(out, node.truth, rows);
+            return;
+        case NodeKind::TRUTH:
+        {
+            const auto &column = batch.column(node.column);
+            with_array(column, [&](const auto *values)
+                       { non_zero(values, rows, out); });
+            mark_nulls(column, rows, out);
+            return;
+        }
+        case NodeKind::IS_NULL:
+        {
+            const auto &column = batch.column(node.column);
+            const std::uint64_t *words = column.null_words();
+            const std::uint8_t negate = node.negate ? 1 : 0;
+            for (std::size_t i = 0; i < rows; ++i)
+                out[i] = static_cast<std::uint8_t>((((words[i >> 6] >> (i & 63)) & 1u) ^ negate) << 1);
+            return;
+        }
+        case NodeKind::COMPARE_CONSTANT:
+        {
+            const auto &column = batch.column(node.column);
+            auto run = [&](auto cmp)
+            {
+                if (column.storage() == Storage::STRING)
+                {
+                    const std::string_view constant = node.string_constant;
+                    for (std::size_t i = 0; i < rows; ++i)
+                        out[i] = static_cast<std::uint8_t>(cmp(column.string(i), constant) << 1);
+                    return;
+                }
+                with_array(column, [&](const auto *values)
+                           {
+                               switch (node.constant_storage)
+                               {
+                               case Storage::DOUBLE:
+                                   compare_with(values, node.double_constant, rows, out, cmp);
+                                   break;
+                               case Storage::INT32:
+                                   compare_with(values, static_cast<std::int32_t>(node.int_constant), rows, out, cmp);
+                                   break;
+                               case Storage::BOOL:
+                                   compare_with(values, static_cast<std::uint8_t>(node.int_constant), rows, out, cmp);
+                                   break;
+                               default:
+                                   compare_with(values, node.int_constant, rows, out, cmp);
+                                   break;
+                               } });
+            };
+            with_comparison(node.op, [&](auto cmp)
+                            {
+                                if (node.constant_first)
+                                    run(Swapped<decltype(cmp)>{cmp});
+                                else
+                                    run(cmp); });
+            mark_nulls(column, rows, out);
+            return;
+        }
+        case NodeKind::COMPARE_COLUMNS:
+        {
+            const auto &lhs = batch.column(node.column);
+            const auto &rhs = batch.column(node.other_column);
+            with_comparison(node.op, [&](auto cmp)
+                            {
+                                if (lhs.storage() == Storage::STRING)
+                                {
+                                    for (std::size_t i = 0; i < rows; ++i)
+                                        out[i] = static_cast<std::uint8_t>(cmp(lhs.string(i), rhs.string(i)) << 1);
+                                    return;
+                                }
+                                with_array(lhs, [&](const auto *left)
+                                           { with_array(rhs, [&](const auto *right)
+                                                        { compare_arrays(left, right, rows, out, cmp); }); }); });
+            mark_nulls(lhs, rows, out);
+            mark_nulls(rhs, rows, out);
+            return;
+        }
+        case NodeKind::NOT:
+            evaluate_node(node.left, batch, out);
+            for (std::size_t i = 0; i < rows; ++i)
+                out[i] = static_cast<std::uint8_t>(kTrue - out[i]);
+            return;
+        case NodeKind::AND:
+        case NodeKind::OR:
+        {
+            evaluate_node(node.left, batch, out);
+            std::vector<std::uint8_t> rhs(rows);
+            evaluate_node(node.right, batch, rhs.data());
+            if (node.kind == NodeKind::AND)
+            {
+                for (std::size_t i = 0; i < rows; ++i)
+                    out[i] = std::min(out[i], rhs[i]);
+            }
+            else
+            {
+                for (std::size_t i = 0; i < rows; ++i)
+                    out[i] = std::max(out[i], rhs[i]);
+            }
+            return;
+        }
+        }
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "engine/column_batch.h"
+#include "sql/ast.h"
+
+namespace kizuna::engine
+{
+    // A WHERE-style predicate compiled against column bindings (see
+    // ExpressionEvaluator::compile_batch_predicate()) and run over a whole ColumnBatch:
+    // every node is one loop over typed arrays that fills a truth byte per row, so
+    // comparisons, AND/OR/NOT and IS NULL run without a Value or a branch per row.
+    // Truth bytes order FALSE < UNKNOWN < TRUE, which makes AND a minimum, OR a maximum
+    // and NOT a subtraction, with SQL's three-valued logic.
+    class BatchPredicate
+    {
+    public:
+        static constexpr std::uint8_t kFalse = 0;
+        static constexpr std::uint8_t kUnknown = 1;
+        static constexpr std::uint8_t kTrue = 2;
+
+        // Truth of every row of the batch.
+        void evaluate(const ColumnBatch &batch, std::vector<std::uint8_t> &truth) const;
+        // Rows for which the predicate is TRUE (not FALSE or UNKNOWN), ascending.
+        void select(const ColumnBatch &batch, SelectionVector &selection) const;
+
+        // Row indexes of the columns the batch must hold, ascending.
+        const std::vector<std::size_t> &columns() const noexcept { return columns_; }
+
+    private:
+        friend class ExpressionEvaluator;
+
+        enum class NodeKind : std::uint8_t
+        {
+            CONSTANT,
+            TRUTH,            // a column used as a predicate: non-zero is TRUE
+            IS_NULL,
+            COMPARE_CONSTANT, // column <op> constant
+            COMPARE_COLUMNS,  // column <op> column
+            NOT,
+            AND,
+            OR
+        };
+
+        struct Node
+        {
+            NodeKind kind{NodeKind::CONSTANT};
+            sql::BinaryOperator op{sql::BinaryOperator::EQUAL};
+            bool negate{false}; // IS NOT NULL
+            bool constant_first{false}; // constant <op> column
+            std::uint8_t truth{kUnknown};
+            std::size_t column{0};
+            std::size_t other_column{0};
+            // The constant of COMPARE_CONSTANT, held in the storage it is compared as.
+            ColumnVector::Storage constant_storage{ColumnVector::Storage::NONE};
+            std::int64_t int_constant{0};
+            double double_constant{0.0};
+            std::string string_constant;
+            std::size_t left{0};
+            std::size_t right{0};
+        };
+
+        std::vector<Node> nodes_; // children before parents; the root is last
+        std::vector<std::size_t> columns_;
+        std::vector<DataType> column_types_; // parallel to columns_
+
+        std::size_t add(Node node);
+        void require(std::size_t column, DataType type);
+        void evaluate_node(std::size_t index, const ColumnBatch &batch, std::uint8_t *out) const;
+    };
+}
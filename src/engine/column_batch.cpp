@@ -0,0 +1,239 @@
+#include "engine/column_batch.h"
+
+#include "common/exception.h"
+
+namespace kizuna::engine
+{
+    ColumnVector::Storage ColumnVector::storage_of(DataType type) noexcept
+    {
+        switch (type)
+        {
+        case DataType::BOOLEAN:
+            return Storage::BOOL;
+        case DataType::INTEGER:
+            return Storage::INT32;
+        case DataType::BIGINT:
+        case DataType::DATE:
+        case DataType::TIMESTAMP:
+            return Storage::INT64;
+        case DataType::FLOAT:
+        case DataType::DOUBLE:
+            return Storage::DOUBLE;
+        case DataType::VARCHAR:
+        case DataType::TEXT:
+            return Storage::STRING;
+        default:
+            return Storage::NONE;
+        }
+    }
+
+    ColumnVector::ColumnVector(DataType type)
+        : type_(type), storage_(storage_of(type))
+    {
+        reserve(config::VECTOR_BATCH_ROWS);
+    }
+
+    void ColumnVector::clear() noexcept
+    {
+        size_ = 0;
+        null_count_ = 0;
+        nulls_.clear();
+        bools_.clear();
+        int32s_.clear();
+        int64s_.clear();
+        doubles_.clear();
+        chars_.clear();
+        string_ends_.clear();
+    }
+
+    void ColumnVector::reserve(std::size_t rows)
+    {
+        nulls_.reserve((rows + 63) / 64);
+        switch (storage_)
+        {
+        case Storage::BOOL:
+            bools_.reserve(rows);
+            break;
+        case Storage::INT32:
+            int32s_.reserve(rows);
+            break;
+        case Storage::INT64:
+            int64s_.reserve(rows);
+            break;
+        case Storage::DOUBLE:
+            doubles_.reserve(rows);
+            break;
+        case Storage::STRING:
+            string_ends_.reserve(rows);
+            break;
+        case Storage::NONE:
+            break;
+        }
+    }
+
+    void ColumnVector::push_null_bit(bool is_null)
+    {
+        if ((size_ & 63) == 0)
+            nulls_.push_back(0);
+        if (is_null)
+        {
+            nulls_.back() |= std::uint64_t{1} << (size_ & 63);
+            ++null_count_;
+        }
+        ++size_;
+    }
+
+    void ColumnVector::append_null()
+    {
+        switch (storage_)
+        {
+        case Storage::BOOL:
+            bools_.push_back(0);
+            break;
+        case Storage::INT32:
+            int32s_.push_back(0);
+            break;
+        case Storage::INT64:
+            int64s_.push_back(0);
+            break;
+        case Storage::DOUBLE:
+            doubles_.push_back(0.0);
+            break;
+        case Storage::STRING:
+            string_ends_.push_back(static_cast<std::uint32_t>(chars_.size()));
+            break;
+        case Storage::NONE:
+            throw QueryException::unsupported_type(data_type_to_string(type_));
+        }
+        push_null_bit(true);
+    }
+
+    void ColumnVector::append(const record::FieldView &field)
+    {
+        if (field.is_null)
+        {
+            append_null();
+            return;
+        }
+        switch (storage_)
+        {
+        case Storage::BOOL:
+            bools_.push_back(field.as_bool() ? 1 : 0);
+            break;
+        case Storage::INT32:
+            int32s_.push_back(field.as_int32());
+            break;
+        case Storage::INT64:
+            int64s_.push_back(field.as_int64());
+            break;
+        case Storage::DOUBLE:
+            doubles_.push_back(type_ == DataType::FLOAT ? static_cast<double>(field.as_float()) : field.as_double());
+            break;
+        case Storage::STRING:
+        {
+            const auto text = field.as_string_view();
+            chars_.insert(chars_.end(), text.begin(), text.end());
+            string_ends_.push_back(static_cast<std::uint32_t>(chars_.size()));
+            break;
+        }
+        case Storage::NONE:
+            throw QueryException::unsupported_type(data_type_to_string(type_));
+        }
+        push_null_bit(false);
+    }
+
+    void ColumnVector::append(const Value &value)
+    {
+        if (value.is_null())
+        {
+            append_null();
+            return;
+        }
+        switch (storage_)
+        {
+        case Storage::BOOL:
+            bools_.push_back(value.as_bool() ? 1 : 0);
+            break;
+        case Storage::INT32:
+            int32s_.push_back(value.as_int32());
+            break;
+        case Storage::INT64:
+            int64s_.push_back(value.as_int64());
+            break;
+        case Storage::DOUBLE:
+            doubles_.push_back(value.as_double());
+            break;
+        case Storage::STRING:
+        {
+            const auto &text = value.as_string();
+            chars_.insert(chars_.end(), text.begin(), text.end());
+            string_ends_.push_back(static_cast<std::uint32_t>(chars_.size()));
+            break;
+        }
+        case Storage::NONE:
+            throw QueryException::unsupported_type(data_type_to_string(type_));
+        }
+        push_null_bit(false);
+    }
+
+    std::string_view ColumnVector::string(std::size_t row) const noexcept
+    {
+        const std::uint32_t begin = row == 0 ? 0 : string_ends_[row - 1];
+        return std::string_view(chars_.data() + begin, string_ends_[row] - begin);
+    }
+
+    Value ColumnVector::value(std::size_t row) const
+    {
+        if (is_null(row))
+            return Value::null(type_);
+        switch (type_)
+        {
+        case DataType::BOOLEAN:
+            return Value::boolean(bools_[row] != 0);
+        case DataType::INTEGER:
+            return Value::int32(int32s_[row]);
+        case DataType::DATE:
+            return Value::date(int64s_[row]);
+        case DataType::BIGINT:
+        case DataType::TIMESTAMP:
+            return Value::int64(int64s_[row]);
+        case DataType::FLOAT:
+        case DataType::DOUBLE:
+            return Value::floating(doubles_[row]);
+        case DataType::VARCHAR:
+        case DataType::TEXT:
+            return Value::string(std::string(string(row)), type_);
+        default:
+            throw QueryException::unsupported_type(data_type_to_string(type_));
+        }
+    }
+
+    ColumnBatch::ColumnBatch(const std::vector<DataType> &types)
+    {
+        columns_.reserve(types.size());
+        for (DataType type : types)
+        {
+            if (type == DataType::NULL_TYPE)
+                columns_.emplace_back();
+            else
+                columns_.emplace_back(type);
+        }
+    }
+
+    void ColumnBatch::append_row(const std::vector<Value> &row)
+    {
+        for (std::size_t i = 0; i < columns_.size() && i < row.size(); ++i)
+        {
+            if (columns_[i].storage() != ColumnVector::Storage::NONE)
+                columns_[i].append(row[i]);
+        }
+        ++rows_;
+    }
+
+    void ColumnBatch::clear() noexcept
+    {
+        for (auto &column : columns_)
+            column.clear();
+        rows_ = 0;
+    }
+}
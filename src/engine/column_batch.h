@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "common/config.h"
+#include "common/value.h"
+#include "storage/record.h"
+
+namespace kizuna::engine
+{
+    // Positions of the rows of a batch that passed a filter, ascending.
+    using SelectionVector = std::vector<std::uint32_t>;
+
+    // One column of a ColumnBatch: values in a typed array plus a null bitmap (bit set =
+    // NULL). BOOLEAN is stored as bytes, INTEGER as int32, BIGINT/DATE/TIMESTAMP as int64,
+    // FLOAT/DOUBLE as double, and VARCHAR/TEXT as one character arena with end offsets.
+    // A NULL entry holds zero (or an empty string) in its array slot.
+    class ColumnVector
+    {
+    public:
+        enum class Storage : std::uint8_t
+        {
+            NONE,
+            BOOL,
+            INT32,
+            INT64,
+            DOUBLE,
+            STRING
+        };
+
+        // NONE for types a batch cannot hold (NULL_TYPE, BLOB).
+        static Storage storage_of(DataType type) noexcept;
+
+        ColumnVector() = default;
+        explicit ColumnVector(DataType type);
+
+        DataType type() const noexcept { return type_; }
+        Storage storage() const noexcept { return storage_; }
+        std::size_t size() const noexcept { return size_; }
+        std::size_t null_count() const noexcept { return null_count_; }
+
+        void clear() noexcept;
+        void reserve(std::size_t rows);
+
+        void append(const record::FieldView &field);
+        // Throws a type error when the value's type does not match the column's storage.
+        void append(const Value &value);
+        void append_null();
+
+        bool is_null(std::size_t row) const noexcept { return (nulls_[row >> 6] >> (row & 63)) & 1u; }
+        const std::uint64_t *null_words() const noexcept { return nulls_.data(); }
+
+        const std::uint8_t *bools() const noexcept { return bools_.data(); }
+        const std::int32_t *int32s() const noexcept { return int32s_.data(); }
+        const std::int64_t *int64s() const noexcept { return int64s_.data(); }
+        const double *doubles() const noexcept { return doubles_.data(); }
+        std::string_view string(std::size_t row) const noexcept;
+
+        // The entry as the row path would decode it.
+        Value value(std::size_t row) const;
+
+    private:
+        DataType type_{DataType::NULL_TYPE};
+        Storage storage_{Storage::NONE};
+        std::size_t size_{0};
+        std::size_t null_count_{0};
+        std::vector<std::uint64_t> nulls_;
+        std::vector<std::uint8_t> bools_;
+        std::vector<std::int32_t> int32s_;
+        std::vector<std::int64_t> int64s_;
+        std::vector<double> doubles_;
+        std::vector<char> chars_;
+        std::vector<std::uint32_t> string_ends_;
+
+        void push_null_bit(bool is_null);
+    };
+
+    // Up to about config::VECTOR_BATCH_ROWS rows stored column by column. Columns sit at
+    // the row index an ExpressionEvaluator binds them to; a column a consumer never reads
+    // can be left NULL_TYPE and empty. Whoever fills the columns sets the row count.
+    class ColumnBatch
+    {
+    public:
+        ColumnBatch() = default;
+        explicit ColumnBatch(const std::vector<DataType> &types);
+
+        std::size_t size() const noexcept { return rows_; }
+        std::size_t column_count() const noexcept { return columns_.size(); }
+        ColumnVector &column(std::size_t index) { return columns_[index]; }
+        const ColumnVector &column(std::size_t index) const { return columns_[index]; }
+
+        void set_size(std::size_t rows) noexcept { rows_ = rows; }
+        // Appends a row to every typed column.
+        void append_row(const std::vector<Value> &row);
+        void clear() noexcept;
+
+    private:
+        std::vector<ColumnVector> columns_;
+        std::size_t rows_{0};
+    };
+}
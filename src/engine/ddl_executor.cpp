@@ -6,10 +6,13 @@
 #include <fstream>
 #include <unordered_set>
 #include <limits>
+#include <memory>
 #include <cstring>
 
 #include "storage/table_heap.h"
 #include "storage/record.h"
+#include "storage/index/key_codec.h"
+#include "storage/index/key_sorter.h"
 
 #include "common/exception.h"
 #include "common/config.h"
@@ -184,6 +187,8 @@ namespace kizuna::engine
             throw QueryException::table_not_found(stmt.table_name);
         }
         pm_.free_page(table_entry.root_page_id);
+        if (table_entry.fsm_root_page_id != config::INVALID_PAGE_ID)
+            FreeSpaceMap::destroy(pm_, table_entry.fsm_root_page_id);
         auto table_file = FileManager::table_path(table_entry.table_id);
         if (FileManager::exists(table_file))
         {
@@ -243,9 +248,16 @@ namespace kizuna::engine
         entry.create_sql = std::string(original_sql);
 
         auto created = catalog_.create_index(entry);
-        auto handle = index_manager_.CreateIndex(created);
-        created.root_page_id = handle->tree().root_page_id();
-        catalog_.set_index_root(created.index_id, created.root_page_id);
+        try
+        {
+            bulk_build_indexes(table_entry, columns, {created});
+        }
+        catch (...)
+        {
+            index_manager_.DropIndex(created);
+            catalog_.drop_index(created.name);
+            throw;
+        }
         return "Index created: " + created.name;
     }
 
@@ -307,6 +319,8 @@ namespace kizuna::engine
             auto added_entry = catalog_.add_column(table_entry.table_id, column);
             catalog_.set_table_root(table_entry.table_id, new_root);
             TableHeapMigration::free_chain(pm_, table_entry.root_page_id);
+            if (table_entry.fsm_root_page_id != config::INVALID_PAGE_ID)
+                FreeSpaceMap::destroy(pm_, table_entry.fsm_root_page_id);
             if (auto updated_entry = catalog_.get_table(table_entry.table_id))
             {
                 rebuild_table_indexes(*updated_entry);
@@ -344,6 +358,8 @@ namespace kizuna::engine
             (void)dropped_entry;
             catalog_.set_table_root(table_entry.table_id, new_root);
             TableHeapMigration::free_chain(pm_, table_entry.root_page_id);
+            if (table_entry.fsm_root_page_id != config::INVALID_PAGE_ID)
+                FreeSpaceMap::destroy(pm_, table_entry.fsm_root_page_id);
             if (auto updated_entry = catalog_.get_table(table_entry.table_id))
             {
                 rebuild_table_indexes(*updated_entry);
@@ -475,33 +491,30 @@ namespace kizuna::engine
         if (indexes.empty())
             return;
 
-        struct RowSnapshot
-        {
-            record_id_t record_id;
-            std::vector<Value> values;
-        };
-        std::vector<RowSnapshot> rows;
-        TableHeap heap(pm_, table_entry.root_page_id);
-        heap.scan([&](const TableHeap::RowLocation &loc, const std::vector<uint8_t> &payload)
-                  {
-            RowSnapshot snap;
-            snap.record_id = make_record_id(loc);
-            snap.values = decode_row_values(columns, payload);
-            rows.push_back(std::move(snap)); });
+        bulk_build_indexes(table_entry, columns, indexes);
+    }
 
-        for (auto &idx : indexes)
-        {
-            index_manager_.DropIndex(idx);
-            catalog::IndexCatalogEntry temp_entry = idx;
-            temp_entry.root_page_id = config::INVALID_PAGE_ID;
-            auto handle = index_manager_.CreateIndex(temp_entry);
-            auto &tree = handle->tree();
-            catalog_.set_index_root(idx.index_id, tree.root_page_id());
+    void DDLExecutor::bulk_build_indexes(const catalog::TableCatalogEntry &table_entry,
+                                         const std::vector<catalog::ColumnCatalogEntry> &columns,
+                                         const std::vector<catalog::IndexCatalogEntry> &indexes)
+    {
+        auto lookup = build_column_lookup(columns);
 
+        struct IndexBuild
+        {
             std::vector<catalog::ColumnCatalogEntry> key_columns;
-            key_columns.reserve(idx.column_ids.size());
             std::vector<std::size_t> key_positions;
-            key_positions.reserve(idx.column_ids.size());
+            bool unique{false};
+            std::unique_ptr<index::KeySorter> sorter;
+        };
+        std::vector<IndexBuild> builds;
+        builds.reserve(indexes.size());
+        for (const auto &idx : indexes)
+        {
+            IndexBuild build;
+            build.unique = idx.is_unique;
+            build.key_columns.reserve(idx.column_ids.size());
+            build.key_positions.reserve(idx.column_ids.size());
             for (auto column_id : idx.column_ids)
             {
                 auto it = lookup.find(column_id);
@@ -509,44 +522,91 @@ namespace kizuna::engine
                 {
                     KIZUNA_THROW_INDEX(StatusCode::INVALID_ARGUMENT, "Index column metadata missing", std::to_string(column_id));
                 }
-                key_positions.push_back(it->second);
-                key_columns.push_back(columns[it->second]);
+                build.key_positions.push_back(it->second);
+                build.key_columns.push_back(columns[it->second]);
             }
+            build.sorter = std::make_unique<index::KeySorter>(config::INDEX_BUILD_SORT_MEMORY / indexes.size());
+            builds.push_back(std::move(build));
+        }
 
-            for (const auto &row : rows)
-            {
-                std::vector<Value> key_values;
-                key_values.reserve(key_positions.size());
-                for (auto pos : key_positions)
-                {
-                    key_values.push_back(row.values[pos]);
-                }
-                auto key = encode_index_key(key_columns, key_values);
-                tree.Insert(key, row.record_id);
-            }
+        // One pass over the heap feeds every index's sorter with its (key, record id) pairs.
+        TableHeap heap(pm_, table_entry.root_page_id, table_entry.tail_page_id, table_entry.fsm_root_page_id);
+        BufferAccessStrategy bulk_read(pm_);
+        record::RecordLayout layout;
+        std::vector<Value> key_values;
+        heap.scan([&](const TableHeap::RowLocation &loc, std::span<const uint8_t> payload)
+                  {
+            const auto values = decode_row_values(columns, payload, &layout);
+            const record_id_t record_id = make_record_id(loc);
+            for (auto &build : builds)
+            {
+                key_values.clear();
+                for (auto pos : build.key_positions)
+                    key_values.push_back(values[pos]);
+                build.sorter->Add(index::encode_index_key(build.key_columns, key_values,
+                                                   build.unique ? std::nullopt : std::optional<record_id_t>(record_id)),
+                                  record_id);
+            } },
+                  &bulk_read);
+
+        for (std::size_t i = 0; i < indexes.size(); ++i)
+        {
+            const auto &idx = indexes[i];
+            index_manager_.DropIndex(idx);
+            catalog::IndexCatalogEntry temp_entry = idx;
+            temp_entry.root_page_id = config::INVALID_PAGE_ID;
+            auto handle = index_manager_.CreateIndex(temp_entry);
+            auto &tree = handle->tree();
+
+            auto loader = tree.StartBulkLoad();
+            builds[i].sorter->Drain([&](std::span<const uint8_t> key, record_id_t record_id)
+                                    { loader.Add(key, record_id); });
+            loader.Finish();
             catalog_.set_index_root(idx.index_id, tree.root_page_id());
+            catalog_.set_index_key_format(idx.index_id, catalog::CURRENT_INDEX_KEY_FORMAT);
         }
     }
 
+    bool DDLExecutor::upgrade_index_keys(table_id_t table_id)
+    {
+        auto indexes = catalog_.get_indexes(table_id);
+        bool legacy = std::any_of(indexes.begin(), indexes.end(), [](const catalog::IndexCatalogEntry &entry) {
+            return entry.key_format != catalog::CURRENT_INDEX_KEY_FORMAT;
+        });
+        if (!legacy)
+            return false;
+
+        auto table_entry = catalog_.get_table(table_id);
+        if (!table_entry)
+            throw QueryException::table_not_found(std::to_string(table_id));
+        rebuild_table_indexes(*table_entry);
+        return true;
+    }
+
     std::vector<Value> DDLExecutor::decode_row_values(const std::vector<catalog::ColumnCatalogEntry> &columns,
-                                                      const std::vector<uint8_t> &payload) const
+                                                      std::span<const uint8_t> payload,
+                                                      record::RecordLayout *layout) const
     {
-        std::vector<record::Field> fields;
-        if (!record::decode(payload.data(), payload.size(), fields))
+        record::RowView row(payload, layout);
+        if (!row.valid())
         {
             throw DBException(StatusCode::INVALID_RECORD_FORMAT, "Failed to decode row", "table row");
         }
-        if (fields.size() != columns.size())
+        if (row.field_count() != columns.size())
         {
             throw DBException(StatusCode::INVALID_ARGUMENT, "Decoded field count mismatch", "table row");
         }
 
         std::vector<Value> values;
         values.reserve(columns.size());
+        record::FieldView field;
         for (std::size_t i = 0; i < columns.size(); ++i)
         {
             const auto &col = columns[i].column;
-            const auto &field = fields[i];
+            if (!row.field(i, field))
+            {
+                throw DBException(StatusCode::INVALID_RECORD_FORMAT, "Failed to decode row", "table row");
+            }
             if (field.is_null)
             {
                 values.push_back(Value::null(col.type));
@@ -556,62 +616,33 @@ namespace kizuna::engine
             switch (col.type)
             {
             case DataType::BOOLEAN:
-            {
-                bool v = !field.payload.empty() && field.payload[0] != 0;
-                values.push_back(Value::boolean(v));
+                values.push_back(Value::boolean(field.as_bool()));
                 break;
-            }
             case DataType::INTEGER:
-            {
-                int32_t v = 0;
-                std::memcpy(&v, field.payload.data(), sizeof(int32_t));
-                values.push_back(Value::int32(v));
+                values.push_back(Value::int32(field.as_int32()));
                 break;
-            }
             case DataType::BIGINT:
-            {
-                int64_t v = 0;
-                std::memcpy(&v, field.payload.data(), sizeof(int64_t));
-                values.push_back(Value::int64(v));
+                values.push_back(Value::int64(field.as_int64()));
                 break;
-            }
             case DataType::DATE:
-            {
-                int64_t v = 0;
-                std::memcpy(&v, field.payload.data(), sizeof(int64_t));
-                values.push_back(Value::date(v));
+                values.push_back(Value::date(field.as_int64()));
                 break;
-            }
             case DataType::TIMESTAMP:
-            {
-                int64_t v = 0;
-                std::memcpy(&v, field.payload.data(), sizeof(int64_t));
-                values.push_back(Value::int64(v));
+                values.push_back(Value::int64(field.as_int64()));
                 break;
-            }
             case DataType::FLOAT:
-            {
-                float v = 0.0f;
-                std::memcpy(&v, field.payload.data(), sizeof(float));
-                values.push_back(Value::floating(static_cast<double>(v)));
+                values.push_back(Value::floating(static_cast<double>(field.as_float())));
                 break;
-            }
             case DataType::DOUBLE:
-            {
-                double v = 0.0;
-                std::memcpy(&v, field.payload.data(), sizeof(double));
-                values.push_back(Value::floating(v));
+                values.push_back(Value::floating(field.as_double()));
                 break;
-            }
             case DataType::VARCHAR:
             case DataType::TEXT:
-            {
-                std::string text(reinterpret_cast<const char *>(field.payload.data()), field.payload.size());
-                values.push_back(Value::string(std::move(text), col.type));
+                values.push_back(Value::string(std::string(field.as_string_view()), col.type));
                 break;
-            }
             default:
-                throw QueryException::unsupported_type("Unsupported column type for index rebuild");
+                values.push_back(Value::string("<unsupported>"));
+                break;
             }
         }
         return values;
@@ -628,49 +659,6 @@ namespace kizuna::engine
         return lookup;
     }
 
-    std::vector<uint8_t> DDLExecutor::encode_index_key(const std::vector<catalog::ColumnCatalogEntry> &key_columns,
-                                                       const std::vector<Value> &values) const
-    {
-        std::vector<record::Field> fields;
-        fields.reserve(key_columns.size());
-        for (std::size_t i = 0; i < key_columns.size(); ++i)
-        {
-            const auto &column = key_columns[i].column;
-            const auto &value = values[i];
-            if (value.is_null())
-            {
-                fields.push_back(record::from_null(column.type));
-                continue;
-            }
-
-            switch (column.type)
-            {
-            case DataType::BOOLEAN:
-                fields.push_back(record::from_bool(value.as_bool()));
-                break;
-            case DataType::INTEGER:
-                fields.push_back(record::from_int32(value.as_int32()));
-                break;
-            case DataType::BIGINT:
-            case DataType::DATE:
-            case DataType::TIMESTAMP:
-                fields.push_back(record::from_int64(value.as_int64()));
-                break;
-            case DataType::FLOAT:
-            case DataType::DOUBLE:
-                fields.push_back(record::from_double(value.as_double()));
-                break;
-            case DataType::VARCHAR:
-            case DataType::TEXT:
-                fields.push_back(record::from_string(value.as_string()));
-                break;
-            default:
-                throw QueryException::unsupported_type("Unsupported index column type");
-            }
-        }
-        return record::encode(fields);
-    }
-
     record_id_t DDLExecutor::make_record_id(const TableHeap::RowLocation &loc)
     {
         return (static_cast<record_id_t>(loc.page_id) << 32) | static_cast<record_id_t>(loc.slot);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <optional>
+#include <span>
 #include <unordered_map>
 #include <string>
 #include <string_view>
@@ -9,6 +10,7 @@
 #include "sql/ddl_parser.h"
 #include "storage/index/index_manager.h"
 #include "storage/table_heap.h"
+#include "storage/record.h"
 #include "common/value.h"
 
 namespace kizuna::engine
@@ -24,6 +26,9 @@ namespace kizuna::engine
         catalog::TableCatalogEntry create_table(std::string_view sql);
         void drop_table(std::string_view sql);
         std::string execute(std::string_view sql);
+        // Rebuilds the table's indexes when any still holds legacy record-encoded
+        // keys; returns true if a rebuild happened.
+        bool upgrade_index_keys(table_id_t table_id);
 
     private:
         catalog::CatalogManager &catalog_;
@@ -45,11 +50,15 @@ namespace kizuna::engine
         static std::optional<Value> parse_default_literal(const ColumnDef &column);
 
         void rebuild_table_indexes(const catalog::TableCatalogEntry &table_entry);
+        // Scans the table once, sorts each index's (key, record id) pairs and bulk-loads
+        // a fresh tree per index.
+        void bulk_build_indexes(const catalog::TableCatalogEntry &table_entry,
+                                const std::vector<catalog::ColumnCatalogEntry> &columns,
+                                const std::vector<catalog::IndexCatalogEntry> &indexes);
         std::vector<Value> decode_row_values(const std::vector<catalog::ColumnCatalogEntry> &columns,
-                                             const std::vector<uint8_t> &payload) const;
+                                             std::span<const uint8_t> payload,
+                                             record::RecordLayout *layout = nullptr) const;
         std::unordered_map<column_id_t, std::size_t> build_column_lookup(const std::vector<catalog::ColumnCatalogEntry> &columns) const;
-        std::vector<uint8_t> encode_index_key(const std::vector<catalog::ColumnCatalogEntry> &key_columns,
-                                              const std::vector<Value> &values) const;
         static record_id_t make_record_id(const TableHeap::RowLocation &loc);
 
         static ColumnConstraint map_constraint(const sql::ColumnConstraintAST &constraint);
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <functional>
+#include <iterator>
 #include <memory>
 #include <cstring>
 #include <limits>
@@ -14,7 +15,11 @@
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "engine/batch_predicate.h"
+#include "engine/ddl_executor.h"
 #include "engine/expression_evaluator.h"
+#include "engine/hash_join.h"
+#include "storage/index/key_codec.h"
 #include "storage/record.h"
 
 namespace kizuna::engine
@@ -35,6 +40,127 @@ namespace kizuna::engine
         constexpr std::string_view kClauseUpdateSet = "SET clause";
         constexpr std::string_view kClauseDeleteTarget = "DELETE target";
         constexpr std::string_view kClauseTruncateTarget = "TRUNCATE target";
+        constexpr std::string_view kClauseVacuumTarget = "VACUUM target";
+
+        Value field_to_value(DataType type, const record::FieldView &field)
+        {
+            if (field.is_null)
+                return Value::null(type);
+            switch (type)
+            {
+            case DataType::BOOLEAN:
+                return Value::boolean(field.as_bool());
+            case DataType::INTEGER:
+                return Value::int32(field.as_int32());
+            case DataType::BIGINT:
+                return Value::int64(field.as_int64());
+            case DataType::DATE:
+                return Value::date(field.as_int64());
+            case DataType::TIMESTAMP:
+                return Value::int64(field.as_int64());
+            case DataType::FLOAT:
+                return Value::floating(static_cast<double>(field.as_float()));
+            case DataType::DOUBLE:
+                return Value::floating(field.as_double());
+            case DataType::VARCHAR:
+            case DataType::TEXT:
+                return Value::string(std::string(field.as_string_view()), type);
+            default:
+                return Value::string("<unsupported>");
+            }
+        }
+
+        record::RowView open_row(std::span<const uint8_t> payload, std::size_t column_count,
+                                 record::RecordLayout *layout = nullptr)
+        {
+            record::RowView row(payload, layout);
+            if (!row.valid())
+            {
+                throw DBException(StatusCode::INVALID_RECORD_FORMAT, "Failed to decode row", "table row");
+            }
+            if (row.field_count() != column_count)
+            {
+                throw DBException(StatusCode::INVALID_ARGUMENT, "Decoded field count mismatch", "table row");
+            }
+            return row;
+        }
+
+        // Decodes only the listed columns (ascending row indexes) into their slots of values.
+        void decode_columns(const std::vector<catalog::ColumnCatalogEntry> &columns,
+                            const record::RowView &row,
+                            const std::vector<std::size_t> &which,
+                            std::vector<Value> &values)
+        {
+            record::FieldView field;
+            for (std::size_t index : which)
+            {
+                if (!row.field(index, field))
+                {
+                    throw DBException(StatusCode::INVALID_RECORD_FORMAT, "Failed to decode row", "table row");
+                }
+                values[index] = field_to_value(columns[index].column.type, field);
+            }
+        }
+
+        std::vector<Value> null_row(const std::vector<catalog::ColumnCatalogEntry> &columns)
+        {
+            std::vector<Value> values;
+            values.reserve(columns.size());
+            for (const auto &col : columns)
+                values.push_back(Value::null(col.column.type));
+            return values;
+        }
+
+        std::vector<std::size_t> sorted_unique(std::vector<std::size_t> indexes)
+        {
+            std::sort(indexes.begin(), indexes.end());
+            indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+            return indexes;
+        }
+
+        // Columns a SELECT reads after filtering: select list (or aggregate arguments) and
+        // ORDER BY. An empty or '*' select list needs every column.
+        std::vector<std::size_t> output_columns(const sql::SelectStatement &stmt,
+                                                std::size_t column_count,
+                                                const ExpressionEvaluator &evaluator)
+        {
+            std::vector<std::size_t> indexes;
+            bool all = stmt.columns.empty();
+            for (const auto &item : stmt.columns)
+            {
+                switch (item.kind)
+                {
+                case sql::SelectItemKind::STAR:
+                    all = true;
+                    break;
+                case sql::SelectItemKind::COLUMN:
+                    indexes.push_back(evaluator.resolve_column(item.column, kClauseSelectList).index);
+                    break;
+                case sql::SelectItemKind::AGGREGATE:
+                    if (item.aggregate.column.has_value())
+                        indexes.push_back(evaluator.resolve_column(*item.aggregate.column, kClauseAggregate).index);
+                    break;
+                }
+            }
+            if (all)
+            {
+                indexes.resize(column_count);
+                std::iota(indexes.begin(), indexes.end(), 0);
+                return indexes;
+            }
+            for (const auto &term : stmt.order_by)
+                indexes.push_back(evaluator.resolve_column(term.column, kClauseOrderBy).index);
+            return sorted_unique(std::move(indexes));
+        }
+
+        // WHERE columns of a single-table statement; empty without a predicate.
+        std::vector<std::size_t> predicate_columns(const sql::Expression *predicate, const ExpressionEvaluator &evaluator)
+        {
+            std::vector<std::size_t> indexes;
+            if (predicate)
+                evaluator.collect_columns(*predicate, indexes, kClauseWhere);
+            return sorted_unique(std::move(indexes));
+        }
 
         std::string join_strings(const std::vector<std::string> &items, std::string_view delimiter)
         {
@@ -173,6 +299,36 @@ namespace kizuna::engine
         {
             return value == TriBool::True;
         }
+
+        // Outer and inner key types an index probe can match exactly: the same type, or two
+        // integer widths. Floating-point keys are not (index encoding and compare() differ on -0.0).
+        bool index_probe_compatible(DataType outer, DataType inner) noexcept
+        {
+            auto floating = [](DataType type)
+            { return type == DataType::FLOAT || type == DataType::DOUBLE; };
+            auto integer = [](DataType type)
+            { return type == DataType::INTEGER || type == DataType::BIGINT; };
+            if (floating(outer) || floating(inner))
+                return false;
+            return outer == inner || (integer(outer) && integer(inner));
+        }
+
+        // The outer value as a key for an index column; nullopt when it cannot match any row.
+        std::optional<Value> index_probe_value(DataType column_type, const Value &value)
+        {
+            if (value.is_null())
+                return std::nullopt;
+            if (column_type == DataType::INTEGER && value.type() == DataType::BIGINT)
+            {
+                const auto v = value.as_int64();
+                if (v < std::numeric_limits<int32_t>::min() || v > std::numeric_limits<int32_t>::max())
+                    return std::nullopt;
+                return Value::int32(static_cast<int32_t>(v));
+            }
+            if (column_type == DataType::BIGINT && value.type() == DataType::INTEGER)
+                return Value::int64(static_cast<int64_t>(value.as_int32()));
+            return value;
+        }
     }
 
     struct DMLExecutor::ColumnPredicate
@@ -251,6 +407,12 @@ namespace kizuna::engine
             truncate(parsed.truncate);
             return "Table truncated";
         }
+        case sql::DMLStatementKind::VACUUM:
+        {
+            auto result = vacuum(parsed.vacuum);
+            return "Pages compacted: " + std::to_string(result.pages_compacted) +
+                   ", pages freed: " + std::to_string(result.pages_freed);
+        }
         }
         throw DBException(StatusCode::NOT_IMPLEMENTED, "Unsupported DML statement", std::string(sql));
     }
@@ -261,12 +423,17 @@ namespace kizuna::engine
         index_usage_observer_ = std::move(observer);
     }
 
+    void DMLExecutor::set_join_observer(std::function<void(const JoinReport &)> observer)
+    {
+        join_observer_ = std::move(observer);
+    }
+
     InsertResult DMLExecutor::insert_into(const sql::InsertStatement &stmt)
     {
         auto table_opt = catalog_.get_table(stmt.table_name);
         if (!table_opt)
             throw QueryException::table_not_found(stmt.table_name, kClauseInsertTarget);
-        const auto table_entry = *table_opt;
+        auto table_entry = *table_opt;
         auto columns = catalog_.get_columns(table_entry.table_id);
         if (columns.empty())
             throw QueryException::invalid_constraint("table has no columns");
@@ -282,7 +449,7 @@ namespace kizuna::engine
             throw QueryException::invalid_constraint("column count mismatch");
 
         auto index_contexts = load_table_indexes(table_entry.table_id);
-        std::vector<std::unique_ptr<index::IndexHandle>> index_handles;
+        std::vector<std::shared_ptr<index::IndexHandle>> index_handles;
         index_handles.reserve(index_contexts.size());
         for (auto &ctx : index_contexts)
         {
@@ -290,35 +457,42 @@ namespace kizuna::engine
         }
         auto column_lookup = build_column_lookup(columns);
 
-        TableHeap heap(pm_, table_entry.root_page_id);
+        TableHeap heap = open_heap_for_write(table_entry);
         std::size_t inserted = 0;
-        for (const auto &row : stmt.rows)
+        try
         {
-            if (row.values.size() != column_names.size())
-                throw QueryException::invalid_constraint("row value count mismatch");
-            auto payload = encode_row(columns, row, column_names, table_entry.name);
-            auto row_values = decode_row_values(columns, payload);
-            auto location = heap.insert(payload);
-            record_id_t record_id = make_record_id(location);
-
-            for (std::size_t i = 0; i < index_contexts.size(); ++i)
+            for (const auto &row : stmt.rows)
             {
-                auto key = build_index_key(index_contexts[i], columns, row_values, column_lookup);
-                auto &tree = index_handles[i]->tree();
-                tree.Insert(key, record_id);
-                catalog_.set_index_root(index_contexts[i].catalog_entry.index_id, tree.root_page_id());
-                index_contexts[i].catalog_entry.root_page_id = tree.root_page_id();
-            }
+                if (row.values.size() != column_names.size())
+                    throw QueryException::invalid_constraint("row value count mismatch");
+                auto payload = encode_row(columns, row, column_names, table_entry.name);
+                auto row_values = decode_row_values(columns, payload);
+                auto location = heap.insert(payload);
+                record_id_t record_id = make_record_id(location);
+
+                for (std::size_t i = 0; i < index_contexts.size(); ++i)
+                {
+                    auto key = build_index_key(index_contexts[i], columns, row_values, column_lookup, record_id);
+                    auto &tree = index_handles[i]->tree();
+                    tree.Insert(key, record_id);
+                    catalog_.set_index_root(index_contexts[i].catalog_entry.index_id, tree.root_page_id());
+                    index_contexts[i].catalog_entry.root_page_id = tree.root_page_id();
+                }
 
-            ++inserted;
+                ++inserted;
+            }
+        }
+        catch (...)
+        {
+            save_heap_state(table_entry, heap);
+            throw;
         }
+        save_heap_state(table_entry, heap);
         return InsertResult{inserted};
     }
 
     SelectResult DMLExecutor::select(const sql::SelectStatement &stmt)
     {
-        SelectResult result;
-
         const sql::TableRef base_ref = !stmt.from.table_name.empty() ? stmt.from : sql::TableRef{stmt.table_name, {}};
         auto bind_table = [&](const sql::TableRef &ref, std::string_view clause) -> BoundTable
         {
@@ -421,364 +595,653 @@ namespace kizuna::engine
         const bool has_order = !order_terms.empty();
 
         const auto *predicate = stmt.where ? stmt.where.get() : nullptr;
-        std::vector<std::vector<Value>> filtered_rows;
-        bool rows_already_sorted = false;
+        using Row = Operator::Row;
 
-        if (tables.size() == 1)
+        // Everything above the scans and joins: the aggregate, or the sort, DISTINCT and
+        // projection, then LIMIT. Pulls the plan's rows and renders them. `rows_in_order` is
+        // set when the source already yields ORDER BY order.
+        auto run_plan = [&](OperatorPtr root, bool rows_in_order)
         {
-            const auto &tbl = tables.front();
-            const auto &columns = tbl.columns;
-            auto index_contexts = load_table_indexes(tbl.table.table_id);
-            auto column_lookup = build_column_lookup(columns);
-
-            std::optional<PredicateExtraction> predicate_info;
-            if (predicate)
-                predicate_info = extract_column_predicates(predicate, columns, tbl.table.name);
-            if (predicate_info && predicate_info->contradiction)
+            SelectResult result;
+            if (has_aggregates)
             {
-                filtered_rows.clear();
+                std::vector<std::unique_ptr<Accumulator>> accumulators;
+                for (const auto &item : stmt.columns)
+                {
+                    if (item.kind != sql::SelectItemKind::AGGREGATE)
+                        continue;
+                    result.column_names.push_back(describe_aggregate(item.aggregate));
+                    accumulators.push_back(make_accumulator(item.aggregate, full_evaluator));
+                }
+                root = std::make_unique<Aggregate>(std::move(root), std::move(accumulators));
             }
             else
             {
-                std::optional<std::size_t> order_index_context;
-                if (has_order && !mixed_order_direction)
+                std::vector<std::string> projection_names;
+                auto projection = build_projection(stmt, bound_columns, full_evaluator, tables.size() > 1, projection_names);
+                if (projection.empty())
                 {
-                    for (std::size_t i = 0; i < index_contexts.size(); ++i)
+                    projection.resize(bound_columns.size());
+                    projection_names.clear();
+                    projection_names.reserve(bound_columns.size());
+                    for (std::size_t i = 0; i < bound_columns.size(); ++i)
                     {
-                        const auto &ctx = index_contexts[i];
-                        if (ctx.catalog_entry.column_ids.size() < order_terms.size())
-                            continue;
-                        bool matches = true;
-                        for (std::size_t j = 0; j < order_terms.size(); ++j)
+                        projection[i] = i;
+                        const auto &col = bound_columns[i];
+                        if (tables.size() > 1)
                         {
-                            if (ctx.catalog_entry.column_ids[j] != order_terms[j].column_id)
-                            {
-                                matches = false;
-                                break;
-                            }
+                            const std::string qualifier = col.table_alias.empty() ? col.table_name : col.table_alias;
+                            projection_names.push_back(qualifier + "." + col.column.column.name);
                         }
-                        if (matches)
+                        else
                         {
-                            order_index_context = i;
-                            break;
+                            projection_names.push_back(col.column.column.name);
                         }
                     }
                 }
+                result.column_names = projection_names;
+
+                if (has_order && !rows_in_order)
+                {
+                    root = std::make_unique<Sort>(std::move(root), [&](const Row &lhs, const Row &rhs)
+                                                  {
+                                                      for (const auto &term : order_terms)
+                                                      {
+                                                          const Value &lv = lhs[term.value_index];
+                                                          const Value &rv = rhs[term.value_index];
+                                                          const bool lhs_null = lv.is_null();
+                                                          const bool rhs_null = rv.is_null();
+                                                          if (lhs_null != rhs_null)
+                                                              return !lhs_null;
+                                                          auto cmp = compare(lv, rv);
+                                                          if (cmp == CompareResult::Less)
+                                                              return term.ascending;
+                                                          if (cmp == CompareResult::Greater)
+                                                              return !term.ascending;
+                                                      }
+                                                      return false; });
+                }
+                if (stmt.distinct)
+                {
+                    root = std::make_unique<Distinct>(std::move(root), [this, projection](const Row &row)
+                                                      { return row_signature(row, projection); });
+                }
+                root = std::make_unique<Project>(std::move(root), std::move(projection));
+            }
+            root = std::make_unique<Limit>(std::move(root), limit);
+
+            root->open();
+            Row row;
+            while (root->next(row))
+            {
+                std::vector<std::string> out_row;
+                out_row.reserve(row.size());
+                for (const auto &value : row)
+                    out_row.push_back(value.to_string());
+                result.rows.push_back(std::move(out_row));
+            }
+            root->close();
+            return result;
+        };
+
+        if (tables.size() == 1)
+        {
+            const auto &tbl = tables.front();
+            const auto &columns = tbl.columns;
+            auto index_contexts = load_table_indexes(tbl.table.table_id);
+            auto column_lookup = build_column_lookup(columns);
+
+            std::optional<PredicateExtraction> predicate_info;
+            if (predicate)
+                predicate_info = extract_column_predicates(predicate, columns, tbl.table.name);
+            if (predicate_info && predicate_info->contradiction)
+                return run_plan(std::make_unique<EmptyScan>(), true);
 
-                std::vector<record_id_t> candidate_ids;
-                bool candidate_ids_populated = false;
-                bool candidate_ids_in_final_order = false;
+            std::optional<std::size_t> order_index_context;
+            if (has_order && !mixed_order_direction)
+            {
+                std::vector<std::size_t> order_columns;
+                for (const auto &term : order_terms)
+                    order_columns.push_back(term.value_index);
+                order_index_context = find_order_index(index_contexts, columns, order_columns, all_order_descending);
+            }
+
+            // An index drives the scan when it can answer the WHERE clause or supplies the
+            // ORDER BY order; its cursor then feeds record ids one at a time, and a LIMIT
+            // above stops it once enough rows have come through.
+            std::optional<std::size_t> scan_context;
+            IndexKeyRange scan_range;
+            bool index_order = false;
 
-                if (predicate && predicate_info && !index_contexts.empty())
+            if (predicate && predicate_info && !index_contexts.empty())
+            {
+                auto spec_opt = choose_index_scan(index_contexts, *predicate_info);
+                if (spec_opt.has_value())
                 {
-                    auto spec_opt = choose_index_scan(index_contexts, *predicate_info);
-                    if (spec_opt.has_value())
-                    {
-                        auto handle = index_manager_.OpenIndex(index_contexts[spec_opt->context_index].catalog_entry);
-                        candidate_ids = run_index_scan(*spec_opt, index_contexts, *handle, columns, column_lookup);
-                        candidate_ids_populated = true;
-                        if (has_order && !mixed_order_direction && order_index_context.has_value() &&
-                            spec_opt->context_index == *order_index_context)
-                        {
-                            candidate_ids_in_final_order = true;
-                            if (all_order_descending)
-                                std::reverse(candidate_ids.begin(), candidate_ids.end());
-                        }
-                    }
+                    scan_context = spec_opt->context_index;
+                    scan_range = index_scan_range(*spec_opt, index_contexts, columns, column_lookup);
+                    index_order = has_order && !mixed_order_direction && order_index_context.has_value() &&
+                                  spec_opt->context_index == *order_index_context;
                 }
+            }
+
+            if (!scan_context.has_value() && has_order && order_index_context.has_value())
+            {
+                const auto &ctx = index_contexts[*order_index_context];
+                scan_context = order_index_context;
+                index_order = true;
 
-                if (!candidate_ids_populated && has_order && order_index_context.has_value())
+                if (predicate_info)
                 {
-                    const auto &ctx = index_contexts[*order_index_context];
-                    auto handle = index_manager_.OpenIndex(ctx.catalog_entry);
-                    std::optional<std::vector<uint8_t>> lower_key;
-                    std::optional<std::vector<uint8_t>> upper_key;
-                    bool lower_inclusive = true;
-                    bool upper_inclusive = true;
-
-                    if (predicate_info)
+                    if (!ctx.catalog_entry.column_ids.empty())
                     {
-                        if (!ctx.catalog_entry.column_ids.empty())
+                        column_id_t first_column = ctx.catalog_entry.column_ids.front();
+                        auto pred_it = predicate_info->predicates.find(first_column);
+                        if (pred_it != predicate_info->predicates.end())
                         {
-                            column_id_t first_column = ctx.catalog_entry.column_ids.front();
-                            auto pred_it = predicate_info->predicates.find(first_column);
-                            if (pred_it != predicate_info->predicates.end())
+                            const auto &col_pred = pred_it->second;
+                            auto lookup_it = column_lookup.find(first_column);
+                            if (lookup_it != column_lookup.end())
                             {
-                                const auto &col_pred = pred_it->second;
-                                auto lookup_it = column_lookup.find(first_column);
-                                if (lookup_it != column_lookup.end())
+                                std::vector<catalog::ColumnCatalogEntry> key_columns{columns[lookup_it->second]};
+                                if (col_pred.equality.has_value())
                                 {
-                                    std::vector<catalog::ColumnCatalogEntry> key_columns{columns[lookup_it->second]};
-                                    if (col_pred.equality.has_value())
+                                    std::vector<Value> key_values{col_pred.equality.value()};
+                                    auto key = index::encode_index_key(key_columns, key_values);
+                                    scan_range.lower = key;
+                                    scan_range.upper = key;
+                                }
+                                else
+                                {
+                                    if (col_pred.lower.has_value())
                                     {
-                                        std::vector<Value> key_values{col_pred.equality.value()};
-                                        auto key = encode_values(key_columns, key_values);
-                                        lower_key = key;
-                                        upper_key = key;
-                                        lower_inclusive = true;
-                                        upper_inclusive = true;
+                                        std::vector<Value> key_values{col_pred.lower.value()};
+                                        scan_range.lower = index::encode_index_key(key_columns, key_values);
+                                        scan_range.lower_inclusive = col_pred.lower_inclusive;
                                     }
-                                    else
+                                    if (col_pred.upper.has_value())
                                     {
-                                        if (col_pred.lower.has_value())
-                                        {
-                                            std::vector<Value> key_values{col_pred.lower.value()};
-                                            lower_key = encode_values(key_columns, key_values);
-                                            lower_inclusive = col_pred.lower_inclusive;
-                                        }
-                                        if (col_pred.upper.has_value())
-                                        {
-                                            std::vector<Value> key_values{col_pred.upper.value()};
-                                            upper_key = encode_values(key_columns, key_values);
-                                            upper_inclusive = col_pred.upper_inclusive;
-                                        }
+                                        std::vector<Value> key_values{col_pred.upper.value()};
+                                        scan_range.upper = index::encode_index_key(key_columns, key_values);
+                                        scan_range.upper_inclusive = col_pred.upper_inclusive;
                                     }
                                 }
                             }
                         }
                     }
-
-                    candidate_ids = handle->tree().ScanRange(lower_key, lower_inclusive, upper_key, upper_inclusive);
-                    candidate_ids_populated = true;
-                    candidate_ids_in_final_order = true;
-                    if (all_order_descending)
-                        std::reverse(candidate_ids.begin(), candidate_ids.end());
-                }
-
-                TableHeap heap(pm_, tbl.table.root_page_id);
-                auto process_row = [&](std::vector<Value> values)
-                {
-                    if (predicate && !is_true(full_evaluator.evaluate_predicate(*predicate, values, kClauseWhere)))
-                        return;
-                    filtered_rows.push_back(std::move(values));
-                };
-
-                if (candidate_ids_populated)
-                {
-                    for (record_id_t rid : candidate_ids)
-                    {
-                        std::vector<uint8_t> payload;
-                        auto location = decode_record_id(rid);
-                        if (!heap.read(location, payload))
-                            continue;
-                        auto values = decode_row_values(columns, payload);
-                        process_row(std::move(values));
-                    }
-                }
-                else
-                {
-                    heap.scan([&](const TableHeap::RowLocation &, const std::vector<uint8_t> &payload)
-                              {
-                        auto values = decode_row_values(columns, payload);
-                        process_row(std::move(values)); });
                 }
+            }
 
-                rows_already_sorted = candidate_ids_in_final_order;
+            // Late materialization: decode the WHERE columns, run the predicate, and
+            // decode the columns the rest of the query reads only for rows that pass.
+            const auto where_columns = predicate_columns(predicate, full_evaluator);
+            std::vector<std::size_t> late_columns;
+            for (std::size_t index : output_columns(stmt, columns.size(), full_evaluator))
+            {
+                if (!std::binary_search(where_columns.begin(), where_columns.end(), index))
+                    late_columns.push_back(index);
             }
-        }
-        else
-        {
-            auto build_prefix_evaluator = [&](std::size_t table_count)
+            std::vector<Value> scratch = null_row(columns);
+            record::RecordLayout layout;
+            auto decode = [&](std::span<const uint8_t> payload, Row &values)
             {
-                std::vector<ExpressionEvaluator::BindingEntry> prefix;
-                std::size_t prefix_columns = 0;
-                for (std::size_t t = 0; t < table_count; ++t)
-                    prefix_columns += tables[t].columns.size();
-                prefix.reserve(prefix_columns);
-                std::size_t index = 0;
-                for (std::size_t t = 0; t < table_count; ++t)
+                auto row = open_row(payload, columns.size(), &layout);
+                decode_columns(columns, row, where_columns, scratch);
+                if (predicate && !is_true(full_evaluator.evaluate_predicate(*predicate, scratch, kClauseWhere)))
+                    return false;
+                values = scratch;
+                decode_columns(columns, row, late_columns, values);
+                return true;
+            };
+
+            if (scan_context.has_value())
+            {
+                const auto &entry = index_contexts[*scan_context].catalog_entry;
+                auto handle = index_manager_.OpenIndex(entry);
+                const bool reverse = index_order && all_order_descending;
+                return run_plan(std::make_unique<IndexScan>([&, handle]
+                                                            { return seek_index(*handle, scan_range, reverse); },
+                                                            reverse, open_heap(tbl.table), decode, index_visit_report(entry)),
+                                index_order);
+            }
+
+            // A WHERE clause the batch kernels can run filters a column batch at a time: the
+            // batch holds only the WHERE columns, and rows that pass are decoded as above.
+            std::optional<BatchPredicate> batch_predicate;
+            if (predicate && vectorized_filters_)
+                batch_predicate = full_evaluator.compile_batch_predicate(*predicate, kClauseWhere);
+            if (!batch_predicate)
+                return run_plan(std::make_unique<SeqScan>(open_heap(tbl.table), decode), false);
+
+            std::vector<DataType> batch_types(columns.size(), DataType::NULL_TYPE);
+            for (std::size_t index : batch_predicate->columns())
+                batch_types[index] = columns[index].column.type;
+            std::vector<std::size_t> row_columns;
+            std::set_union(where_columns.begin(), where_columns.end(), late_columns.begin(), late_columns.end(),
+                           std::back_inserter(row_columns));
+            const std::vector<Value> blank = null_row(columns);
+            auto fill = [&](const BatchScan::Payloads &payloads, ColumnBatch &batch)
+            {
+                record::FieldView field;
+                for (const auto &payload : payloads)
                 {
-                    const auto &tbl = tables[t];
-                    for (const auto &col : tbl.columns)
+                    auto row = open_row(payload, columns.size(), &layout);
+                    for (std::size_t index : batch_predicate->columns())
                     {
-                        ExpressionEvaluator::BindingEntry entry;
-                        entry.column_name = col.column.name;
-                        entry.index = index++;
-                        entry.type = col.column.type;
-                        entry.qualifiers.push_back(tbl.table.name);
-                        if (!tbl.alias.empty())
-                            entry.qualifiers.push_back(tbl.alias);
-                        prefix.push_back(std::move(entry));
+                        if (!row.field(index, field))
+                            throw DBException(StatusCode::INVALID_RECORD_FORMAT, "Failed to decode row", "table row");
+                        batch.column(index).append(field);
                     }
                 }
-                return ExpressionEvaluator(prefix);
+                batch.set_size(payloads.size());
             };
-
-            std::vector<std::vector<std::vector<Value>>> table_rows;
-            table_rows.reserve(tables.size());
-            for (const auto &tbl : tables)
-            {
-                std::vector<std::vector<Value>> rows;
-                TableHeap heap(pm_, tbl.table.root_page_id);
-                heap.scan([&](const TableHeap::RowLocation &, const std::vector<uint8_t> &payload)
-                          { rows.push_back(decode_row_values(tbl.columns, payload)); });
-                table_rows.push_back(std::move(rows));
-            }
-
-            std::vector<std::vector<Value>> combined_rows;
-            if (!table_rows.empty())
+            auto filter = [&](const ColumnBatch &batch, SelectionVector &selection)
+            { batch_predicate->select(batch, selection); };
+            auto decode_selected = [&](std::span<const uint8_t> payload, Row &values)
             {
-                combined_rows = std::move(table_rows.front());
-            }
+                values = blank;
+                decode_columns(columns, open_row(payload, columns.size(), &layout), row_columns, values);
+                return true;
+            };
+            return run_plan(std::make_unique<BatchScan>(open_heap(tbl.table), ColumnBatch(batch_types), fill, filter,
+                                                        decode_selected),
+                            false);
+        }
 
-            for (std::size_t join_idx = 0; join_idx < stmt.joins.size(); ++join_idx)
+        auto build_prefix_evaluator = [&](std::size_t table_count)
+        {
+            std::vector<ExpressionEvaluator::BindingEntry> prefix;
+            std::size_t prefix_columns = 0;
+            for (std::size_t t = 0; t < table_count; ++t)
+                prefix_columns += tables[t].columns.size();
+            prefix.reserve(prefix_columns);
+            std::size_t index = 0;
+            for (std::size_t t = 0; t < table_count; ++t)
             {
-                std::vector<std::vector<Value>> next_rows;
-                next_rows.reserve(combined_rows.size() * table_rows[join_idx + 1].size());
-                auto join_evaluator = build_prefix_evaluator(join_idx + 2);
-                const auto *condition = stmt.joins[join_idx].condition.get();
-                for (const auto &left : combined_rows)
+                const auto &tbl = tables[t];
+                for (const auto &col : tbl.columns)
                 {
-                    for (const auto &right : table_rows[join_idx + 1])
-                    {
-                        std::vector<Value> merged;
-                        merged.reserve(left.size() + right.size());
-                        merged.insert(merged.end(), left.begin(), left.end());
-                        merged.insert(merged.end(), right.begin(), right.end());
-                        if (!condition || is_true(join_evaluator.evaluate_predicate(*condition, merged, kClauseJoinCondition)))
-                        {
-                            next_rows.push_back(std::move(merged));
-                        }
-                    }
+                    ExpressionEvaluator::BindingEntry entry;
+                    entry.column_name = col.column.name;
+                    entry.index = index++;
+                    entry.type = col.column.type;
+                    entry.qualifiers.push_back(tbl.table.name);
+                    if (!tbl.alias.empty())
+                        entry.qualifiers.push_back(tbl.alias);
+                    prefix.push_back(std::move(entry));
                 }
-                combined_rows = std::move(next_rows);
-                if (combined_rows.empty())
-                    break;
             }
+            return ExpressionEvaluator(prefix);
+        };
 
-            filtered_rows.reserve(combined_rows.size());
-            if (predicate)
+        // WHERE conjuncts run as soon as the tables they read have been joined, so later
+        // joins, and the choice of join strategy, see only the rows that survive them.
+        std::vector<std::size_t> prefix_width(tables.size());
+        for (std::size_t t = 0, width = 0; t < tables.size(); ++t)
+        {
+            width += tables[t].columns.size();
+            prefix_width[t] = width;
+        }
+        std::vector<std::vector<const sql::Expression *>> stage_filters(tables.size());
+        if (predicate)
+        {
+            for (const auto *conjunct : split_conjuncts(*predicate))
             {
-                for (auto &row : combined_rows)
+                std::size_t stage = tables.size() - 1;
+                try
+                {
+                    std::vector<std::size_t> read;
+                    full_evaluator.collect_columns(*conjunct, read, kClauseWhere);
+                    const std::size_t width = read.empty() ? 0 : *std::max_element(read.begin(), read.end()) + 1;
+                    stage = static_cast<std::size_t>(
+                        std::lower_bound(prefix_width.begin(), prefix_width.end(), width) - prefix_width.begin());
+                }
+                catch (const QueryException &)
                 {
-                    if (is_true(full_evaluator.evaluate_predicate(*predicate, row, kClauseWhere)))
-                        filtered_rows.push_back(std::move(row));
+                    // Left for after the joins, where evaluating it reports the error.
                 }
+                stage_filters[stage].push_back(conjunct);
             }
-            else
+        }
+        auto passes = [&](std::size_t stage, const Row &row)
+        {
+            for (const auto *conjunct : stage_filters[stage])
             {
-                filtered_rows = std::move(combined_rows);
+                if (!is_true(full_evaluator.evaluate_predicate(*conjunct, row, kClauseWhere)))
+                    return false;
             }
-        }
+            return true;
+        };
+        auto decode_table = [&](const BoundTable &tbl)
+        {
+            auto layout = std::make_shared<record::RecordLayout>();
+            return [&tbl, layout, this](std::span<const uint8_t> payload, Row &row)
+            {
+                row = decode_row_values(tbl.columns, payload, layout.get());
+                return true;
+            };
+        };
 
-        if (has_aggregates)
+        // Every join is planned before a table is read: a merge join on base table
+        // columns decides whether the base table is read in key order.
+        struct JoinPlan
         {
-            std::vector<std::string> column_names;
-            std::vector<Value> aggregate_values;
-            column_names.reserve(stmt.columns.size());
-            aggregate_values.reserve(stmt.columns.size());
-            for (const auto &item : stmt.columns)
+            ExpressionEvaluator evaluator;
+            std::optional<EquiJoinKeys> keys;
+            std::vector<TableIndexContext> inner_indexes;
+            std::optional<IndexJoinPlan> index_plan;
+            bool merge{false};
+        };
+        std::vector<JoinPlan> join_plans;
+        join_plans.reserve(stmt.joins.size());
+        for (std::size_t join_idx = 0; join_idx < stmt.joins.size(); ++join_idx)
+        {
+            auto &plan = join_plans.emplace_back(JoinPlan{build_prefix_evaluator(join_idx + 2), {}, {}, {}, false});
+            const auto *condition = stmt.joins[join_idx].condition.get();
+            if (condition)
+                plan.keys = find_equi_join_keys(*condition, plan.evaluator, prefix_width[join_idx], kClauseJoinCondition);
+            if (!plan.keys)
+                continue;
+            plan.inner_indexes = load_table_indexes(tables[join_idx + 1].table.table_id);
+            plan.index_plan = choose_index_join(plan.inner_indexes, tables[join_idx + 1].columns, *plan.keys, bound_columns);
+            // A merge join walks the inner index and pays off when its key order is the
+            // order ORDER BY asks for first.
+            if (plan.index_plan && has_order)
             {
-                if (item.kind != sql::SelectItemKind::AGGREGATE)
-                    continue;
-                column_names.push_back(describe_aggregate(item.aggregate));
-                aggregate_values.push_back(evaluate_aggregate(item.aggregate, full_evaluator, filtered_rows));
-            }
-            result.column_names = std::move(column_names);
-            if (limit == 0)
-                return result;
-            std::vector<std::string> out_row;
-            out_row.reserve(aggregate_values.size());
-            for (const auto &value : aggregate_values)
-                out_row.push_back(value.to_string());
-            if (!out_row.empty())
-                result.rows.push_back(std::move(out_row));
-            return result;
+                const auto first = order_terms.front().value_index;
+                plan.merge = first == plan.index_plan->outer_columns.front() ||
+                             first == prefix_width[join_idx] + plan.index_plan->inner_columns.front();
+            }
         }
 
-        std::vector<std::string> projection_names;
-        auto projection = build_projection(stmt, bound_columns, full_evaluator, tables.size() > 1, projection_names);
-        if (projection.empty())
+        // A last join that merges on the keys the ORDER BY terms list, in order and in one
+        // direction, already yields the final order: no Sort, so LIMIT stops pulling early.
+        bool rows_in_order = false;
+        if (!join_plans.empty() && join_plans.back().merge)
         {
-            projection.resize(bound_columns.size());
-            projection_names.clear();
-            projection_names.reserve(bound_columns.size());
-            for (std::size_t i = 0; i < bound_columns.size(); ++i)
+            const auto &index_plan = *join_plans.back().index_plan;
+            const std::size_t left_width = prefix_width[join_plans.size() - 1];
+            rows_in_order = order_terms.size() <= index_plan.outer_columns.size();
+            for (std::size_t k = 0; rows_in_order && k < order_terms.size(); ++k)
             {
-                projection[i] = i;
-                const auto &col = bound_columns[i];
-                if (tables.size() > 1)
-                {
-                    const std::string qualifier = col.table_alias.empty() ? col.table_name : col.table_alias;
-                    projection_names.push_back(qualifier + "." + col.column.column.name);
-                }
-                else
-                {
-                    projection_names.push_back(col.column.column.name);
-                }
+                const auto &term = order_terms[k];
+                rows_in_order = term.ascending == order_terms.front().ascending &&
+                                (term.value_index == index_plan.outer_columns[k] ||
+                                 term.value_index == left_width + index_plan.inner_columns[k]);
             }
         }
-        result.column_names = projection_names;
-        if (limit == 0)
-            return result;
 
-        std::vector<std::size_t> row_indices(filtered_rows.size());
-        std::iota(row_indices.begin(), row_indices.end(), 0);
+        OperatorPtr root;
+        const auto &base = tables.front();
+        std::vector<TableIndexContext> base_indexes;
+        std::optional<std::size_t> base_order_index;
+        if (!join_plans.empty() && join_plans.front().merge)
+        {
+            base_indexes = load_table_indexes(base.table.table_id);
+            base_order_index = find_order_index(base_indexes, base.columns, join_plans.front().index_plan->outer_columns, false);
+        }
+        if (base_order_index.has_value())
+        {
+            // Read through the base table's own index so the merge finds its rows in order.
+            const auto &entry = base_indexes[*base_order_index].catalog_entry;
+            auto handle = index_manager_.OpenIndex(entry);
+            const bool reverse = !order_terms.front().ascending;
+            root = std::make_unique<IndexScan>([this, handle, reverse]
+                                               { return seek_index(*handle, IndexKeyRange{}, reverse); },
+                                               reverse, open_heap(base.table), decode_table(base), index_visit_report(entry));
+        }
+        else
+        {
+            root = std::make_unique<SeqScan>(open_heap(base.table), decode_table(base));
+        }
+        if (!stage_filters.front().empty())
+        {
+            root = std::make_unique<Filter>(std::move(root), [&](const Row &row)
+                                            { return passes(0, row); });
+        }
 
-        if (!order_terms.empty() && !rows_already_sorted)
+        for (std::size_t join_idx = 0; join_idx < stmt.joins.size(); ++join_idx)
         {
-            auto comparator = [&](std::size_t lhs_idx, std::size_t rhs_idx)
+            auto planner = [&, join_idx](std::vector<Row> &left_rows) -> Join::Strategy
             {
-                const auto &lhs = filtered_rows[lhs_idx];
-                const auto &rhs = filtered_rows[rhs_idx];
-                for (const auto &term : order_terms)
+                const auto &right_table = tables[join_idx + 1];
+                const std::size_t stage = join_idx + 1;
+                auto &plan = join_plans[join_idx];
+                const auto &join_evaluator = plan.evaluator;
+                const auto &equi_keys = plan.keys;
+                const auto *condition = stmt.joins[join_idx].condition.get();
+                auto merge = [](const Row &left, const Row &right)
                 {
-                    const Value &lv = lhs[term.value_index];
-                    const Value &rv = rhs[term.value_index];
-                    const bool lhs_null = lv.is_null();
-                    const bool rhs_null = rv.is_null();
-                    if (lhs_null != rhs_null)
-                        return !lhs_null;
-                    auto cmp = compare(lv, rv);
-                    if (cmp == CompareResult::Less)
-                        return term.ascending;
-                    if (cmp == CompareResult::Greater)
-                        return !term.ascending;
+                    Row merged;
+                    merged.reserve(left.size() + right.size());
+                    merged.insert(merged.end(), left.begin(), left.end());
+                    merged.insert(merged.end(), right.begin(), right.end());
+                    return merged;
+                };
+                // Passes on a merged row that meets the rest of the ON condition and this stage's WHERE conjuncts.
+                auto accept = [&, stage](Row &&merged, const Join::Sink &sink)
+                {
+                    for (const auto *residual : equi_keys->residual)
+                    {
+                        if (!is_true(join_evaluator.evaluate_predicate(*residual, merged, kClauseJoinCondition)))
+                            return false;
+                    }
+                    if (!passes(stage, merged))
+                        return false;
+                    sink(std::move(merged));
+                    return true;
+                };
+                // Index-driven joins match the index columns; the other equality keys still need checking.
+                auto keys_match = [&](const Row &left, const Row &right)
+                {
+                    for (std::size_t k = 0; k < equi_keys->left.size(); ++k)
+                    {
+                        if (compare(left[equi_keys->left[k]], right[equi_keys->right[k]]) != CompareResult::Equal)
+                            return false;
+                    }
+                    return true;
+                };
+                auto report_join = [this](const JoinReport &report)
+                {
+                    if (join_observer_)
+                        join_observer_(report);
+                };
+
+                JoinReport report;
+                report.table = right_table.table.name;
+                report.outer_rows = left_rows.size();
+
+                std::shared_ptr<index::IndexHandle> inner_handle;
+                bool probe = false;
+                if (plan.index_plan.has_value())
+                {
+                    // Probing pays off while the outer side is small next to the inner index:
+                    // a probe reads one root-to-leaf path, a hash join reads the whole inner table.
+                    inner_handle = index_manager_.OpenIndex(plan.inner_indexes[plan.index_plan->context_index].catalog_entry);
+                    const std::size_t probe_pages = left_rows.size() * inner_handle->tree().Height();
+                    probe = left_rows.size() <= config::INDEX_JOIN_MAX_OUTER_ROWS ||
+                            probe_pages <= inner_handle->file_manager().page_count();
                 }
-                return false;
-            };
-            std::stable_sort(row_indices.begin(), row_indices.end(), comparator);
-        }
 
-        if (stmt.distinct)
-        {
-            std::unordered_set<std::string> seen;
-            seen.reserve(row_indices.size());
-            std::vector<std::size_t> deduped;
-            deduped.reserve(row_indices.size());
-            for (auto idx : row_indices)
-            {
-                const auto &row = filtered_rows[idx];
-                std::string key = row_signature(row, projection);
-                if (seen.insert(key).second)
-                    deduped.push_back(idx);
-            }
-            row_indices = std::move(deduped);
-        }
+                Join::Strategy strategy;
+                if (probe)
+                {
+                    // Probes keep the outer order, so it must be key order when the last
+                    // join stands in for the final sort.
+                    if (rows_in_order && stage == stmt.joins.size())
+                    {
+                        MergeJoin key_order(plan.index_plan->outer_columns, plan.index_plan->inner_columns, !order_terms.front().ascending);
+                        if (!key_order.left_sorted(left_rows))
+                        {
+                            key_order.sort_left(left_rows);
+                            report.sorted_outer = true;
+                        }
+                    }
+                    const auto &entry = plan.inner_indexes[plan.index_plan->context_index].catalog_entry;
+                    auto heap = std::make_shared<TableHeap>(open_heap(right_table.table));
+                    strategy.per_row = [&, heap, inner_handle, accept, keys_match, merge](const Row &left, const Join::Sink &sink)
+                    {
+                        index_join(*plan.index_plan, entry, *inner_handle, *heap, right_table, left, [&](const Row &right)
+                                   {
+                                       if (keys_match(left, right))
+                                           accept(merge(left, right), sink); });
+                    };
+                    report.strategy = JoinStrategy::INDEX_NESTED_LOOP;
+                    report.index = entry.name;
+                    report_join(report);
+                }
+                else if (plan.merge)
+                {
+                    // Merge join: the inner index yields rows in key order, and the outer rows
+                    // are sorted unless an index scan or an earlier merge already ordered them.
+                    strategy.all_rows = [&, report, inner_handle, accept, keys_match, merge, report_join](std::vector<Row> &left, const Join::Sink &sink) mutable
+                    {
+                        const auto &index_plan = *plan.index_plan;
+                        const auto &entry = plan.inner_indexes[index_plan.context_index].catalog_entry;
+                        MergeJoin join(index_plan.outer_columns, index_plan.inner_columns, !order_terms.front().ascending);
+                        if (!join.left_sorted(left))
+                        {
+                            join.sort_left(left);
+                            report.sorted_outer = true;
+                        }
 
-        if (row_indices.size() > limit)
-            row_indices.resize(limit);
+                        // Only the span of outer keys is read from the inner index.
+                        const Value *first_key = nullptr;
+                        const Value *last_key = nullptr;
+                        for (const auto &row : left)
+                        {
+                            const auto &value = row[index_plan.outer_columns.front()];
+                            if (value.is_null())
+                                continue;
+                            if (!first_key)
+                                first_key = &value;
+                            last_key = &value;
+                        }
+                        IndexKeyRange range;
+                        const std::vector<catalog::ColumnCatalogEntry> bound_column{index_plan.key_columns.front()};
+                        auto bound = [&](const Value *value) -> std::optional<std::vector<uint8_t>>
+                        {
+                            auto key = index_probe_value(bound_column.front().column.type, *value);
+                            if (!key)
+                                return std::nullopt;
+                            return index::encode_index_key(bound_column, {*key});
+                        };
+                        if (first_key)
+                        {
+                            range.lower = bound(join.descending() ? last_key : first_key);
+                            range.upper = bound(join.descending() ? first_key : last_key);
+                        }
 
-        for (auto idx : row_indices)
-        {
-            const auto &row = filtered_rows[idx];
-            std::vector<std::string> out_row;
-            out_row.reserve(projection.size());
-            for (auto proj_idx : projection)
-                out_row.push_back(row[proj_idx].to_string());
-            result.rows.push_back(std::move(out_row));
+                        TableHeap heap = open_heap(right_table.table);
+                        record::RecordLayout layout;
+                        std::vector<uint8_t> payload;
+                        join.run(
+                            left,
+                            [&](const MergeJoin::RowSink &right_sink)
+                            {
+                                if (!first_key)
+                                    return;
+                                scan_index(entry, *inner_handle, range, join.descending(), [&](record_id_t rid)
+                                           {
+                                               if (heap.read(decode_record_id(rid), payload))
+                                                   right_sink(decode_row_values(right_table.columns, payload, &layout));
+                                               return true; });
+                            },
+                            [&](const Row &l, const Row &r)
+                            {
+                                if (keys_match(l, r))
+                                    accept(merge(l, r), sink);
+                            });
+                        report.strategy = JoinStrategy::MERGE;
+                        report.index = entry.name;
+                        report_join(report);
+                    };
+                }
+                else if (equi_keys.has_value())
+                {
+                    // Hash join on the equality conjuncts; the rest of the condition is checked
+                    // per match. Matches are put back into nested-loop order when the join
+                    // could not keep it, so results do not depend on the strategy.
+                    strategy.all_rows = [&, report, accept, merge, report_join](std::vector<Row> &left, const Join::Sink &sink) mutable
+                    {
+                        HashJoin join(equi_keys->left, equi_keys->right, join_memory_limit_);
+                        std::vector<Row> joined;
+                        std::vector<std::pair<std::size_t, std::size_t>> ordinals;
+                        const Join::Sink collect = [&](Row &&row)
+                        { joined.push_back(std::move(row)); };
+                        join.run(
+                            [&](const HashJoin::RowSink &left_sink)
+                            {
+                                for (auto &row : left)
+                                    left_sink(std::move(row));
+                            },
+                            [&](const HashJoin::RowSink &right_sink)
+                            {
+                                SeqScan scan(open_heap(right_table.table), decode_table(right_table));
+                                scan.open();
+                                Row row;
+                                while (scan.next(row))
+                                    right_sink(std::move(row));
+                                scan.close();
+                            },
+                            [&](std::size_t left_ordinal, const Row &l, std::size_t right_ordinal, const Row &r)
+                            {
+                                if (accept(merge(l, r), collect))
+                                    ordinals.emplace_back(left_ordinal, right_ordinal);
+                            });
+                        std::vector<std::size_t> order(joined.size());
+                        std::iota(order.begin(), order.end(), 0);
+                        if (!join.ordered())
+                        {
+                            std::sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs)
+                                      { return ordinals[lhs] < ordinals[rhs]; });
+                        }
+                        for (std::size_t idx : order)
+                            sink(std::move(joined[idx]));
+                        report.strategy = JoinStrategy::HASH;
+                        report.spilled_partitions = join.spilled_partitions();
+                        report_join(report);
+                    };
+                }
+                else
+                {
+                    auto right_rows = std::make_shared<std::vector<Row>>();
+                    SeqScan scan(open_heap(right_table.table), decode_table(right_table));
+                    scan.open();
+                    Row row;
+                    while (scan.next(row))
+                        right_rows->push_back(std::move(row));
+                    scan.close();
+                    strategy.per_row = [&, right_rows, condition, stage, merge](const Row &left, const Join::Sink &sink)
+                    {
+                        for (const auto &right : *right_rows)
+                        {
+                            auto merged = merge(left, right);
+                            if (condition && !is_true(join_evaluator.evaluate_predicate(*condition, merged, kClauseJoinCondition)))
+                                continue;
+                            if (passes(stage, merged))
+                                sink(std::move(merged));
+                        }
+                    };
+                    report.strategy = JoinStrategy::NESTED_LOOP;
+                    report_join(report);
+                }
+                return strategy;
+            };
+            root = std::make_unique<Join>(std::move(root), planner);
         }
 
-        return result;
+        return run_plan(std::move(root), rows_in_order);
     }
+
     DeleteResult DMLExecutor::delete_all(const sql::DeleteStatement &stmt)
     {
         auto table_opt = catalog_.get_table(stmt.table_name);
         if (!table_opt)
             throw QueryException::table_not_found(stmt.table_name, kClauseDeleteTarget);
-        const auto table_entry = *table_opt;
+        auto table_entry = *table_opt;
         auto index_contexts = load_table_indexes(table_entry.table_id);
-        std::vector<std::unique_ptr<index::IndexHandle>> index_handles;
+        std::vector<std::shared_ptr<index::IndexHandle>> index_handles;
         index_handles.reserve(index_contexts.size());
         for (auto &ctx : index_contexts)
         {
@@ -787,7 +1250,7 @@ namespace kizuna::engine
         auto columns = catalog_.get_columns(table_entry.table_id);
         auto column_lookup = build_column_lookup(columns);
 
-        TableHeap heap(pm_, table_entry.root_page_id);
+        TableHeap heap = open_heap_for_write(table_entry);
         ExpressionEvaluator evaluator(columns, table_entry.name);
         const auto *predicate = stmt.where ? stmt.where.get() : nullptr;
 
@@ -822,7 +1285,7 @@ namespace kizuna::engine
             record_id_t record_id = make_record_id(loc);
             for (std::size_t i = 0; i < index_contexts.size(); ++i)
             {
-                auto key = build_index_key(index_contexts[i], columns, values, column_lookup);
+                auto key = build_index_key(index_contexts[i], columns, values, column_lookup, record_id);
                 auto &tree = index_handles[i]->tree();
                 tree.Remove(key, record_id);
                 catalog_.set_index_root(index_contexts[i].catalog_entry.index_id, tree.root_page_id());
@@ -831,28 +1294,38 @@ namespace kizuna::engine
             ++deleted;
         };
 
+        // Rows are decoded in full (for index keys) only once the WHERE columns qualify them.
+        const auto where_columns = predicate_columns(predicate, evaluator);
+        std::vector<Value> scratch = null_row(columns);
+        record::RecordLayout layout;
+        auto matches = [&](std::span<const uint8_t> payload)
+        {
+            if (!predicate)
+                return true;
+            decode_columns(columns, open_row(payload, columns.size(), &layout), where_columns, scratch);
+            return is_true(evaluator.evaluate_predicate(*predicate, scratch, kClauseWhere));
+        };
+
         if (index_spec.has_value())
         {
+            std::vector<uint8_t> payload;
             for (record_id_t rid : candidate_ids)
             {
                 auto loc = decode_record_id(rid);
-                std::vector<uint8_t> payload;
                 if (!heap.read(loc, payload))
                     continue;
-                auto values = decode_row_values(columns, payload);
-                if (predicate && !is_true(evaluator.evaluate_predicate(*predicate, values, kClauseWhere)))
+                if (!matches(payload))
                     continue;
-                remove_row(loc, values);
+                remove_row(loc, decode_row_values(columns, payload, &layout));
             }
         }
         else
         {
-            heap.scan([&](const TableHeap::RowLocation &loc, const std::vector<uint8_t> &payload)
+            heap.scan([&](const TableHeap::RowLocation &loc, std::span<const uint8_t> payload)
                       {
-                auto values = decode_row_values(columns, payload);
-                if (predicate && !is_true(evaluator.evaluate_predicate(*predicate, values, kClauseWhere)))
+                if (!matches(payload))
                     return;
-                remove_row(loc, values); });
+                remove_row(loc, decode_row_values(columns, payload, &layout)); });
         }
 
         return DeleteResult{deleted};
@@ -866,9 +1339,9 @@ namespace kizuna::engine
         auto table_opt = catalog_.get_table(stmt.table_name);
         if (!table_opt)
             throw QueryException::table_not_found(stmt.table_name, kClauseUpdateTarget);
-        const auto table_entry = *table_opt;
+        auto table_entry = *table_opt;
         auto index_contexts = load_table_indexes(table_entry.table_id);
-        std::vector<std::unique_ptr<index::IndexHandle>> index_handles;
+        std::vector<std::shared_ptr<index::IndexHandle>> index_handles;
         index_handles.reserve(index_contexts.size());
         for (auto &ctx : index_contexts)
         {
@@ -883,7 +1356,7 @@ namespace kizuna::engine
             column_index.emplace(columns[i].column.name, i);
         }
 
-        TableHeap heap(pm_, table_entry.root_page_id);
+        TableHeap heap = open_heap_for_write(table_entry);
         ExpressionEvaluator evaluator(columns, table_entry.name);
         const auto *predicate = stmt.where ? stmt.where.get() : nullptr;
 
@@ -918,20 +1391,26 @@ namespace kizuna::engine
             }
         }
 
-        auto collect_target = [&](const TableHeap::RowLocation &loc, const std::vector<uint8_t> &payload)
+        const auto where_columns = predicate_columns(predicate, evaluator);
+        std::vector<Value> scratch = null_row(columns);
+        record::RecordLayout layout;
+        auto collect_target = [&](const TableHeap::RowLocation &loc, std::span<const uint8_t> payload)
         {
-            auto current_values = decode_row_values(columns, payload);
-            if (predicate && !is_true(evaluator.evaluate_predicate(*predicate, current_values, kClauseWhere)))
-                return;
-            targets.push_back(UpdateTarget{loc, std::move(current_values)});
+            if (predicate)
+            {
+                decode_columns(columns, open_row(payload, columns.size(), &layout), where_columns, scratch);
+                if (!is_true(evaluator.evaluate_predicate(*predicate, scratch, kClauseWhere)))
+                    return;
+            }
+            targets.push_back(UpdateTarget{loc, decode_row_values(columns, payload, &layout)});
         };
 
         if (index_spec.has_value())
         {
+            std::vector<uint8_t> payload;
             for (record_id_t rid : candidate_ids)
             {
                 auto loc = decode_record_id(rid);
-                std::vector<uint8_t> payload;
                 if (!heap.read(loc, payload))
                     continue;
                 collect_target(loc, payload);
@@ -939,49 +1418,58 @@ namespace kizuna::engine
         }
         else
         {
-            heap.scan([&](const TableHeap::RowLocation &loc, const std::vector<uint8_t> &payload)
+            heap.scan([&](const TableHeap::RowLocation &loc, std::span<const uint8_t> payload)
                       { collect_target(loc, payload); });
         }
 
         std::size_t updated = 0;
-        for (auto &target : targets)
+        try
         {
-            auto &current_values = target.current_values;
-            std::vector<Value> new_values = current_values;
-            for (const auto &assignment : stmt.assignments)
+            for (auto &target : targets)
             {
-                auto it = column_index.find(assignment.column_name);
-                if (it == column_index.end())
-                    throw QueryException::column_not_found(assignment.column_name, stmt.table_name, kClauseUpdateSet);
+                auto &current_values = target.current_values;
+                std::vector<Value> new_values = current_values;
+                for (const auto &assignment : stmt.assignments)
+                {
+                    auto it = column_index.find(assignment.column_name);
+                    if (it == column_index.end())
+                        throw QueryException::column_not_found(assignment.column_name, stmt.table_name, kClauseUpdateSet);
+
+                    std::size_t idx = it->second;
+                    Value evaluated = evaluator.evaluate_scalar(*assignment.value, current_values, kClauseUpdateSet);
+                    Value coerced = coerce_value_for_column(columns[idx], evaluated);
+                    new_values[idx] = coerced;
+                }
 
-                std::size_t idx = it->second;
-                Value evaluated = evaluator.evaluate_scalar(*assignment.value, current_values, kClauseUpdateSet);
-                Value coerced = coerce_value_for_column(columns[idx], evaluated);
-                new_values[idx] = coerced;
-            }
+                auto new_payload = encode_values(columns, new_values);
+                record_id_t old_record_id = make_record_id(target.location);
+                auto new_location = heap.update(target.location, new_payload);
+                record_id_t new_record_id = make_record_id(new_location);
 
-            auto new_payload = encode_values(columns, new_values);
-            record_id_t old_record_id = make_record_id(target.location);
-            auto new_location = heap.update(target.location, new_payload);
-            record_id_t new_record_id = make_record_id(new_location);
+                for (std::size_t i = 0; i < index_contexts.size(); ++i)
+                {
+                    auto old_key = build_index_key(index_contexts[i], columns, current_values, column_lookup, old_record_id);
+                    auto new_key = build_index_key(index_contexts[i], columns, new_values, column_lookup, new_record_id);
+                    if (old_record_id == new_record_id && old_key == new_key)
+                        continue;
+                    auto &tree = index_handles[i]->tree();
+                    tree.Remove(old_key, old_record_id);
+                    tree.Insert(new_key, new_record_id);
+                    catalog_.set_index_root(index_contexts[i].catalog_entry.index_id, tree.root_page_id());
+                    index_contexts[i].catalog_entry.root_page_id = tree.root_page_id();
+                }
 
-            for (std::size_t i = 0; i < index_contexts.size(); ++i)
-            {
-                auto old_key = build_index_key(index_contexts[i], columns, current_values, column_lookup);
-                auto new_key = build_index_key(index_contexts[i], columns, new_values, column_lookup);
-                if (old_record_id == new_record_id && old_key == new_key)
-                    continue;
-                auto &tree = index_handles[i]->tree();
-                tree.Remove(old_key, old_record_id);
-                tree.Insert(new_key, new_record_id);
-                catalog_.set_index_root(index_contexts[i].catalog_entry.index_id, tree.root_page_id());
-                index_contexts[i].catalog_entry.root_page_id = tree.root_page_id();
+                target.location = new_location;
+                current_values = std::move(new_values);
+                ++updated;
             }
-
-            target.location = new_location;
-            current_values = std::move(new_values);
-            ++updated;
         }
+        catch (...)
+        {
+            save_heap_state(table_entry, heap);
+            throw;
+        }
+        save_heap_state(table_entry, heap);
 
         return UpdateResult{updated};
     }
@@ -991,98 +1479,44 @@ namespace kizuna::engine
         auto table_opt = catalog_.get_table(stmt.table_name);
         if (!table_opt)
             throw QueryException::table_not_found(stmt.table_name, kClauseTruncateTarget);
-        const auto table_entry = *table_opt;
+        auto table_entry = *table_opt;
 
-        TableHeap heap(pm_, table_entry.root_page_id);
+        TableHeap heap = open_heap_for_write(table_entry);
         heap.truncate();
+        save_heap_state(table_entry, heap);
     }
 
-    std::vector<Value> DMLExecutor::decode_row_values(const std::vector<catalog::ColumnCatalogEntry> &columns,
-                                                      const std::vector<uint8_t> &payload) const
+    VacuumResult DMLExecutor::vacuum(const sql::VacuumStatement &stmt)
     {
-        std::vector<record::Field> fields;
-        if (!record::decode(payload.data(), payload.size(), fields))
-        {
-            throw DBException(StatusCode::INVALID_RECORD_FORMAT, "Failed to decode row", "table row");
-        }
-        if (fields.size() != columns.size())
-        {
-            throw DBException(StatusCode::INVALID_ARGUMENT, "Decoded field count mismatch", "table row");
-        }
+        auto table_opt = catalog_.get_table(stmt.table_name);
+        if (!table_opt)
+            throw QueryException::table_not_found(stmt.table_name, kClauseVacuumTarget);
+        auto table_entry = *table_opt;
+
+        TableHeap heap = open_heap_for_write(table_entry);
+        auto stats = heap.vacuum();
+        save_heap_state(table_entry, heap);
+        Logger::instance().debug("[VACUUM] table=", table_entry.name, " scanned=", stats.pages_scanned,
+                                 " compacted=", stats.pages_compacted, " freed=", stats.pages_freed,
+                                 " reclaimed=", stats.bytes_reclaimed);
+        return VacuumResult{stats.pages_scanned, stats.pages_compacted, stats.pages_freed, stats.bytes_reclaimed};
+    }
 
+    std::vector<Value> DMLExecutor::decode_row_values(const std::vector<catalog::ColumnCatalogEntry> &columns,
+                                                      std::span<const uint8_t> payload,
+                                                      record::RecordLayout *layout) const
+    {
+        auto row = open_row(payload, columns.size(), layout);
         std::vector<Value> values;
         values.reserve(columns.size());
+        record::FieldView field;
         for (std::size_t i = 0; i < columns.size(); ++i)
         {
-            const auto &col = columns[i].column;
-            const auto &field = fields[i];
-            if (field.is_null)
-            {
-                values.push_back(Value::null(col.type));
-                continue;
-            }
-
-            switch (col.type)
-            {
-            case DataType::BOOLEAN:
-            {
-                bool v = !field.payload.empty() && field.payload[0] != 0;
-                values.push_back(Value::boolean(v));
-                break;
-            }
-            case DataType::INTEGER:
-            {
-                int32_t v = 0;
-                std::memcpy(&v, field.payload.data(), sizeof(int32_t));
-                values.push_back(Value::int32(v));
-                break;
-            }
-            case DataType::BIGINT:
-            {
-                int64_t v = 0;
-                std::memcpy(&v, field.payload.data(), sizeof(int64_t));
-                values.push_back(Value::int64(v));
-                break;
-            }
-            case DataType::DATE:
-            {
-                int64_t v = 0;
-                std::memcpy(&v, field.payload.data(), sizeof(int64_t));
-                values.push_back(Value::date(v));
-                break;
-            }
-            case DataType::TIMESTAMP:
-            {
-                int64_t v = 0;
-                std::memcpy(&v, field.payload.data(), sizeof(int64_t));
-                values.push_back(Value::int64(v));
-                break;
-            }
-            case DataType::FLOAT:
+            if (!row.field(i, field))
             {
-                float v = 0.0f;
-                std::memcpy(&v, field.payload.data(), sizeof(float));
-                values.push_back(Value::floating(static_cast<double>(v)));
-                break;
-            }
-            case DataType::DOUBLE:
-            {
-                double v = 0.0;
-                std::memcpy(&v, field.payload.data(), sizeof(double));
-                values.push_back(Value::floating(v));
-                break;
-            }
-            case DataType::VARCHAR:
-            case DataType::TEXT:
-            {
-                std::string text(reinterpret_cast<const char *>(field.payload.data()), field.payload.size());
-                values.push_back(Value::string(std::move(text), col.type));
-                break;
-            }
-            default:
-                values.push_back(Value::string("<unsupported>"));
-                break;
+                throw DBException(StatusCode::INVALID_RECORD_FORMAT, "Failed to decode row", "table row");
             }
+            values.push_back(field_to_value(columns[i].column.type, field));
         }
         return values;
     }
@@ -1091,6 +1525,15 @@ namespace kizuna::engine
     {
         std::vector<TableIndexContext> contexts;
         auto indexes = catalog_.get_indexes(table_id);
+        bool legacy = std::any_of(indexes.begin(), indexes.end(), [](const catalog::IndexCatalogEntry &entry) {
+            return entry.key_format != catalog::CURRENT_INDEX_KEY_FORMAT;
+        });
+        if (legacy)
+        {
+            DDLExecutor ddl(catalog_, pm_, fm_, index_manager_);
+            ddl.upgrade_index_keys(table_id);
+            indexes = catalog_.get_indexes(table_id);
+        }
         contexts.reserve(indexes.size());
         for (auto &entry : indexes)
         {
@@ -1113,7 +1556,8 @@ namespace kizuna::engine
     std::vector<uint8_t> DMLExecutor::build_index_key(const TableIndexContext &ctx,
                                                       const std::vector<catalog::ColumnCatalogEntry> &columns,
                                                       const std::vector<Value> &row_values,
-                                                      const std::unordered_map<column_id_t, std::size_t> &lookup) const
+                                                      const std::unordered_map<column_id_t, std::size_t> &lookup,
+                                                      record_id_t record_id) const
     {
         std::vector<catalog::ColumnCatalogEntry> key_columns;
         std::vector<Value> key_values;
@@ -1129,7 +1573,8 @@ namespace kizuna::engine
             key_columns.push_back(columns[it->second]);
             key_values.push_back(row_values[it->second]);
         }
-        return encode_values(key_columns, key_values);
+        return index::encode_index_key(key_columns, key_values,
+                                ctx.catalog_entry.is_unique ? std::nullopt : std::optional<record_id_t>(record_id));
     }
 
     bool DMLExecutor::ColumnPredicate::bounds_compatible() const
@@ -1585,10 +2030,9 @@ namespace kizuna::engine
         return std::nullopt;
     }
 
-    std::vector<record_id_t> DMLExecutor::run_index_scan(
+    DMLExecutor::IndexKeyRange DMLExecutor::index_scan_range(
         const IndexScanSpec &spec,
         const std::vector<TableIndexContext> &index_contexts,
-        index::IndexHandle &handle,
         const std::vector<catalog::ColumnCatalogEntry> &columns,
         const std::unordered_map<column_id_t, std::size_t> &column_lookup) const
     {
@@ -1605,38 +2049,208 @@ namespace kizuna::engine
             key_columns.push_back(columns[it->second]);
         }
 
-        auto &tree = handle.tree();
-        std::vector<record_id_t> result;
+        IndexKeyRange range;
         switch (spec.kind)
         {
         case IndexScanSpec::Kind::Equality:
         {
             if (spec.equality_values.size() != key_columns.size())
-                break;
-            auto key = encode_values(key_columns, spec.equality_values);
-            result = tree.ScanEqual(key);
+            {
+                KIZUNA_THROW_INDEX(StatusCode::INVALID_ARGUMENT, "Index equality key incomplete", ctx.catalog_entry.name);
+            }
+            auto key = index::encode_index_key(key_columns, spec.equality_values);
+            range.lower = key;
+            range.upper = std::move(key);
             break;
         }
         case IndexScanSpec::Kind::Range:
         {
-            std::optional<std::vector<uint8_t>> lower;
-            std::optional<std::vector<uint8_t>> upper;
             if (spec.lower_value.has_value())
             {
                 std::vector<Value> tmp{spec.lower_value.value()};
-                lower = encode_values(key_columns, tmp);
+                range.lower = index::encode_index_key(key_columns, tmp);
+                range.lower_inclusive = spec.lower_inclusive;
             }
             if (spec.upper_value.has_value())
             {
                 std::vector<Value> tmp{spec.upper_value.value()};
-                upper = encode_values(key_columns, tmp);
+                range.upper = index::encode_index_key(key_columns, tmp);
+                range.upper_inclusive = spec.upper_inclusive;
             }
-            result = tree.ScanRange(lower, spec.lower_inclusive, upper, spec.upper_inclusive);
             break;
         }
         }
+        return range;
+    }
+
+    index::BPlusTree::Cursor DMLExecutor::seek_index(index::IndexHandle &handle,
+                                                     const IndexKeyRange &range,
+                                                     bool reverse) const
+    {
+        // Bounds hold encoded column values, which index keys extend with further key
+        // columns or, in a non-unique index, the record id. Widen an exclusive lower or
+        // inclusive upper bound past every key that extends it.
+        auto lower = range.lower;
+        auto upper = range.upper;
+        if (lower && !range.lower_inclusive)
+            lower->push_back(index::KeyEncoder::kPrefixEnd);
+        if (upper && range.upper_inclusive)
+            upper->push_back(index::KeyEncoder::kPrefixEnd);
+        return handle.tree().SeekRange(lower, range.lower_inclusive, upper, range.upper_inclusive, reverse);
+    }
+
+    IndexScan::VisitReport DMLExecutor::index_visit_report(const catalog::IndexCatalogEntry &entry) const
+    {
+        if (!index_usage_observer_)
+            return {};
+        return [this, entry](const std::vector<record_id_t> &visited)
+        { index_usage_observer_(entry, visited); };
+    }
+
+    void DMLExecutor::scan_index(const catalog::IndexCatalogEntry &entry,
+                                 index::IndexHandle &handle,
+                                 const IndexKeyRange &range,
+                                 bool reverse,
+                                 const std::function<bool(record_id_t)> &fn) const
+    {
+        std::vector<record_id_t> visited;
+        {
+            auto cursor = seek_index(handle, range, reverse);
+            while (cursor.Valid())
+            {
+                const record_id_t rid = cursor.Value();
+                if (index_usage_observer_)
+                    visited.push_back(rid);
+                if (!fn(rid))
+                    break;
+                if (reverse)
+                    cursor.Prev();
+                else
+                    cursor.Next();
+            }
+        }
         if (index_usage_observer_)
-            index_usage_observer_(ctx.catalog_entry, result);
+            index_usage_observer_(entry, visited);
+    }
+
+    std::optional<std::size_t> DMLExecutor::find_order_index(
+        const std::vector<TableIndexContext> &index_contexts,
+        const std::vector<catalog::ColumnCatalogEntry> &columns,
+        const std::vector<std::size_t> &positions,
+        bool require_not_null) const
+    {
+        for (std::size_t i = 0; i < index_contexts.size(); ++i)
+        {
+            const auto &column_ids = index_contexts[i].catalog_entry.column_ids;
+            if (column_ids.size() < positions.size())
+                continue;
+            bool matches = true;
+            for (std::size_t j = 0; j < positions.size() && matches; ++j)
+            {
+                const auto &column = columns[positions[j]];
+                matches = column_ids[j] == column.column_id &&
+                          (!require_not_null || column.column.constraint.not_null || column.column.constraint.primary_key);
+            }
+            if (matches)
+                return i;
+        }
+        return std::nullopt;
+    }
+
+    std::optional<DMLExecutor::IndexJoinPlan> DMLExecutor::choose_index_join(
+        const std::vector<TableIndexContext> &index_contexts,
+        const std::vector<catalog::ColumnCatalogEntry> &inner_columns,
+        const EquiJoinKeys &keys,
+        const std::vector<BoundColumn> &outer_columns) const
+    {
+        std::optional<IndexJoinPlan> best;
+        bool best_unique = false;
+        for (std::size_t i = 0; i < index_contexts.size(); ++i)
+        {
+            const auto &entry = index_contexts[i].catalog_entry;
+            IndexJoinPlan plan;
+            plan.context_index = i;
+            for (auto column_id : entry.column_ids)
+            {
+                std::optional<std::size_t> key;
+                for (std::size_t k = 0; k < keys.right.size() && !key; ++k)
+                {
+                    const auto &inner = inner_columns[keys.right[k]];
+                    if (inner.column_id == column_id &&
+                        index_probe_compatible(outer_columns[keys.left[k]].column.column.type, inner.column.type))
+                        key = k;
+                }
+                if (!key)
+                    break;
+                plan.outer_columns.push_back(keys.left[*key]);
+                plan.inner_columns.push_back(keys.right[*key]);
+                plan.key_columns.push_back(inner_columns[keys.right[*key]]);
+            }
+            if (plan.key_columns.empty())
+                continue;
+
+            const bool unique = entry.is_unique && plan.key_columns.size() == entry.column_ids.size();
+            if (!best || plan.key_columns.size() > best->key_columns.size() ||
+                (plan.key_columns.size() == best->key_columns.size() && unique && !best_unique))
+            {
+                best = std::move(plan);
+                best_unique = unique;
+            }
+        }
+        return best;
+    }
+
+    void DMLExecutor::index_join(const IndexJoinPlan &plan,
+                                 const catalog::IndexCatalogEntry &entry,
+                                 index::IndexHandle &handle,
+                                 TableHeap &heap,
+                                 const BoundTable &inner,
+                                 const std::vector<Value> &outer,
+                                 const std::function<void(const std::vector<Value> &)> &on_match) const
+    {
+        std::vector<Value> key_values(plan.key_columns.size());
+        for (std::size_t j = 0; j < plan.key_columns.size(); ++j)
+        {
+            auto value = index_probe_value(plan.key_columns[j].column.type, outer[plan.outer_columns[j]]);
+            if (!value)
+                return;
+            key_values[j] = std::move(*value);
+        }
+
+        IndexKeyRange range;
+        range.lower = index::encode_index_key(plan.key_columns, key_values);
+        range.upper = range.lower;
+        std::vector<record_id_t> rids;
+        scan_index(entry, handle, range, false, [&](record_id_t rid)
+                   {
+                       rids.push_back(rid);
+                       return true; });
+        // Record id order reads each heap page once per probe.
+        std::sort(rids.begin(), rids.end());
+        record::RecordLayout layout;
+        std::vector<uint8_t> payload;
+        for (record_id_t rid : rids)
+        {
+            if (heap.read(decode_record_id(rid), payload))
+                on_match(decode_row_values(inner.columns, payload, &layout));
+        }
+    }
+
+    std::vector<record_id_t> DMLExecutor::run_index_scan(
+        const IndexScanSpec &spec,
+        const std::vector<TableIndexContext> &index_contexts,
+        index::IndexHandle &handle,
+        const std::vector<catalog::ColumnCatalogEntry> &columns,
+        const std::unordered_map<column_id_t, std::size_t> &column_lookup) const
+    {
+        std::vector<record_id_t> result;
+        scan_index(index_contexts[spec.context_index].catalog_entry, handle,
+                   index_scan_range(spec, index_contexts, columns, column_lookup), false,
+                   [&](record_id_t rid)
+                   {
+                       result.push_back(rid);
+                       return true;
+                   });
         return result;
     }
 
@@ -1652,6 +2266,28 @@ namespace kizuna::engine
         return (static_cast<record_id_t>(loc.page_id) << 32) | static_cast<record_id_t>(loc.slot);
     }
 
+    TableHeap DMLExecutor::open_heap(const catalog::TableCatalogEntry &table) const
+    {
+        return TableHeap(pm_, table.root_page_id, table.tail_page_id, table.fsm_root_page_id);
+    }
+
+    TableHeap DMLExecutor::open_heap_for_write(catalog::TableCatalogEntry &table)
+    {
+        if (table.fsm_root_page_id == config::INVALID_PAGE_ID)
+        {
+            table.fsm_root_page_id = FreeSpaceMap::build(pm_, table.root_page_id);
+            catalog_.set_table_storage(table.table_id, table.tail_page_id, table.fsm_root_page_id);
+        }
+        return open_heap(table);
+    }
+
+    void DMLExecutor::save_heap_state(catalog::TableCatalogEntry &table, const TableHeap &heap)
+    {
+        table.tail_page_id = heap.tail_page_id();
+        table.fsm_root_page_id = heap.fsm_root_page_id();
+        catalog_.set_table_storage(table.table_id, table.tail_page_id, table.fsm_root_page_id);
+    }
+
     std::vector<uint8_t> DMLExecutor::encode_values(const std::vector<catalog::ColumnCatalogEntry> &columns,
                                                     const std::vector<Value> &values) const
     {
@@ -1700,7 +2336,7 @@ namespace kizuna::engine
                 throw QueryException::unsupported_type("unsupported column type");
             }
         }
-        return record::encode(fields);
+        return record::encode(fields, record::ROW_FORMAT);
     }
 
     Value DMLExecutor::coerce_value_for_column(const catalog::ColumnCatalogEntry &column,
@@ -1828,165 +2464,124 @@ namespace kizuna::engine
         return projection;
     }
 
-    Value DMLExecutor::evaluate_aggregate(const sql::AggregateCall &call,
-                                          const ExpressionEvaluator &resolver,
-                                          const std::vector<std::vector<Value>> &rows) const
+    class DMLExecutor::AggregateAccumulator : public Accumulator
     {
-        auto ensure_column = [&](const char *operation) -> ExpressionEvaluator::ResolvedColumn
+    public:
+        // Without a column the call is COUNT(*).
+        AggregateAccumulator(sql::AggregateFunction function, bool distinct,
+                             std::optional<ExpressionEvaluator::ResolvedColumn> column)
+            : function_(function), distinct_(distinct), column_(column)
         {
-            if (!call.column.has_value())
-                throw QueryException::invalid_constraint(std::string(operation) + " requires a column reference");
-            std::string clause = std::string(kClauseAggregate) + " (" + operation + ")";
-            return resolver.resolve_column(*call.column, clause);
-        };
+        }
 
-        switch (call.function)
+        void add(const Operator::Row &row) override
         {
-        case sql::AggregateFunction::COUNT:
-            if (call.is_star)
-                return Value::int64(static_cast<std::int64_t>(rows.size()));
-            else
+            if (!column_)
             {
-                auto resolved = ensure_column("COUNT");
-                std::unordered_set<std::string> seen;
-                std::int64_t count = 0;
-                for (const auto &row : rows)
-                {
-                    const Value &value = row[resolved.index];
-                    if (value.is_null())
-                        continue;
-                    if (call.is_distinct)
-                    {
-                        if (!seen.insert(value_signature(value)).second)
-                            continue;
-                    }
-                    ++count;
-                }
-                return Value::int64(count);
+                ++count_;
+                return;
             }
-        case sql::AggregateFunction::SUM:
-        {
-            auto resolved = ensure_column("SUM");
-            std::unordered_set<std::string> seen;
-            bool any = false;
-            long double total = 0.0;
-            const DataType type = resolved.type;
-            auto add_value = [&](const Value &value)
+            const Value &value = row[column_->index];
+            if (value.is_null())
+                return;
+            if (distinct_ && !seen_.insert(value_signature(value)).second)
+                return;
+
+            switch (function_)
             {
-                switch (type)
+            case sql::AggregateFunction::COUNT:
+                break;
+            case sql::AggregateFunction::SUM:
+            case sql::AggregateFunction::AVG:
+                switch (column_->type)
                 {
                 case DataType::INTEGER:
-                    total += static_cast<long double>(value.as_int32());
+                    total_ += static_cast<long double>(value.as_int32());
                     break;
                 case DataType::BIGINT:
-                    total += static_cast<long double>(value.as_int64());
+                    total_ += static_cast<long double>(value.as_int64());
                     break;
                 case DataType::FLOAT:
                 case DataType::DOUBLE:
-                    total += static_cast<long double>(value.as_double());
+                    total_ += static_cast<long double>(value.as_double());
                     break;
                 default:
-                    throw QueryException::type_error("SUM", "numeric", data_type_to_string(type));
+                    throw QueryException::type_error(aggregate_function_to_string(function_), "numeric",
+                                                     data_type_to_string(column_->type));
                 }
-            };
-
-            for (const auto &row : rows)
-            {
-                const Value &value = row[resolved.index];
-                if (value.is_null())
-                    continue;
-                if (call.is_distinct)
-                {
-                    if (!seen.insert(value_signature(value)).second)
-                        continue;
-                }
-                add_value(value);
-                any = true;
-            }
-            if (!any)
-            {
-                return Value::null(type == DataType::DOUBLE || type == DataType::FLOAT ? DataType::DOUBLE : DataType::BIGINT);
-            }
-            if (type == DataType::DOUBLE || type == DataType::FLOAT)
-                return Value::floating(static_cast<double>(total));
-            return Value::int64(static_cast<std::int64_t>(total));
-        }
-        case sql::AggregateFunction::AVG:
-        {
-            auto resolved = ensure_column("AVG");
-            std::unordered_set<std::string> seen;
-            long double total = 0.0;
-            std::int64_t count = 0;
-            for (const auto &row : rows)
-            {
-                const Value &value = row[resolved.index];
-                if (value.is_null())
-                    continue;
-                if (call.is_distinct)
+                break;
+            case sql::AggregateFunction::MIN:
+            case sql::AggregateFunction::MAX:
+                if (count_ == 0)
                 {
-                    if (!seen.insert(value_signature(value)).second)
-                        continue;
+                    best_ = value;
+                    break;
                 }
-                switch (resolved.type)
                 {
-                case DataType::INTEGER:
-                    total += static_cast<long double>(value.as_int32());
-                    break;
-                case DataType::BIGINT:
-                    total += static_cast<long double>(value.as_int64());
-                    break;
-                case DataType::FLOAT:
-                case DataType::DOUBLE:
-                    total += static_cast<long double>(value.as_double());
-                    break;
-                default:
-                    throw QueryException::type_error("AVG", "numeric", data_type_to_string(resolved.type));
+                    const auto cmp = compare(value, best_);
+                    if (function_ == sql::AggregateFunction::MIN && cmp == CompareResult::Less)
+                        best_ = value;
+                    else if (function_ == sql::AggregateFunction::MAX && cmp == CompareResult::Greater)
+                        best_ = value;
                 }
-                ++count;
+                break;
             }
-            if (count == 0)
-                return Value::null(DataType::DOUBLE);
-            double avg = static_cast<double>(total / static_cast<long double>(count));
-            return Value::floating(avg);
+            ++count_;
         }
-        case sql::AggregateFunction::MIN:
-        case sql::AggregateFunction::MAX:
+
+        Value result() const override
         {
-            auto resolved = ensure_column(call.function == sql::AggregateFunction::MIN ? "MIN" : "MAX");
-            std::unordered_set<std::string> seen;
-            bool has_value = false;
-            Value best;
-            for (const auto &row : rows)
+            switch (function_)
             {
-                const Value &value = row[resolved.index];
-                if (value.is_null())
-                    continue;
-                if (call.is_distinct)
-                {
-                    if (!seen.insert(value_signature(value)).second)
-                        continue;
-                }
-                if (!has_value)
-                {
-                    best = value;
-                    has_value = true;
-                    continue;
-                }
-                auto cmp = compare(value, best);
-                if (call.function == sql::AggregateFunction::MIN && cmp == CompareResult::Less)
-                    best = value;
-                else if (call.function == sql::AggregateFunction::MAX && cmp == CompareResult::Greater)
-                    best = value;
+            case sql::AggregateFunction::COUNT:
+                return Value::int64(count_);
+            case sql::AggregateFunction::SUM:
+            {
+                const bool floating = column_->type == DataType::DOUBLE || column_->type == DataType::FLOAT;
+                if (count_ == 0)
+                    return Value::null(floating ? DataType::DOUBLE : DataType::BIGINT);
+                if (floating)
+                    return Value::floating(static_cast<double>(total_));
+                return Value::int64(static_cast<std::int64_t>(total_));
             }
-            if (!has_value)
-                return Value::null(resolved.type);
-            return best;
-        }
+            case sql::AggregateFunction::AVG:
+                if (count_ == 0)
+                    return Value::null(DataType::DOUBLE);
+                return Value::floating(static_cast<double>(total_ / static_cast<long double>(count_)));
+            case sql::AggregateFunction::MIN:
+            case sql::AggregateFunction::MAX:
+                if (count_ == 0)
+                    return Value::null(column_->type);
+                return best_;
+            }
+            throw QueryException::invalid_constraint("Unsupported aggregate function");
         }
-        throw QueryException::invalid_constraint("Unsupported aggregate function");
+
+    private:
+        sql::AggregateFunction function_;
+        bool distinct_;
+        std::optional<ExpressionEvaluator::ResolvedColumn> column_;
+        std::unordered_set<std::string> seen_;
+        std::int64_t count_{0}; // values folded in
+        long double total_{0.0};
+        Value best_;
+    };
+
+    std::unique_ptr<Accumulator> DMLExecutor::make_accumulator(const sql::AggregateCall &call,
+                                                               const ExpressionEvaluator &resolver) const
+    {
+        if (call.function == sql::AggregateFunction::COUNT && call.is_star)
+            return std::make_unique<AggregateAccumulator>(call.function, false, std::nullopt);
+
+        const std::string operation = aggregate_function_to_string(call.function);
+        if (!call.column.has_value())
+            throw QueryException::invalid_constraint(operation + " requires a column reference");
+        const std::string clause = std::string(kClauseAggregate) + " (" + operation + ")";
+        return std::make_unique<AggregateAccumulator>(call.function, call.is_distinct,
+                                                      resolver.resolve_column(*call.column, clause));
     }
 
-    std::string DMLExecutor::value_signature(const Value &value) const
+    std::string DMLExecutor::value_signature(const Value &value)
     {
         std::string signature = std::to_string(static_cast<int>(value.type()));
         signature.push_back('|');
@@ -2144,7 +2739,7 @@ namespace kizuna::engine
             fields.push_back(std::move(field));
         }
 
-        return record::encode(fields);
+        return record::encode(fields, record::ROW_FORMAT);
     }
 
 } // namespace kizuna::engine
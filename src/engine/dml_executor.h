@@ -1,17 +1,24 @@
 #pragma once
 
 #include <functional>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
 
 #include "catalog/catalog_manager.h"
+#include "common/config.h"
 #include "engine/expression_evaluator.h"
+#include "engine/hash_join.h"
+#include "engine/merge_join.h"
+#include "engine/operators.h"
 #include "common/value.h"
 #include "sql/ast.h"
 #include "sql/dml_parser.h"
 #include "storage/index/index_manager.h"
+#include "storage/record.h"
 #include "storage/table_heap.h"
 
 namespace kizuna::engine
@@ -31,12 +38,39 @@ namespace kizuna::engine
         std::size_t rows_updated{0};
     };
 
+    struct VacuumResult
+    {
+        std::size_t pages_scanned{0};
+        std::size_t pages_compacted{0};
+        std::size_t pages_freed{0};
+        std::size_t bytes_reclaimed{0};
+    };
+
     struct SelectResult
     {
         std::vector<std::string> column_names;
         std::vector<std::vector<std::string>> rows;
     };
 
+    enum class JoinStrategy
+    {
+        NESTED_LOOP,
+        HASH,
+        INDEX_NESTED_LOOP,
+        MERGE
+    };
+
+    // How select() executed one JOIN clause.
+    struct JoinReport
+    {
+        std::string table;                 // the joined (right-hand) table
+        JoinStrategy strategy{JoinStrategy::NESTED_LOOP};
+        std::size_t outer_rows{0};         // rows of the left-hand side it was joined to
+        std::string index;                 // probed or walked inner index (INDEX_NESTED_LOOP, MERGE)
+        std::size_t spilled_partitions{0}; // HASH
+        bool sorted_outer{false};          // MERGE, or an ordered INDEX_NESTED_LOOP: the left-hand rows had to be sorted first
+    };
+
     class DMLExecutor
     {
     public:
@@ -50,35 +84,54 @@ namespace kizuna::engine
         DeleteResult delete_all(const sql::DeleteStatement &stmt);
         UpdateResult update_all(const sql::UpdateStatement &stmt);
         void truncate(const sql::TruncateStatement &stmt);
+        VacuumResult vacuum(const sql::VacuumStatement &stmt);
 
         std::string execute(std::string_view sql);
 
         void set_index_usage_observer(std::function<void(const catalog::IndexCatalogEntry &,
                                                          const std::vector<record_id_t> &)> observer);
+        void set_join_observer(std::function<void(const JoinReport &)> observer);
+        // Memory an equi-join may hold before it partitions its inputs to temp_dir().
+        void set_join_memory_limit(std::size_t bytes) noexcept { join_memory_limit_ = bytes; }
+        // Whether a single-table SELECT without an index scan may filter whole column batches
+        // (on by default); off, every row runs through ExpressionEvaluator::evaluate_predicate().
+        void set_vectorized_filters(bool enabled) noexcept { vectorized_filters_ = enabled; }
 
     private:
         catalog::CatalogManager &catalog_;
         PageManager &pm_;
         FileManager &fm_;
         index::IndexManager &index_manager_;
+        std::size_t join_memory_limit_{config::HASH_JOIN_MEMORY};
+        bool vectorized_filters_{true};
 
+        // A layout shared across one scan lets fixed-offset rows skip the field walk.
         std::vector<Value> decode_row_values(const std::vector<catalog::ColumnCatalogEntry> &columns,
-                                             const std::vector<uint8_t> &payload) const;
+                                             std::span<const uint8_t> payload,
+                                             record::RecordLayout *layout = nullptr) const;
         struct TableIndexContext
         {
             catalog::IndexCatalogEntry catalog_entry;
         };
+        // Indexes still holding legacy record-encoded keys are rebuilt before use.
         std::vector<TableIndexContext> load_table_indexes(table_id_t table_id) const;
         std::unordered_map<column_id_t, std::size_t> build_column_lookup(const std::vector<catalog::ColumnCatalogEntry> &columns) const;
         std::vector<uint8_t> build_index_key(const TableIndexContext &ctx,
                                              const std::vector<catalog::ColumnCatalogEntry> &columns,
                                              const std::vector<Value> &row_values,
-                                             const std::unordered_map<column_id_t, std::size_t> &lookup) const;
+                                             const std::unordered_map<column_id_t, std::size_t> &lookup,
+                                             record_id_t record_id) const;
         static record_id_t make_record_id(const TableHeap::RowLocation &loc);
+        // Heaps open with the catalog's stored tail and free-space map. Writers build the map
+        // on first use for tables that predate it, and save tail changes afterwards.
+        TableHeap open_heap(const catalog::TableCatalogEntry &table) const;
+        TableHeap open_heap_for_write(catalog::TableCatalogEntry &table);
+        void save_heap_state(catalog::TableCatalogEntry &table, const TableHeap &heap);
         std::vector<uint8_t> encode_row(const std::vector<catalog::ColumnCatalogEntry> &columns,
                                         const sql::InsertRow &row,
                                         const std::vector<std::string> &column_names,
                                         std::string_view table_name);
+        // Encodes a row payload in record::ROW_FORMAT, enforcing NOT NULL and VARCHAR length.
         std::vector<uint8_t> encode_values(const std::vector<catalog::ColumnCatalogEntry> &columns,
                                            const std::vector<Value> &values) const;
         Value coerce_value_for_column(const catalog::ColumnCatalogEntry &column,
@@ -97,6 +150,31 @@ namespace kizuna::engine
             std::string table_alias;
         };
 
+        // An inner-table index whose leading columns are all equi-join keys, probed with the
+        // outer row's values for them.
+        struct IndexJoinPlan
+        {
+            std::size_t context_index{0};
+            std::vector<std::size_t> outer_columns;               // outer row position per key column
+            std::vector<std::size_t> inner_columns;               // inner row position per key column
+            std::vector<catalog::ColumnCatalogEntry> key_columns; // the index's leading columns
+        };
+        // Prefers the index covering the most key columns, then a unique one. Floating-point
+        // keys are left to the hash join, whose equality matches compare().
+        std::optional<IndexJoinPlan> choose_index_join(const std::vector<TableIndexContext> &index_contexts,
+                                                       const std::vector<catalog::ColumnCatalogEntry> &inner_columns,
+                                                       const EquiJoinKeys &keys,
+                                                       const std::vector<BoundColumn> &outer_columns) const;
+        // One step of an index nested-loop join: probes the index with the outer row's key and
+        // reads the inner rows it finds, in record id order. A NULL key matches nothing.
+        void index_join(const IndexJoinPlan &plan,
+                        const catalog::IndexCatalogEntry &entry,
+                        index::IndexHandle &handle,
+                        TableHeap &heap,
+                        const BoundTable &inner,
+                        const std::vector<Value> &outer,
+                        const std::function<void(const std::vector<Value> &)> &on_match) const;
+
         std::vector<size_t> build_projection(const sql::SelectStatement &stmt,
                                              const std::vector<BoundColumn> &columns,
                                              const ExpressionEvaluator &resolver,
@@ -107,11 +185,12 @@ namespace kizuna::engine
                                       const sql::ColumnRef &ref,
                                       std::string_view clause) const;
 
-        Value evaluate_aggregate(const sql::AggregateCall &call,
-                                 const ExpressionEvaluator &resolver,
-                                 const std::vector<std::vector<Value>> &rows) const;
+        class AggregateAccumulator;
+        // Resolves the call's column up front; the accumulator then folds rows one at a time.
+        std::unique_ptr<Accumulator> make_accumulator(const sql::AggregateCall &call,
+                                                      const ExpressionEvaluator &resolver) const;
 
-        std::string value_signature(const Value &value) const;
+        static std::string value_signature(const Value &value);
         std::string row_signature(const std::vector<Value> &row,
                                   const std::vector<size_t> &projection) const;
 
@@ -124,8 +203,40 @@ namespace kizuna::engine
             const sql::Expression *predicate,
             const std::vector<catalog::ColumnCatalogEntry> &columns,
             const std::string &table_name) const;
+        // The first index whose leading columns are `positions` of `columns`, in order, so
+        // walking it yields rows sorted on them. Index keys put NULLs last; with
+        // `require_not_null` (for backward walks) the columns must be NOT NULL.
+        std::optional<std::size_t> find_order_index(const std::vector<TableIndexContext> &index_contexts,
+                                                    const std::vector<catalog::ColumnCatalogEntry> &columns,
+                                                    const std::vector<std::size_t> &positions,
+                                                    bool require_not_null) const;
         std::optional<IndexScanSpec> choose_index_scan(const std::vector<TableIndexContext> &index_contexts,
                                                        const PredicateExtraction &predicates) const;
+        struct IndexKeyRange
+        {
+            std::optional<std::vector<uint8_t>> lower;
+            bool lower_inclusive{true};
+            std::optional<std::vector<uint8_t>> upper;
+            bool upper_inclusive{true};
+        };
+        IndexKeyRange index_scan_range(const IndexScanSpec &spec,
+                                       const std::vector<TableIndexContext> &index_contexts,
+                                       const std::vector<catalog::ColumnCatalogEntry> &columns,
+                                       const std::unordered_map<column_id_t, std::size_t> &column_lookup) const;
+        // A tree cursor over the range, positioned at its last entry when reverse is set.
+        index::BPlusTree::Cursor seek_index(index::IndexHandle &handle,
+                                            const IndexKeyRange &range,
+                                            bool reverse) const;
+        // Reports the record ids an index scan visited to the index usage observer, if any.
+        IndexScan::VisitReport index_visit_report(const catalog::IndexCatalogEntry &entry) const;
+        // Streams record ids of the range through a tree cursor, in descending key order when
+        // reverse is set, until fn returns false.
+        void scan_index(const catalog::IndexCatalogEntry &entry,
+                        index::IndexHandle &handle,
+                        const IndexKeyRange &range,
+                        bool reverse,
+                        const std::function<bool(record_id_t)> &fn) const;
+        // Collects the whole range; writers use it so they can edit the tree afterwards.
         std::vector<record_id_t> run_index_scan(const IndexScanSpec &spec,
                                                 const std::vector<TableIndexContext> &index_contexts,
                                                 index::IndexHandle &handle,
@@ -136,5 +247,6 @@ namespace kizuna::engine
         mutable std::function<void(const catalog::IndexCatalogEntry &,
                                    const std::vector<record_id_t> &)>
             index_usage_observer_;
+        std::function<void(const JoinReport &)> join_observer_;
     };
 }
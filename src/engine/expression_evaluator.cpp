@@ -30,6 +30,78 @@ namespace kizuna::engine
                 throw QueryException::type_error("predicate", "BOOLEAN", data_type_to_string(value.type()));
             }
         }
+
+        // A non-NULL value of the type a decoded column of `column_type` carries (FLOAT
+        // columns decode to DOUBLE values, TIMESTAMP columns to BIGINT ones).
+        Value sample_value(DataType column_type)
+        {
+            switch (column_type)
+            {
+            case DataType::BOOLEAN:
+                return Value::boolean(false);
+            case DataType::INTEGER:
+                return Value::int32(0);
+            case DataType::BIGINT:
+            case DataType::TIMESTAMP:
+                return Value::int64(0);
+            case DataType::DATE:
+                return Value::date(0);
+            case DataType::FLOAT:
+            case DataType::DOUBLE:
+                return Value::floating(0.0);
+            case DataType::VARCHAR:
+            case DataType::TEXT:
+                return Value::string("", column_type);
+            default:
+                return Value::null(column_type);
+            }
+        }
+
+        // Whether compare() accepts values of these two types.
+        bool comparable(const Value &lhs, const Value &rhs)
+        {
+            if (lhs.is_null() || rhs.is_null())
+                return false;
+            try
+            {
+                compare(lhs, rhs);
+                return true;
+            }
+            catch (const DBException &)
+            {
+                return false;
+            }
+        }
+
+        // Storage both sides of a comparison can be compared in exactly as compare() does,
+        // or NONE. compare() orders an int64 against a double in long double precision.
+        ColumnVector::Storage common_storage(ColumnVector::Storage lhs, ColumnVector::Storage rhs)
+        {
+            using Storage = ColumnVector::Storage;
+            if (lhs == rhs)
+                return lhs;
+            auto either = [&](Storage a, Storage b)
+            { return (lhs == a && rhs == b) || (lhs == b && rhs == a); };
+            if (either(Storage::INT32, Storage::INT64))
+                return Storage::INT64;
+            if (either(Storage::INT32, Storage::DOUBLE))
+                return Storage::DOUBLE;
+            return Storage::NONE;
+        }
+
+        std::uint8_t batch_truth(TriBool value)
+        {
+            switch (value)
+            {
+            case TriBool::False:
+                return BatchPredicate::kFalse;
+            case TriBool::True:
+                return BatchPredicate::kTrue;
+            case TriBool::Unknown:
+                break;
+            }
+            return BatchPredicate::kUnknown;
+        }
     } // namespace
 
     namespace
@@ -123,6 +195,21 @@ namespace kizuna::engine
         return ResolvedColumn{binding->index, binding->type};
     }
 
+    void ExpressionEvaluator::collect_columns(const sql::Expression &expression,
+                                              std::vector<std::size_t> &out,
+                                              std::string_view clause) const
+    {
+        if (expression.kind == sql::ExpressionKind::COLUMN_REF)
+        {
+            out.push_back(resolve_column(expression.column, clause).index);
+            return;
+        }
+        if (expression.left)
+            collect_columns(*expression.left, out, clause);
+        if (expression.right)
+            collect_columns(*expression.right, out, clause);
+    }
+
     Value ExpressionEvaluator::literal_to_value(const sql::LiteralValue &literal,
                                                 std::optional<DataType> target_type) const
     {
@@ -389,4 +476,182 @@ namespace kizuna::engine
     {
         return evaluate_predicate_internal(expression, row_values, clause);
     }
+
+    std::optional<BatchPredicate> ExpressionEvaluator::compile_batch_predicate(const sql::Expression &expression,
+                                                                               std::string_view clause) const
+    {
+        BatchPredicate predicate;
+        try
+        {
+            if (!compile_batch_node(expression, predicate, clause))
+                return std::nullopt;
+        }
+        catch (const DBException &)
+        {
+            return std::nullopt;
+        }
+        return predicate;
+    }
+
+    std::optional<std::size_t> ExpressionEvaluator::compile_batch_node(const sql::Expression &expression,
+                                                                       BatchPredicate &predicate,
+                                                                       std::string_view clause) const
+    {
+        using Kind = BatchPredicate::NodeKind;
+        using Storage = ColumnVector::Storage;
+        BatchPredicate::Node node;
+
+        // A subtree that reads no column has the same truth on every row.
+        std::vector<std::size_t> read;
+        collect_columns(expression, read, clause);
+        if (read.empty())
+        {
+            node.kind = Kind::CONSTANT;
+            node.truth = batch_truth(evaluate_predicate_internal(expression, {}, clause));
+            return predicate.add(std::move(node));
+        }
+
+        switch (expression.kind)
+        {
+        case sql::ExpressionKind::LITERAL:
+            break;
+        case sql::ExpressionKind::COLUMN_REF:
+        {
+            const auto *binding = lookup_column(expression.column, clause);
+            const Storage storage = ColumnVector::storage_of(binding->type);
+            if (storage == Storage::NONE || storage == Storage::STRING)
+                return std::nullopt;
+            predicate.require(binding->index, binding->type);
+            node.kind = Kind::TRUTH;
+            node.column = binding->index;
+            return predicate.add(std::move(node));
+        }
+        case sql::ExpressionKind::UNARY:
+        {
+            auto operand = compile_batch_node(*expression.left, predicate, clause);
+            if (!operand)
+                return std::nullopt;
+            node.kind = Kind::NOT;
+            node.left = *operand;
+            return predicate.add(std::move(node));
+        }
+        case sql::ExpressionKind::NULL_TEST:
+        {
+            if (expression.left->kind != sql::ExpressionKind::COLUMN_REF)
+                return std::nullopt;
+            const auto *binding = lookup_column(expression.left->column, clause);
+            if (ColumnVector::storage_of(binding->type) == Storage::NONE)
+                return std::nullopt;
+            predicate.require(binding->index, binding->type);
+            node.kind = Kind::IS_NULL;
+            node.column = binding->index;
+            node.negate = expression.is_not_null;
+            return predicate.add(std::move(node));
+        }
+        case sql::ExpressionKind::BINARY:
+        {
+            if (expression.binary_op == sql::BinaryOperator::AND || expression.binary_op == sql::BinaryOperator::OR)
+            {
+                auto lhs = compile_batch_node(*expression.left, predicate, clause);
+                if (!lhs)
+                    return std::nullopt;
+                auto rhs = compile_batch_node(*expression.right, predicate, clause);
+                if (!rhs)
+                    return std::nullopt;
+                node.kind = expression.binary_op == sql::BinaryOperator::AND ? Kind::AND : Kind::OR;
+                node.left = *lhs;
+                node.right = *rhs;
+                return predicate.add(std::move(node));
+            }
+
+            const auto *left_binding = expression.left->kind == sql::ExpressionKind::COLUMN_REF
+                                           ? lookup_column(expression.left->column, clause)
+                                           : nullptr;
+            const auto *right_binding = expression.right->kind == sql::ExpressionKind::COLUMN_REF
+                                            ? lookup_column(expression.right->column, clause)
+                                            : nullptr;
+            if (left_binding && right_binding)
+            {
+                const Storage lhs = ColumnVector::storage_of(left_binding->type);
+                const Storage rhs = ColumnVector::storage_of(right_binding->type);
+                if (!comparable(sample_value(left_binding->type), sample_value(right_binding->type)) ||
+                    common_storage(lhs, rhs) == Storage::NONE)
+                    return std::nullopt;
+                predicate.require(left_binding->index, left_binding->type);
+                predicate.require(right_binding->index, right_binding->type);
+                node.kind = Kind::COMPARE_COLUMNS;
+                node.op = expression.binary_op;
+                node.column = left_binding->index;
+                node.other_column = right_binding->index;
+                return predicate.add(std::move(node));
+            }
+
+            // column <op> literal, with the literal read as the column's type as the row path does.
+            const bool column_on_left = left_binding != nullptr;
+            const auto *binding = column_on_left ? left_binding : right_binding;
+            const auto *literal = column_on_left ? expression.right.get() : expression.left.get();
+            if (!binding || literal->kind != sql::ExpressionKind::LITERAL)
+                return std::nullopt;
+            const Value constant = literal_to_value(literal->literal, binding->type);
+            if (constant.is_null())
+            {
+                node.kind = Kind::CONSTANT;
+                node.truth = BatchPredicate::kUnknown;
+                return predicate.add(std::move(node));
+            }
+            const Storage storage = ColumnVector::storage_of(constant.type());
+            if (!comparable(sample_value(binding->type), constant) ||
+                common_storage(ColumnVector::storage_of(binding->type), storage) == Storage::NONE)
+                return std::nullopt;
+
+            predicate.require(binding->index, binding->type);
+            node.kind = Kind::COMPARE_CONSTANT;
+            node.op = expression.binary_op;
+            node.constant_first = !column_on_left;
+            node.column = binding->index;
+            node.constant_storage = storage;
+            switch (storage)
+            {
+            case Storage::BOOL:
+                node.int_constant = constant.as_bool() ? 1 : 0;
+                break;
+            case Storage::INT32:
+                node.int_constant = constant.as_int32();
+                break;
+            case Storage::INT64:
+                node.int_constant = constant.as_int64();
+                break;
+            case Storage::DOUBLE:
+                node.double_constant = constant.as_double();
+                break;
+            case Storage::STRING:
+                node.string_constant = constant.as_string();
+                break;
+            case Storage::NONE:
+                return std::nullopt;
+            }
+            return predicate.add(std::move(node));
+        }
+        }
+        return std::nullopt;
+    }
+
+    std::vector<const sql::Expression *> split_conjuncts(const sql::Expression &expression)
+    {
+        std::vector<const sql::Expression *> conjuncts;
+        std::vector<const sql::Expression *> pending{&expression};
+        while (!pending.empty())
+        {
+            const auto *current = pending.back();
+            pending.pop_back();
+            if (current->kind == sql::ExpressionKind::BINARY && current->binary_op == sql::BinaryOperator::AND)
+            {
+                pending.push_back(current->right.get());
+                pending.push_back(current->left.get());
+                continue;
+            }
+            conjuncts.push_back(current);
+        }
+        return conjuncts;
+    }
 }
@@ -9,6 +9,7 @@
 
 #include "catalog/schema.h"
 #include "common/value.h"
+#include "engine/batch_predicate.h"
 #include "sql/ast.h"
 
 namespace kizuna::engine
@@ -46,6 +47,18 @@ namespace kizuna::engine
         ResolvedColumn resolve_column(const sql::ColumnRef &ref,
                                       std::string_view clause = "") const;
 
+        // Appends the row index of every column the expression reads (duplicates included).
+        void collect_columns(const sql::Expression &expression,
+                             std::vector<std::size_t> &out,
+                             std::string_view clause = "") const;
+
+        // The predicate compiled for ColumnBatches whose columns sit at their row indexes, or
+        // nullopt when part of it can only be decided row by row: operand types the row path
+        // converts or rejects, or expressions used as comparison operands. The caller then
+        // uses evaluate_predicate(), which also reports any error the predicate raises.
+        std::optional<BatchPredicate> compile_batch_predicate(const sql::Expression &expression,
+                                                              std::string_view clause = "") const;
+
     private:
         struct ColumnBinding
         {
@@ -68,5 +81,12 @@ namespace kizuna::engine
                                             const std::vector<Value> &row_values,
                                             std::string_view clause) const;
         Value coerce_to_type(const Value &value, DataType target) const;
+        std::optional<std::size_t> compile_batch_node(const sql::Expression &expression,
+                                                      BatchPredicate &predicate,
+                                                      std::string_view clause) const;
     };
+
+    // Operands of the expression's top-level AND chain, left to right; just the expression
+    // when it is not an AND. A row satisfies the expression when every operand is true.
+    std::vector<const sql::Expression *> split_conjuncts(const sql::Expression &expression);
 }
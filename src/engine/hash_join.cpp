@@ -0,0 +1,648 @@
+#include "engine/hash_join.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "common/exception.h"
+
+namespace kizuna::engine
+{
+    namespace
+    {
+        // Hash level of the in-memory tables; partitioning uses levels below HASH_JOIN_MAX_DEPTH.
+        constexpr std::size_t kTableLevel = config::HASH_JOIN_MAX_DEPTH;
+        constexpr std::size_t kNoEntry = std::numeric_limits<std::size_t>::max();
+
+        uint64_t mix(uint64_t h) noexcept
+        {
+            h ^= h >> 30;
+            h *= 0xbf58476d1ce4e5b9ULL;
+            h ^= h >> 27;
+            h *= 0x94d049bb133111ebULL;
+            h ^= h >> 31;
+            return h;
+        }
+
+        bool is_numeric_type(DataType type) noexcept
+        {
+            return type == DataType::INTEGER || type == DataType::BIGINT ||
+                   type == DataType::FLOAT || type == DataType::DOUBLE;
+        }
+
+        bool is_hashable_type(DataType type) noexcept
+        {
+            switch (type)
+            {
+            case DataType::BOOLEAN:
+            case DataType::INTEGER:
+            case DataType::BIGINT:
+            case DataType::FLOAT:
+            case DataType::DOUBLE:
+            case DataType::DATE:
+            case DataType::TIMESTAMP:
+            case DataType::VARCHAR:
+            case DataType::TEXT:
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        // Values that compare equal hash equally: integral doubles hash like the integer.
+        uint64_t value_hash(const Value &value)
+        {
+            switch (value.type())
+            {
+            case DataType::BOOLEAN:
+                return value.as_bool() ? 1 : 0;
+            case DataType::INTEGER:
+                return mix(static_cast<uint64_t>(static_cast<int64_t>(value.as_int32())));
+            case DataType::BIGINT:
+            case DataType::DATE:
+            case DataType::TIMESTAMP:
+                return mix(static_cast<uint64_t>(value.as_int64()));
+            case DataType::FLOAT:
+            case DataType::DOUBLE:
+            {
+                const double d = value.as_double();
+                if (d == std::trunc(d) && d >= -9223372036854775808.0 && d < 9223372036854775808.0)
+                    return mix(static_cast<uint64_t>(static_cast<int64_t>(d)));
+                uint64_t bits = 0;
+                std::memcpy(&bits, &d, sizeof(bits));
+                return mix(bits);
+            }
+            case DataType::VARCHAR:
+            case DataType::TEXT:
+                return std::hash<std::string>{}(value.as_string());
+            default:
+                return 0;
+            }
+        }
+
+        // Rough heap footprint of a buffered row, hash table links included.
+        std::size_t row_bytes(const HashJoin::Row &row)
+        {
+            std::size_t bytes = sizeof(HashJoin::Row) + 4 * sizeof(std::size_t) + row.capacity() * sizeof(Value);
+            for (const auto &value : row)
+            {
+                if (!value.is_null() && (value.type() == DataType::VARCHAR || value.type() == DataType::TEXT))
+                    bytes += value.as_string().size();
+            }
+            return bytes;
+        }
+
+        std::filesystem::path next_partition_path(const void *owner)
+        {
+            static std::atomic<uint64_t> counter{0};
+            const auto tag = std::to_string(reinterpret_cast<uintptr_t>(owner)) + "_" + std::to_string(counter.fetch_add(1));
+            return config::temp_dir() / ("hash_join_" + tag + ".part");
+        }
+
+        // Partition files hold [ordinal u64][count u32] rows of [type u8][null u8][payload]
+        // values in native byte order; they never outlive the join that wrote them.
+        template <typename T>
+        void put(std::ofstream &out, T value)
+        {
+            out.write(reinterpret_cast<const char *>(&value), sizeof(value));
+        }
+
+        template <typename T>
+        bool get(std::ifstream &in, T &value)
+        {
+            return static_cast<bool>(in.read(reinterpret_cast<char *>(&value), sizeof(value)));
+        }
+
+        void write_value(std::ofstream &out, const Value &value)
+        {
+            put<uint8_t>(out, static_cast<uint8_t>(value.type()));
+            put<uint8_t>(out, value.is_null() ? 1 : 0);
+            if (value.is_null())
+                return;
+            switch (value.type())
+            {
+            case DataType::BOOLEAN:
+                put<uint8_t>(out, value.as_bool() ? 1 : 0);
+                break;
+            case DataType::INTEGER:
+                put<int32_t>(out, value.as_int32());
+                break;
+            case DataType::BIGINT:
+            case DataType::DATE:
+            case DataType::TIMESTAMP:
+                put<int64_t>(out, value.as_int64());
+                break;
+            case DataType::FLOAT:
+            case DataType::DOUBLE:
+                put<double>(out, value.as_double());
+                break;
+            case DataType::VARCHAR:
+            case DataType::TEXT:
+            {
+                const auto &text = value.as_string();
+                put<uint32_t>(out, static_cast<uint32_t>(text.size()));
+                out.write(text.data(), static_cast<std::streamsize>(text.size()));
+                break;
+            }
+            default:
+                KIZUNA_THROW_QUERY(StatusCode::UNSUPPORTED_DATA_TYPE, "Cannot spill join value",
+                                   data_type_to_string(value.type()));
+            }
+        }
+
+        bool read_value(std::ifstream &in, Value &value)
+        {
+            uint8_t type_tag = 0;
+            uint8_t is_null = 0;
+            if (!get(in, type_tag) || !get(in, is_null))
+                return false;
+            const auto type = static_cast<DataType>(type_tag);
+            if (is_null)
+            {
+                value = Value::null(type);
+                return true;
+            }
+            switch (type)
+            {
+            case DataType::BOOLEAN:
+            {
+                uint8_t v = 0;
+                if (!get(in, v))
+                    return false;
+                value = Value::boolean(v != 0);
+                return true;
+            }
+            case DataType::INTEGER:
+            {
+                int32_t v = 0;
+                if (!get(in, v))
+                    return false;
+                value = Value::int32(v);
+                return true;
+            }
+            case DataType::BIGINT:
+            case DataType::TIMESTAMP:
+            {
+                int64_t v = 0;
+                if (!get(in, v))
+                    return false;
+                value = Value::int64(v);
+                return true;
+            }
+            case DataType::DATE:
+            {
+                int64_t v = 0;
+                if (!get(in, v))
+                    return false;
+                value = Value::date(v);
+                return true;
+            }
+            case DataType::FLOAT:
+            case DataType::DOUBLE:
+            {
+                double v = 0;
+                if (!get(in, v))
+                    return false;
+                value = Value::floating(v);
+                return true;
+            }
+            case DataType::VARCHAR:
+            case DataType::TEXT:
+            {
+                uint32_t len = 0;
+                if (!get(in, len))
+                    return false;
+                std::string text(len, '\0');
+                if (!in.read(text.data(), len))
+                    return false;
+                value = Value::string(std::move(text), type);
+                return true;
+            }
+            default:
+                return false;
+            }
+        }
+    } // namespace
+
+    std::optional<EquiJoinKeys> find_equi_join_keys(const sql::Expression &condition,
+                                                    const ExpressionEvaluator &evaluator,
+                                                    std::size_t left_width,
+                                                    std::string_view clause)
+    {
+        EquiJoinKeys keys;
+        for (const auto *conjunct : split_conjuncts(condition))
+        {
+            const bool column_pair = conjunct->kind == sql::ExpressionKind::BINARY &&
+                                     conjunct->binary_op == sql::BinaryOperator::EQUAL &&
+                                     conjunct->left && conjunct->left->kind == sql::ExpressionKind::COLUMN_REF &&
+                                     conjunct->right && conjunct->right->kind == sql::ExpressionKind::COLUMN_REF;
+            if (!column_pair)
+            {
+                keys.residual.push_back(conjunct);
+                continue;
+            }
+
+            ExpressionEvaluator::ResolvedColumn lhs;
+            ExpressionEvaluator::ResolvedColumn rhs;
+            try
+            {
+                lhs = evaluator.resolve_column(conjunct->left->column, clause);
+                rhs = evaluator.resolve_column(conjunct->right->column, clause);
+            }
+            catch (const QueryException &)
+            {
+                return std::nullopt;
+            }
+            if (rhs.index < left_width)
+                std::swap(lhs, rhs);
+
+            const bool compatible = is_hashable_type(lhs.type) &&
+                                    (lhs.type == rhs.type || (is_numeric_type(lhs.type) && is_numeric_type(rhs.type)));
+            if (lhs.index >= left_width || rhs.index < left_width || !compatible)
+            {
+                keys.residual.push_back(conjunct);
+                continue;
+            }
+            keys.left.push_back(lhs.index);
+            keys.right.push_back(rhs.index - left_width);
+        }
+
+        if (keys.left.empty())
+            return std::nullopt;
+        return keys;
+    }
+
+    struct HashJoin::Partition
+    {
+        std::filesystem::path path;
+        std::ofstream out;
+        std::size_t rows{0};
+        std::size_t bytes{0}; // in-memory size of its rows
+    };
+
+    class HashJoin::PartitionReader
+    {
+    public:
+        explicit PartitionReader(const std::filesystem::path &path)
+            : in_(path, std::ios::binary)
+        {
+            if (!in_)
+            {
+                KIZUNA_THROW_IO(StatusCode::READ_ERROR, "Cannot open hash join partition", path.string());
+            }
+        }
+
+        bool next(Entry &entry)
+        {
+            uint64_t ordinal = 0;
+            if (!get(in_, ordinal))
+                return false;
+            uint32_t count = 0;
+            if (!get(in_, count))
+                truncated();
+            entry.ordinal = static_cast<std::size_t>(ordinal);
+            entry.row.assign(count, Value());
+            for (auto &value : entry.row)
+            {
+                if (!read_value(in_, value))
+                    truncated();
+            }
+            return true;
+        }
+
+    private:
+        std::ifstream in_;
+
+        [[noreturn]] static void truncated()
+        {
+            KIZUNA_THROW_IO(StatusCode::FILE_CORRUPTED, "Hash join partition truncated", "");
+        }
+    };
+
+    class HashJoin::Table
+    {
+    public:
+        Table(const HashJoin &join, Side side, std::vector<Entry> entries)
+            : join_(join), side_(side), entries_(std::move(entries)), next_(entries_.size(), kNoEntry)
+        {
+            // Linking back to front leaves every chain in input order.
+            heads_.reserve(entries_.size());
+            for (std::size_t i = entries_.size(); i-- > 0;)
+            {
+                const auto hash = join_.key_hash(entries_[i].row, side_, kTableLevel);
+                if (!hash)
+                    continue;
+                auto [it, inserted] = heads_.try_emplace(*hash, i);
+                if (!inserted)
+                {
+                    next_[i] = it->second;
+                    it->second = i;
+                }
+            }
+        }
+
+        void probe(const Entry &probe, const MatchFn &on_match) const
+        {
+            const Side probe_side = side_ == Side::LEFT ? Side::RIGHT : Side::LEFT;
+            const auto hash = join_.key_hash(probe.row, probe_side, kTableLevel);
+            if (!hash)
+                return;
+            auto it = heads_.find(*hash);
+            if (it == heads_.end())
+                return;
+            for (std::size_t i = it->second; i != kNoEntry; i = next_[i])
+            {
+                const Entry &build = entries_[i];
+                const bool equal = side_ == Side::LEFT ? join_.keys_equal(build.row, probe.row)
+                                                       : join_.keys_equal(probe.row, build.row);
+                if (equal)
+                    join_.emit(side_, build, probe, on_match);
+            }
+        }
+
+    private:
+        const HashJoin &join_;
+        Side side_;
+        std::vector<Entry> entries_;
+        std::vector<std::size_t> next_;                  // entry -> next entry with the same hash
+        std::unordered_map<uint64_t, std::size_t> heads_; // hash -> first entry
+    };
+
+    HashJoin::HashJoin(std::vector<std::size_t> left_keys,
+                       std::vector<std::size_t> right_keys,
+                       std::size_t memory_limit,
+                       std::size_t partitions)
+        : left_keys_(std::move(left_keys)),
+          right_keys_(std::move(right_keys)),
+          memory_limit_(memory_limit),
+          partition_count_(std::max<std::size_t>(2, partitions))
+    {
+        if (left_keys_.empty() || left_keys_.size() != right_keys_.size())
+        {
+            KIZUNA_THROW_QUERY(StatusCode::INVALID_ARGUMENT, "Hash join needs matching key columns", "");
+        }
+    }
+
+    HashJoin::~HashJoin()
+    {
+        for (const auto &path : files_)
+        {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+    }
+
+    void HashJoin::run(const RowSource &left, const RowSource &right, const MatchFn &on_match)
+    {
+        ordered_ = true;
+        built_on_left_ = false;
+        spilled_partitions_ = 0;
+
+        // Left input: kept in memory until it outgrows the limit, then partitioned.
+        std::vector<Entry> left_rows;
+        std::size_t left_bytes = 0;
+        std::size_t left_count = 0;
+        std::vector<std::unique_ptr<Partition>> left_parts;
+        left([&](Row &&row)
+             {
+                 const std::size_t ordinal = left_count++;
+                 if (!left_parts.empty())
+                 {
+                     write_row(left_parts, Side::LEFT, 0, ordinal, row);
+                     return;
+                 }
+                 left_bytes += row_bytes(row);
+                 left_rows.push_back(Entry{ordinal, std::move(row)});
+                 if (left_bytes > memory_limit_)
+                 {
+                     left_parts = open_partitions();
+                     for (const auto &entry : left_rows)
+                         write_row(left_parts, Side::LEFT, 0, entry.ordinal, entry.row);
+                     left_rows = std::vector<Entry>();
+                 } });
+
+        std::vector<Entry> right_rows;
+        std::size_t right_bytes = 0;
+        std::size_t right_count = 0;
+
+        if (left_parts.empty())
+        {
+            // The left input fits. The right one is buffered while it is the smaller; once it
+            // is not, the table goes on the left and the rest of the right input streams past it.
+            std::unique_ptr<Table> left_table;
+            right([&](Row &&row)
+                  {
+                      Entry entry{right_count++, std::move(row)};
+                      if (left_table)
+                      {
+                          left_table->probe(entry, on_match);
+                          return;
+                      }
+                      right_bytes += row_bytes(entry.row);
+                      right_rows.push_back(std::move(entry));
+                      if (right_bytes > left_bytes)
+                      {
+                          built_on_left_ = true;
+                          ordered_ = false;
+                          left_table = std::make_unique<Table>(*this, Side::LEFT, std::move(left_rows));
+                          for (const auto &buffered : right_rows)
+                              left_table->probe(buffered, on_match);
+                          right_rows = std::vector<Entry>();
+                      } });
+            if (!left_table)
+            {
+                // Probing in left order keeps the nested-loop order of the output.
+                Table right_table(*this, Side::RIGHT, std::move(right_rows));
+                for (const auto &entry : left_rows)
+                    right_table.probe(entry, on_match);
+            }
+            return;
+        }
+
+        ordered_ = false;
+        std::vector<std::unique_ptr<Partition>> right_parts;
+        right([&](Row &&row)
+              {
+                  const std::size_t ordinal = right_count++;
+                  if (!right_parts.empty())
+                  {
+                      write_row(right_parts, Side::RIGHT, 0, ordinal, row);
+                      return;
+                  }
+                  right_bytes += row_bytes(row);
+                  right_rows.push_back(Entry{ordinal, std::move(row)});
+                  if (right_bytes > memory_limit_)
+                  {
+                      right_parts = open_partitions();
+                      for (const auto &entry : right_rows)
+                          write_row(right_parts, Side::RIGHT, 0, entry.ordinal, entry.row);
+                      right_rows = std::vector<Entry>();
+                  } });
+        close_partitions(left_parts);
+
+        if (right_parts.empty())
+        {
+            // Only the left input spilled: build on the right and probe partition by partition.
+            Table right_table(*this, Side::RIGHT, std::move(right_rows));
+            Entry entry;
+            for (auto &part : left_parts)
+            {
+                PartitionReader reader(part->path);
+                while (reader.next(entry))
+                    right_table.probe(entry, on_match);
+                remove_file(part->path);
+            }
+            return;
+        }
+
+        close_partitions(right_parts);
+        for (std::size_t p = 0; p < partition_count_; ++p)
+            join_partition(*left_parts[p], *right_parts[p], 0, on_match);
+    }
+
+    std::optional<uint64_t> HashJoin::key_hash(const Row &row, Side side, std::size_t depth) const
+    {
+        uint64_t hash = mix(0x9e3779b97f4a7c15ULL * (depth + 1));
+        for (std::size_t index : keys(side))
+        {
+            const Value &value = row[index];
+            if (value.is_null())
+                return std::nullopt;
+            hash ^= value_hash(value) + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+        }
+        return mix(hash);
+    }
+
+    bool HashJoin::keys_equal(const Row &left, const Row &right) const
+    {
+        for (std::size_t i = 0; i < left_keys_.size(); ++i)
+        {
+            if (compare(left[left_keys_[i]], right[right_keys_[i]]) != CompareResult::Equal)
+                return false;
+        }
+        return true;
+    }
+
+    void HashJoin::emit(Side build_side, const Entry &build, const Entry &probe, const MatchFn &on_match) const
+    {
+        if (build_side == Side::LEFT)
+            on_match(build.ordinal, build.row, probe.ordinal, probe.row);
+        else
+            on_match(probe.ordinal, probe.row, build.ordinal, build.row);
+    }
+
+    std::vector<std::unique_ptr<HashJoin::Partition>> HashJoin::open_partitions()
+    {
+        std::filesystem::create_directories(config::temp_dir());
+        std::vector<std::unique_ptr<Partition>> parts;
+        parts.reserve(partition_count_);
+        for (std::size_t p = 0; p < partition_count_; ++p)
+        {
+            auto part = std::make_unique<Partition>();
+            part->path = next_partition_path(this);
+            part->out.open(part->path, std::ios::binary | std::ios::trunc);
+            if (!part->out)
+            {
+                KIZUNA_THROW_IO(StatusCode::WRITE_ERROR, "Cannot create hash join partition", part->path.string());
+            }
+            files_.push_back(part->path);
+            ++spilled_partitions_;
+            parts.push_back(std::move(part));
+        }
+        return parts;
+    }
+
+    void HashJoin::write_row(std::vector<std::unique_ptr<Partition>> &parts, Side side, std::size_t depth,
+                             std::size_t ordinal, const Row &row)
+    {
+        const auto hash = key_hash(row, side, depth);
+        if (!hash)
+            return;
+        Partition &part = *parts[*hash % parts.size()];
+        put<uint64_t>(part.out, static_cast<uint64_t>(ordinal));
+        put<uint32_t>(part.out, static_cast<uint32_t>(row.size()));
+        for (const auto &value : row)
+            write_value(part.out, value);
+        ++part.rows;
+        part.bytes += row_bytes(row);
+    }
+
+    void HashJoin::close_partitions(std::vector<std::unique_ptr<Partition>> &parts)
+    {
+        for (auto &part : parts)
+        {
+            part->out.close();
+            if (part->out.fail())
+            {
+                KIZUNA_THROW_IO(StatusCode::WRITE_ERROR, "Hash join partition write failed", part->path.string());
+            }
+        }
+    }
+
+    void HashJoin::join_partition(Partition &left, Partition &right, std::size_t depth, const MatchFn &on_match)
+    {
+        if (left.rows == 0 || right.rows == 0)
+        {
+            remove_file(left.path);
+            remove_file(right.path);
+            return;
+        }
+
+        const bool build_left = left.bytes < right.bytes;
+        Partition &build = build_left ? left : right;
+        Partition &probe = build_left ? right : left;
+
+        if (build.bytes > memory_limit_ && depth + 1 < config::HASH_JOIN_MAX_DEPTH)
+        {
+            // Split both sides again with the next level's hash.
+            auto split = [&](Partition &part, Side side)
+            {
+                auto parts = open_partitions();
+                PartitionReader reader(part.path);
+                Entry entry;
+                while (reader.next(entry))
+                    write_row(parts, side, depth + 1, entry.ordinal, entry.row);
+                close_partitions(parts);
+                remove_file(part.path);
+                return parts;
+            };
+            auto left_parts = split(left, Side::LEFT);
+            auto right_parts = split(right, Side::RIGHT);
+            for (std::size_t p = 0; p < partition_count_; ++p)
+                join_partition(*left_parts[p], *right_parts[p], depth + 1, on_match);
+            return;
+        }
+
+        // Joined in memory, even past the limit once the depth runs out (heavy duplicate keys).
+        std::vector<Entry> entries;
+        entries.reserve(build.rows);
+        {
+            PartitionReader reader(build.path);
+            Entry entry;
+            while (reader.next(entry))
+                entries.push_back(std::move(entry));
+        }
+        remove_file(build.path);
+        built_on_left_ = built_on_left_ || build_left;
+
+        Table table(*this, build_left ? Side::LEFT : Side::RIGHT, std::move(entries));
+        PartitionReader reader(probe.path);
+        Entry entry;
+        while (reader.next(entry))
+            table.probe(entry, on_match);
+        remove_file(probe.path);
+    }
+
+    void HashJoin::remove_file(const std::filesystem::path &path) noexcept
+    {
+        std::error_code ec;
+        std::filesystem::remove(path, ec);
+        files_.erase(std::remove(files_.begin(), files_.end(), path), files_.end());
+    }
+}
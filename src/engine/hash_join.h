@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "common/config.h"
+#include "common/value.h"
+#include "engine/expression_evaluator.h"
+#include "sql/ast.h"
+
+namespace kizuna::engine
+{
+    // The part of a join condition a hash join can use: `left.col = right.col` conjuncts
+    // of its top-level AND, as column positions in each side's row, plus whatever else the
+    // condition requires of a matching pair.
+    struct EquiJoinKeys
+    {
+        std::vector<std::size_t> left;
+        std::vector<std::size_t> right;
+        std::vector<const sql::Expression *> residual; // every one must be true
+    };
+
+    // Looks for equi-join conjuncts in `condition`, resolved through `evaluator`, whose rows
+    // are the left row (`left_width` values) followed by the right row. Only column pairs
+    // whose types compare without error qualify (same type, or both numeric). Returns
+    // nullopt when none does or a column fails to resolve, leaving the condition to the
+    // nested loop, which reports such errors.
+    std::optional<EquiJoinKeys> find_equi_join_keys(const sql::Expression &condition,
+                                                    const ExpressionEvaluator &evaluator,
+                                                    std::size_t left_width,
+                                                    std::string_view clause);
+
+    // Inner equi-join of two row streams. run() reads the left input, then the right, and
+    // builds a hash table on whichever is smaller, probing with the other. When both
+    // inputs outgrow `memory_limit`, they are hash-partitioned into temp_dir() files and
+    // joined one partition pair at a time (Grace hash join); partitions that still do not
+    // fit are split again with a different hash, up to HASH_JOIN_MAX_DEPTH levels.
+    //
+    // Rows with a NULL key never match. Matches only guarantee equal keys; the caller
+    // checks any residual condition.
+    class HashJoin
+    {
+    public:
+        using Row = std::vector<Value>;
+        // A source pushes its rows, in order, to the sink it is given.
+        using RowSink = std::function<void(Row &&)>;
+        using RowSource = std::function<void(const RowSink &)>;
+        // Ordinals are the rows' positions in their inputs.
+        using MatchFn = std::function<void(std::size_t left_ordinal, const Row &left,
+                                           std::size_t right_ordinal, const Row &right)>;
+
+        HashJoin(std::vector<std::size_t> left_keys,
+                 std::vector<std::size_t> right_keys,
+                 std::size_t memory_limit = config::HASH_JOIN_MEMORY,
+                 std::size_t partitions = config::HASH_JOIN_PARTITIONS);
+        ~HashJoin();
+
+        HashJoin(const HashJoin &) = delete;
+        HashJoin &operator=(const HashJoin &) = delete;
+
+        void run(const RowSource &left, const RowSource &right, const MatchFn &on_match);
+
+        // Whether the matches of the last run() came in (left, right) ordinal order, the
+        // order a nested loop would produce.
+        bool ordered() const noexcept { return ordered_; }
+        bool built_on_left() const noexcept { return built_on_left_; }
+        // Partition files written by the last run(), both sides and all levels.
+        std::size_t spilled_partitions() const noexcept { return spilled_partitions_; }
+
+    private:
+        struct Entry
+        {
+            std::size_t ordinal{0};
+            Row row;
+        };
+        struct Partition;
+        class PartitionReader;
+        enum class Side
+        {
+            LEFT,
+            RIGHT
+        };
+
+        std::vector<std::size_t> left_keys_;
+        std::vector<std::size_t> right_keys_;
+        std::size_t memory_limit_;
+        std::size_t partition_count_;
+        bool ordered_{true};
+        bool built_on_left_{false};
+        std::size_t spilled_partitions_{0};
+        std::vector<std::filesystem::path> files_; // partition files not yet removed
+
+        const std::vector<std::size_t> &keys(Side side) const noexcept
+        {
+            return side == Side::LEFT ? left_keys_ : right_keys_;
+        }
+        // Hash of the row's key columns for partitioning level `depth`; nullopt for a NULL key.
+        std::optional<uint64_t> key_hash(const Row &row, Side side, std::size_t depth) const;
+        bool keys_equal(const Row &left, const Row &right) const;
+
+        // In-memory hash table over one side's rows, probed with rows of the other.
+        class Table;
+        void emit(Side build_side, const Entry &build, const Entry &probe, const MatchFn &on_match) const;
+
+        std::vector<std::unique_ptr<Partition>> open_partitions();
+        void write_row(std::vector<std::unique_ptr<Partition>> &parts, Side side, std::size_t depth,
+                       std::size_t ordinal, const Row &row);
+        void close_partitions(std::vector<std::unique_ptr<Partition>> &parts);
+        void join_partition(Partition &left, Partition &right, std::size_t depth, const MatchFn &on_match);
+        void remove_file(const std::filesystem::path &path) noexcept;
+    };
+}
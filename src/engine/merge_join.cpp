@@ -0,0 +1,116 @@
+#include "engine/merge_join.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "common/exception.h"
+
+namespace kizuna::engine
+{
+    MergeJoin::MergeJoin(std::vector<std::size_t> left_keys,
+                         std::vector<std::size_t> right_keys,
+                         bool descending)
+        : left_keys_(std::move(left_keys)),
+          right_keys_(std::move(right_keys)),
+          descending_(descending)
+    {
+        if (left_keys_.empty() || left_keys_.size() != right_keys_.size())
+        {
+            KIZUNA_THROW_QUERY(StatusCode::INVALID_ARGUMENT, "Merge join needs matching key columns", "");
+        }
+    }
+
+    bool MergeJoin::has_null(const Row &row, const std::vector<std::size_t> &keys)
+    {
+        for (std::size_t key : keys)
+        {
+            if (row[key].is_null())
+                return true;
+        }
+        return false;
+    }
+
+    int MergeJoin::order(const Row &a, const std::vector<std::size_t> &a_keys,
+                         const Row &b, const std::vector<std::size_t> &b_keys) const
+    {
+        for (std::size_t i = 0; i < a_keys.size(); ++i)
+        {
+            const auto cmp = compare(a[a_keys[i]], b[b_keys[i]]);
+            if (cmp == CompareResult::Less)
+                return descending_ ? 1 : -1;
+            if (cmp == CompareResult::Greater)
+                return descending_ ? -1 : 1;
+        }
+        return 0;
+    }
+
+    bool MergeJoin::left_sorted(const std::vector<Row> &rows) const
+    {
+        const Row *previous = nullptr;
+        for (const auto &row : rows)
+        {
+            if (has_null(row, left_keys_))
+                continue;
+            if (previous && order(*previous, left_keys_, row, left_keys_) > 0)
+                return false;
+            previous = &row;
+        }
+        return true;
+    }
+
+    void MergeJoin::sort_left(std::vector<Row> &rows) const
+    {
+        auto nulls = std::stable_partition(rows.begin(), rows.end(), [&](const Row &row)
+                                           { return !has_null(row, left_keys_); });
+        std::stable_sort(rows.begin(), nulls, [&](const Row &lhs, const Row &rhs)
+                         { return order(lhs, left_keys_, rhs, left_keys_) < 0; });
+    }
+
+    void MergeJoin::run(const std::vector<Row> &left, const RowSource &right, const MatchFn &on_match)
+    {
+        max_group_ = 0;
+        std::size_t next_left = 0; // left rows before it sort ahead of every key still to come
+        std::vector<Row> group;
+
+        // Pairs the gathered right rows with the left rows of the same key. The next group's
+        // key sorts after this one, so the left run is passed over only when that group
+        // arrives.
+        auto flush_group = [&]()
+        {
+            if (group.empty())
+                return;
+            const Row &key = group.front();
+            while (next_left < left.size() &&
+                   (has_null(left[next_left], left_keys_) || order(left[next_left], left_keys_, key, right_keys_) < 0))
+                ++next_left;
+            for (std::size_t l = next_left; l < left.size(); ++l)
+            {
+                if (has_null(left[l], left_keys_))
+                    continue;
+                if (order(left[l], left_keys_, key, right_keys_) != 0)
+                    break;
+                for (const auto &row : group)
+                    on_match(left[l], row);
+            }
+            max_group_ = std::max(max_group_, group.size());
+            group.clear();
+        };
+
+        right([&](Row &&row)
+              {
+                  if (has_null(row, right_keys_))
+                      return;
+                  if (!group.empty())
+                  {
+                      const int cmp = order(row, right_keys_, group.front(), right_keys_);
+                      if (cmp < 0)
+                      {
+                          KIZUNA_THROW_QUERY(StatusCode::INTERNAL_ERROR, "Merge join input out of key order", "");
+                      }
+                      if (cmp > 0)
+                          flush_group();
+                  }
+                  group.push_back(std::move(row)); });
+        flush_group();
+    }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include "common/value.h"
+
+namespace kizuna::engine
+{
+    // Inner equi-join of two inputs in join-key order, ascending or, with `descending`,
+    // descending. The left rows are held in memory (sort_left() puts them in order when
+    // they are not); the right rows stream in, and each run of equal right keys is
+    // gathered and paired with the run of equal left keys, so duplicate keys on both sides
+    // join fully. Matches come out in key order, then left order, then right order.
+    //
+    // Rows with a NULL key never match and may sit anywhere in either input. Matches only
+    // guarantee equal keys; the caller checks any residual condition.
+    class MergeJoin
+    {
+    public:
+        using Row = std::vector<Value>;
+        using RowSink = std::function<void(Row &&)>;
+        using RowSource = std::function<void(const RowSink &)>;
+        using MatchFn = std::function<void(const Row &left, const Row &right)>;
+
+        MergeJoin(std::vector<std::size_t> left_keys,
+                  std::vector<std::size_t> right_keys,
+                  bool descending = false);
+
+        // Whether the rows with non-NULL keys are already in left key order.
+        bool left_sorted(const std::vector<Row> &rows) const;
+        // Stable sort into left key order, rows with a NULL key last.
+        void sort_left(std::vector<Row> &rows) const;
+
+        // Throws if a right row arrives out of key order.
+        void run(const std::vector<Row> &left, const RowSource &right, const MatchFn &on_match);
+
+        bool descending() const noexcept { return descending_; }
+        // Most right rows with one key held at once during the last run().
+        std::size_t max_group() const noexcept { return max_group_; }
+
+    private:
+        std::vector<std::size_t> left_keys_;
+        std::vector<std::size_t> right_keys_;
+        bool descending_;
+        std::size_t max_group_{0};
+
+        static bool has_null(const Row &row, const std::vector<std::size_t> &keys);
+        // <0, 0 or >0 as `a` sorts before, with or after `b` in the join's direction.
+        int order(const Row &a, const std::vector<std::size_t> &a_keys,
+                  const Row &b, const std::vector<std::size_t> &b_keys) const;
+    };
+}
@@ -0,0 +1,378 @@
+#include "engine/operators.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace kizuna::engine
+{
+    namespace
+    {
+        TableHeap::RowLocation location_of(record_id_t id)
+        {
+            return TableHeap::RowLocation{static_cast<page_id_t>(id >> 32), static_cast<slot_id_t>(id & 0xFFFFFFFFu)};
+        }
+    }
+
+    SeqScan::SeqScan(TableHeap heap, RowDecoder decode)
+        : heap_(std::move(heap)), decode_(std::move(decode))
+    {
+    }
+
+    void SeqScan::open()
+    {
+        pages_.emplace(heap_.scan_pages());
+        page_rows_.clear();
+        position_ = 0;
+    }
+
+    bool SeqScan::next(Row &row)
+    {
+        while (position_ == page_rows_.size())
+        {
+            if (!pages_)
+                return false;
+            page_rows_.clear();
+            position_ = 0;
+            Row decoded;
+            const bool more = pages_->next_page([&](const TableHeap::RowLocation &, std::span<const uint8_t> payload)
+                                               {
+                                                   if (decode_(payload, decoded))
+                                                       page_rows_.push_back(std::move(decoded)); });
+            if (!more)
+            {
+                pages_.reset();
+                return false;
+            }
+        }
+        row = std::move(page_rows_[position_++]);
+        return true;
+    }
+
+    void SeqScan::close()
+    {
+        pages_.reset();
+        page_rows_.clear();
+        page_rows_.shrink_to_fit();
+        position_ = 0;
+    }
+
+    BatchScan::BatchScan(TableHeap heap, ColumnBatch batch, BatchFill fill, BatchFilter filter, RowDecoder decode)
+        : heap_(std::move(heap)),
+          batch_(std::move(batch)),
+          fill_(std::move(fill)),
+          filter_(std::move(filter)),
+          decode_(std::move(decode))
+    {
+    }
+
+    void BatchScan::open()
+    {
+        pages_.emplace(heap_.scan_pages());
+        selection_.clear();
+        position_ = 0;
+    }
+
+    bool BatchScan::next_batch()
+    {
+        bytes_.clear();
+        ends_.clear();
+        while (pages_ && ends_.size() < config::VECTOR_BATCH_ROWS)
+        {
+            const bool more = pages_->next_page([&](const TableHeap::RowLocation &, std::span<const uint8_t> payload)
+                                                {
+                                                    bytes_.insert(bytes_.end(), payload.begin(), payload.end());
+                                                    ends_.push_back(bytes_.size()); });
+            if (!more)
+                pages_.reset();
+        }
+        if (ends_.empty())
+            return false;
+
+        payloads_.clear();
+        for (std::size_t i = 0, begin = 0; i < ends_.size(); begin = ends_[i++])
+            payloads_.emplace_back(bytes_.data() + begin, ends_[i] - begin);
+        batch_.clear();
+        fill_(payloads_, batch_);
+        filter_(batch_, selection_);
+        position_ = 0;
+        return true;
+    }
+
+    bool BatchScan::next(Row &row)
+    {
+        while (true)
+        {
+            while (position_ < selection_.size())
+            {
+                if (decode_(payloads_[selection_[position_++]], row))
+                    return true;
+            }
+            if (!next_batch())
+                return false;
+        }
+    }
+
+    void BatchScan::close()
+    {
+        pages_.reset();
+        selection_.clear();
+        payloads_.clear();
+        bytes_.clear();
+        bytes_.shrink_to_fit();
+        ends_.clear();
+        batch_.clear();
+        position_ = 0;
+    }
+
+    IndexScan::IndexScan(CursorFactory seek, bool reverse, TableHeap heap, RowDecoder decode,
+                         VisitReport on_close)
+        : seek_(std::move(seek)),
+          reverse_(reverse),
+          heap_(std::move(heap)),
+          decode_(std::move(decode)),
+          on_close_(std::move(on_close))
+    {
+    }
+
+    void IndexScan::open()
+    {
+        visited_.clear();
+        cursor_.emplace(seek_());
+    }
+
+    bool IndexScan::next(Row &row)
+    {
+        while (cursor_ && cursor_->Valid())
+        {
+            const record_id_t rid = cursor_->Value();
+            if (on_close_)
+                visited_.push_back(rid);
+            if (reverse_)
+                cursor_->Prev();
+            else
+                cursor_->Next();
+            if (heap_.read(location_of(rid), payload_) && decode_(payload_, row))
+                return true;
+        }
+        return false;
+    }
+
+    void IndexScan::close()
+    {
+        if (!cursor_)
+            return;
+        cursor_.reset();
+        if (on_close_)
+            on_close_(visited_);
+        visited_.clear();
+    }
+
+    Filter::Filter(OperatorPtr child, RowPredicate predicate)
+        : child_(std::move(child)), predicate_(std::move(predicate))
+    {
+    }
+
+    bool Filter::next(Row &row)
+    {
+        while (child_->next(row))
+        {
+            if (predicate_(row))
+                return true;
+        }
+        return false;
+    }
+
+    Project::Project(OperatorPtr child, std::vector<std::size_t> columns)
+        : child_(std::move(child)), columns_(std::move(columns))
+    {
+    }
+
+    bool Project::next(Row &row)
+    {
+        if (!child_->next(input_))
+            return false;
+        row.clear();
+        row.reserve(columns_.size());
+        for (std::size_t column : columns_)
+            row.push_back(input_[column]);
+        return true;
+    }
+
+    Join::Join(OperatorPtr left, Planner plan)
+        : left_(std::move(left)), plan_(std::move(plan))
+    {
+    }
+
+    void Join::open()
+    {
+        left_rows_.clear();
+        matches_.clear();
+        next_left_ = 0;
+        next_match_ = 0;
+        strategy_ = Strategy{};
+
+        left_->open();
+        Row row;
+        while (left_->next(row))
+            left_rows_.push_back(std::move(row));
+        left_->close();
+        if (left_rows_.empty())
+            return;
+
+        strategy_ = plan_(left_rows_);
+        if (strategy_.all_rows)
+        {
+            strategy_.all_rows(left_rows_, [&](Row &&match)
+                               { matches_.push_back(std::move(match)); });
+            left_rows_.clear();
+            left_rows_.shrink_to_fit();
+        }
+    }
+
+    bool Join::next(Row &row)
+    {
+        while (next_match_ == matches_.size())
+        {
+            if (!strategy_.per_row || next_left_ == left_rows_.size())
+                return false;
+            matches_.clear();
+            next_match_ = 0;
+            strategy_.per_row(left_rows_[next_left_++], [&](Row &&match)
+                              { matches_.push_back(std::move(match)); });
+        }
+        row = std::move(matches_[next_match_++]);
+        return true;
+    }
+
+    void Join::close()
+    {
+        left_->close();
+        strategy_ = Strategy{};
+        left_rows_.clear();
+        left_rows_.shrink_to_fit();
+        matches_.clear();
+        matches_.shrink_to_fit();
+    }
+
+    Sort::Sort(OperatorPtr child, Less less)
+        : child_(std::move(child)), less_(std::move(less))
+    {
+    }
+
+    void Sort::open()
+    {
+        rows_.clear();
+        position_ = 0;
+        child_->open();
+        Row row;
+        while (child_->next(row))
+            rows_.push_back(std::move(row));
+        child_->close();
+
+        std::stable_sort(rows_.begin(), rows_.end(), less_);
+    }
+
+    bool Sort::next(Row &row)
+    {
+        if (position_ == rows_.size())
+            return false;
+        row = std::move(rows_[position_++]);
+        return true;
+    }
+
+    void Sort::close()
+    {
+        child_->close();
+        rows_.clear();
+        rows_.shrink_to_fit();
+    }
+
+    Limit::Limit(OperatorPtr child, std::size_t limit)
+        : child_(std::move(child)), limit_(limit)
+    {
+    }
+
+    void Limit::open()
+    {
+        produced_ = 0;
+        // LIMIT 0 never pulls a row, so a draining input (Sort, Join) is not even started.
+        if (limit_ != 0)
+            child_->open();
+    }
+
+    bool Limit::next(Row &row)
+    {
+        if (produced_ == limit_ || !child_->next(row))
+            return false;
+        ++produced_;
+        return true;
+    }
+
+    void Limit::close()
+    {
+        if (limit_ != 0)
+            child_->close();
+    }
+
+    Distinct::Distinct(OperatorPtr child, Key key)
+        : child_(std::move(child)), key_(std::move(key))
+    {
+    }
+
+    void Distinct::open()
+    {
+        seen_.clear();
+        child_->open();
+    }
+
+    bool Distinct::next(Row &row)
+    {
+        while (child_->next(row))
+        {
+            if (seen_.insert(key_(row)).second)
+                return true;
+        }
+        return false;
+    }
+
+    void Distinct::close()
+    {
+        child_->close();
+        seen_.clear();
+    }
+
+    Aggregate::Aggregate(OperatorPtr child, std::vector<std::unique_ptr<Accumulator>> accumulators)
+        : child_(std::move(child)), accumulators_(std::move(accumulators))
+    {
+    }
+
+    void Aggregate::open()
+    {
+        done_ = false;
+        child_->open();
+    }
+
+    bool Aggregate::next(Row &row)
+    {
+        if (done_)
+            return false;
+        Row input;
+        while (child_->next(input))
+        {
+            for (auto &accumulator : accumulators_)
+                accumulator->add(input);
+        }
+        child_->close();
+        row.clear();
+        row.reserve(accumulators_.size());
+        for (const auto &accumulator : accumulators_)
+            row.push_back(accumulator->result());
+        done_ = true;
+        return true;
+    }
+
+    void Aggregate::close()
+    {
+        child_->close();
+    }
+}
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "common/types.h"
+#include "common/value.h"
+#include "engine/column_batch.h"
+#include "storage/index/bplus_tree.h"
+#include "storage/table_heap.h"
+
+namespace kizuna::engine
+{
+    // A node of a physical SELECT plan. The consumer pulls rows from the root: open()
+    // prepares the subtree, next() yields one row at a time until it returns false, and
+    // close() releases what the subtree holds (page pins, buffered rows). close() may be
+    // called before the input is exhausted, and more than once. A plan runs once.
+    class Operator
+    {
+    public:
+        using Row = std::vector<Value>;
+
+        virtual ~Operator() = default;
+        virtual void open() = 0;
+        virtual bool next(Row &row) = 0;
+        virtual void close() = 0;
+    };
+
+    using OperatorPtr = std::unique_ptr<Operator>;
+    using RowPredicate = std::function<bool(const Operator::Row &)>;
+    // Decodes a stored row into `row`, or returns false to drop it, which lets a scan check
+    // the WHERE clause before decoding the columns only the output needs.
+    using RowDecoder = std::function<bool(std::span<const uint8_t> payload, Operator::Row &row)>;
+
+    // Produces no rows: the plan of a WHERE clause that can never hold.
+    class EmptyScan : public Operator
+    {
+    public:
+        void open() override {}
+        bool next(Row &) override { return false; }
+        void close() override {}
+    };
+
+    // Reads a table heap in chain order. Rows are decoded in place one page at a time, so
+    // at most a page of rows is buffered and a consumer that stops early stops the scan.
+    class SeqScan : public Operator
+    {
+    public:
+        SeqScan(TableHeap heap, RowDecoder decode);
+
+        void open() override;
+        bool next(Row &row) override;
+        void close() override;
+
+    private:
+        TableHeap heap_;
+        RowDecoder decode_;
+        std::optional<TableHeap::PageScan> pages_;
+        std::vector<Row> page_rows_;
+        std::size_t position_{0};
+    };
+
+    // Reads a table heap like SeqScan but filters a batch of rows at a time. Rows are
+    // gathered (copied out of their pages) until about config::VECTOR_BATCH_ROWS are held,
+    // `fill` decodes the columns the filter reads into a ColumnBatch, `filter` selects the
+    // qualifying rows, and only those are passed to `decode`.
+    class BatchScan : public Operator
+    {
+    public:
+        using Payloads = std::vector<std::span<const uint8_t>>;
+        using BatchFill = std::function<void(const Payloads &payloads, ColumnBatch &batch)>;
+        using BatchFilter = std::function<void(const ColumnBatch &batch, SelectionVector &selection)>;
+
+        BatchScan(TableHeap heap, ColumnBatch batch, BatchFill fill, BatchFilter filter, RowDecoder decode);
+
+        void open() override;
+        bool next(Row &row) override;
+        void close() override;
+
+    private:
+        TableHeap heap_;
+        ColumnBatch batch_;
+        BatchFill fill_;
+        BatchFilter filter_;
+        RowDecoder decode_;
+        std::optional<TableHeap::PageScan> pages_;
+        std::vector<uint8_t> bytes_;
+        std::vector<std::size_t> ends_;
+        Payloads payloads_;
+        SelectionVector selection_;
+        std::size_t position_{0};
+
+        // Gathers and filters the next batch; false once the heap is exhausted.
+        bool next_batch();
+    };
+
+    // Walks a B+ tree cursor and reads each record id's row from the heap. The cursor keeps
+    // one leaf pinned between calls. With `on_close`, the record ids visited are reported
+    // when the scan closes.
+    class IndexScan : public Operator
+    {
+    public:
+        using CursorFactory = std::function<index::BPlusTree::Cursor()>;
+        using VisitReport = std::function<void(const std::vector<record_id_t> &)>;
+
+        IndexScan(CursorFactory seek, bool reverse, TableHeap heap, RowDecoder decode,
+                  VisitReport on_close = {});
+
+        void open() override;
+        bool next(Row &row) override;
+        void close() override;
+
+    private:
+        CursorFactory seek_;
+        bool reverse_;
+        TableHeap heap_;
+        RowDecoder decode_;
+        VisitReport on_close_;
+        std::optional<index::BPlusTree::Cursor> cursor_;
+        std::vector<record_id_t> visited_;
+        std::vector<uint8_t> payload_;
+    };
+
+    class Filter : public Operator
+    {
+    public:
+        Filter(OperatorPtr child, RowPredicate predicate);
+
+        void open() override { child_->open(); }
+        bool next(Row &row) override;
+        void close() override { child_->close(); }
+
+    private:
+        OperatorPtr child_;
+        RowPredicate predicate_;
+    };
+
+    // Keeps the listed columns, in list order.
+    class Project : public Operator
+    {
+    public:
+        Project(OperatorPtr child, std::vector<std::size_t> columns);
+
+        void open() override { child_->open(); }
+        bool next(Row &row) override;
+        void close() override { child_->close(); }
+
+    private:
+        OperatorPtr child_;
+        std::vector<std::size_t> columns_;
+        Row input_;
+    };
+
+    // Joins its left input with another table. The left input is pulled in full at open():
+    // choosing a strategy needs its size, and hash and merge joins need all of it. The
+    // planner's strategy then either joins one left row at a time (nested loops), so
+    // matches stream out as they are found, or the whole input at once (hash and merge
+    // joins), whose matches are held until pulled. An empty left input is never planned.
+    class Join : public Operator
+    {
+    public:
+        using Sink = std::function<void(Row &&)>;
+        struct Strategy
+        {
+            std::function<void(const Row &left, const Sink &sink)> per_row;
+            std::function<void(std::vector<Row> &left, const Sink &sink)> all_rows;
+        };
+        using Planner = std::function<Strategy(std::vector<Row> &left)>;
+
+        Join(OperatorPtr left, Planner plan);
+
+        void open() override;
+        bool next(Row &row) override;
+        void close() override;
+
+    private:
+        OperatorPtr left_;
+        Planner plan_;
+        Strategy strategy_;
+        std::vector<Row> left_rows_;
+        std::size_t next_left_{0};
+        std::vector<Row> matches_;
+        std::size_t next_match_{0};
+    };
+
+    // Stable sort of the whole input by `less`. It drains its input on open(); plans whose
+    // rows already arrive in order leave it out.
+    class Sort : public Operator
+    {
+    public:
+        using Less = std::function<bool(const Row &, const Row &)>;
+
+        Sort(OperatorPtr child, Less less);
+
+        void open() override;
+        bool next(Row &row) override;
+        void close() override;
+
+    private:
+        OperatorPtr child_;
+        Less less_;
+        std::vector<Row> rows_;
+        std::size_t position_{0};
+    };
+
+    // Passes the first `limit` rows and stops pulling its input after them.
+    class Limit : public Operator
+    {
+    public:
+        Limit(OperatorPtr child, std::size_t limit);
+
+        void open() override;
+        bool next(Row &row) override;
+        void close() override;
+
+    private:
+        OperatorPtr child_;
+        std::size_t limit_;
+        std::size_t produced_{0};
+    };
+
+    // Passes the first row of each distinct `key`.
+    class Distinct : public Operator
+    {
+    public:
+        using Key = std::function<std::string(const Row &)>;
+
+        Distinct(OperatorPtr child, Key key);
+
+        void open() override;
+        bool next(Row &row) override;
+        void close() override;
+
+    private:
+        OperatorPtr child_;
+        Key key_;
+        std::unordered_set<std::string> seen_;
+    };
+
+    // Running state of one aggregate call over the input rows.
+    class Accumulator
+    {
+    public:
+        virtual ~Accumulator() = default;
+        virtual void add(const Operator::Row &row) = 0;
+        virtual Value result() const = 0;
+    };
+
+    // Folds the whole input into one row holding each accumulator's result.
+    class Aggregate : public Operator
+    {
+    public:
+        Aggregate(OperatorPtr child, std::vector<std::unique_ptr<Accumulator>> accumulators);
+
+        void open() override;
+        bool next(Row &row) override;
+        void close() override;
+
+    private:
+        OperatorPtr child_;
+        std::vector<std::unique_ptr<Accumulator>> accumulators_;
+        bool done_{false};
+    };
+}
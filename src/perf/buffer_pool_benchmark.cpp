@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
+#include "common/exception.h"
+#include "storage/file_manager.h"
+#include "storage/page_manager.h"
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    struct Options
+    {
+        int pages{1'024};
+        int ops_per_thread{200'000};
+        std::vector<int> threads{1, 2, 4, 8, 16};
+        std::vector<int> shards{1, 16};
+        kizuna::ReplacementPolicyKind policy{kizuna::ReplacementPolicyKind::LRU};
+        unsigned int seed{42};
+    };
+
+    [[noreturn]] void print_usage_and_exit(std::ostream &out, int code)
+    {
+        out << "Usage: kizuna_buffer_pool_benchmark [options]\n"
+            << "Options:\n"
+            << "  --pages N                Working set size in pages, fully cached (default: 1024)\n"
+            << "  --ops N                  fetch/unpin pairs per thread (default: 200000)\n"
+            << "  --threads N [N ...]      Thread counts to run (default: 1 2 4 8 16)\n"
+            << "  --shards N [N ...]       Buffer pool shard counts to compare (default: 1 16)\n"
+            << "  --policy NAME            Replacement policy: LRU, CLOCK, 2Q (default: LRU)\n"
+            << "  --seed N                 Random seed (default: 42)\n"
+            << "  -h, --help               Show this message\n";
+        std::exit(code);
+    }
+
+    int parse_positive_int(const std::string &value, std::string_view flag)
+    {
+        try
+        {
+            std::size_t pos = 0;
+            int parsed = std::stoi(value, &pos);
+            if (pos != value.size() || parsed <= 0)
+            {
+                throw std::invalid_argument("non-positive");
+            }
+            return parsed;
+        }
+        catch (const std::exception &)
+        {
+            std::ostringstream oss;
+            oss << "Invalid numeric value for " << flag << ": " << value;
+            throw std::runtime_error(oss.str());
+        }
+    }
+
+    unsigned int parse_unsigned_int(const std::string &value, std::string_view flag)
+    {
+        try
+        {
+            std::size_t pos = 0;
+            unsigned long parsed = std::stoul(value, &pos);
+            if (pos != value.size() || parsed > std::numeric_limits<unsigned int>::max())
+            {
+                throw std::invalid_argument("out of range");
+            }
+            return static_cast<unsigned int>(parsed);
+        }
+        catch (const std::exception &)
+        {
+            std::ostringstream oss;
+            oss << "Invalid numeric value for " << flag << ": " << value;
+            throw std::runtime_error(oss.str());
+        }
+    }
+
+    std::vector<int> parse_int_list(int argc, char **argv, int &i, std::string_view flag)
+    {
+        std::vector<int> values;
+        while (i + 1 < argc)
+        {
+            const std::string next = argv[i + 1];
+            if (next.rfind("--", 0) == 0)
+                break;
+            ++i;
+            values.push_back(parse_positive_int(next, flag));
+        }
+        if (values.empty())
+        {
+            std::ostringstream oss;
+            oss << "Expected at least one numeric value after " << flag;
+            throw std::runtime_error(oss.str());
+        }
+        return values;
+    }
+
+    Options parse_arguments(int argc, char **argv)
+    {
+        Options opts;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h")
+            {
+                print_usage_and_exit(std::cout, 0);
+            }
+            else if (arg == "--pages")
+            {
+                if (i + 1 >= argc)
+                    throw std::runtime_error("Expected value after --pages");
+                opts.pages = parse_positive_int(argv[++i], "--pages");
+            }
+            else if (arg == "--ops")
+            {
+                if (i + 1 >= argc)
+                    throw std::runtime_error("Expected value after --ops");
+                opts.ops_per_thread = parse_positive_int(argv[++i], "--ops");
+            }
+            else if (arg == "--threads")
+            {
+                opts.threads = parse_int_list(argc, argv, i, "--threads");
+            }
+            else if (arg == "--shards")
+            {
+                opts.shards = parse_int_list(argc, argv, i, "--shards");
+            }
+            else if (arg == "--policy")
+            {
+                if (i + 1 >= argc)
+                    throw std::runtime_error("Expected value after --policy");
+                const std::string name = argv[++i];
+                const auto parsed = kizuna::parse_replacement_policy(name);
+                if (!parsed)
+                    throw std::runtime_error("Unknown replacement policy: " + name);
+                opts.policy = *parsed;
+            }
+            else if (arg == "--seed")
+            {
+                if (i + 1 >= argc)
+                    throw std::runtime_error("Expected value after --seed");
+                opts.seed = parse_unsigned_int(argv[++i], "--seed");
+            }
+            else
+            {
+                std::ostringstream oss;
+                oss << "Unknown option: " << arg;
+                throw std::runtime_error(oss.str());
+            }
+        }
+        return opts;
+    }
+
+    fs::path make_database_path()
+    {
+        auto base = kizuna::config::temp_dir();
+        std::error_code ec;
+        fs::create_directories(base, ec);
+        const auto now = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+        std::ostringstream oss;
+        oss << "kizuna_bufpool_" << now << kizuna::config::DB_FILE_EXTENSION;
+        return base / oss.str();
+    }
+
+    // Random fetch/unpin over a fully cached working set; returns elapsed milliseconds.
+    double run_threads(kizuna::PageManager &pm,
+                       const std::vector<kizuna::page_id_t> &ids,
+                       int thread_count,
+                       int ops_per_thread,
+                       unsigned int seed)
+    {
+        std::atomic<bool> start{false};
+        std::atomic<uint64_t> checksum{0};
+        std::vector<std::thread> workers;
+        workers.reserve(static_cast<std::size_t>(thread_count));
+        for (int t = 0; t < thread_count; ++t)
+        {
+            workers.emplace_back([&, t]()
+                                 {
+                                     std::mt19937 rng(seed + static_cast<unsigned int>(t));
+                                     std::uniform_int_distribution<std::size_t> pick(0, ids.size() - 1);
+                                     uint64_t local = 0;
+                                     while (!start.load(std::memory_order_acquire))
+                                     {
+                                         std::this_thread::yield();
+                                     }
+                                     for (int op = 0; op < ops_per_thread; ++op)
+                                     {
+                                         const kizuna::page_id_t id = ids[pick(rng)];
+                                         auto &page = pm.fetch(id, /*pin*/ true);
+                                         local += page.header().page_id;
+                                         pm.unpin(id, /*dirty*/ false);
+                                     }
+                                     checksum.fetch_add(local, std::memory_order_relaxed);
+                                 });
+        }
+        const auto begin = Clock::now();
+        start.store(true, std::memory_order_release);
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+        const auto end = Clock::now();
+        if (checksum.load() == 0)
+        {
+            throw std::runtime_error("benchmark checksum mismatch");
+        }
+        return std::chrono::duration<double, std::milli>(end - begin).count();
+    }
+
+    void run_for_shards(const Options &options, int shards)
+    {
+        const fs::path db_path = make_database_path();
+        kizuna::FileManager fm(db_path.string(), /*create_if_missing=*/true);
+        fm.open();
+        {
+            // Leave headroom so per-shard slices never run out of frames.
+            const std::size_t capacity = static_cast<std::size_t>(options.pages) * 2 + 64;
+            kizuna::PageManager pm(fm, capacity, static_cast<std::size_t>(shards), options.policy);
+
+            std::vector<kizuna::page_id_t> ids;
+            ids.reserve(static_cast<std::size_t>(options.pages));
+            for (int i = 0; i < options.pages; ++i)
+            {
+                ids.push_back(pm.new_page(kizuna::PageType::DATA));
+            }
+            for (auto id : ids)
+            {
+                pm.fetch(id, /*pin*/ false); // warm the cache
+            }
+
+            std::cout << "=== shards: " << pm.shard_count() << " ===\n";
+            double baseline = 0.0;
+            for (int threads : options.threads)
+            {
+                const double ms = run_threads(pm, ids, threads, options.ops_per_thread, options.seed);
+                const double total_ops = static_cast<double>(threads) * options.ops_per_thread;
+                const double throughput = total_ops / (ms / 1000.0);
+                if (baseline == 0.0)
+                    baseline = throughput;
+                std::cout << "  threads " << std::setw(2) << threads
+                          << " : " << std::setw(10) << ms << " ms  "
+                          << std::setw(12) << (throughput / 1e6) << " Mops/s  "
+                          << "speedup x" << (throughput / baseline) << "\n";
+            }
+            std::cout << "\n";
+        }
+        fm.close();
+        std::error_code ec;
+        fs::remove(db_path, ec);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const Options options = parse_arguments(argc, argv);
+
+        std::cout << "Kizuna buffer pool benchmark (C++ driver)\n";
+        std::cout << "Working set    : " << options.pages << " pages\n";
+        std::cout << "Ops per thread : " << options.ops_per_thread << "\n";
+        std::cout << "Policy         : " << kizuna::replacement_policy_to_string(options.policy) << "\n";
+        std::cout << "Hardware conc. : " << std::thread::hardware_concurrency() << "\n";
+        std::cout << "Seed           : " << options.seed << "\n\n";
+
+        std::cout.setf(std::ios::fixed);
+        std::cout << std::setprecision(3);
+
+        for (int shards : options.shards)
+        {
+            try
+            {
+                run_for_shards(options, shards);
+            }
+            catch (const std::exception &ex)
+            {
+                std::cout << "=== shards: " << shards << " ===\n";
+                std::cout << "  FAILED: " << ex.what() << "\n\n";
+            }
+        }
+        return 0;
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+}
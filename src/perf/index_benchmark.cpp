@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <filesystem>
 #include <iomanip>
 #include <iostream>
@@ -19,6 +20,8 @@
 #include "engine/dml_executor.h"
 #include "sql/dml_parser.h"
 #include "storage/file_manager.h"
+#include "storage/index/bplus_tree.h"
+#include "storage/index/key_sorter.h"
 #include "storage/index/index_manager.h"
 #include "storage/page_manager.h"
 
@@ -32,6 +35,8 @@ namespace
         std::vector<int> rows{1'000, 10'000};
         int chunk_size{500};
         int lookup_samples{5};
+        std::vector<int> tree_keys{1'000, 50'000, 500'000};
+        int tree_lookups{200'000};
         unsigned int seed{42};
     };
 
@@ -52,6 +57,21 @@ namespace
         }
     };
 
+    struct TreeLookupResult
+    {
+        int keys{};
+        std::size_t height{0};
+        double build_ms{0.0};
+        double bulk_build_ms{0.0};
+        int lookups{0};
+        double lookup_ms{0.0};
+
+        double lookups_per_second() const
+        {
+            return lookup_ms > 0.0 ? static_cast<double>(lookups) * 1000.0 / lookup_ms : 0.0;
+        }
+    };
+
     [[noreturn]] void print_usage_and_exit(std::ostream &out, int code)
     {
         out << "Usage: kizuna_index_benchmark [options]\n"
@@ -59,6 +79,8 @@ namespace
             << "  --rows N [N ...]         Row counts to benchmark (default: 1000 10000)\n"
             << "  --chunk-size N           Number of VALUES per INSERT (default: 500)\n"
             << "  --lookup-samples N       Number of lookup probes (default: 5)\n"
+            << "  --tree-keys N [N ...]    Key counts for the raw B+ tree lookup test (default: 1000 50000 500000)\n"
+            << "  --tree-lookups N         Point lookups per tree (default: 200000)\n"
             << "  --seed N                 Random seed (default: 42)\n"
             << "  -h, --help               Show this message\n";
         std::exit(code);
@@ -146,6 +168,28 @@ namespace
                     throw std::runtime_error("Expected value after --lookup-samples");
                 opts.lookup_samples = parse_positive_int(argv[++i], "--lookup-samples");
             }
+            else if (arg == "--tree-keys")
+            {
+                opts.tree_keys.clear();
+                while (i + 1 < argc)
+                {
+                    const std::string next = argv[i + 1];
+                    if (next.rfind("--", 0) == 0)
+                        break;
+                    ++i;
+                    opts.tree_keys.push_back(parse_positive_int(next, "--tree-keys"));
+                }
+                if (opts.tree_keys.empty())
+                {
+                    throw std::runtime_error("Expected at least one numeric value after --tree-keys");
+                }
+            }
+            else if (arg == "--tree-lookups")
+            {
+                if (i + 1 >= argc)
+                    throw std::runtime_error("Expected value after --tree-lookups");
+                opts.tree_lookups = parse_positive_int(argv[++i], "--tree-lookups");
+            }
             else if (arg == "--seed")
             {
                 if (i + 1 >= argc)
@@ -318,6 +362,81 @@ namespace
 
         return result;
     }
+
+    // 8-byte big-endian keys from a bijective mix of the ordinal, so keys arrive in
+    // scattered order and their leading bytes differ like real memcomparable keys.
+    std::vector<uint8_t> make_tree_key(std::uint64_t ordinal)
+    {
+        std::uint64_t z = ordinal + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        std::vector<uint8_t> key(sizeof(z));
+        for (std::size_t i = 0; i < key.size(); ++i)
+            key[i] = static_cast<uint8_t>(z >> (8 * (key.size() - 1 - i)));
+        return key;
+    }
+
+    TreeLookupResult run_tree_lookup_benchmark(int keys, int lookups, std::mt19937 &rng)
+    {
+        const fs::path run_dir = make_database_path().parent_path();
+        TreeLookupResult result;
+        result.keys = keys;
+        result.lookups = lookups;
+        {
+            kizuna::FileManager fm((run_dir / "tree.kzi").string(), /*create_if_missing=*/true);
+            fm.open();
+            kizuna::PageManager pm(fm, kizuna::config::DEFAULT_CACHE_SIZE);
+            kizuna::index::BPlusTree tree(pm, fm, kizuna::config::INVALID_PAGE_ID, true);
+
+            result.build_ms = measure_ms([&]()
+                                         {
+                                             for (int i = 0; i < keys; ++i)
+                                                 tree.Insert(make_tree_key(static_cast<std::uint64_t>(i)),
+                                                             static_cast<kizuna::record_id_t>(i));
+                                         });
+            result.height = tree.Height();
+
+            std::uniform_int_distribution<int> pick(0, keys - 1);
+            std::vector<std::vector<uint8_t>> probes;
+            probes.reserve(static_cast<std::size_t>(lookups));
+            for (int i = 0; i < lookups; ++i)
+                probes.push_back(make_tree_key(static_cast<std::uint64_t>(pick(rng))));
+
+            std::size_t found = 0;
+            result.lookup_ms = measure_ms([&]()
+                                          {
+                                              for (const auto &probe : probes)
+                                                  found += tree.Search(probe).found ? 1 : 0;
+                                          });
+            if (found != probes.size())
+                throw std::runtime_error("B+ tree lookup missed an inserted key");
+            fm.close();
+        }
+        {
+            // Same keys through the CREATE INDEX path: sort, then load bottom-up.
+            kizuna::FileManager fm((run_dir / "tree_bulk.kzi").string(), /*create_if_missing=*/true);
+            fm.open();
+            kizuna::PageManager pm(fm, kizuna::config::DEFAULT_CACHE_SIZE);
+            kizuna::index::BPlusTree tree(pm, fm, kizuna::config::INVALID_PAGE_ID, true);
+
+            result.bulk_build_ms = measure_ms([&]()
+                                              {
+                                                  kizuna::index::KeySorter sorter;
+                                                  for (int i = 0; i < keys; ++i)
+                                                      sorter.Add(make_tree_key(static_cast<std::uint64_t>(i)),
+                                                                 static_cast<kizuna::record_id_t>(i));
+                                                  auto loader = tree.StartBulkLoad();
+                                                  sorter.Drain([&](std::span<const uint8_t> key, kizuna::record_id_t value)
+                                                               { loader.Add(key, value); });
+                                                  loader.Finish();
+                                              });
+            fm.close();
+        }
+        std::error_code ec;
+        fs::remove_all(run_dir, ec);
+        return result;
+    }
 } // namespace
 
 int main(int argc, char **argv)
@@ -338,6 +457,7 @@ int main(int argc, char **argv)
         std::cout << "\n";
         std::cout << "Chunk size     : " << options.chunk_size << "\n";
         std::cout << "Lookup samples : " << options.lookup_samples << "\n";
+        std::cout << "Tree lookups   : " << options.tree_lookups << "\n";
         std::cout << "Seed           : " << options.seed << "\n\n";
 
         std::cout.setf(std::ios::fixed);
@@ -375,6 +495,26 @@ int main(int argc, char **argv)
             }
         }
 
+        for (int keys : options.tree_keys)
+        {
+            try
+            {
+                TreeLookupResult result = run_tree_lookup_benchmark(keys, options.tree_lookups, rng);
+                std::cout << "=== B+ tree point lookups, " << result.keys << " keys ===\n";
+                std::cout << "  Tree height  : " << result.height << "\n";
+                std::cout << "  Build        : " << result.build_ms << " ms\n";
+                std::cout << "  Bulk build   : " << result.bulk_build_ms << " ms\n";
+                std::cout << "  Lookups      : " << result.lookups << " in " << result.lookup_ms << " ms\n";
+                std::cout << "  Throughput   : " << result.lookups_per_second() << " lookups/s ("
+                          << (result.lookups_per_second() * static_cast<double>(result.height)) << " node searches/s)\n\n";
+            }
+            catch (const std::exception &ex)
+            {
+                std::cout << "=== B+ tree point lookups, " << keys << " keys ===\n";
+                std::cout << "  FAILED: " << ex.what() << "\n\n";
+            }
+        }
+
         return 0;
     }
     catch (const std::exception &ex)
@@ -0,0 +1,455 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "common/config.h"
+#include "common/exception.h"
+#include "storage/async_io.h"
+#include "storage/file_manager.h"
+#include "storage/page_manager.h"
+
+#if KIZUNA_HAS_POSIX_IO
+#include <fcntl.h>
+#endif
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    struct Options
+    {
+        int pages{4'096};
+        std::vector<kizuna::FileBackend> backends{kizuna::FileBackend::FSTREAM, kizuna::FileBackend::POSIX};
+        std::vector<int> queue_depths{1, 8, 32};
+        unsigned int seed{42};
+    };
+
+    struct BenchmarkResult
+    {
+        double write_ms{0.0};
+        double sync_ms{0.0};
+        double seq_read_ms{0.0};
+        double random_read_ms{0.0};
+    };
+
+    [[noreturn]] void print_usage_and_exit(std::ostream &out, int code)
+    {
+        out << "Usage: kizuna_io_benchmark [options]\n"
+            << "Options:\n"
+            << "  --pages N                Pages to write and read back (default: 4096)\n"
+            << "  --backend NAME [NAME ...] File backends: fstream, posix (default: both)\n"
+            << "  --queue-depth N [N ...]  Async I/O depths for the cold scan (default: 1 8 32)\n"
+            << "  --seed N                 Random seed (default: 42)\n"
+            << "  -h, --help               Show this message\n";
+        std::exit(code);
+    }
+
+    int parse_positive_int(const std::string &value, std::string_view flag)
+    {
+        try
+        {
+            std::size_t pos = 0;
+            int parsed = std::stoi(value, &pos);
+            if (pos != value.size() || parsed <= 0)
+            {
+                throw std::invalid_argument("non-positive");
+            }
+            return parsed;
+        }
+        catch (const std::exception &)
+        {
+            std::ostringstream oss;
+            oss << "Invalid numeric value for " << flag << ": " << value;
+            throw std::runtime_error(oss.str());
+        }
+    }
+
+    unsigned int parse_unsigned_int(const std::string &value, std::string_view flag)
+    {
+        try
+        {
+            std::size_t pos = 0;
+            unsigned long parsed = std::stoul(value, &pos);
+            if (pos != value.size() || parsed > std::numeric_limits<unsigned int>::max())
+            {
+                throw std::invalid_argument("out of range");
+            }
+            return static_cast<unsigned int>(parsed);
+        }
+        catch (const std::exception &)
+        {
+            std::ostringstream oss;
+            oss << "Invalid numeric value for " << flag << ": " << value;
+            throw std::runtime_error(oss.str());
+        }
+    }
+
+    kizuna::FileBackend parse_backend(const std::string &value)
+    {
+        if (value == "fstream")
+            return kizuna::FileBackend::FSTREAM;
+        if (value == "posix")
+            return kizuna::FileBackend::POSIX;
+        throw std::runtime_error("Unknown backend: " + value);
+    }
+
+    Options parse_arguments(int argc, char **argv)
+    {
+        Options opts;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h")
+            {
+                print_usage_and_exit(std::cout, 0);
+            }
+            else if (arg == "--pages")
+            {
+                if (i + 1 >= argc)
+                    throw std::runtime_error("Expected value after --pages");
+                opts.pages = parse_positive_int(argv[++i], "--pages");
+            }
+            else if (arg == "--backend")
+            {
+                opts.backends.clear();
+                while (i + 1 < argc)
+                {
+                    const std::string next = argv[i + 1];
+                    if (next.rfind("--", 0) == 0)
+                        break;
+                    ++i;
+                    opts.backends.push_back(parse_backend(next));
+                }
+                if (opts.backends.empty())
+                    throw std::runtime_error("Expected at least one value after --backend");
+            }
+            else if (arg == "--queue-depth")
+            {
+                opts.queue_depths.clear();
+                while (i + 1 < argc)
+                {
+                    const std::string next = argv[i + 1];
+                    if (next.rfind("--", 0) == 0)
+                        break;
+                    ++i;
+                    opts.queue_depths.push_back(parse_positive_int(next, "--queue-depth"));
+                }
+                if (opts.queue_depths.empty())
+                    throw std::runtime_error("Expected at least one value after --queue-depth");
+            }
+            else if (arg == "--seed")
+            {
+                if (i + 1 >= argc)
+                    throw std::runtime_error("Expected value after --seed");
+                opts.seed = parse_unsigned_int(argv[++i], "--seed");
+            }
+            else
+            {
+                std::ostringstream oss;
+                oss << "Unknown option: " << arg;
+                throw std::runtime_error(oss.str());
+            }
+        }
+        return opts;
+    }
+
+    template <typename Fn>
+    double measure_ms(Fn &&fn)
+    {
+        const auto start = Clock::now();
+        fn();
+        const auto end = Clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+    fs::path make_database_path()
+    {
+        auto base = kizuna::config::temp_dir();
+        std::error_code ec;
+        fs::create_directories(base, ec);
+        const auto now = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+        std::ostringstream oss;
+        oss << "kizuna_io_" << now << kizuna::config::DB_FILE_EXTENSION;
+        return base / oss.str();
+    }
+
+    BenchmarkResult run_single_benchmark(kizuna::FileBackend backend, int pages, unsigned int seed)
+    {
+        const fs::path db_path = make_database_path();
+        BenchmarkResult result;
+        {
+            kizuna::FileManager fm(db_path.string(), /*create_if_missing=*/true, backend);
+            fm.open();
+
+            std::vector<std::uint8_t> buffer(kizuna::config::PAGE_SIZE, 0xAB);
+            result.write_ms = measure_ms([&]()
+                                         {
+                                             for (int i = 0; i < pages; ++i)
+                                             {
+                                                 const auto id = fm.allocate_page();
+                                                 fm.write_page(id, buffer.data());
+                                             }
+                                         });
+            result.sync_ms = measure_ms([&]()
+                                        { fm.sync(); });
+
+            result.seq_read_ms = measure_ms([&]()
+                                            {
+                                                for (int i = 1; i <= pages; ++i)
+                                                {
+                                                    fm.read_page(static_cast<kizuna::page_id_t>(i), buffer.data());
+                                                }
+                                            });
+
+            std::vector<kizuna::page_id_t> order(static_cast<std::size_t>(pages));
+            std::iota(order.begin(), order.end(), 1);
+            std::mt19937 rng(seed);
+            std::shuffle(order.begin(), order.end(), rng);
+            result.random_read_ms = measure_ms([&]()
+                                               {
+                                                   for (auto id : order)
+                                                   {
+                                                       fm.read_page(id, buffer.data());
+                                                   }
+                                               });
+            fm.close();
+        }
+        std::error_code ec;
+        fs::remove(db_path, ec);
+        return result;
+    }
+
+    double mb_per_sec(int pages, double ms)
+    {
+        if (ms <= 0.0)
+            return 0.0;
+        const double mb = static_cast<double>(pages) * kizuna::config::PAGE_SIZE / (1024.0 * 1024.0);
+        return mb / (ms / 1000.0);
+    }
+    // Ask the kernel to drop the file from the page cache so the next scan is cold.
+    bool drop_os_cache(const kizuna::FileManager &fm)
+    {
+#if KIZUNA_HAS_POSIX_IO && defined(POSIX_FADV_DONTNEED)
+        return fm.native_handle() >= 0 && ::posix_fadvise(fm.native_handle(), 0, 0, POSIX_FADV_DONTNEED) == 0;
+#else
+        (void)fm;
+        return false;
+#endif
+    }
+
+    // Sequential read of every page keeping up to `depth` requests in flight.
+    double run_async_scan(kizuna::FileManager &fm, int pages, int depth, kizuna::AsyncIoBackend &backend_out)
+    {
+        kizuna::AsyncIoEngine engine(fm, static_cast<std::size_t>(depth));
+        backend_out = engine.backend();
+        std::vector<std::uint8_t> buffers(static_cast<std::size_t>(depth) * kizuna::config::PAGE_SIZE);
+        std::vector<std::size_t> free_buffers;
+        for (int i = depth; i > 0; --i)
+            free_buffers.push_back(static_cast<std::size_t>(i - 1));
+        std::vector<kizuna::IoCompletion> done;
+        std::size_t failures = 0;
+
+        const double ms = measure_ms([&]()
+                                     {
+                                         kizuna::page_id_t next = 1;
+                                         while (next <= static_cast<kizuna::page_id_t>(pages) || engine.in_flight() > 0)
+                                         {
+                                             while (next <= static_cast<kizuna::page_id_t>(pages) && !free_buffers.empty())
+                                             {
+                                                 const std::size_t b = free_buffers.back();
+                                                 if (!engine.submit_read(next, buffers.data() + b * kizuna::config::PAGE_SIZE, b))
+                                                     break;
+                                                 free_buffers.pop_back();
+                                                 ++next;
+                                             }
+                                             done.clear();
+                                             engine.poll(done, 1);
+                                             for (const auto &c : done)
+                                             {
+                                                 if (!c.ok())
+                                                     ++failures;
+                                                 free_buffers.push_back(static_cast<std::size_t>(c.user_data));
+                                             }
+                                         }
+                                     });
+        if (failures != 0)
+            throw std::runtime_error("async scan had failed reads");
+        return ms;
+    }
+
+    void run_queue_depth_benchmark(const Options &options)
+    {
+        const fs::path db_path = make_database_path();
+        {
+            kizuna::FileManager fm(db_path.string(), /*create_if_missing=*/true, kizuna::FileBackend::POSIX);
+            fm.open();
+            std::vector<std::uint8_t> buffer(kizuna::config::PAGE_SIZE, 0xCD);
+            for (int i = 0; i < options.pages; ++i)
+            {
+                fm.write_page(fm.allocate_page(), buffer.data());
+            }
+            fm.sync();
+
+            std::cout << "=== cold scan, async engine ===\n";
+            for (int depth : options.queue_depths)
+            {
+                const bool cold = drop_os_cache(fm);
+                kizuna::AsyncIoBackend backend = kizuna::AsyncIoBackend::SYNC;
+                const double ms = run_async_scan(fm, options.pages, depth, backend);
+                std::cout << "  depth " << std::setw(3) << depth << " : " << ms << " ms ("
+                          << mb_per_sec(options.pages, ms) << " MB/s) ["
+                          << (backend == kizuna::AsyncIoBackend::IO_URING ? "io_uring" : "sync fallback")
+                          << (cold ? ", cold" : ", warm") << "]\n";
+            }
+            std::cout << "\n";
+            fm.close();
+        }
+        std::error_code ec;
+        fs::remove(db_path, ec);
+    }
+
+    // Walk a next_page_id chain the way a heap scan does, optionally reading ahead.
+    double run_chain_scan(kizuna::FileManager &fm, kizuna::page_id_t root, std::size_t window, int &pages_seen)
+    {
+        kizuna::PageManager pm(fm);
+        kizuna::BufferAccessStrategy ring(pm);
+        pages_seen = 0;
+        return measure_ms([&]()
+                          {
+                              kizuna::page_id_t prev = kizuna::config::INVALID_PAGE_ID;
+                              kizuna::page_id_t readahead_end = kizuna::config::INVALID_PAGE_ID;
+                              kizuna::page_id_t current = root;
+                              while (current >= kizuna::config::FIRST_PAGE_ID)
+                              {
+                                  if (window > 0 && current == prev + 1 && current >= readahead_end)
+                                  {
+                                      const std::size_t span = std::min(window, pm.prefetch_limit(&ring));
+                                      pm.prefetch(current, span, &ring);
+                                      readahead_end = current + static_cast<kizuna::page_id_t>(span);
+                                  }
+                                  auto &page = pm.fetch(current, true, &ring);
+                                  const kizuna::page_id_t next = page.next_page_id();
+                                  pm.unpin(current, false);
+                                  ++pages_seen;
+                                  prev = current;
+                                  current = next;
+                              }
+                          });
+    }
+
+    void run_readahead_benchmark(const Options &options)
+    {
+        const fs::path db_path = make_database_path();
+        {
+            kizuna::FileManager fm(db_path.string(), /*create_if_missing=*/true, kizuna::FileBackend::POSIX);
+            fm.open();
+            kizuna::page_id_t root = kizuna::config::INVALID_PAGE_ID;
+            {
+                kizuna::PageManager pm(fm);
+                kizuna::page_id_t prev = kizuna::config::INVALID_PAGE_ID;
+                for (int i = 0; i < options.pages; ++i)
+                {
+                    const kizuna::page_id_t id = pm.new_page(kizuna::PageType::DATA);
+                    if (prev == kizuna::config::INVALID_PAGE_ID)
+                    {
+                        root = id;
+                    }
+                    else
+                    {
+                        auto &page = pm.fetch(prev, true);
+                        page.set_next_page_id(id);
+                        pm.unpin(prev, true);
+                    }
+                    prev = id;
+                }
+                pm.flush_all();
+            }
+
+            std::cout << "=== cold chain scan, read-ahead ===\n";
+            const std::vector<std::size_t> windows{0, kizuna::config::PREFETCH_WINDOW_SIZE, kizuna::config::BULKREAD_RING_SIZE};
+            for (std::size_t window : windows)
+            {
+                const bool cold = drop_os_cache(fm);
+                int seen = 0;
+                const double ms = run_chain_scan(fm, root, window, seen);
+                std::cout << "  window " << std::setw(3) << window << " : " << ms << " ms ("
+                          << mb_per_sec(seen, ms) << " MB/s)" << (cold ? " [cold]" : " [warm]") << "\n";
+            }
+            std::cout << "\n";
+            fm.close();
+        }
+        std::error_code ec;
+        fs::remove(db_path, ec);
+    }
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const Options options = parse_arguments(argc, argv);
+
+        std::cout << "Kizuna file I/O benchmark (C++ driver)\n";
+        std::cout << "Pages          : " << options.pages << " (" << options.pages * kizuna::config::PAGE_SIZE / 1024 << " KiB)\n";
+        std::cout << "Seed           : " << options.seed << "\n\n";
+
+        std::cout.setf(std::ios::fixed);
+        std::cout << std::setprecision(3);
+
+        for (auto backend : options.backends)
+        {
+            const std::string name = kizuna::file_backend_to_string(backend);
+            try
+            {
+                const BenchmarkResult r = run_single_benchmark(backend, options.pages, options.seed);
+                std::cout << "=== backend: " << name << " ===\n";
+                std::cout << "  Write        : " << r.write_ms << " ms (" << mb_per_sec(options.pages, r.write_ms) << " MB/s)\n";
+                std::cout << "  Sync         : " << r.sync_ms << " ms\n";
+                std::cout << "  Seq read     : " << r.seq_read_ms << " ms (" << mb_per_sec(options.pages, r.seq_read_ms) << " MB/s)\n";
+                std::cout << "  Random read  : " << r.random_read_ms << " ms (" << mb_per_sec(options.pages, r.random_read_ms) << " MB/s)\n\n";
+            }
+            catch (const std::exception &ex)
+            {
+                std::cout << "=== backend: " << name << " ===\n";
+                std::cout << "  FAILED: " << ex.what() << "\n\n";
+            }
+        }
+        try
+        {
+            run_queue_depth_benchmark(options);
+        }
+        catch (const std::exception &ex)
+        {
+            std::cout << "=== cold scan, async engine ===\n";
+            std::cout << "  FAILED: " << ex.what() << "\n\n";
+        }
+        try
+        {
+            run_readahead_benchmark(options);
+        }
+        catch (const std::exception &ex)
+        {
+            std::cout << "=== cold chain scan, read-ahead ===\n";
+            std::cout << "  FAILED: " << ex.what() << "\n\n";
+        }
+        return 0;
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,315 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "catalog/catalog_manager.h"
+#include "common/config.h"
+#include "common/exception.h"
+#include "engine/column_batch.h"
+#include "engine/ddl_executor.h"
+#include "engine/dml_executor.h"
+#include "engine/expression_evaluator.h"
+#include "sql/dml_parser.h"
+#include "storage/file_manager.h"
+#include "storage/index/index_manager.h"
+#include "storage/page_manager.h"
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    struct Options
+    {
+        int rows{1'000'000};
+        int table_rows{100'000};
+        int repeat{3};
+    };
+
+    // WHERE clauses over the bench table: (id INTEGER, grp INTEGER, score INTEGER, tag VARCHAR, flag BOOLEAN).
+    const std::vector<std::string> kPredicates = {
+        "score > 500",
+        "grp = 7 AND score < 300",
+        "NOT (flag = TRUE) OR score IS NULL",
+        "tag = 'tag3' AND grp <> 2",
+        "(score >= 100 AND score < 200) OR (id < 1000 AND flag)",
+    };
+
+    [[noreturn]] void print_usage_and_exit(std::ostream &out, int code)
+    {
+        out << "Usage: kizuna_vector_benchmark [options]\n"
+            << "Options:\n"
+            << "  --rows N         In-memory rows filtered per predicate (default: 1000000)\n"
+            << "  --table-rows N   Rows in the table the SELECT comparison scans (default: 100000)\n"
+            << "  --repeat N       Runs per measurement; the fastest is reported (default: 3)\n"
+            << "  -h, --help       Show this message\n";
+        std::exit(code);
+    }
+
+    int parse_positive_int(const std::string &value, std::string_view flag)
+    {
+        try
+        {
+            std::size_t pos = 0;
+            int parsed = std::stoi(value, &pos);
+            if (pos != value.size() || parsed <= 0)
+            {
+                throw std::invalid_argument("non-positive");
+            }
+            return parsed;
+        }
+        catch (const std::exception &)
+        {
+            std::ostringstream oss;
+            oss << "Invalid numeric value for " << flag << ": " << value;
+            throw std::runtime_error(oss.str());
+        }
+    }
+
+    Options parse_arguments(int argc, char **argv)
+    {
+        Options opts;
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string arg = argv[i];
+            if (arg == "--help" || arg == "-h")
+            {
+                print_usage_and_exit(std::cout, 0);
+            }
+            else if (arg == "--rows" || arg == "--table-rows" || arg == "--repeat")
+            {
+                if (i + 1 >= argc)
+                    throw std::runtime_error("Expected value after " + arg);
+                const int value = parse_positive_int(argv[++i], arg);
+                if (arg == "--rows")
+                    opts.rows = value;
+                else if (arg == "--table-rows")
+                    opts.table_rows = value;
+                else
+                    opts.repeat = value;
+            }
+            else
+            {
+                std::ostringstream oss;
+                oss << "Unknown option: " << arg;
+                throw std::runtime_error(oss.str());
+            }
+        }
+        return opts;
+    }
+
+    template <typename Fn>
+    double fastest_ms(int repeat, Fn &&fn)
+    {
+        double best = 0.0;
+        for (int run = 0; run < repeat; ++run)
+        {
+            const auto start = Clock::now();
+            fn();
+            const double elapsed = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            if (run == 0 || elapsed < best)
+                best = elapsed;
+        }
+        return best;
+    }
+
+    kizuna::catalog::ColumnCatalogEntry make_column(kizuna::column_id_t id, std::string name, kizuna::DataType type)
+    {
+        kizuna::catalog::ColumnCatalogEntry entry;
+        entry.column_id = id;
+        entry.ordinal_position = static_cast<uint32_t>(id - 1);
+        entry.column.id = id;
+        entry.column.name = std::move(name);
+        entry.column.type = type;
+        return entry;
+    }
+
+    // Row n of the bench data; score is NULL on every 13th row.
+    std::vector<kizuna::Value> make_row(int n)
+    {
+        using kizuna::Value;
+        const int score = static_cast<int>((static_cast<std::uint64_t>(n) * 2654435761u) % 1000);
+        return {Value::int32(n),
+                Value::int32(n % 16),
+                n % 13 == 0 ? Value::null(kizuna::DataType::INTEGER) : Value::int32(score),
+                Value::string("tag" + std::to_string(n % 10)),
+                Value::boolean(n % 3 != 0)};
+    }
+
+    std::string value_sql(const kizuna::Value &value)
+    {
+        if (value.is_null())
+            return "NULL";
+        if (value.type() == kizuna::DataType::VARCHAR)
+            return "'" + value.as_string() + "'";
+        return value.to_string();
+    }
+
+    // The predicate over `rows` values: one evaluate_predicate() call per row against one
+    // BatchPredicate::select() call per column batch of the same rows.
+    void run_in_memory(const Options &options)
+    {
+        using namespace kizuna;
+        const std::vector<catalog::ColumnCatalogEntry> columns = {
+            make_column(1, "id", DataType::INTEGER), make_column(2, "grp", DataType::INTEGER),
+            make_column(3, "score", DataType::INTEGER), make_column(4, "tag", DataType::VARCHAR),
+            make_column(5, "flag", DataType::BOOLEAN)};
+        engine::ExpressionEvaluator evaluator(columns, "bench");
+
+        std::vector<DataType> types;
+        for (const auto &column : columns)
+            types.push_back(column.column.type);
+        std::vector<std::vector<Value>> rows;
+        std::vector<engine::ColumnBatch> batches;
+        rows.reserve(static_cast<std::size_t>(options.rows));
+        for (int n = 0; n < options.rows; ++n)
+        {
+            rows.push_back(make_row(n));
+            if (batches.empty() || batches.back().size() == config::VECTOR_BATCH_ROWS)
+                batches.emplace_back(types);
+            batches.back().append_row(rows.back());
+        }
+
+        std::cout << "=== In-memory filter, " << options.rows << " rows, batches of " << config::VECTOR_BATCH_ROWS
+                  << " ===\n";
+        for (const auto &text : kPredicates)
+        {
+            auto stmt = sql::parse_select("SELECT * FROM bench WHERE " + text + ";");
+            auto compiled = evaluator.compile_batch_predicate(*stmt.where);
+            if (!compiled)
+                throw std::runtime_error("Predicate does not compile for batches: " + text);
+
+            std::size_t row_matches = 0;
+            const double row_ms = fastest_ms(options.repeat, [&]()
+                                             {
+                                                 row_matches = 0;
+                                                 for (const auto &row : rows)
+                                                     row_matches += evaluator.evaluate_predicate(*stmt.where, row) == TriBool::True;
+                                             });
+            std::size_t batch_matches = 0;
+            engine::SelectionVector selection;
+            const double batch_ms = fastest_ms(options.repeat, [&]()
+                                               {
+                                                   batch_matches = 0;
+                                                   for (const auto &batch : batches)
+                                                   {
+                                                       compiled->select(batch, selection);
+                                                       batch_matches += selection.size();
+                                                   }
+                                               });
+            if (row_matches != batch_matches)
+                throw std::runtime_error("Row and batch results differ for: " + text);
+
+            std::cout << "  " << text << "\n";
+            std::cout << "    matches      : " << row_matches << "\n";
+            std::cout << "    row-at-a-time: " << row_ms << " ms (" << options.rows / row_ms / 1000.0 << " Mrows/s)\n";
+            std::cout << "    vectorized   : " << batch_ms << " ms (" << options.rows / batch_ms / 1000.0 << " Mrows/s)\n";
+            std::cout << "    speedup      : " << (batch_ms > 0.0 ? row_ms / batch_ms : 0.0) << "x\n";
+        }
+        std::cout << "\n";
+    }
+
+    fs::path make_database_path()
+    {
+        auto base = kizuna::config::temp_dir();
+        std::error_code ec;
+        fs::create_directories(base, ec);
+        const auto now = std::chrono::high_resolution_clock::now().time_since_epoch().count();
+        fs::path run_dir = base / ("kizuna_vector_perf_" + std::to_string(now));
+        fs::create_directories(run_dir, ec);
+        return run_dir / (std::string("benchmark") + kizuna::config::DB_FILE_EXTENSION);
+    }
+
+    // The same predicates through DMLExecutor::select(), which reads the table heap, with
+    // vectorized filters on and off.
+    void run_select(const Options &options)
+    {
+        using namespace kizuna;
+        const fs::path db_path = make_database_path();
+        {
+            FileManager fm(db_path.string(), /*create_if_missing=*/true);
+            fm.open();
+            PageManager pm(fm, config::DEFAULT_CACHE_SIZE);
+            catalog::CatalogManager catalog(pm, fm);
+            index::IndexManager index_manager(db_path.parent_path() / "indexes");
+            engine::DDLExecutor ddl(catalog, pm, fm, index_manager);
+            engine::DMLExecutor dml(catalog, pm, fm, index_manager);
+
+            ddl.execute("CREATE TABLE bench (id INTEGER, grp INTEGER, score INTEGER, tag VARCHAR(16), flag BOOLEAN);");
+            for (int start = 0; start < options.table_rows; start += 1000)
+            {
+                std::string sql = "INSERT INTO bench (id, grp, score, tag, flag) VALUES ";
+                for (int n = start; n < std::min(options.table_rows, start + 1000); ++n)
+                {
+                    const auto row = make_row(n);
+                    sql += n > start ? ", (" : "(";
+                    for (std::size_t c = 0; c < row.size(); ++c)
+                        sql += (c > 0 ? ", " : "") + value_sql(row[c]);
+                    sql += ")";
+                }
+                dml.insert_into(sql::parse_insert(sql + ";"));
+            }
+
+            std::cout << "=== SELECT COUNT(*) over a " << options.table_rows << "-row table ===\n";
+            for (const auto &text : kPredicates)
+            {
+                const auto stmt = sql::parse_select("SELECT COUNT(*) FROM bench WHERE " + text + ";");
+                engine::SelectResult rows_result;
+                dml.set_vectorized_filters(false);
+                const double row_ms = fastest_ms(options.repeat, [&]()
+                                                 { rows_result = dml.select(stmt); });
+                engine::SelectResult batch_result;
+                dml.set_vectorized_filters(true);
+                const double batch_ms = fastest_ms(options.repeat, [&]()
+                                                   { batch_result = dml.select(stmt); });
+                if (rows_result.rows != batch_result.rows)
+                    throw std::runtime_error("Row and batch SELECT results differ for: " + text);
+
+                std::cout << "  " << text << "\n";
+                std::cout << "    count        : " << batch_result.rows.front().front() << "\n";
+                std::cout << "    row-at-a-time: " << row_ms << " ms\n";
+                std::cout << "    vectorized   : " << batch_ms << " ms\n";
+                std::cout << "    speedup      : " << (batch_ms > 0.0 ? row_ms / batch_ms : 0.0) << "x\n";
+            }
+            std::cout << "\n";
+            pm.flush_all();
+            fm.close();
+        }
+        std::error_code ec;
+        fs::remove_all(db_path.parent_path(), ec);
+    }
+} // namespace
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        const Options options = parse_arguments(argc, argv);
+
+        std::cout << "Kizuna vectorized filter benchmark\n";
+        std::cout << "In-memory rows : " << options.rows << "\n";
+        std::cout << "Table rows     : " << options.table_rows << "\n";
+        std::cout << "Repeat         : " << options.repeat << "\n\n";
+
+        std::cout.setf(std::ios::fixed);
+        std::cout << std::setprecision(3);
+
+        run_in_memory(options);
+        run_select(options);
+        return 0;
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error: " << ex.what() << "\n";
+        return 1;
+    }
+}
@@ -257,6 +257,11 @@ namespace kizuna::sql
         std::string table_name;
     };
 
+    struct VacuumStatement
+    {
+        std::string table_name;
+    };
+
     struct UpdateAssignment
     {
         std::string column_name;
@@ -276,7 +281,8 @@ namespace kizuna::sql
         SELECT,
         DELETE,
         UPDATE,
-        TRUNCATE
+        TRUNCATE,
+        VACUUM
     };
 
     struct ParsedDML
@@ -287,5 +293,6 @@ namespace kizuna::sql
         DeleteStatement del;
         UpdateStatement update;
         TruncateStatement truncate;
+        VacuumStatement vacuum;
     };
 }
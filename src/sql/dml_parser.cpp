@@ -338,6 +338,17 @@ namespace kizuna::sql
                 return stmt;
             }
 
+            VacuumStatement parse_vacuum()
+            {
+                expect_keyword("VACUUM");
+                match_keyword("TABLE");
+                VacuumStatement stmt;
+                stmt.table_name = expect_identifier("table name");
+                consume_semicolon();
+                expect_end();
+                return stmt;
+            }
+
             const Token &peek(size_t offset = 0) const
             {
                 size_t index = position_ + offset;
@@ -826,6 +837,13 @@ namespace kizuna::sql
         return parser.parse_truncate();
     }
 
+    VacuumStatement parse_vacuum(std::string_view sql)
+    {
+        Lexer lexer(sql);
+        Parser parser(sql, lexer.tokens());
+        return parser.parse_vacuum();
+    }
+
     ParsedDML parse_dml(std::string_view sql)
     {
         Lexer lexer(sql);
@@ -866,6 +884,12 @@ namespace kizuna::sql
             result.truncate = parser.parse_truncate();
             return result;
         }
+        if (first.upper == "VACUUM")
+        {
+            result.kind = DMLStatementKind::VACUUM;
+            result.vacuum = parser.parse_vacuum();
+            return result;
+        }
         throw QueryException::syntax_error(sql, first.position, "DML statement");
     }
 }
@@ -12,5 +12,6 @@ namespace kizuna::sql
     DeleteStatement parse_delete(std::string_view sql);
     UpdateStatement parse_update(std::string_view sql);
     TruncateStatement parse_truncate(std::string_view sql);
+    VacuumStatement parse_vacuum(std::string_view sql);
     ParsedDML parse_dml(std::string_view sql);
 }
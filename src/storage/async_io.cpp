@@ -0,0 +1,334 @@
+#include "storage/async_io.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+#if KIZUNA_HAS_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace kizuna
+{
+#if KIZUNA_HAS_IO_URING
+    namespace
+    {
+        int sys_io_uring_setup(unsigned entries, io_uring_params *params)
+        {
+            return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+        }
+
+        int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+        {
+            return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+        }
+
+        int sys_io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args)
+        {
+            return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+        }
+
+        // Whether the kernel implements the opcodes queue_sqe() issues. Kernels before
+        // 5.6 have neither IORING_OP_READ/WRITE nor IORING_REGISTER_PROBE, so a failed
+        // probe counts as missing opcodes too.
+        bool supports_page_io(int fd)
+        {
+            constexpr unsigned kProbeOps = 256;
+            std::vector<uint8_t> buffer(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op), 0);
+            auto *probe = reinterpret_cast<io_uring_probe *>(buffer.data());
+            if (sys_io_uring_register(fd, IORING_REGISTER_PROBE, probe, kProbeOps) < 0)
+            {
+                return false;
+            }
+            auto supported = [probe](unsigned op)
+            {
+                return op <= probe->last_op && op < probe->ops_len &&
+                       (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+            };
+            return supported(IORING_OP_READ) && supported(IORING_OP_WRITE);
+        }
+
+        unsigned load_acquire(const unsigned *p) { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+        void store_release(unsigned *p, unsigned v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+
+        template <typename T>
+        T *at_offset(void *base, std::size_t off)
+        {
+            return reinterpret_cast<T *>(static_cast<uint8_t *>(base) + off);
+        }
+    }
+#endif
+
+    AsyncIoEngine::AsyncIoEngine(FileManager &fm, std::size_t queue_depth, bool prefer_io_uring)
+        : fm_(fm), queue_depth_(std::max<std::size_t>(1, queue_depth))
+    {
+        if (!fm_.is_open())
+        {
+            KIZUNA_THROW_IO(StatusCode::IO_ERROR, "AsyncIoEngine needs an open file", fm_.path());
+        }
+#if KIZUNA_HAS_IO_URING
+        if (prefer_io_uring && fm_.native_handle() >= 0 && setup_ring())
+        {
+            backend_ = AsyncIoBackend::IO_URING;
+            slots_.resize(queue_depth_);
+            free_slots_.reserve(queue_depth_);
+            for (std::size_t i = queue_depth_; i > 0; --i)
+            {
+                free_slots_.push_back(i - 1);
+            }
+        }
+#else
+        (void)prefer_io_uring;
+#endif
+    }
+
+    AsyncIoEngine::~AsyncIoEngine()
+    {
+#if KIZUNA_HAS_IO_URING
+        if (backend_ == AsyncIoBackend::IO_URING)
+        {
+            // Buffers may be freed right after us; never leave requests behind.
+            try
+            {
+                std::vector<IoCompletion> sink;
+                drain(sink);
+            }
+            catch (...)
+            {
+            }
+            teardown_ring();
+        }
+#endif
+    }
+
+    bool AsyncIoEngine::submit_read(page_id_t page_id, uint8_t *buffer, uint64_t user_data)
+    {
+        if (full())
+            return false;
+#if KIZUNA_HAS_IO_URING
+        if (backend_ == AsyncIoBackend::IO_URING)
+            return queue_sqe(false, page_id, buffer, user_data);
+#endif
+        run_sync(false, page_id, buffer, user_data);
+        return true;
+    }
+
+    bool AsyncIoEngine::submit_write(page_id_t page_id, const uint8_t *buffer, uint64_t user_data)
+    {
+        if (full())
+            return false;
+#if KIZUNA_HAS_IO_URING
+        if (backend_ == AsyncIoBackend::IO_URING)
+            return queue_sqe(true, page_id, const_cast<uint8_t *>(buffer), user_data);
+#endif
+        run_sync(true, page_id, const_cast<uint8_t *>(buffer), user_data);
+        return true;
+    }
+
+    std::size_t AsyncIoEngine::poll(std::vector<IoCompletion> &out, std::size_t min_complete)
+    {
+        min_complete = std::min(min_complete, in_flight_);
+#if KIZUNA_HAS_IO_URING
+        if (backend_ == AsyncIoBackend::IO_URING)
+        {
+            std::size_t reaped = reap(out);
+            while (pending_submit_ > 0 || reaped < min_complete)
+            {
+                const unsigned wait = reaped < min_complete ? static_cast<unsigned>(min_complete - reaped) : 0u;
+                const int rc = sys_io_uring_enter(ring_.fd,
+                                                  static_cast<unsigned>(pending_submit_),
+                                                  wait,
+                                                  wait > 0 ? IORING_ENTER_GETEVENTS : 0u);
+                if (rc < 0)
+                {
+                    if (errno == EINTR || errno == EAGAIN || errno == EBUSY)
+                    {
+                        reaped += reap(out);
+                        continue;
+                    }
+                    KIZUNA_THROW_IO(StatusCode::IO_ERROR, "io_uring_enter failed", std::strerror(errno));
+                }
+                pending_submit_ -= std::min<std::size_t>(pending_submit_, static_cast<std::size_t>(rc));
+                reaped += reap(out);
+            }
+            return reaped;
+        }
+#endif
+        const std::size_t count = ready_.size();
+        for (auto &c : ready_)
+        {
+            out.push_back(c);
+        }
+        ready_.clear();
+        in_flight_ -= count;
+        return count;
+    }
+
+    void AsyncIoEngine::run_sync(bool is_write, page_id_t page_id, uint8_t *buffer, uint64_t user_data)
+    {
+        IoCompletion c;
+        c.user_data = user_data;
+        c.page_id = page_id;
+        c.is_write = is_write;
+        try
+        {
+            if (is_write)
+                fm_.write_page(page_id, buffer);
+            else
+                fm_.read_page(page_id, buffer);
+            c.result = static_cast<int>(config::PAGE_SIZE);
+        }
+        catch (const DBException &)
+        {
+            c.result = -EIO;
+        }
+        ready_.push_back(c);
+        ++in_flight_;
+    }
+
+#if KIZUNA_HAS_IO_URING
+    bool AsyncIoEngine::setup_ring()
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        const int fd = sys_io_uring_setup(static_cast<unsigned>(queue_depth_), &params);
+        if (fd < 0)
+        {
+            KIZUNA_LOG_DEBUG("io_uring unavailable (", std::strerror(errno), "); using synchronous I/O");
+            return false;
+        }
+        ring_.fd = fd;
+        if (!supports_page_io(fd))
+        {
+            KIZUNA_LOG_DEBUG("io_uring lacks IORING_OP_READ/WRITE; using synchronous I/O");
+            teardown_ring();
+            return false;
+        }
+
+        ring_.sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        ring_.cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap)
+        {
+            ring_.sq_size = ring_.cq_size = std::max(ring_.sq_size, ring_.cq_size);
+        }
+        ring_.sq_ptr = ::mmap(nullptr, ring_.sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (ring_.sq_ptr == MAP_FAILED)
+        {
+            ring_.sq_ptr = nullptr;
+            teardown_ring();
+            return false;
+        }
+        if (single_mmap)
+        {
+            ring_.cq_ptr = ring_.sq_ptr;
+        }
+        else
+        {
+            ring_.cq_ptr = ::mmap(nullptr, ring_.cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (ring_.cq_ptr == MAP_FAILED)
+            {
+                ring_.cq_ptr = nullptr;
+                teardown_ring();
+                return false;
+            }
+        }
+        ring_.sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+        ring_.sqes_ptr = ::mmap(nullptr, ring_.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (ring_.sqes_ptr == MAP_FAILED)
+        {
+            ring_.sqes_ptr = nullptr;
+            teardown_ring();
+            return false;
+        }
+
+        ring_.sq_head = at_offset<unsigned>(ring_.sq_ptr, params.sq_off.head);
+        ring_.sq_tail = at_offset<unsigned>(ring_.sq_ptr, params.sq_off.tail);
+        ring_.sq_mask = at_offset<unsigned>(ring_.sq_ptr, params.sq_off.ring_mask);
+        ring_.sq_array = at_offset<unsigned>(ring_.sq_ptr, params.sq_off.array);
+        ring_.cq_head = at_offset<unsigned>(ring_.cq_ptr, params.cq_off.head);
+        ring_.cq_tail = at_offset<unsigned>(ring_.cq_ptr, params.cq_off.tail);
+        ring_.cq_mask = at_offset<unsigned>(ring_.cq_ptr, params.cq_off.ring_mask);
+        ring_.cqes = at_offset<void>(ring_.cq_ptr, params.cq_off.cqes);
+        return true;
+    }
+
+    void AsyncIoEngine::teardown_ring() noexcept
+    {
+        if (ring_.sqes_ptr)
+            ::munmap(ring_.sqes_ptr, ring_.sqes_size);
+        if (ring_.cq_ptr && ring_.cq_ptr != ring_.sq_ptr)
+            ::munmap(ring_.cq_ptr, ring_.cq_size);
+        if (ring_.sq_ptr)
+            ::munmap(ring_.sq_ptr, ring_.sq_size);
+        if (ring_.fd >= 0)
+            ::close(ring_.fd);
+        ring_ = Ring{};
+    }
+
+    bool AsyncIoEngine::queue_sqe(bool is_write, page_id_t page_id, uint8_t *buffer, uint64_t user_data)
+    {
+        if (buffer == nullptr || page_id < config::FIRST_PAGE_ID)
+        {
+            KIZUNA_THROW_IO(StatusCode::INVALID_ARGUMENT, "Invalid async I/O request", std::to_string(page_id));
+        }
+        const unsigned tail = *ring_.sq_tail;
+        const unsigned head = load_acquire(ring_.sq_head);
+        if (tail - head >= queue_depth_ || free_slots_.empty())
+        {
+            return false;
+        }
+        const std::size_t slot = free_slots_.back();
+        free_slots_.pop_back();
+        slots_[slot] = Pending{user_data, page_id, is_write};
+
+        const unsigned index = tail & *ring_.sq_mask;
+        auto *sqe = static_cast<io_uring_sqe *>(ring_.sqes_ptr) + index;
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = is_write ? IORING_OP_WRITE : IORING_OP_READ;
+        sqe->fd = fm_.native_handle();
+        sqe->off = FileManager::offset_of(page_id);
+        sqe->addr = reinterpret_cast<uint64_t>(buffer);
+        sqe->len = static_cast<uint32_t>(config::PAGE_SIZE);
+        sqe->user_data = static_cast<uint64_t>(slot);
+        ring_.sq_array[index] = index;
+        store_release(ring_.sq_tail, tail + 1);
+
+        ++pending_submit_;
+        ++in_flight_;
+        return true;
+    }
+
+    std::size_t AsyncIoEngine::reap(std::vector<IoCompletion> &out)
+    {
+        std::size_t count = 0;
+        unsigned head = *ring_.cq_head;
+        const unsigned tail = load_acquire(ring_.cq_tail);
+        while (head != tail)
+        {
+            const auto *cqe = static_cast<const io_uring_cqe *>(ring_.cqes) + (head & *ring_.cq_mask);
+            const std::size_t slot = static_cast<std::size_t>(cqe->user_data);
+            const Pending &pending = slots_[slot];
+            IoCompletion c;
+            c.user_data = pending.user_data;
+            c.page_id = pending.page_id;
+            c.is_write = pending.is_write;
+            c.result = cqe->res;
+            out.push_back(c);
+            free_slots_.push_back(slot);
+            ++head;
+            ++count;
+        }
+        store_release(ring_.cq_head, head);
+        in_flight_ -= count;
+        return count;
+    }
+#endif
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "common/config.h"
+#include "common/types.h"
+#include "storage/file_manager.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define KIZUNA_HAS_IO_URING 1
+#endif
+#endif
+#ifndef KIZUNA_HAS_IO_URING
+#define KIZUNA_HAS_IO_URING 0
+#endif
+
+namespace kizuna
+{
+    enum class AsyncIoBackend : uint8_t
+    {
+        SYNC = 0,    // requests run inline on submit; completions are queued for poll()
+        IO_URING = 1 // requests are queued to the kernel and complete asynchronously
+    };
+
+    struct IoCompletion
+    {
+        uint64_t user_data{0};
+        page_id_t page_id{0};
+        bool is_write{false};
+        int result{0}; // bytes transferred, or -errno
+
+        bool ok() const noexcept { return result == static_cast<int>(config::PAGE_SIZE); }
+    };
+
+    // Page-granular asynchronous reads/writes against one FileManager.
+    // Uses io_uring (raw syscalls, no liburing) when the FileManager runs the POSIX
+    // backend and the kernel supports IORING_OP_READ/WRITE (probed with
+    // IORING_REGISTER_PROBE at construction); otherwise every request is executed
+    // synchronously through FileManager so callers need only one code path.
+    // Buffers must stay valid until their completion is returned by poll().
+    // Not thread-safe; callers serialize access.
+    class AsyncIoEngine
+    {
+    public:
+        explicit AsyncIoEngine(FileManager &fm,
+                               std::size_t queue_depth = config::ASYNC_IO_QUEUE_DEPTH,
+                               bool prefer_io_uring = true);
+        ~AsyncIoEngine();
+
+        AsyncIoEngine(const AsyncIoEngine &) = delete;
+        AsyncIoEngine &operator=(const AsyncIoEngine &) = delete;
+
+        AsyncIoBackend backend() const noexcept { return backend_; }
+        std::size_t queue_depth() const noexcept { return queue_depth_; }
+        std::size_t in_flight() const noexcept { return in_flight_; }
+        bool full() const noexcept { return in_flight_ >= queue_depth_; }
+
+        // Queue a request. Returns false (nothing queued) when queue_depth requests are
+        // already in flight; reap some with poll() first.
+        bool submit_read(page_id_t page_id, uint8_t *buffer, uint64_t user_data = 0);
+        bool submit_write(page_id_t page_id, const uint8_t *buffer, uint64_t user_data = 0);
+
+        // Push queued requests to the kernel and append finished ones to `out`.
+        // Blocks until at least `min_complete` completions are available (capped at in_flight()).
+        std::size_t poll(std::vector<IoCompletion> &out, std::size_t min_complete = 0);
+
+        // Wait for every in-flight request.
+        std::size_t drain(std::vector<IoCompletion> &out) { return poll(out, in_flight_); }
+
+    private:
+        FileManager &fm_;
+        std::size_t queue_depth_;
+        AsyncIoBackend backend_{AsyncIoBackend::SYNC};
+        std::size_t in_flight_{0};
+        std::deque<IoCompletion> ready_; // SYNC backend completions
+
+#if KIZUNA_HAS_IO_URING
+        struct Ring
+        {
+            int fd{-1};
+            void *sq_ptr{nullptr};
+            std::size_t sq_size{0};
+            void *cq_ptr{nullptr};
+            std::size_t cq_size{0};
+            void *sqes_ptr{nullptr};
+            std::size_t sqes_size{0};
+            unsigned *sq_head{nullptr};
+            unsigned *sq_tail{nullptr};
+            unsigned *sq_mask{nullptr};
+            unsigned *sq_array{nullptr};
+            unsigned *cq_head{nullptr};
+            unsigned *cq_tail{nullptr};
+            unsigned *cq_mask{nullptr};
+            void *cqes{nullptr};
+        };
+        Ring ring_{};
+        std::size_t pending_submit_{0};
+        // page id + direction per user_data slot
+        struct Pending
+        {
+            uint64_t user_data{0};
+            page_id_t page_id{0};
+            bool is_write{false};
+        };
+        std::vector<Pending> slots_;
+        std::vector<std::size_t> free_slots_;
+
+        bool setup_ring();
+        void teardown_ring() noexcept;
+        bool queue_sqe(bool is_write, page_id_t page_id, uint8_t *buffer, uint64_t user_data);
+        std::size_t reap(std::vector<IoCompletion> &out);
+#endif
+
+        void run_sync(bool is_write, page_id_t page_id, uint8_t *buffer, uint64_t user_data);
+    };
+}
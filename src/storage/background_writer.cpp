@@ -0,0 +1,96 @@
+#include "storage/background_writer.h"
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace kizuna
+{
+    BackgroundWriter::BackgroundWriter(BufferPool &pool, std::chrono::milliseconds delay, std::size_t max_pages,
+                                       std::chrono::milliseconds checkpoint_interval)
+        : pool_(pool),
+          delay_(delay.count() > 0 ? delay : std::chrono::milliseconds(1)),
+          max_pages_(max_pages ? max_pages : 1),
+          checkpoint_interval_(checkpoint_interval)
+    {
+        thread_ = std::thread([this]()
+                              { run(); });
+    }
+
+    BackgroundWriter::~BackgroundWriter()
+    {
+        {
+            std::lock_guard<std::mutex> guard(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    void BackgroundWriter::request_checkpoint()
+    {
+        std::unique_lock<std::mutex> guard(mutex_);
+        const uint64_t target = checkpoints_ + 1;
+        checkpoint_requested_ = true;
+        wake_.notify_all();
+        done_.wait(guard, [&]()
+                   { return checkpoints_ >= target || stop_; });
+    }
+
+    uint64_t BackgroundWriter::rounds() const
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return rounds_;
+    }
+
+    uint64_t BackgroundWriter::checkpoints() const
+    {
+        std::lock_guard<std::mutex> guard(mutex_);
+        return checkpoints_;
+    }
+
+    void BackgroundWriter::run()
+    {
+        auto next_checkpoint = Clock::now() + checkpoint_interval_;
+        std::unique_lock<std::mutex> guard(mutex_);
+        while (!stop_)
+        {
+            wake_.wait_for(guard, delay_, [&]()
+                           { return stop_ || checkpoint_requested_; });
+            if (stop_)
+                break;
+            const bool checkpoint = checkpoint_requested_ ||
+                                    (checkpoint_interval_.count() > 0 && Clock::now() >= next_checkpoint);
+            checkpoint_requested_ = false;
+            guard.unlock();
+
+            // Errors are logged and retried next round; the pages stay dirty.
+            try
+            {
+                if (checkpoint)
+                {
+                    const std::size_t written = pool_.checkpoint();
+                    Logger::instance().debug("Checkpoint wrote ", written, " page(s)");
+                    next_checkpoint = Clock::now() + checkpoint_interval_;
+                }
+                else
+                {
+                    pool_.write_back_cold(max_pages_);
+                }
+            }
+            catch (const DBException &e)
+            {
+                Logger::instance().warn("Background writer: ", e.what());
+            }
+
+            guard.lock();
+            ++rounds_;
+            if (checkpoint)
+            {
+                ++checkpoints_;
+                done_.notify_all();
+            }
+        }
+        done_.notify_all();
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "common/config.h"
+#include "storage/buffer_pool.h"
+
+namespace kizuna
+{
+    // Background writer and checkpointer for a BufferPool (like PostgreSQL's bgwriter
+    // and checkpointer processes). Every `delay` it cleans up to `max_pages` dirty
+    // pages at the cold end of the replacement policy, so the next victims are usually
+    // clean by the time a query evicts them. Every `checkpoint_interval` it writes all
+    // dirty pages in page order and syncs the files. A zero interval disables that part.
+    // The thread starts on construction and stops on destruction; the pool must
+    // outlive the writer.
+    class BackgroundWriter
+    {
+    public:
+        explicit BackgroundWriter(BufferPool &pool,
+                                  std::chrono::milliseconds delay = std::chrono::milliseconds(config::BGWRITER_DELAY_MS),
+                                  std::size_t max_pages = config::BGWRITER_MAX_PAGES,
+                                  std::chrono::milliseconds checkpoint_interval = std::chrono::milliseconds(config::CHECKPOINT_INTERVAL_MS));
+        ~BackgroundWriter();
+
+        BackgroundWriter(const BackgroundWriter &) = delete;
+        BackgroundWriter &operator=(const BackgroundWriter &) = delete;
+
+        // Runs a checkpoint on the writer thread now and waits for it.
+        void request_checkpoint();
+        uint64_t rounds() const;
+        uint64_t checkpoints() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        BufferPool &pool_;
+        std::chrono::milliseconds delay_;
+        std::size_t max_pages_;
+        std::chrono::milliseconds checkpoint_interval_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        bool stop_{false};
+        bool checkpoint_requested_{false};
+        uint64_t rounds_{0};
+        uint64_t checkpoints_{0};
+        std::thread thread_;
+
+        void run();
+    };
+}
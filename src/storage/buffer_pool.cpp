@@ -0,0 +1,1334 @@
+#include "storage/buffer_pool.h"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <new>
+
+#include "storage/file_manager.h"
+#include "storage/page_manager.h"
+
+#if KIZUNA_HAS_POSIX_IO
+#include <sys/mman.h>
+#endif
+
+namespace kizuna
+{
+    namespace
+    {
+        static_assert(sizeof(Page) == config::PAGE_SIZE, "Frame arenas assume pages are packed");
+
+        constexpr std::size_t kHugePageBytes = 2 * 1024 * 1024;
+
+        page_id_t page_of(page_key_t key) noexcept { return static_cast<page_id_t>(key); }
+
+        // Lets the OS reclaim the memory behind retired frames of a chunk that stays mapped.
+        void release_pages([[maybe_unused]] void *first, [[maybe_unused]] std::size_t count) noexcept
+        {
+#if KIZUNA_HAS_POSIX_IO && defined(MADV_DONTNEED)
+            ::madvise(first, count * config::PAGE_SIZE, MADV_DONTNEED);
+#endif
+        }
+
+        // Frames shard `s` of `shard_count` holds when the pool has `capacity` frames.
+        std::size_t shard_target(std::size_t capacity, std::size_t shard_count, std::size_t s) noexcept
+        {
+            return std::max<std::size_t>(1, capacity / shard_count + (s < capacity % shard_count ? 1 : 0));
+        }
+    }
+
+    BufferPool::BufferPool(std::size_t capacity, std::size_t shard_count, ReplacementPolicyKind policy)
+        : policy_kind_(policy)
+    {
+        capacity = capacity ? capacity : 1;
+        // Every shard needs at least one frame.
+        shard_count = std::clamp<std::size_t>(shard_count, 1, config::BUFFER_POOL_MAX_SHARDS);
+        shard_count = std::min(shard_count, capacity);
+        shards_.reserve(shard_count);
+        for (std::size_t s = 0; s < shard_count; ++s)
+        {
+            auto shard = std::make_unique<Shard>();
+            shard->policy = make_replacement_policy(policy_kind_, 0, 0);
+            shards_.push_back(std::move(shard));
+        }
+        resize(capacity);
+    }
+
+    BufferPool::~BufferPool()
+    {
+        for (auto &chunk : chunks_)
+        {
+            unmap_chunk(*chunk);
+        }
+    }
+
+    file_id_t BufferPool::register_file(PageManager &owner)
+    {
+        std::lock_guard<std::mutex> guard(registry_mutex_);
+        files_.insert(&owner);
+        return next_file_id_++;
+    }
+
+    void BufferPool::unregister_file(PageManager &owner)
+    {
+        for (auto &shard : shards_)
+        {
+            std::lock_guard<std::mutex> guard(shard->latch);
+            std::vector<std::size_t> owned;
+            for (const auto &kv : shard->page_table)
+            {
+                if (frame(kv.second).owner == &owner)
+                    owned.push_back(kv.second);
+            }
+            for (auto idx : owned)
+            {
+                auto &fr = frame(idx);
+                settle(fr);
+                if (fr.dirty)
+                {
+                    try { write_frame(fr); } catch (...) { /* best-effort, the file is going away */ }
+                }
+                discard_frame(*shard, idx);
+            }
+        }
+        std::lock_guard<std::mutex> guard(registry_mutex_);
+        files_.erase(&owner);
+    }
+
+    std::size_t BufferPool::file_count() const
+    {
+        std::lock_guard<std::mutex> guard(registry_mutex_);
+        return files_.size();
+    }
+
+    void BufferPool::create_page(PageManager &owner, page_id_t id, PageType type)
+    {
+        // Initialize header in a cache frame (a recycled page may still be cached) and
+        // write it through so the on-disk image is valid immediately.
+        const page_key_t key = page_key(owner.file_id(), id);
+        Shard &shard = shard_for(key);
+        std::lock_guard<std::mutex> guard(shard.latch);
+        auto it = shard.page_table.find(key);
+        std::size_t idx = 0;
+        if (it != shard.page_table.end())
+        {
+            idx = it->second;
+            if (frame(idx).ring != nullptr)
+                adopt_into_policy(shard, idx);
+            shard.policy->record_hit(frame(idx).slot);
+        }
+        else
+        {
+            idx = obtain_frame_for(shard, owner, key, /*pin*/ false);
+        }
+        auto &fr = frame(idx);
+        settle(fr);
+        std::memset(fr.page->data(), 0, config::PAGE_SIZE);
+        fr.page->init(type, id);
+        owner.disk_write(id, fr.page->data());
+        fr.dirty = false;
+        fr.loading = false;
+    }
+
+    Page &BufferPool::fetch(PageManager &owner, page_id_t id, bool pin, BufferAccessStrategy *strategy)
+    {
+        const page_key_t key = page_key(owner.file_id(), id);
+        const std::size_t shard_idx = shard_index(key);
+        Shard &shard = *shards_[shard_idx];
+        std::unique_lock<std::mutex> guard(shard.latch);
+        auto it = shard.page_table.find(key);
+        if (it != shard.page_table.end())
+        {
+            const std::size_t idx = it->second;
+            auto &fr = frame(idx);
+            bool pinned = false;
+            if (fr.loading.load(std::memory_order_acquire))
+            {
+                // Wait for the read without the shard latch; the pin keeps the frame put.
+                if (fr.pin_count.fetch_add(1, std::memory_order_acq_rel) == 0 && fr.ring == nullptr)
+                {
+                    shard.policy->set_evictable(fr.slot, false);
+                }
+                pinned = true;
+                guard.unlock();
+                try
+                {
+                    await_load(fr);
+                }
+                catch (const DBException &)
+                {
+                    guard.lock();
+                    if (fr.pin_count.fetch_sub(1, std::memory_order_acq_rel) == 1 && fr.ring == nullptr)
+                    {
+                        shard.policy->set_evictable(fr.slot, true);
+                    }
+                    throw;
+                }
+                guard.lock();
+            }
+            shard.stats.hits++;
+            if (fr.ring != nullptr && fr.ring != strategy)
+            {
+                // Referenced outside its scan: the page is worth keeping.
+                adopt_into_policy(shard, idx);
+            }
+            const bool in_policy = fr.ring == nullptr;
+            if (in_policy)
+            {
+                shard.policy->record_hit(fr.slot);
+            }
+            if (pin && !pinned)
+            {
+                if (fr.pin_count.fetch_add(1, std::memory_order_acq_rel) == 0 && in_policy)
+                {
+                    shard.policy->set_evictable(fr.slot, false);
+                }
+            }
+            else if (!pin && pinned)
+            {
+                if (fr.pin_count.fetch_sub(1, std::memory_order_acq_rel) == 1 && in_policy)
+                {
+                    shard.policy->set_evictable(fr.slot, true);
+                }
+            }
+            return *fr.page;
+        }
+
+        // Load from disk into a frame
+        shard.stats.misses++;
+        const std::size_t idx = strategy ? obtain_ring_frame(shard, shard_idx, *strategy, owner, key, pin)
+                                         : obtain_frame_for(shard, owner, key, pin);
+        auto &fr = frame(idx);
+        try
+        {
+            owner.disk_read(id, fr.page->data());
+        }
+        catch (const DBException &)
+        {
+            // release the frame since load failed
+            discard_frame(shard, idx);
+            throw;
+        }
+        return *fr.page;
+    }
+
+    std::size_t BufferPool::load_range(PageManager &owner, page_id_t first, std::size_t count, BufferAccessStrategy *strategy)
+    {
+        const file_id_t file = owner.file_id();
+        // Latch every shard the window touches, in index order. This is the only path
+        // holding more than one shard latch, so the fixed order cannot deadlock.
+        std::vector<std::size_t> shard_ids;
+        shard_ids.reserve(count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            shard_ids.push_back(shard_index(page_key(file, static_cast<page_id_t>(first + i))));
+        }
+        std::vector<std::size_t> order = shard_ids;
+        std::sort(order.begin(), order.end());
+        order.erase(std::unique(order.begin(), order.end()), order.end());
+        std::vector<std::unique_lock<std::mutex>> guards;
+        guards.reserve(order.size());
+        for (auto s : order)
+        {
+            guards.emplace_back(shards_[s]->latch);
+        }
+
+        // Claim a pinned frame for each uncached page; pinning keeps a frame claimed
+        // earlier in this window from being chosen as a victim for a later one.
+        std::vector<LoadRun> runs;
+        bool run_open = false;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const page_id_t id = static_cast<page_id_t>(first + i);
+            const page_key_t key = page_key(file, id);
+            Shard &shard = *shards_[shard_ids[i]];
+            if (shard.page_table.count(key) != 0)
+            {
+                run_open = false;
+                continue;
+            }
+            std::size_t idx = 0;
+            try
+            {
+                idx = strategy ? obtain_ring_frame(shard, shard_ids[i], *strategy, owner, key, /*pin*/ true)
+                               : obtain_frame_for(shard, owner, key, /*pin*/ true);
+            }
+            catch (const DBException &)
+            {
+                break; // every frame is pinned; read-ahead is only a hint
+            }
+            if (!run_open)
+            {
+                runs.push_back(LoadRun{id, {}});
+                run_open = true;
+            }
+            runs.back().frames.push_back(idx);
+        }
+
+        // The synchronous fallback engine would split each run into single-page reads.
+        if (owner.async_io_backend() == AsyncIoBackend::IO_URING)
+        {
+            return load_runs_async(owner, runs, guards);
+        }
+
+        std::size_t loaded = 0;
+        std::size_t next_run = 0;
+        try
+        {
+            std::vector<uint8_t *> buffers;
+            for (; next_run < runs.size(); ++next_run)
+            {
+                const LoadRun &run = runs[next_run];
+                buffers.clear();
+                for (auto idx : run.frames)
+                {
+                    buffers.push_back(frame(idx).page->data());
+                }
+                owner.disk_read_pages(run.first, buffers.data(), buffers.size());
+                for (std::size_t k = 0; k < run.frames.size(); ++k)
+                {
+                    const std::size_t idx = run.frames[k];
+                    Shard &shard = shard_for(page_key(file, static_cast<page_id_t>(run.first + k)));
+                    auto &fr = frame(idx);
+                    fr.pin_count = 0;
+                    if (fr.ring == nullptr)
+                    {
+                        shard.policy->set_evictable(fr.slot, true);
+                    }
+                    shard.stats.prefetched++;
+                    ++loaded;
+                }
+            }
+        }
+        catch (const DBException &)
+        {
+            for (; next_run < runs.size(); ++next_run)
+            {
+                const LoadRun &run = runs[next_run];
+                for (std::size_t k = 0; k < run.frames.size(); ++k)
+                {
+                    discard_frame(shard_for(page_key(file, static_cast<page_id_t>(run.first + k))), run.frames[k]);
+                }
+            }
+            throw;
+        }
+        return loaded;
+    }
+
+    std::size_t BufferPool::load_runs_async(PageManager &owner, const std::vector<LoadRun> &runs,
+                                            std::vector<std::unique_lock<std::mutex>> &guards)
+    {
+        const file_id_t file = owner.file_id();
+        struct Pending
+        {
+            page_key_t key{0};
+            std::size_t frame{0};
+        };
+        std::vector<Pending> pending;
+        for (const auto &run : runs)
+        {
+            for (std::size_t k = 0; k < run.frames.size(); ++k)
+            {
+                pending.push_back(Pending{page_key(file, static_cast<page_id_t>(run.first + k)), run.frames[k]});
+            }
+        }
+
+        // Mark the claimed frames as loading under their io_latch and let go of the shards
+        // while the reads are in flight: a fetch of one of these pages waits for that page
+        // alone (await_load). Nothing takes a shard latch while holding an io_latch.
+        std::vector<std::unique_lock<std::mutex>> io_latches;
+        io_latches.reserve(pending.size());
+        for (const auto &p : pending)
+        {
+            auto &fr = frame(p.frame);
+            io_latches.emplace_back(fr.io_latch);
+            fr.loading = true;
+        }
+        for (auto &guard : guards)
+        {
+            guard.unlock();
+        }
+
+        std::size_t failed = 0;
+        {
+            std::lock_guard<std::mutex> io_guard(owner.io_mutex_);
+            AsyncIoEngine &engine = *owner.async_io_;
+            std::vector<IoCompletion> done;
+            auto collect = [&]()
+            {
+                for (const auto &c : done)
+                {
+                    const std::size_t i = static_cast<std::size_t>(c.user_data);
+                    if (c.ok())
+                        frame(pending[i].frame).loading = false;
+                    else
+                        ++failed; // left loading: a fetch reads it again, or it is dropped below
+                    io_latches[i].unlock();
+                }
+                done.clear();
+            };
+            for (std::size_t i = 0; i < pending.size(); ++i)
+            {
+                while (!engine.submit_read(page_of(pending[i].key), frame(pending[i].frame).page->data(), i))
+                {
+                    engine.poll(done, 1);
+                    collect();
+                }
+            }
+            engine.drain(done);
+            collect();
+        }
+
+        for (auto &guard : guards)
+        {
+            guard.lock();
+        }
+        std::size_t loaded = 0;
+        for (const auto &p : pending)
+        {
+            Shard &shard = shard_for(p.key);
+            auto &fr = frame(p.frame);
+            if (fr.key != p.key)
+                continue; // the file let go of its frames meanwhile
+            const bool failed_load = fr.loading;
+            if (failed_load && fr.pin_count == 1)
+            {
+                // Only this load pinned it: no fetch is reading the page itself.
+                discard_frame(shard, p.frame);
+                continue;
+            }
+            if (fr.pin_count.fetch_sub(1, std::memory_order_acq_rel) == 1 && fr.ring == nullptr)
+            {
+                shard.policy->set_evictable(fr.slot, true);
+            }
+            if (failed_load)
+                continue;
+            shard.stats.prefetched++;
+            ++loaded;
+        }
+        if (failed != 0)
+        {
+            KIZUNA_THROW_IO(StatusCode::READ_ERROR, "Asynchronous read-ahead failed", std::to_string(failed) + " page(s)");
+        }
+        return loaded;
+    }
+
+    void BufferPool::await_load(Frame &fr)
+    {
+        settle(fr);
+        if (fr.loading.load(std::memory_order_acquire))
+        {
+            fr.owner->disk_read(page_of(fr.key), fr.page->data());
+            fr.loading = false;
+        }
+    }
+
+    std::size_t BufferPool::prefetch_limit(const BufferAccessStrategy *strategy) const noexcept
+    {
+        // Keep the window well inside the frames it may occupy.
+        const std::size_t budget = strategy ? std::min(strategy->ring_size(), capacity() / 4) / 2 : capacity() / 4;
+        return std::max<std::size_t>(1, budget);
+    }
+
+    void BufferPool::unpin(PageManager &owner, page_id_t id, bool dirty)
+    {
+        const page_key_t key = page_key(owner.file_id(), id);
+        Shard &shard = shard_for(key);
+        std::lock_guard<std::mutex> guard(shard.latch);
+        auto it = shard.page_table.find(key);
+        if (it == shard.page_table.end())
+        {
+            KIZUNA_THROW_STORAGE(StatusCode::PAGE_NOT_FOUND, "Unpin unknown page", std::to_string(id));
+        }
+        auto &fr = frame(it->second);
+        if (fr.pin_count == 0)
+        {
+            KIZUNA_THROW_STORAGE(StatusCode::PAGE_LOCKED, "Unpin already unpinned", std::to_string(id));
+        }
+        if (dirty) fr.dirty = true;
+        if (fr.pin_count.fetch_sub(1, std::memory_order_acq_rel) == 1 && fr.ring == nullptr)
+        {
+            shard.policy->set_evictable(fr.slot, true);
+        }
+    }
+
+    void BufferPool::mark_dirty(PageManager &owner, page_id_t id)
+    {
+        const page_key_t key = page_key(owner.file_id(), id);
+        Shard &shard = shard_for(key);
+        std::lock_guard<std::mutex> guard(shard.latch);
+        auto it = shard.page_table.find(key);
+        if (it == shard.page_table.end())
+        {
+            KIZUNA_THROW_STORAGE(StatusCode::PAGE_NOT_FOUND, "Mark dirty unknown page", std::to_string(id));
+        }
+        frame(it->second).dirty = true;
+    }
+
+    void BufferPool::flush(PageManager &owner, page_id_t id)
+    {
+        const page_key_t key = page_key(owner.file_id(), id);
+        Shard &shard = shard_for(key);
+        std::lock_guard<std::mutex> guard(shard.latch);
+        auto it = shard.page_table.find(key);
+        if (it == shard.page_table.end())
+        {
+            // Not cached, nothing to do
+            return;
+        }
+        auto &fr = frame(it->second);
+        settle(fr);
+        if (fr.dirty)
+        {
+            write_frame(fr);
+        }
+    }
+
+    void BufferPool::flush_file(PageManager &owner)
+    {
+        for (auto &shard : shards_)
+        {
+            std::lock_guard<std::mutex> guard(shard->latch);
+            if (owner.async_io_enabled())
+            {
+                write_back_async(owner, *shard);
+                continue;
+            }
+            for (auto &kv : shard->page_table)
+            {
+                auto &fr = frame(kv.second);
+                if (fr.owner != &owner)
+                    continue;
+                settle(fr);
+                if (fr.dirty)
+                {
+                    write_frame(fr);
+                }
+            }
+        }
+    }
+
+    void BufferPool::write_back_async(PageManager &owner, Shard &shard)
+    {
+        // Caller holds the shard latch, so frames stay put until every write completes.
+        // Background writes settle before io_mutex_ is taken: write_behind() holds a
+        // frame's io_latch while disk_write() takes io_mutex_ on the fstream backend.
+        std::vector<std::size_t> dirty;
+        for (auto &kv : shard.page_table)
+        {
+            auto &fr = frame(kv.second);
+            if (fr.owner != &owner)
+                continue;
+            settle(fr);
+            if (fr.dirty)
+                dirty.push_back(kv.second);
+        }
+        if (dirty.empty())
+            return;
+
+        std::lock_guard<std::mutex> io_guard(owner.io_mutex_);
+        AsyncIoEngine &engine = *owner.async_io_;
+        std::vector<IoCompletion> done;
+        std::size_t failed = 0;
+        auto collect = [&]()
+        {
+            for (const auto &c : done)
+            {
+                if (!c.ok())
+                {
+                    ++failed;
+                    frame(static_cast<std::size_t>(c.user_data)).dirty = true;
+                }
+            }
+            done.clear();
+        };
+        for (auto idx : dirty)
+        {
+            auto &fr = frame(idx);
+            fr.dirty = false;
+            while (!engine.submit_write(page_of(fr.key), fr.page->data(), idx))
+            {
+                engine.poll(done, 1);
+                collect();
+            }
+        }
+        engine.drain(done);
+        collect();
+        if (failed != 0)
+        {
+            KIZUNA_THROW_IO(StatusCode::WRITE_ERROR, "Asynchronous write-back failed", std::to_string(failed) + " page(s)");
+        }
+    }
+
+    std::size_t BufferPool::write_back_cold(std::size_t max_pages)
+    {
+        std::vector<page_key_t> keys;
+        // Each shard gets its share of the budget, so the first shards cannot use it all up.
+        const std::size_t per_shard = std::max<std::size_t>(1, (max_pages + shards_.size() - 1) / shards_.size());
+        for (auto &shard : shards_)
+        {
+            if (keys.size() >= max_pages)
+                break;
+            std::lock_guard<std::mutex> guard(shard->latch);
+            // Look a quarter of the shard ahead of the eviction point.
+            const std::size_t lookahead = std::max<std::size_t>(1, shard->frames.size() / config::BGWRITER_LOOKAHEAD_DIVISOR);
+            std::size_t taken = 0;
+            for (auto slot : shard->policy->coldest(lookahead))
+            {
+                if (taken >= per_shard || keys.size() >= max_pages)
+                    break;
+                const auto &fr = frame(shard->frames[slot]);
+                if (fr.dirty && fr.key != 0)
+                {
+                    keys.push_back(fr.key);
+                    ++taken;
+                }
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        return write_behind(keys, /*unpinned_only*/ true, &BufferPoolStats::background_writes);
+    }
+
+    std::size_t BufferPool::checkpoint()
+    {
+        std::vector<page_key_t> keys;
+        for (auto &shard : shards_)
+        {
+            std::lock_guard<std::mutex> guard(shard->latch);
+            for (const auto &kv : shard->page_table)
+            {
+                if (frame(kv.second).dirty)
+                    keys.push_back(kv.first);
+            }
+        }
+        // Keys order by file, then page id, so each file is written front to back.
+        std::sort(keys.begin(), keys.end());
+        const std::size_t written = write_behind(keys, /*unpinned_only*/ false, &BufferPoolStats::checkpoint_writes);
+
+        // Unregistering a file takes the registry latch, so no file closes mid-sync.
+        {
+            std::lock_guard<std::mutex> guard(registry_mutex_);
+            for (auto *file : files_)
+            {
+                std::lock_guard<std::mutex> io_guard(file->io_mutex_);
+                file->fm_.sync();
+            }
+        }
+        checkpoints_.fetch_add(1, std::memory_order_relaxed);
+        return written;
+    }
+
+    std::size_t BufferPool::write_behind(const std::vector<page_key_t> &keys, bool unpinned_only,
+                                         uint64_t BufferPoolStats::*counter)
+    {
+        Page buffer;
+        std::size_t written = 0;
+        for (auto key : keys)
+        {
+            Shard &shard = shard_for(key);
+            std::unique_lock<std::mutex> guard(shard.latch);
+            auto it = shard.page_table.find(key);
+            if (it == shard.page_table.end())
+                continue;
+            auto &fr = frame(it->second);
+            if (!fr.dirty || (unpinned_only && fr.pin_count != 0))
+                continue;
+            // Take the frame's I/O latch before letting go of the shard: eviction and ring
+            // reuse pass the frame over while it is held, and whoever needs this very
+            // page (flush, unregister_file) waits on it instead of racing the write.
+            std::unique_lock<std::mutex> io(fr.io_latch);
+            std::memcpy(buffer.data(), fr.page->data(), config::PAGE_SIZE);
+            fr.dirty = false;
+            PageManager &owner = *fr.owner;
+            guard.unlock();
+            std::exception_ptr failure;
+            try
+            {
+                owner.disk_write(page_of(key), buffer.data());
+            }
+            catch (const DBException &)
+            {
+                failure = std::current_exception();
+            }
+            io.unlock(); // never take a shard latch while holding an io_latch
+            guard.lock();
+            if (failure)
+            {
+                // Look the page up again: a resize may have moved it meanwhile.
+                auto again = shard.page_table.find(key);
+                if (again != shard.page_table.end())
+                    frame(again->second).dirty = true;
+                std::rethrow_exception(failure);
+            }
+            (shard.stats.*counter)++;
+            ++written;
+        }
+        return written;
+    }
+
+    std::size_t BufferPool::resident_pages(const PageManager &owner)
+    {
+        std::size_t count = 0;
+        for (auto &shard : shards_)
+        {
+            std::lock_guard<std::mutex> guard(shard->latch);
+            for (const auto &kv : shard->page_table)
+            {
+                if (frame(kv.second).owner == &owner)
+                    ++count;
+            }
+        }
+        return count;
+    }
+
+    std::size_t BufferPool::shard_of(const PageManager &owner, page_id_t id) const
+    {
+        return shard_index(page_key(owner.file_id(), id));
+    }
+
+    std::size_t BufferPool::shard_index(page_key_t key) const
+    {
+        if (shards_.size() == 1)
+        {
+            return 0;
+        }
+        // Fibonacci hashing spreads sequential page ids (and files) across shards.
+        const uint64_t h = (key ^ (key >> 29)) * 0x9E3779B97F4A7C15ull;
+        return static_cast<std::size_t>(h >> 32) % shards_.size();
+    }
+
+    void BufferPool::write_frame(Frame &fr)
+    {
+        fr.owner->disk_write(page_of(fr.key), fr.page->data());
+        fr.dirty = false;
+    }
+
+    std::size_t BufferPool::evict_frame(Shard &shard)
+    {
+        // Pass over victims whose background write is still in flight instead of waiting
+        // for it under the shard latch; they rejoin the policy once a victim is found.
+        // Only when every candidate is busy does eviction wait, for the coldest one.
+        std::vector<std::size_t> busy;
+        std::unique_lock<std::mutex> io;
+        std::size_t idx = 0;
+        for (;;)
+        {
+            const auto victim = shard.policy->evict();
+            if (!victim)
+            {
+                if (busy.empty())
+                {
+                    KIZUNA_THROW_STORAGE(StatusCode::CACHE_FULL, "No unpinned pages to evict", "");
+                }
+                idx = busy.front();
+                busy.erase(busy.begin());
+                io = std::unique_lock<std::mutex>(frame(idx).io_latch);
+                break;
+            }
+            idx = shard.frames[*victim];
+            io = std::unique_lock<std::mutex>(frame(idx).io_latch, std::try_to_lock);
+            if (io.owns_lock())
+                break;
+            busy.push_back(idx);
+        }
+        for (auto skipped : busy)
+        {
+            auto &other = frame(skipped);
+            shard.policy->record_load(other.slot, other.key);
+            shard.policy->set_evictable(other.slot, true);
+        }
+        auto &fr = frame(idx);
+        if (fr.pin_count != 0)
+        {
+            KIZUNA_THROW_STORAGE(StatusCode::INTERNAL_ERROR, "Evicting pinned page", std::to_string(page_of(fr.key)));
+        }
+        if (fr.dirty)
+        {
+            write_frame(fr);
+            shard.stats.foreground_writes++;
+        }
+        shard.page_table.erase(fr.key);
+        shard.stats.evictions++;
+        fr.key = 0;
+        fr.owner = nullptr;
+        return idx;
+    }
+
+    std::size_t BufferPool::take_frame(Shard &shard)
+    {
+        if (!shard.free_frames.empty())
+        {
+            const std::size_t idx = shard.free_frames.back();
+            shard.free_frames.pop_back();
+            return idx;
+        }
+        return evict_frame(shard);
+    }
+
+    std::size_t BufferPool::obtain_frame_for(Shard &shard, PageManager &owner, page_key_t key, bool pin)
+    {
+        const std::size_t idx = take_frame(shard);
+        auto &fr = frame(idx);
+        fr.key = key;
+        fr.owner = &owner;
+        fr.dirty = false;
+        fr.pin_count = pin ? 1 : 0;
+        fr.ring = nullptr;
+        shard.policy->record_load(fr.slot, key);
+        shard.policy->set_evictable(fr.slot, !pin);
+        shard.page_table[key] = idx;
+        return idx;
+    }
+
+    std::size_t BufferPool::obtain_ring_frame(Shard &shard, std::size_t shard_idx, BufferAccessStrategy &ring,
+                                              PageManager &owner, page_key_t key, bool pin)
+    {
+        if (ring.shard_rings_.size() != shards_.size())
+        {
+            ring.shard_rings_.resize(shards_.size());
+        }
+        auto &slots = ring.shard_rings_[shard_idx];
+        // Spread the ring over shards, but never let it take more than a quarter of a shard.
+        const std::size_t per_shard = (ring.ring_size_ + shards_.size() - 1) / shards_.size();
+        const std::size_t limit = std::max<std::size_t>(1, std::min(per_shard, shard.frames.size() / 4));
+
+        std::size_t idx = 0;
+        if (slots.frames.size() < limit)
+        {
+            idx = take_frame(shard);
+            slots.frames.push_back(idx);
+        }
+        else
+        {
+            std::size_t &slot = slots.frames[slots.cursor];
+            auto &candidate = frame(slot);
+            std::unique_lock<std::mutex> io(candidate.io_latch, std::defer_lock);
+            if (candidate.ring == &ring && owns(shard, slot) && candidate.pin_count == 0 && io.try_lock())
+            {
+                if (candidate.dirty)
+                {
+                    write_frame(candidate);
+                    shard.stats.foreground_writes++;
+                }
+                if (candidate.key != 0)
+                {
+                    shard.page_table.erase(candidate.key);
+                }
+                shard.stats.ring_reuses++;
+                idx = slot;
+            }
+            else
+            {
+                // Slot was adopted by the shared pool, is still pinned or has I/O in flight; replace it.
+                if (candidate.ring == &ring && owns(shard, slot))
+                {
+                    adopt_into_policy(shard, slot);
+                }
+                idx = take_frame(shard);
+                slot = idx;
+            }
+            slots.cursor = (slots.cursor + 1) % slots.frames.size();
+        }
+
+        auto &fr = frame(idx);
+        fr.key = key;
+        fr.owner = &owner;
+        fr.dirty = false;
+        fr.pin_count = pin ? 1 : 0;
+        fr.ring = &ring;
+        shard.page_table[key] = idx;
+        return idx;
+    }
+
+    void BufferPool::discard_frame(Shard &shard, std::size_t idx)
+    {
+        auto &fr = frame(idx);
+        shard.page_table.erase(fr.key);
+        fr.key = 0;
+        fr.owner = nullptr;
+        fr.pin_count = 0;
+        fr.dirty = false;
+        fr.loading = false;
+        if (fr.ring == nullptr)
+        {
+            shard.policy->remove(fr.slot);
+            shard.free_frames.push_back(idx);
+        }
+        // ring frames stay in their ring and are reused or released with it
+    }
+
+    void BufferPool::adopt_into_policy(Shard &shard, std::size_t idx)
+    {
+        auto &fr = frame(idx);
+        fr.ring = nullptr;
+        if (fr.key == 0)
+        {
+            shard.free_frames.push_back(idx);
+            return;
+        }
+        shard.policy->record_load(fr.slot, fr.key);
+        shard.policy->set_evictable(fr.slot, fr.pin_count == 0);
+    }
+
+    void BufferPool::release_strategy(BufferAccessStrategy &ring)
+    {
+        for (std::size_t s = 0; s < ring.shard_rings_.size() && s < shards_.size(); ++s)
+        {
+            Shard &shard = *shards_[s];
+            std::lock_guard<std::mutex> guard(shard.latch);
+            for (auto idx : ring.shard_rings_[s].frames)
+            {
+                auto &fr = frame(idx);
+                if (fr.ring != &ring || !owns(shard, idx))
+                    continue;
+                if (fr.pin_count != 0)
+                {
+                    adopt_into_policy(shard, idx);
+                    continue;
+                }
+                // Hand clean frames back to the free list so the scan leaves no trace.
+                settle(fr);
+                if (fr.dirty)
+                {
+                    write_frame(fr);
+                }
+                if (fr.key != 0)
+                {
+                    shard.page_table.erase(fr.key);
+                }
+                fr.key = 0;
+                fr.owner = nullptr;
+                fr.ring = nullptr;
+                shard.free_frames.push_back(idx);
+            }
+            ring.shard_rings_[s] = BufferAccessStrategy::ShardRing{};
+        }
+    }
+
+    std::size_t BufferPool::resize(std::size_t capacity)
+    {
+        std::lock_guard<std::mutex> resize_guard(resize_mutex_);
+        capacity = std::max(capacity, shards_.size());
+        // Frame ownership moves between shards and chunks, so stop the whole pool. Shard
+        // latches are taken in index order, like load_range.
+        std::vector<std::unique_lock<std::mutex>> guards;
+        guards.reserve(shards_.size());
+        for (auto &shard : shards_)
+        {
+            guards.emplace_back(shard->latch);
+        }
+
+        std::size_t missing = 0;
+        for (std::size_t s = 0; s < shards_.size(); ++s)
+        {
+            const std::size_t target = shard_target(capacity, shards_.size(), s);
+            Shard &shard = *shards_[s];
+            if (shard.frames.size() > target)
+                shrink_shard(shard, target);
+            else
+                missing += target - shard.frames.size();
+        }
+        if (missing != 0)
+        {
+            const std::vector<std::size_t> added = add_frames(missing);
+            std::size_t next = 0;
+            for (std::size_t s = 0; s < shards_.size(); ++s)
+            {
+                Shard &shard = *shards_[s];
+                const std::size_t target = shard_target(capacity, shards_.size(), s);
+                if (shard.frames.size() >= target)
+                    continue;
+                const std::size_t take = target - shard.frames.size();
+                grow_shard(shard, std::vector<std::size_t>(added.begin() + next, added.begin() + next + take));
+                next += take;
+            }
+        }
+        for (auto &chunk : chunks_)
+        {
+            if (chunk->live == 0)
+                unmap_chunk(*chunk);
+        }
+
+        std::size_t total = 0;
+        for (auto &shard : shards_)
+        {
+            total += shard->frames.size();
+        }
+        capacity_.store(total, std::memory_order_relaxed);
+        return total;
+    }
+
+    std::size_t BufferPool::set_memory_budget(std::size_t bytes)
+    {
+        return resize(frames_for_budget(bytes)) * config::PAGE_SIZE;
+    }
+
+    std::size_t BufferPool::mapped_bytes() const
+    {
+        std::lock_guard<std::mutex> guard(resize_mutex_);
+        std::size_t bytes = 0;
+        for (const auto &chunk : chunks_)
+        {
+            bytes += chunk->arena_bytes;
+        }
+        return bytes;
+    }
+
+    std::size_t BufferPool::huge_page_bytes() const
+    {
+        std::lock_guard<std::mutex> guard(resize_mutex_);
+        std::size_t bytes = 0;
+        for (const auto &chunk : chunks_)
+        {
+            if (chunk->huge_pages)
+                bytes += chunk->arena_bytes;
+        }
+        return bytes;
+    }
+
+    bool BufferPool::owns(const Shard &shard, std::size_t idx)
+    {
+        const auto &fr = frame(idx);
+        return fr.active && fr.slot < shard.frames.size() && shard.frames[fr.slot] == idx;
+    }
+
+    std::vector<std::size_t> BufferPool::add_frames(std::size_t count)
+    {
+        constexpr std::size_t per_chunk = config::BUFFER_POOL_CHUNK_FRAMES;
+        std::vector<std::size_t> added;
+        added.reserve(count);
+        auto activate = [&](Chunk &chunk, std::size_t c, std::size_t i)
+        {
+            Frame &fr = chunk.frames[i];
+            fr.active = true;
+            fr.key = 0;
+            fr.owner = nullptr;
+            fr.ring = nullptr;
+            fr.dirty = false;
+            fr.pin_count = 0;
+            ++chunk.live;
+            added.push_back(c * per_chunk + i);
+        };
+        // Reuse retired frames whose buffers are still mapped, then re-map emptied
+        // chunks, and only then map new ones.
+        for (std::size_t c = 0; c < chunks_.size() && added.size() < count; ++c)
+        {
+            Chunk &chunk = *chunks_[c];
+            for (std::size_t i = 0; i < chunk.frame_count && added.size() < count; ++i)
+            {
+                if (!chunk.frames[i].active)
+                    activate(chunk, c, i);
+            }
+        }
+        for (std::size_t c = 0; c < chunks_.size() && added.size() < count; ++c)
+        {
+            Chunk &chunk = *chunks_[c];
+            if (chunk.arena != nullptr)
+                continue;
+            map_chunk(chunk, std::min(per_chunk, count - added.size()));
+            for (std::size_t i = 0; i < chunk.frame_count; ++i)
+                activate(chunk, c, i);
+        }
+        while (added.size() < count)
+        {
+            auto chunk = std::make_unique<Chunk>();
+            chunk->frames = std::make_unique<Frame[]>(per_chunk);
+            map_chunk(*chunk, std::min(per_chunk, count - added.size()));
+            chunks_.push_back(std::move(chunk));
+            Chunk &mapped = *chunks_.back();
+            for (std::size_t i = 0; i < mapped.frame_count; ++i)
+                activate(mapped, chunks_.size() - 1, i);
+        }
+        return added;
+    }
+
+    void BufferPool::map_chunk(Chunk &chunk, std::size_t frame_count)
+    {
+        const std::size_t bytes = frame_count * config::PAGE_SIZE;
+        void *arena = nullptr;
+        bool huge = false;
+#if KIZUNA_HAS_POSIX_IO
+#ifdef MAP_HUGETLB
+        if (bytes % kHugePageBytes == 0)
+        {
+            arena = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            huge = arena != MAP_FAILED;
+            if (!huge)
+                arena = nullptr;
+        }
+#endif
+        if (arena == nullptr)
+        {
+            arena = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (arena == MAP_FAILED)
+            {
+                KIZUNA_THROW_STORAGE(StatusCode::OUT_OF_MEMORY, "Cannot map buffer pool chunk", std::to_string(bytes));
+            }
+#ifdef MADV_HUGEPAGE
+            // No reserved huge pages: let transparent huge pages back the arena if enabled.
+            if (bytes >= kHugePageBytes)
+                ::madvise(arena, bytes, MADV_HUGEPAGE);
+#endif
+        }
+#else
+        try
+        {
+            arena = ::operator new(bytes, std::align_val_t{kHugePageBytes});
+        }
+        catch (const std::bad_alloc &)
+        {
+            KIZUNA_THROW_STORAGE(StatusCode::OUT_OF_MEMORY, "Cannot allocate buffer pool chunk", std::to_string(bytes));
+        }
+#endif
+        chunk.arena = arena;
+        chunk.arena_bytes = bytes;
+        chunk.frame_count = frame_count;
+        chunk.huge_pages = huge;
+        auto *pages = static_cast<uint8_t *>(arena);
+        for (std::size_t i = 0; i < frame_count; ++i)
+        {
+            chunk.frames[i].page = new (pages + i * config::PAGE_SIZE) Page();
+        }
+    }
+
+    void BufferPool::unmap_chunk(Chunk &chunk)
+    {
+        if (chunk.arena == nullptr)
+            return;
+        for (std::size_t i = 0; i < chunk.frame_count; ++i)
+        {
+            chunk.frames[i].page = nullptr;
+        }
+#if KIZUNA_HAS_POSIX_IO
+        ::munmap(chunk.arena, chunk.arena_bytes);
+#else
+        ::operator delete(chunk.arena, std::align_val_t{kHugePageBytes});
+#endif
+        chunk.arena = nullptr;
+        chunk.arena_bytes = 0;
+        chunk.frame_count = 0;
+        chunk.huge_pages = false;
+    }
+
+    std::vector<std::size_t> BufferPool::drain_policy(Shard &shard)
+    {
+        // Evicting everything evictable yields the frames coldest first; the caller
+        // rebuilds the policy from that order. Pinned and ring frames are not returned.
+        std::vector<std::size_t> order;
+        while (auto slot = shard.policy->evict())
+        {
+            order.push_back(shard.frames[*slot]);
+        }
+        return order;
+    }
+
+    void BufferPool::rebuild_shard(Shard &shard, const std::vector<std::size_t> &cold_to_hot)
+    {
+        // Recency order survives a resize; policy-specific history (2Q queue membership
+        // and ghosts, CLOCK reference bits) starts over.
+        shard.policy = make_replacement_policy(policy_kind_, 0, shard.frames.size());
+        for (std::size_t slot = 0; slot < shard.frames.size(); ++slot)
+        {
+            auto &fr = frame(shard.frames[slot]);
+            fr.slot = slot;
+            if (fr.key != 0 && fr.ring == nullptr && fr.pin_count != 0)
+            {
+                shard.policy->record_load(slot, fr.key);
+                shard.policy->set_evictable(slot, false);
+            }
+        }
+        for (auto idx : cold_to_hot)
+        {
+            auto &fr = frame(idx);
+            shard.policy->record_load(fr.slot, fr.key);
+            shard.policy->set_evictable(fr.slot, true);
+        }
+    }
+
+    void BufferPool::grow_shard(Shard &shard, const std::vector<std::size_t> &added)
+    {
+        const std::vector<std::size_t> order = drain_policy(shard);
+        shard.frames.insert(shard.frames.end(), added.begin(), added.end());
+        // Push in reverse so the lowest frame index is handed out first.
+        for (auto it = added.rbegin(); it != added.rend(); ++it)
+        {
+            shard.free_frames.push_back(*it);
+        }
+        shard.page_table.reserve(shard.frames.size());
+        rebuild_shard(shard, order);
+    }
+
+    void BufferPool::shrink_shard(Shard &shard, std::size_t target)
+    {
+        for (auto idx : shard.frames)
+        {
+            settle(frame(idx));
+        }
+        std::vector<std::size_t> order = drain_policy(shard);
+
+        // Ring pages belong to scans that can reload them; hand idle ring frames back.
+        for (auto idx : shard.frames)
+        {
+            auto &fr = frame(idx);
+            if (fr.ring == nullptr || fr.pin_count != 0)
+                continue;
+            if (fr.dirty)
+                write_frame(fr);
+            if (fr.key != 0)
+                shard.page_table.erase(fr.key);
+            fr.key = 0;
+            fr.owner = nullptr;
+            fr.ring = nullptr;
+        }
+
+        // Drop the coldest pages until the rest fit in the target.
+        std::size_t dropped = 0;
+        while (shard.page_table.size() > target && dropped < order.size())
+        {
+            auto &fr = frame(order[dropped++]);
+            if (fr.dirty)
+                write_frame(fr);
+            shard.page_table.erase(fr.key);
+            shard.stats.evictions++;
+            fr.key = 0;
+            fr.owner = nullptr;
+        }
+        order.erase(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(dropped));
+
+        // Keep pinned frames where they are (their pages are in use) and otherwise the
+        // lowest frame indices, so retiring frees whole chunks at the top of the arena.
+        std::vector<std::size_t> by_index = shard.frames;
+        std::sort(by_index.begin(), by_index.end());
+        std::vector<std::size_t> keep;
+        std::vector<std::size_t> retire;
+        std::size_t pinned = 0;
+        for (auto idx : by_index)
+        {
+            if (frame(idx).pin_count != 0)
+                ++pinned;
+        }
+        std::size_t unpinned_slots = target > pinned ? target - pinned : 0;
+        for (auto idx : by_index)
+        {
+            if (frame(idx).pin_count != 0)
+            {
+                keep.push_back(idx);
+            }
+            else if (unpinned_slots != 0)
+            {
+                keep.push_back(idx);
+                --unpinned_slots;
+            }
+            else
+            {
+                retire.push_back(idx);
+            }
+        }
+
+        // Move resident pages out of retiring frames into free kept ones.
+        std::unordered_map<std::size_t, std::size_t> moved;
+        std::vector<std::size_t> vacant;
+        for (auto it = keep.rbegin(); it != keep.rend(); ++it)
+        {
+            if (frame(*it).key == 0)
+                vacant.push_back(*it);
+        }
+        for (auto idx : retire)
+        {
+            auto &from = frame(idx);
+            if (from.key != 0)
+            {
+                const std::size_t dst = vacant.back();
+                vacant.pop_back();
+                auto &to = frame(dst);
+                std::memcpy(to.page->data(), from.page->data(), config::PAGE_SIZE);
+                to.key = from.key;
+                to.owner = from.owner;
+                to.dirty = from.dirty.load();
+                to.pin_count = 0;
+                to.ring = nullptr;
+                shard.page_table[to.key] = dst;
+                moved[idx] = dst;
+            }
+            from.key = 0;
+            from.owner = nullptr;
+            from.dirty = false;
+            from.ring = nullptr;
+            from.active = false;
+            --chunks_[idx / config::BUFFER_POOL_CHUNK_FRAMES]->live;
+        }
+        // Retired frames of chunks that stay mapped give their memory back, a run at a time.
+        for (std::size_t r = 0; r < retire.size();)
+        {
+            Chunk &chunk = *chunks_[retire[r] / config::BUFFER_POOL_CHUNK_FRAMES];
+            std::size_t end = r + 1;
+            while (end < retire.size() && retire[end] == retire[end - 1] + 1 &&
+                   retire[end] / config::BUFFER_POOL_CHUNK_FRAMES == retire[r] / config::BUFFER_POOL_CHUNK_FRAMES)
+                ++end;
+            if (chunk.live != 0 && !chunk.huge_pages)
+                release_pages(frame(retire[r]).page, end - r);
+            r = end;
+        }
+
+        for (auto &idx : order)
+        {
+            auto it = moved.find(idx);
+            if (it != moved.end())
+                idx = it->second;
+        }
+
+        shard.frames = std::move(keep);
+        shard.free_frames.clear();
+        for (auto it = shard.frames.rbegin(); it != shard.frames.rend(); ++it)
+        {
+            const auto &fr = frame(*it);
+            if (fr.key == 0 && fr.ring == nullptr)
+                shard.free_frames.push_back(*it);
+        }
+        rebuild_shard(shard, order);
+    }
+
+    BufferAccessStrategy::BufferAccessStrategy(BufferPool &pool, std::size_t ring_size)
+        : pool_(pool), ring_size_(ring_size ? ring_size : 1)
+    {
+    }
+
+    BufferAccessStrategy::BufferAccessStrategy(PageManager &pm, std::size_t ring_size)
+        : BufferAccessStrategy(pm.pool(), ring_size)
+    {
+    }
+
+    BufferAccessStrategy::~BufferAccessStrategy()
+    {
+        try { pool_.release_strategy(*this); } catch (...) { /* best-effort */ }
+    }
+
+    BufferPoolStats BufferPool::stats()
+    {
+        BufferPoolStats total;
+        for (auto &shard : shards_)
+        {
+            std::lock_guard<std::mutex> guard(shard->latch);
+            total.hits += shard->stats.hits;
+            total.misses += shard->stats.misses;
+            total.evictions += shard->stats.evictions;
+            total.ring_reuses += shard->stats.ring_reuses;
+            total.prefetched += shard->stats.prefetched;
+            total.foreground_writes += shard->stats.foreground_writes;
+            total.background_writes += shard->stats.background_writes;
+            total.checkpoint_writes += shard->stats.checkpoint_writes;
+        }
+        total.checkpoints = checkpoints_.load(std::memory_order_relaxed);
+        return total;
+    }
+
+    void BufferPool::reset_stats()
+    {
+        for (auto &shard : shards_)
+        {
+            std::lock_guard<std::mutex> guard(shard->latch);
+            shard->stats = BufferPoolStats{};
+        }
+        checkpoints_.store(0, std::memory_order_relaxed);
+    }
+}
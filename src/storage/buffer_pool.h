@@ -0,0 +1,261 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/config.h"
+#include "common/exception.h"
+#include "common/types.h"
+#include "storage/page.h"
+#include "storage/replacement_policy.h"
+
+namespace kizuna
+{
+    // Cache counters, aggregated over all shards.
+    struct BufferPoolStats
+    {
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t evictions{0};
+        uint64_t ring_reuses{0}; // frames recycled inside a BufferAccessStrategy ring
+        uint64_t prefetched{0};  // pages loaded ahead of use by prefetch()
+        uint64_t foreground_writes{0};  // dirty victims a query thread had to write before reuse
+        uint64_t background_writes{0};  // cold dirty pages cleaned by write_back_cold()
+        uint64_t checkpoint_writes{0};  // pages written by checkpoint()
+        uint64_t checkpoints{0};        // checkpoint() calls, counted by the pool rather than a shard
+
+        double hit_ratio() const noexcept
+        {
+            const uint64_t total = hits + misses;
+            return total == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(total);
+        }
+    };
+
+    class BufferPool;
+    class PageManager;
+
+    // Per-query access strategy handle (like PostgreSQL's BAS_BULKREAD). Pages that miss
+    // the cache while fetched through a strategy are loaded into a small private ring of
+    // frames that is recycled in place, so a large sequential scan cannot flush the shared
+    // cache. A ring page that is later fetched without the strategy joins the shared pool.
+    // Single-threaded: one strategy belongs to one scan. Must not outlive its pool.
+    class BufferAccessStrategy
+    {
+    public:
+        explicit BufferAccessStrategy(BufferPool &pool, std::size_t ring_size = config::BULKREAD_RING_SIZE);
+        explicit BufferAccessStrategy(PageManager &pm, std::size_t ring_size = config::BULKREAD_RING_SIZE);
+        ~BufferAccessStrategy();
+
+        BufferAccessStrategy(const BufferAccessStrategy &) = delete;
+        BufferAccessStrategy &operator=(const BufferAccessStrategy &) = delete;
+
+        std::size_t ring_size() const noexcept { return ring_size_; }
+
+    private:
+        struct ShardRing
+        {
+            std::vector<std::size_t> frames;
+            std::size_t cursor{0};
+        };
+
+        BufferPool &pool_;
+        std::size_t ring_size_;
+        std::vector<ShardRing> shard_rings_;
+
+        friend class BufferPool;
+    };
+
+    // Frame arena shared by every file registered with it. Pages are keyed by
+    // (file_id, page_id), so table and index files compete for the same frames under
+    // one budget instead of each holding a private cache. Eviction is pluggable (LRU by
+    // default); the page table and replacement state are hash-partitioned into shards,
+    // each guarded by its own latch. A PageManager registers its file on construction
+    // and routes all cached access through here; disk I/O goes back through the
+    // PageManager that owns the frame's file.
+    //
+    // Page buffers live in chunks of BUFFER_POOL_CHUNK_FRAMES frames, each mapped as one
+    // aligned region (huge pages where the OS provides them). resize() grows the pool
+    // by mapping chunks and shrinks it by evicting the coldest pages and unmapping
+    // chunks that empty out; pinned pages never move, so a shrink stops short rather
+    // than wait for them.
+    class BufferPool
+    {
+    public:
+        explicit BufferPool(std::size_t capacity = config::DEFAULT_CACHE_SIZE,
+                            std::size_t shard_count = config::BUFFER_POOL_DEFAULT_SHARDS,
+                            ReplacementPolicyKind policy = ReplacementPolicyKind::LRU);
+        ~BufferPool();
+
+        BufferPool(const BufferPool &) = delete;
+        BufferPool &operator=(const BufferPool &) = delete;
+
+        static page_key_t page_key(file_id_t file, page_id_t page) noexcept
+        {
+            return (static_cast<page_key_t>(file) << 32) | page;
+        }
+        // Frames a memory budget pays for (at least one per shard is kept regardless).
+        static std::size_t frames_for_budget(std::size_t bytes) noexcept
+        {
+            return std::max<std::size_t>(1, bytes / config::PAGE_SIZE);
+        }
+
+        // Assigns the file an id for page keys. Unregistering writes back the file's
+        // dirty pages and releases its frames.
+        file_id_t register_file(PageManager &owner);
+        void unregister_file(PageManager &owner);
+        std::size_t file_count() const;
+
+        // Cache-side halves of the PageManager operations of the same names.
+        Page &fetch(PageManager &owner, page_id_t id, bool pin, BufferAccessStrategy *strategy);
+        // Caches a freshly allocated page initialized to `type` and writes it through.
+        void create_page(PageManager &owner, page_id_t id, PageType type);
+        // Loads the uncached pages of [first, first + count), one request per run of misses.
+        // When the owner's async I/O runs on io_uring the reads are queued to its
+        // AsyncIoEngine instead, and the shards are released while they are in flight.
+        std::size_t load_range(PageManager &owner, page_id_t first, std::size_t count, BufferAccessStrategy *strategy);
+        std::size_t prefetch_limit(const BufferAccessStrategy *strategy = nullptr) const noexcept;
+        void unpin(PageManager &owner, page_id_t id, bool dirty);
+        void mark_dirty(PageManager &owner, page_id_t id);
+        void flush(PageManager &owner, page_id_t id);
+        void flush_file(PageManager &owner);
+
+        // Background writing (see BackgroundWriter). Pages are copied out under the shard
+        // latch and written without it, so queries keep running while the write is in
+        // flight; only a query that needs that very frame back waits for it.
+        //
+        // Writes up to `max_pages` dirty pages from the cold end of the shards' policies
+        // (the next victims), in page order; each shard gets an even share of the
+        // budget. Returns the pages written.
+        std::size_t write_back_cold(std::size_t max_pages);
+        // Writes every dirty page of every file in (file, page id) order, then syncs the
+        // files. Pinned pages are written as they are, like flush_all(). Returns the
+        // pages written.
+        std::size_t checkpoint();
+
+        // Grows or shrinks the pool to `capacity` frames while it is in use and returns
+        // the capacity reached. Shrinking writes back and drops the coldest pages first;
+        // it keeps frames that are pinned, so it may end above the target.
+        std::size_t resize(std::size_t capacity);
+        // resize() to what `bytes` of page buffers pays for; returns the bytes in use.
+        std::size_t set_memory_budget(std::size_t bytes);
+
+        std::size_t capacity() const noexcept { return capacity_.load(std::memory_order_relaxed); }
+        std::size_t memory_bytes() const noexcept { return capacity() * config::PAGE_SIZE; }
+        // Bytes of page buffers currently mapped, and how many of them are huge pages.
+        std::size_t mapped_bytes() const;
+        std::size_t huge_page_bytes() const;
+        std::size_t shard_count() const noexcept { return shards_.size(); }
+        // Shard whose latch and frames serve the page.
+        std::size_t shard_of(const PageManager &owner, page_id_t id) const;
+        ReplacementPolicyKind policy() const noexcept { return policy_kind_; }
+        // Pages of the file currently cached.
+        std::size_t resident_pages(const PageManager &owner);
+        BufferPoolStats stats();
+        void reset_stats();
+
+    private:
+        struct Frame
+        {
+            page_key_t key{0}; // 0 = unused
+            PageManager *owner{nullptr};
+            Page *page{nullptr}; // buffer in the chunk arena; null once the chunk is unmapped
+            std::atomic<bool> dirty{false};
+            std::atomic<uint32_t> pin_count{0};
+            BufferAccessStrategy *ring{nullptr}; // owning ring; such frames bypass the policy
+            std::size_t slot{0};                 // index in its shard's frame list and policy
+            bool active{false};                  // counted in capacity and owned by a shard
+            std::atomic<bool> loading{false};    // an asynchronous read is filling (or failed to fill) the page
+            std::mutex io_latch;                 // held while a background write or asynchronous read is in flight
+        };
+
+        // Frame descriptors outlive their buffers: an unmapped chunk keeps its (retired)
+        // descriptors so a stale frame index held by a ring is still safe to inspect.
+        struct Chunk
+        {
+            std::unique_ptr<Frame[]> frames;
+            void *arena{nullptr};
+            std::size_t arena_bytes{0};
+            std::size_t frame_count{0}; // frames backed by the arena
+            std::size_t live{0};        // active frames
+            bool huge_pages{false};
+        };
+
+        // One partition of the page table, owning the frames listed in `frames`.
+        struct Shard
+        {
+            std::mutex latch;
+            std::unordered_map<page_key_t, std::size_t> page_table; // key -> frame index
+            std::vector<std::size_t> frames;                        // slot -> frame index
+            std::unique_ptr<ReplacementPolicy> policy;              // victim selection over slots
+            std::vector<std::size_t> free_frames;                   // unused frame indices (stack)
+            BufferPoolStats stats;
+        };
+
+        ReplacementPolicyKind policy_kind_;
+        std::atomic<std::size_t> capacity_{0};
+        std::vector<std::unique_ptr<Chunk>> chunks_; // guarded by every shard latch
+        std::vector<std::unique_ptr<Shard>> shards_;
+        mutable std::mutex resize_mutex_;
+        mutable std::mutex registry_mutex_;
+        std::unordered_set<PageManager *> files_;
+        file_id_t next_file_id_{1};
+        std::atomic<uint64_t> checkpoints_{0};
+
+        Frame &frame(std::size_t idx)
+        {
+            return chunks_[idx / config::BUFFER_POOL_CHUNK_FRAMES]->frames[idx % config::BUFFER_POOL_CHUNK_FRAMES];
+        }
+        // Whether the frame is currently one of the shard's (ring indices can go stale).
+        bool owns(const Shard &shard, std::size_t idx);
+        std::size_t shard_index(page_key_t key) const;
+        Shard &shard_for(page_key_t key) { return *shards_[shard_index(key)]; }
+        // The following require the shard latch to be held.
+        void write_frame(Frame &fr);
+        // Waits for a background write or asynchronous read of the frame to land; `dirty`
+        // and `loading` are exact afterwards. Needed before a page is dropped, rewritten or flushed.
+        static void settle(Frame &fr) { std::lock_guard<std::mutex> io(fr.io_latch); }
+        // Makes a frame that load_range() claimed readable: waits for its read and, if
+        // that read failed, reads the page synchronously. Called with the frame pinned
+        // and the shard latch released.
+        void await_load(Frame &fr);
+        std::size_t take_frame(Shard &shard);
+        std::size_t obtain_frame_for(Shard &shard, PageManager &owner, page_key_t key, bool pin);
+        std::size_t obtain_ring_frame(Shard &shard, std::size_t shard_idx, BufferAccessStrategy &ring,
+                                      PageManager &owner, page_key_t key, bool pin);
+        void adopt_into_policy(Shard &shard, std::size_t idx);
+        void discard_frame(Shard &shard, std::size_t idx);
+        std::size_t evict_frame(Shard &shard);
+        struct LoadRun
+        {
+            page_id_t first{0};
+            std::vector<std::size_t> frames;
+        };
+        // load_range() through the owner's AsyncIoEngine; `guards` hold the window's shard
+        // latches on entry and on return.
+        std::size_t load_runs_async(PageManager &owner, const std::vector<LoadRun> &runs,
+                                    std::vector<std::unique_lock<std::mutex>> &guards);
+        void write_back_async(PageManager &owner, Shard &shard);
+        // Writes the cached, dirty pages among `keys` (sorted) outside their shard latches.
+        std::size_t write_behind(const std::vector<page_key_t> &keys, bool unpinned_only,
+                                 uint64_t BufferPoolStats::*counter);
+
+        // Resizing; callers hold resize_mutex_ and every shard latch.
+        std::vector<std::size_t> add_frames(std::size_t count);
+        void map_chunk(Chunk &chunk, std::size_t frame_count);
+        void unmap_chunk(Chunk &chunk);
+        void grow_shard(Shard &shard, const std::vector<std::size_t> &added);
+        void shrink_shard(Shard &shard, std::size_t target);
+        std::vector<std::size_t> drain_policy(Shard &shard);
+        void rebuild_shard(Shard &shard, const std::vector<std::size_t> &cold_to_hot);
+
+        void release_strategy(BufferAccessStrategy &ring);
+        friend class BufferAccessStrategy;
+    };
+}
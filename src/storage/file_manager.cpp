@@ -1,14 +1,35 @@
 #include "storage/file_manager.h"
 
 #include <algorithm>
+#include <cerrno>
 #include <cstring>
 
+#if KIZUNA_HAS_POSIX_IO
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
 namespace fs = std::filesystem;
 
 namespace kizuna
 {
-    FileManager::FileManager(std::string path, bool create_if_missing)
-        : path_(std::move(path)), create_if_missing_(create_if_missing)
+    std::string file_backend_to_string(FileBackend backend)
+    {
+        switch (backend)
+        {
+        case FileBackend::FSTREAM:
+            return "fstream";
+        case FileBackend::POSIX:
+            return "posix";
+        }
+        return "unknown";
+    }
+
+    FileManager::FileManager(std::string path, bool create_if_missing, FileBackend backend)
+        : path_(std::move(path)), create_if_missing_(create_if_missing),
+          backend_(KIZUNA_HAS_POSIX_IO ? backend : FileBackend::FSTREAM)
     {
     }
 
@@ -30,6 +51,18 @@ namespace kizuna
             }
         }
 
+        if (backend_ == FileBackend::POSIX)
+        {
+            open_posix();
+        }
+        else
+        {
+            open_fstream();
+        }
+    }
+
+    void FileManager::open_fstream()
+    {
         // Try opening read/write, create if needed
         file_.open(path_, std::ios::in | std::ios::out | std::ios::binary);
         if (!file_.is_open())
@@ -56,8 +89,44 @@ namespace kizuna
         }
     }
 
+    void FileManager::open_posix()
+    {
+#if KIZUNA_HAS_POSIX_IO
+        if (fd_ >= 0)
+        {
+            return;
+        }
+        int flags = O_RDWR;
+#ifdef O_CLOEXEC
+        flags |= O_CLOEXEC;
+#endif
+        if (create_if_missing_)
+        {
+            flags |= O_CREAT;
+        }
+        fd_ = ::open(path_.c_str(), flags, 0644);
+        if (fd_ < 0)
+        {
+            if (errno == ENOENT && !create_if_missing_)
+            {
+                KIZUNA_THROW_IO(StatusCode::FILE_NOT_FOUND, "Failed to open database file", path_);
+            }
+            KIZUNA_THROW_IO(StatusCode::IO_ERROR, "Failed to open database file", path_ + ": " + std::strerror(errno));
+        }
+#else
+        KIZUNA_THROW_IO(StatusCode::NOT_IMPLEMENTED, "POSIX file backend unavailable", path_);
+#endif
+    }
+
     void FileManager::close() noexcept
     {
+#if KIZUNA_HAS_POSIX_IO
+        if (fd_ >= 0)
+        {
+            ::close(fd_);
+            fd_ = -1;
+        }
+#endif
         if (file_.is_open())
         {
             file_.flush();
@@ -67,7 +136,7 @@ namespace kizuna
 
     void FileManager::ensure_open_for_rw()
     {
-        if (!file_.is_open())
+        if (!is_open())
         {
             KIZUNA_THROW_IO(StatusCode::IO_ERROR, "File is not open", path_);
         }
@@ -75,6 +144,17 @@ namespace kizuna
 
     std::uint64_t FileManager::size_bytes() const
     {
+#if KIZUNA_HAS_POSIX_IO
+        if (fd_ >= 0)
+        {
+            struct stat st{};
+            if (::fstat(fd_, &st) != 0)
+            {
+                KIZUNA_THROW_IO(StatusCode::IO_ERROR, "Failed to get file size", path_);
+            }
+            return static_cast<std::uint64_t>(st.st_size);
+        }
+#endif
         std::error_code ec;
         const auto sz = fs::file_size(path_, ec);
         if (ec)
@@ -102,6 +182,29 @@ namespace kizuna
         ensure_open_for_rw();
 
         const std::uint64_t off = page_offset(page_id);
+#if KIZUNA_HAS_POSIX_IO
+        if (backend_ == FileBackend::POSIX)
+        {
+            // A short read can only mean EOF; no separate size check needed.
+            std::size_t done = 0;
+            while (done < len)
+            {
+                const ssize_t n = ::pread(fd_, out_buffer + done, len - done, static_cast<off_t>(off + done));
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    KIZUNA_THROW_IO(StatusCode::READ_ERROR, "pread failed", std::to_string(page_id) + ": " + std::strerror(errno));
+                }
+                if (n == 0)
+                {
+                    KIZUNA_THROW_STORAGE(StatusCode::PAGE_NOT_FOUND, "Page beyond EOF", std::to_string(page_id));
+                }
+                done += static_cast<std::size_t>(n);
+            }
+            return;
+        }
+#endif
         const auto file_sz = size_bytes();
         if (off + len > file_sz)
         {
@@ -120,6 +223,97 @@ namespace kizuna
         }
     }
 
+    void FileManager::read_pages(page_id_t first_id, std::uint8_t *const *out_buffers, std::size_t count)
+    {
+        if (count == 0)
+            return;
+        if (out_buffers == nullptr)
+        {
+            KIZUNA_THROW_IO(StatusCode::INVALID_ARGUMENT, "Null output buffer", "read_pages");
+        }
+        if (count == 1)
+        {
+            read_page(first_id, out_buffers[0]);
+            return;
+        }
+        if (first_id < config::FIRST_PAGE_ID)
+        {
+            KIZUNA_THROW_STORAGE(StatusCode::PAGE_NOT_FOUND, "Invalid page id", std::to_string(first_id));
+        }
+
+        ensure_open_for_rw();
+
+        const std::uint64_t off = page_offset(first_id);
+#if KIZUNA_HAS_POSIX_IO
+        if (backend_ == FileBackend::POSIX)
+        {
+            constexpr std::size_t max_iov = 64;
+            std::size_t done = 0;
+            while (done < count)
+            {
+                const std::size_t batch = std::min(max_iov, count - done);
+                struct iovec iov[max_iov];
+                for (std::size_t i = 0; i < batch; ++i)
+                {
+                    iov[i].iov_base = out_buffers[done + i];
+                    iov[i].iov_len = config::PAGE_SIZE;
+                }
+                const ssize_t n = ::preadv(fd_, iov, static_cast<int>(batch),
+                                           static_cast<off_t>(off + done * config::PAGE_SIZE));
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    KIZUNA_THROW_IO(StatusCode::READ_ERROR, "preadv failed",
+                                    std::to_string(first_id + done) + ": " + std::strerror(errno));
+                }
+                const std::size_t full = static_cast<std::size_t>(n) / config::PAGE_SIZE;
+                if (full == 0)
+                {
+                    // Short read: let read_page finish the page or report EOF.
+                    read_page(static_cast<page_id_t>(first_id + done), out_buffers[done]);
+                    ++done;
+                    continue;
+                }
+                done += full;
+            }
+            return;
+        }
+#endif
+        const auto file_sz = size_bytes();
+        if (off + count * config::PAGE_SIZE > file_sz)
+        {
+            KIZUNA_THROW_STORAGE(StatusCode::PAGE_NOT_FOUND, "Page beyond EOF", std::to_string(first_id + count - 1));
+        }
+        file_.seekg(static_cast<std::streamoff>(off), std::ios::beg);
+        if (!file_)
+        {
+            KIZUNA_THROW_IO(StatusCode::SEEK_ERROR, "Failed to seek for read", std::to_string(off));
+        }
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            file_.read(reinterpret_cast<char *>(out_buffers[i]), static_cast<std::streamsize>(config::PAGE_SIZE));
+            if (file_.gcount() != static_cast<std::streamsize>(config::PAGE_SIZE))
+            {
+                KIZUNA_THROW_IO(StatusCode::READ_ERROR, "Short read", std::to_string(first_id + i));
+            }
+        }
+    }
+
+    void FileManager::advise_willneed(page_id_t first_id, std::size_t count) const noexcept
+    {
+#if KIZUNA_HAS_POSIX_IO && defined(POSIX_FADV_WILLNEED)
+        if (backend_ == FileBackend::POSIX && fd_ >= 0 && first_id >= config::FIRST_PAGE_ID && count > 0)
+        {
+            ::posix_fadvise(fd_, static_cast<off_t>(page_offset(first_id)),
+                            static_cast<off_t>(count * config::PAGE_SIZE), POSIX_FADV_WILLNEED);
+        }
+#else
+        (void)first_id;
+        (void)count;
+#endif
+    }
+
     void FileManager::write_page(page_id_t page_id, const std::uint8_t *buffer, std::size_t len)
     {
         if (buffer == nullptr)
@@ -138,6 +332,24 @@ namespace kizuna
         ensure_open_for_rw();
 
         const std::uint64_t off = page_offset(page_id);
+#if KIZUNA_HAS_POSIX_IO
+        if (backend_ == FileBackend::POSIX)
+        {
+            std::size_t done = 0;
+            while (done < len)
+            {
+                const ssize_t n = ::pwrite(fd_, buffer + done, len - done, static_cast<off_t>(off + done));
+                if (n < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+                    KIZUNA_THROW_IO(StatusCode::WRITE_ERROR, "pwrite failed", std::to_string(page_id) + ": " + std::strerror(errno));
+                }
+                done += static_cast<std::size_t>(n);
+            }
+            return;
+        }
+#endif
 
         file_.seekp(static_cast<std::streamoff>(off), std::ios::beg);
         if (!file_)
@@ -153,6 +365,39 @@ namespace kizuna
         file_.flush();
     }
 
+    void FileManager::sync()
+    {
+        ensure_open_for_rw();
+#if KIZUNA_HAS_POSIX_IO
+        if (backend_ == FileBackend::POSIX)
+        {
+            if (::fsync(fd_) != 0)
+            {
+                KIZUNA_THROW_IO(StatusCode::SYNC_ERROR, "fsync failed", path_ + ": " + std::strerror(errno));
+            }
+            return;
+        }
+#endif
+        file_.flush();
+        if (!file_)
+        {
+            KIZUNA_THROW_IO(StatusCode::SYNC_ERROR, "Failed to flush database file", path_);
+        }
+#if KIZUNA_HAS_POSIX_IO
+        // fstream exposes no descriptor; fsync through a short-lived one.
+        const int fd = ::open(path_.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            const int rc = ::fsync(fd);
+            ::close(fd);
+            if (rc != 0)
+            {
+                KIZUNA_THROW_IO(StatusCode::SYNC_ERROR, "fsync failed", path_);
+            }
+        }
+#endif
+    }
+
     page_id_t FileManager::allocate_page()
     {
         ensure_open_for_rw();
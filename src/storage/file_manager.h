@@ -10,13 +10,38 @@
 #include "common/config.h"
 #include "common/exception.h"
 
+#if defined(__unix__) || defined(__APPLE__)
+#define KIZUNA_HAS_POSIX_IO 1
+#else
+#define KIZUNA_HAS_POSIX_IO 0
+#endif
+
 namespace kizuna
 {
+    // Page I/O implementation used by a FileManager.
+    enum class FileBackend : uint8_t
+    {
+        FSTREAM = 0, // std::fstream, seek + read/write, flush after every write
+        POSIX = 1    // pread/pwrite on a raw descriptor; durable only after sync()
+    };
+
+    constexpr FileBackend default_file_backend() noexcept
+    {
+        return KIZUNA_HAS_POSIX_IO ? FileBackend::POSIX : FileBackend::FSTREAM;
+    }
+
+    std::string file_backend_to_string(FileBackend backend);
+
     // Minimal file manager for fixed-size page I/O.
+    // The POSIX backend uses positional I/O, so read_page/write_page may be called from
+    // several threads at once; allocate_page and open/close still need external ordering.
+    // Requesting POSIX where it is unavailable falls back to FSTREAM.
     class FileManager
     {
     public:
-        explicit FileManager(std::string path, bool create_if_missing = true);
+        explicit FileManager(std::string path,
+                             bool create_if_missing = true,
+                             FileBackend backend = default_file_backend());
         ~FileManager();
 
         // Non-copyable, non-movable for simplicity in v0.1
@@ -25,9 +50,15 @@ namespace kizuna
 
         void open();
         void close() noexcept;
-        bool is_open() const noexcept { return file_.is_open(); }
+        bool is_open() const noexcept { return backend_ == FileBackend::POSIX ? fd_ >= 0 : file_.is_open(); }
 
         const std::string &path() const noexcept { return path_; }
+        FileBackend backend() const noexcept { return backend_; }
+        // True when page reads/writes need no external serialization.
+        bool supports_concurrent_io() const noexcept { return backend_ == FileBackend::POSIX; }
+        // Raw descriptor for the POSIX backend (-1 otherwise); used by AsyncIoEngine.
+        int native_handle() const noexcept { return fd_; }
+        static std::uint64_t offset_of(page_id_t page_id) { return page_offset(page_id); }
 
         // File stats
         std::uint64_t size_bytes() const;                // total file size
@@ -46,14 +77,24 @@ namespace kizuna
         // Page I/O
         void read_page(page_id_t page_id, std::uint8_t *out_buffer, std::size_t len = config::PAGE_SIZE);
         void write_page(page_id_t page_id, const std::uint8_t *buffer, std::size_t len = config::PAGE_SIZE);
+        // Read `count` adjacent pages starting at first_id with one request (preadv on POSIX).
+        // out_buffers[i] receives page first_id + i.
+        void read_pages(page_id_t first_id, std::uint8_t *const *out_buffers, std::size_t count);
+        // Hint that a page range will be read soon so the OS can load it in the background.
+        void advise_willneed(page_id_t first_id, std::size_t count) const noexcept;
 
         // Allocate a new page (zero-filled) and return its page id
         page_id_t allocate_page();
 
+        // Force written pages to stable storage (fsync). Durability points for callers.
+        void sync();
+
     private:
         std::string path_;
         bool create_if_missing_;
+        FileBackend backend_;
         mutable std::fstream file_;
+        int fd_{-1};
 
         static std::uint64_t page_offset(page_id_t page_id)
         {
@@ -62,6 +103,8 @@ namespace kizuna
         }
 
         void ensure_open_for_rw();
+        void open_fstream();
+        void open_posix();
     };
 }
 
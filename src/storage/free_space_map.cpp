@@ -0,0 +1,322 @@
+#include "storage/free_space_map.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace kizuna
+{
+    namespace
+    {
+        // FSM page layout after the common header:
+        //   entry_count(2) | max_category(1) | reserved(1) | last_fsm_page(4, root only)
+        //   entries: { data_page_id(4), category(1) } packed
+        constexpr std::size_t kCountOffset = sizeof(PageHeader);
+        constexpr std::size_t kMaxCategoryOffset = kCountOffset + 2;
+        constexpr std::size_t kLastPageOffset = kCountOffset + 4;
+        constexpr std::size_t kEntriesOffset = kCountOffset + 8;
+        constexpr std::size_t kEntrySize = sizeof(uint32_t) + 1;
+        constexpr std::size_t kEntryCapacity = (config::PAGE_SIZE - kEntriesOffset) / kEntrySize;
+
+        constexpr bool is_valid_page(page_id_t id)
+        {
+            return id >= config::FIRST_PAGE_ID;
+        }
+
+        uint16_t entry_count(const Page &page)
+        {
+            uint16_t count = 0;
+            std::memcpy(&count, page.data() + kCountOffset, sizeof(count));
+            return count;
+        }
+
+        void set_entry_count(Page &page, uint16_t count)
+        {
+            std::memcpy(page.data() + kCountOffset, &count, sizeof(count));
+        }
+
+        uint8_t max_category(const Page &page)
+        {
+            return page.data()[kMaxCategoryOffset];
+        }
+
+        void set_max_category(Page &page, uint8_t category)
+        {
+            page.data()[kMaxCategoryOffset] = category;
+        }
+
+        page_id_t last_page(const Page &root)
+        {
+            uint32_t id = 0;
+            std::memcpy(&id, root.data() + kLastPageOffset, sizeof(id));
+            return static_cast<page_id_t>(id);
+        }
+
+        void set_last_page(Page &root, page_id_t id)
+        {
+            const uint32_t raw = static_cast<uint32_t>(id);
+            std::memcpy(root.data() + kLastPageOffset, &raw, sizeof(raw));
+        }
+
+        page_id_t entry_page(const Page &page, std::size_t i)
+        {
+            uint32_t id = 0;
+            std::memcpy(&id, page.data() + kEntriesOffset + i * kEntrySize, sizeof(id));
+            return static_cast<page_id_t>(id);
+        }
+
+        uint8_t entry_category(const Page &page, std::size_t i)
+        {
+            return page.data()[kEntriesOffset + i * kEntrySize + sizeof(uint32_t)];
+        }
+
+        void set_entry(Page &page, std::size_t i, page_id_t id, uint8_t category)
+        {
+            const uint32_t raw = static_cast<uint32_t>(id);
+            uint8_t *entry = page.data() + kEntriesOffset + i * kEntrySize;
+            std::memcpy(entry, &raw, sizeof(raw));
+            entry[sizeof(uint32_t)] = category;
+        }
+
+        uint8_t recompute_max(const Page &page)
+        {
+            uint8_t best = 0;
+            const std::size_t count = entry_count(page);
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                best = std::max(best, entry_category(page, i));
+            }
+            return best;
+        }
+    }
+
+    FreeSpaceMap::FreeSpaceMap(PageManager &pm, page_id_t root_page_id)
+        : pm_(pm), root_page_id_(root_page_id)
+    {
+        if (!is_valid_page(root_page_id_))
+        {
+            KIZUNA_THROW_STORAGE(StatusCode::INVALID_ARGUMENT, "Invalid free-space map root", std::to_string(root_page_id_));
+        }
+    }
+
+    page_id_t FreeSpaceMap::create(PageManager &pm)
+    {
+        const page_id_t id = pm.new_page(PageType::FSM);
+        auto &root = pm.fetch(id, true);
+        set_entry_count(root, 0);
+        set_max_category(root, 0);
+        set_last_page(root, id);
+        pm.unpin(id, true);
+        return id;
+    }
+
+    page_id_t FreeSpaceMap::build(PageManager &pm, page_id_t heap_root_page_id)
+    {
+        const page_id_t root = create(pm);
+        FreeSpaceMap fsm(pm, root);
+        page_id_t current = heap_root_page_id;
+        while (is_valid_page(current))
+        {
+            auto &page = pm.fetch(current, true);
+            const std::size_t free_bytes = page.reclaimable_bytes();
+            const page_id_t next = page.next_page_id();
+            pm.unpin(current, false);
+            fsm.append(current, category_for(free_bytes));
+            current = next;
+        }
+        return root;
+    }
+
+    void FreeSpaceMap::destroy(PageManager &pm, page_id_t root_page_id)
+    {
+        page_id_t current = root_page_id;
+        while (is_valid_page(current))
+        {
+            auto &page = pm.fetch(current, true);
+            const page_id_t next = page.next_page_id();
+            pm.unpin(current, false);
+            pm.free_page(current);
+            current = next;
+        }
+    }
+
+    uint8_t FreeSpaceMap::category_for(std::size_t free_bytes) noexcept
+    {
+        return static_cast<uint8_t>(std::min<std::size_t>(free_bytes / config::FSM_CATEGORY_BYTES, 255));
+    }
+
+    void FreeSpaceMap::update(page_id_t data_page_id, std::size_t free_bytes)
+    {
+        const uint8_t category = category_for(free_bytes);
+        const auto loc = locate(data_page_id);
+        if (!loc)
+        {
+            append(data_page_id, category);
+            return;
+        }
+        auto &page = pm_.fetch(loc->fsm_page_id, true);
+        const uint8_t old = entry_category(page, loc->index);
+        if (old == category)
+        {
+            pm_.unpin(loc->fsm_page_id, false);
+            return;
+        }
+        set_entry(page, loc->index, data_page_id, category);
+        if (category > max_category(page))
+        {
+            set_max_category(page, category);
+        }
+        else if (old == max_category(page))
+        {
+            set_max_category(page, recompute_max(page));
+        }
+        pm_.unpin(loc->fsm_page_id, true);
+    }
+
+    bool FreeSpaceMap::remove(page_id_t data_page_id)
+    {
+        const auto loc = locate(data_page_id);
+        if (!loc)
+        {
+            return false;
+        }
+        auto &page = pm_.fetch(loc->fsm_page_id, true);
+        const uint16_t count = entry_count(page);
+        const std::size_t last = static_cast<std::size_t>(count - 1);
+        set_entry(page, loc->index, entry_page(page, last), entry_category(page, last));
+        set_entry_count(page, static_cast<uint16_t>(last));
+        set_max_category(page, recompute_max(page));
+        pm_.unpin(loc->fsm_page_id, true);
+        return true;
+    }
+
+    void FreeSpaceMap::clear()
+    {
+        auto &root = pm_.fetch(root_page_id_, true);
+        page_id_t current = root.next_page_id();
+        root.set_next_page_id(config::INVALID_PAGE_ID);
+        set_entry_count(root, 0);
+        set_max_category(root, 0);
+        set_last_page(root, root_page_id_);
+        pm_.unpin(root_page_id_, true);
+        destroy(pm_, current);
+    }
+
+    std::optional<page_id_t> FreeSpaceMap::find(std::size_t needed_bytes)
+    {
+        const std::size_t wanted = (needed_bytes + config::FSM_CATEGORY_BYTES - 1) / config::FSM_CATEGORY_BYTES;
+        if (wanted > 255)
+        {
+            return std::nullopt;
+        }
+        page_id_t current = root_page_id_;
+        while (is_valid_page(current))
+        {
+            auto &page = pm_.fetch(current, true);
+            if (max_category(page) >= wanted)
+            {
+                const std::size_t count = entry_count(page);
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    if (entry_category(page, i) >= wanted)
+                    {
+                        const page_id_t found = entry_page(page, i);
+                        pm_.unpin(current, false);
+                        return found;
+                    }
+                }
+            }
+            const page_id_t next = page.next_page_id();
+            pm_.unpin(current, false);
+            current = next;
+        }
+        return std::nullopt;
+    }
+
+    std::size_t FreeSpaceMap::tracked_pages()
+    {
+        std::size_t total = 0;
+        page_id_t current = root_page_id_;
+        while (is_valid_page(current))
+        {
+            auto &page = pm_.fetch(current, true);
+            total += entry_count(page);
+            const page_id_t next = page.next_page_id();
+            pm_.unpin(current, false);
+            current = next;
+        }
+        return total;
+    }
+
+    std::optional<FreeSpaceMap::Location> FreeSpaceMap::locate(page_id_t data_page_id)
+    {
+        // Recently added pages (the heap tail) live on the last FSM page: look there first.
+        const page_id_t last = last_page_id();
+        page_id_t current = last;
+        bool searched_last = false;
+        while (is_valid_page(current))
+        {
+            auto &page = pm_.fetch(current, true);
+            const std::size_t count = entry_count(page);
+            for (std::size_t i = count; i > 0; --i)
+            {
+                if (entry_page(page, i - 1) == data_page_id)
+                {
+                    pm_.unpin(current, false);
+                    return Location{current, i - 1};
+                }
+            }
+            page_id_t next = page.next_page_id();
+            pm_.unpin(current, false);
+            if (!searched_last)
+            {
+                searched_last = true;
+                next = root_page_id_;
+            }
+            if (next == last)
+            {
+                next = config::INVALID_PAGE_ID;
+            }
+            current = next;
+        }
+        return std::nullopt;
+    }
+
+    page_id_t FreeSpaceMap::last_page_id()
+    {
+        auto &root = pm_.fetch(root_page_id_, true);
+        const page_id_t last = last_page(root);
+        pm_.unpin(root_page_id_, false);
+        return is_valid_page(last) ? last : root_page_id_;
+    }
+
+    void FreeSpaceMap::append(page_id_t data_page_id, uint8_t category)
+    {
+        const page_id_t last = last_page_id();
+        auto &page = pm_.fetch(last, true);
+        const uint16_t count = entry_count(page);
+        if (count < kEntryCapacity)
+        {
+            set_entry(page, count, data_page_id, category);
+            set_entry_count(page, static_cast<uint16_t>(count + 1));
+            set_max_category(page, std::max(max_category(page), category));
+            pm_.unpin(last, true);
+            return;
+        }
+        pm_.unpin(last, false);
+
+        const page_id_t fresh = pm_.new_page(PageType::FSM);
+        auto &fresh_page = pm_.fetch(fresh, true);
+        set_entry(fresh_page, 0, data_page_id, category);
+        set_entry_count(fresh_page, 1);
+        set_max_category(fresh_page, category);
+        pm_.unpin(fresh, true);
+
+        auto &prev = pm_.fetch(last, true);
+        prev.set_next_page_id(fresh);
+        pm_.unpin(last, true);
+
+        auto &root = pm_.fetch(root_page_id_, true);
+        set_last_page(root, fresh);
+        pm_.unpin(root_page_id_, true);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "common/config.h"
+#include "common/types.h"
+#include "storage/page_manager.h"
+
+namespace kizuna
+{
+    // Persistent free-space map for one table heap.
+    // Tracks a one-byte free-space category (FSM_CATEGORY_BYTES per step) for every data
+    // page of the heap, so inserts can find a page with room without walking the chain.
+    // Entries live in a chain of FSM pages; each page keeps its largest category so a
+    // search skips pages with nothing big enough. The root also remembers the last FSM
+    // page, where newly tracked data pages are appended.
+    class FreeSpaceMap
+    {
+    public:
+        FreeSpaceMap(PageManager &pm, page_id_t root_page_id);
+
+        // Allocate an empty map and return its root page id.
+        static page_id_t create(PageManager &pm);
+        // Allocate a map describing every page of an existing heap chain.
+        static page_id_t build(PageManager &pm, page_id_t heap_root_page_id);
+        // Return every page of the map to the page manager's free list.
+        static void destroy(PageManager &pm, page_id_t root_page_id);
+
+        static uint8_t category_for(std::size_t free_bytes) noexcept;
+
+        page_id_t root_page_id() const noexcept { return root_page_id_; }
+
+        // Record the free space of a data page, tracking it if it is new.
+        void update(page_id_t data_page_id, std::size_t free_bytes);
+        // Stop tracking a data page (e.g. when it is freed).
+        bool remove(page_id_t data_page_id);
+        // Drop every entry and release all FSM pages but the root.
+        void clear();
+        // A tracked page whose recorded category guarantees at least needed_bytes free.
+        std::optional<page_id_t> find(std::size_t needed_bytes);
+
+        std::size_t tracked_pages();
+
+    private:
+        PageManager &pm_;
+        page_id_t root_page_id_;
+
+        struct Location
+        {
+            page_id_t fsm_page_id{config::INVALID_PAGE_ID};
+            std::size_t index{0};
+        };
+
+        std::optional<Location> locate(page_id_t data_page_id);
+        page_id_t last_page_id();
+        void append(page_id_t data_page_id, uint8_t category);
+    };
+}
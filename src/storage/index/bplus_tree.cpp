@@ -7,6 +7,44 @@
 
 namespace kizuna::index
 {
+    namespace
+    {
+        // Keeps a node page pinned while a view reads or edits it in place.
+        class NodePin
+        {
+        public:
+            NodePin(PageManager &pm, page_id_t page_id)
+                : pm_(pm), page_id_(page_id), page_(pm.fetch(page_id, true))
+            {
+            }
+
+            ~NodePin() { pm_.unpin(page_id_, dirty_); }
+
+            NodePin(const NodePin &) = delete;
+            NodePin &operator=(const NodePin &) = delete;
+
+            Page &page() noexcept { return page_; }
+            void mark_dirty() noexcept { dirty_ = true; }
+
+        private:
+            PageManager &pm_;
+            page_id_t page_id_;
+            Page &page_;
+            bool dirty_{false};
+        };
+
+        struct PinnedNode
+        {
+            PinnedNode(PageManager &pm, page_id_t page_id)
+                : pin(pm, page_id), view(pin.page())
+            {
+            }
+
+            NodePin pin;
+            BPlusTreeNodeView view;
+        };
+    } // namespace
+
     BPlusTree::BPlusTree(PageManager &pm, FileManager &fm, page_id_t root_page_id, bool unique)
         : pm_(pm), fm_(fm), root_page_id_(root_page_id), unique_(unique)
     {
@@ -25,18 +63,17 @@ namespace kizuna::index
         page_id_t current = root_page_id_;
         while (true)
         {
-            BPlusTreeNode node = LoadNode(current);
-            if (node.node_type() == BPlusTreeNode::NodeType::LEAF)
+            PinnedNode node(pm_, current);
+            if (node.view.is_leaf())
             {
-                size_t idx = FindLeafIndex(node, key);
-                if (idx < node.leaf_entries().size() && CompareKeys(node.leaf_entries()[idx].key, key) == 0)
+                size_t idx = node.view.LowerBound(key);
+                if (idx < node.view.key_count() && CompareKeys(node.view.KeyAt(idx), key) == 0)
                 {
-                    return {true, node.leaf_entries()[idx].value};
+                    return {true, node.view.ValueAt(idx)};
                 }
                 return {false, 0};
             }
-            size_t child_index = FindInternalChild(node, key);
-            current = node.children().at(child_index);
+            current = node.view.ChildAt(node.view.UpperBound(key));
         }
     }
 
@@ -54,13 +91,8 @@ namespace kizuna::index
             new_root.children().push_back(*promoted_child);
             new_root.internal_entries().push_back(BPlusTreeNode::InternalEntry{*promoted_key, *promoted_child});
 
-            BPlusTreeNode left_child = LoadNode(root_page_id_);
-            left_child.set_parent(new_root_page);
-            StoreNode(left_child);
-
-            BPlusTreeNode right_child = LoadNode(*promoted_child);
-            right_child.set_parent(new_root_page);
-            StoreNode(right_child);
+            SetParent(root_page_id_, new_root_page);
+            SetParent(*promoted_child, new_root_page);
 
             StoreNode(new_root);
             root_page_id_ = new_root_page;
@@ -72,26 +104,23 @@ namespace kizuna::index
         page_id_t current = root_page_id_;
         while (true)
         {
-            BPlusTreeNode node = LoadNode(current);
-            if (node.node_type() == BPlusTreeNode::NodeType::LEAF)
+            PinnedNode node(pm_, current);
+            if (node.view.is_leaf())
             {
-                size_t idx = FindLeafIndex(node, key);
-                while (idx < node.leaf_entries().size() && CompareKeys(node.leaf_entries()[idx].key, key) == 0)
+                size_t idx = node.view.LowerBound(key);
+                while (idx < node.view.key_count() && CompareKeys(node.view.KeyAt(idx), key) == 0)
                 {
-                    if (node.leaf_entries()[idx].value == value)
+                    if (node.view.ValueAt(idx) == value)
                     {
-                        node.leaf_entries().erase(node.leaf_entries().begin() + idx);
-                        StoreNode(node);
+                        node.view.RemoveLeaf(idx);
+                        node.pin.mark_dirty();
                         return;
                     }
                     ++idx;
                 }
                 return;
             }
-            size_t child_index = FindInternalChild(node, key);
-            if (child_index >= node.children().size())
-                child_index = node.children().size() - 1;
-            current = node.children().at(child_index);
+            current = node.view.ChildAt(node.view.UpperBound(key));
         }
     }
 
@@ -106,58 +135,411 @@ namespace kizuna::index
                                                   bool upper_inclusive) const
     {
         std::vector<record_id_t> results;
+        for (auto cursor = SeekRange(lower_key, lower_inclusive, upper_key, upper_inclusive); cursor.Valid(); cursor.Next())
+        {
+            results.push_back(cursor.Value());
+        }
+        return results;
+    }
 
-        page_id_t current = config::INVALID_PAGE_ID;
-        size_t start_index = 0;
+    BPlusTree::Cursor BPlusTree::SeekFirst() const
+    {
+        Cursor cursor(pm_);
+        cursor.Pin(FindLeftmostLeaf(), 0);
+        cursor.SettleForward();
+        return cursor;
+    }
+
+    BPlusTree::Cursor BPlusTree::SeekLast() const
+    {
+        Cursor cursor(pm_);
+        cursor.Pin(FindRightmostLeaf(), 0);
+        cursor.index_ = cursor.view_->key_count();
+        cursor.StepBack();
+        return cursor;
+    }
 
+    BPlusTree::Cursor BPlusTree::Seek(std::span<const uint8_t> key) const
+    {
+        Cursor cursor(pm_);
+        auto [leaf, index] = FindLeafPosition(key, true);
+        cursor.Pin(leaf, index);
+        cursor.SettleForward();
+        return cursor;
+    }
+
+    BPlusTree::Cursor BPlusTree::SeekRange(const std::optional<std::vector<uint8_t>> &lower_key,
+                                           bool lower_inclusive,
+                                           const std::optional<std::vector<uint8_t>> &upper_key,
+                                           bool upper_inclusive,
+                                           bool reverse) const
+    {
+        Cursor cursor(pm_);
         if (lower_key.has_value())
+            cursor.lower_ = Cursor::Bound{*lower_key, lower_inclusive};
+        if (upper_key.has_value())
+            cursor.upper_ = Cursor::Bound{*upper_key, upper_inclusive};
+
+        if (!reverse)
         {
-            auto [leaf, index] = FindLeafPosition(*lower_key);
-            current = leaf;
-            start_index = index;
+            if (lower_key.has_value())
+            {
+                auto [leaf, index] = FindLeafPosition(*lower_key, lower_inclusive);
+                cursor.Pin(leaf, index);
+            }
+            else
+            {
+                cursor.Pin(FindLeftmostLeaf(), 0);
+            }
+            cursor.SettleForward();
         }
         else
         {
-            current = FindLeftmostLeaf();
-            start_index = 0;
+            // Start just past the upper bound and step back onto the last entry inside it.
+            if (upper_key.has_value())
+            {
+                auto [leaf, index] = FindLeafPosition(*upper_key, !upper_inclusive);
+                cursor.Pin(leaf, index);
+            }
+            else
+            {
+                cursor.Pin(FindRightmostLeaf(), 0);
+                cursor.index_ = cursor.view_->key_count();
+            }
+            cursor.StepBack();
         }
 
-        while (current != config::INVALID_PAGE_ID)
+        if (cursor.Valid() && !(cursor.AboveLower() && cursor.BelowUpper()))
+            cursor.Release();
+        return cursor;
+    }
+
+    BPlusTree::Cursor::Cursor(Cursor &&other) noexcept
+        : pm_(other.pm_),
+          page_id_(other.page_id_),
+          index_(other.index_),
+          lower_(std::move(other.lower_)),
+          upper_(std::move(other.upper_))
+    {
+        if (other.view_.has_value())
+        {
+            // The pin moves with the position; other no longer owns it.
+            view_.emplace(*other.view_);
+            other.view_.reset();
+        }
+    }
+
+    BPlusTree::Cursor &BPlusTree::Cursor::operator=(Cursor &&other) noexcept
+    {
+        if (this != &other)
         {
-            BPlusTreeNode node = LoadNode(current);
-            if (node.leaf_entries().empty() || start_index >= node.leaf_entries().size())
+            Release();
+            pm_ = other.pm_;
+            page_id_ = other.page_id_;
+            index_ = other.index_;
+            lower_ = std::move(other.lower_);
+            upper_ = std::move(other.upper_);
+            if (other.view_.has_value())
             {
-                current = node.next_leaf();
-                start_index = 0;
-                continue;
+                view_.emplace(*other.view_);
+                other.view_.reset();
             }
+        }
+        return *this;
+    }
+
+    BPlusTree::Cursor::~Cursor()
+    {
+        Release();
+    }
+
+    std::span<const uint8_t> BPlusTree::Cursor::Key() const
+    {
+        return view_->KeyAt(index_);
+    }
+
+    record_id_t BPlusTree::Cursor::Value() const
+    {
+        return view_->ValueAt(index_);
+    }
+
+    void BPlusTree::Cursor::Next()
+    {
+        if (!view_.has_value())
+            return;
+        ++index_;
+        SettleForward();
+        if (view_.has_value() && !BelowUpper())
+            Release();
+    }
+
+    void BPlusTree::Cursor::Prev()
+    {
+        if (!view_.has_value())
+            return;
+        StepBack();
+        if (view_.has_value() && !AboveLower())
+            Release();
+    }
 
-            for (size_t idx = start_index; idx < node.leaf_entries().size(); ++idx)
+    void BPlusTree::Cursor::Pin(page_id_t page_id, size_t index)
+    {
+        Release();
+        Page &page = pm_->fetch(page_id, true);
+        page_id_ = page_id;
+        index_ = index;
+        view_.emplace(page);
+    }
+
+    void BPlusTree::Cursor::Release() noexcept
+    {
+        if (!view_.has_value())
+            return;
+        view_.reset();
+        pm_->unpin(page_id_, false);
+        page_id_ = config::INVALID_PAGE_ID;
+    }
+
+    void BPlusTree::Cursor::SettleForward()
+    {
+        while (view_.has_value() && index_ >= view_->key_count())
+        {
+            const page_id_t next = view_->next_leaf();
+            Release();
+            if (next == config::INVALID_PAGE_ID)
+                return;
+            Pin(next, 0);
+        }
+    }
+
+    void BPlusTree::Cursor::StepBack()
+    {
+        while (view_.has_value() && index_ == 0)
+        {
+            const page_id_t prev = view_->prev_leaf();
+            Release();
+            if (prev == config::INVALID_PAGE_ID)
+                return;
+            Pin(prev, 0);
+            index_ = view_->key_count();
+        }
+        if (view_.has_value())
+            --index_;
+    }
+
+    bool BPlusTree::Cursor::AboveLower() const
+    {
+        if (!lower_.has_value())
+            return true;
+        int cmp = CompareKeyBytes(Key(), lower_->key);
+        return cmp > 0 || (cmp == 0 && lower_->inclusive);
+    }
+
+    bool BPlusTree::Cursor::BelowUpper() const
+    {
+        if (!upper_.has_value())
+            return true;
+        int cmp = CompareKeyBytes(Key(), upper_->key);
+        return cmp < 0 || (cmp == 0 && upper_->inclusive);
+    }
+
+    BPlusTree::BulkLoader BPlusTree::StartBulkLoad(double fill_factor)
+    {
+        if (!(fill_factor > 0.0 && fill_factor <= 1.0))
+        {
+            KIZUNA_THROW_INDEX(StatusCode::INVALID_ARGUMENT, "Bulk load fill factor out of range", std::to_string(fill_factor));
+        }
+        {
+            PinnedNode root(pm_, root_page_id_);
+            if (!root.view.is_leaf() || root.view.key_count() != 0)
             {
-                const auto &entry = node.leaf_entries()[idx];
+                KIZUNA_THROW_INDEX(StatusCode::INVALID_ARGUMENT, "Bulk load needs an empty tree", std::to_string(root_page_id_));
+            }
+        }
+        return BulkLoader(*this, fill_factor);
+    }
 
-                if (lower_key.has_value())
-                {
-                    int cmp = CompareKeys(entry.key, *lower_key);
-                    if (cmp < 0 || (cmp == 0 && !lower_inclusive))
-                        continue;
-                }
+    BPlusTree::BulkLoader::BulkLoader(BPlusTree &tree, double fill_factor)
+        : tree_(tree),
+          max_keys_(std::max<size_t>(1, static_cast<size_t>(fill_factor * config::BTREE_MAX_KEYS))),
+          leaf_budget_(static_cast<size_t>(fill_factor * BPlusTreeNode::EntryCapacity(BPlusTreeNode::NodeType::LEAF))),
+          internal_budget_(static_cast<size_t>(fill_factor * BPlusTreeNode::EntryCapacity(BPlusTreeNode::NodeType::INTERNAL)))
+    {
+    }
 
-                if (upper_key.has_value())
+    void BPlusTree::BulkLoader::Add(std::span<const uint8_t> key, record_id_t value)
+    {
+        const size_t entry_bytes = BPlusTreeNode::LeafEntrySize(key.size());
+        if (levels_.empty())
+        {
+            // The empty root becomes the first leaf.
+            levels_.emplace_back();
+            StartNode(0, std::vector<uint8_t>(key.begin(), key.end()), BPlusTreeNode::MakeLeaf(tree_.root_page_id_));
+        }
+        else
+        {
+            auto &leaf = levels_.front().pending.back().node;
+            auto &last = leaf.leaf_entries().back();
+            int cmp = CompareKeys(key, last.key);
+            if (cmp < 0)
+            {
+                KIZUNA_THROW_INDEX(StatusCode::INVALID_ARGUMENT, "Bulk load keys out of order", "");
+            }
+            if (cmp == 0)
+            {
+                if (tree_.unique_)
                 {
-                    int cmp = CompareKeys(entry.key, *upper_key);
-                    if (cmp > 0 || (cmp == 0 && !upper_inclusive))
-                        return results;
+                    KIZUNA_THROW_INDEX(StatusCode::DUPLICATE_KEY, "Duplicate key insertion", "");
                 }
+                last.value = value;
+                return;
+            }
 
-                results.push_back(entry.value);
+            if (leaf.key_count() >= max_keys_ || leaf_bytes_ + entry_bytes > leaf_budget_)
+            {
+                const page_id_t next = tree_.pm_.new_page(PageType::INDEX);
+                leaf.set_next_leaf(next);
+                BPlusTreeNode fresh = BPlusTreeNode::MakeLeaf(next);
+                fresh.set_prev_leaf(leaf.page_id());
+                leaf_bytes_ = 0;
+                StartNode(0, std::vector<uint8_t>(key.begin(), key.end()), std::move(fresh));
             }
+        }
 
-            current = node.next_leaf();
-            start_index = 0;
+        levels_.front().pending.back().node.leaf_entries().push_back(
+            BPlusTreeNode::LeafEntry{std::vector<uint8_t>(key.begin(), key.end()), value});
+        leaf_bytes_ += entry_bytes;
+    }
+
+    void BPlusTree::BulkLoader::Finish()
+    {
+        if (levels_.empty())
+            return;
+        // Bottom-up: settling a level's waiting child may still re-parent nodes of the
+        // level below, and may open a node (or a level) above.
+        for (size_t level = 0; level < levels_.size(); ++level)
+        {
+            if (level + 1 < levels_.size() && levels_[level + 1].waiting.has_value())
+            {
+                auto &parent_level = levels_[level + 1];
+                ChildRef waiting = std::move(*parent_level.waiting);
+                parent_level.waiting.reset();
+                // The last node gives up its last child so the new one has a separator.
+                auto &left = parent_level.pending.back().node;
+                auto moved = std::move(left.internal_entries().back());
+                left.internal_entries().pop_back();
+                left.children().pop_back();
+                OpenInternalNode(level + 1, ChildRef{std::move(moved.key), moved.child}, std::move(waiting));
+            }
+            for (auto &pending : levels_[level].pending)
+                tree_.StoreNode(pending.node);
+            if (level + 1 == levels_.size())
+                tree_.root_page_id_ = levels_[level].pending.front().node.page_id(); // the level's only node
+            levels_[level].pending.clear();
         }
+        levels_.clear();
+    }
 
-        return results;
+    void BPlusTree::BulkLoader::StartNode(size_t level, std::vector<uint8_t> first_key, BPlusTreeNode node)
+    {
+        const page_id_t page_id = node.page_id();
+        levels_[level].pending.push_back(PendingNode{std::move(node), first_key});
+        const size_t count = ++levels_[level].node_count;
+        if (count == 2)
+        {
+            // A second node means the level needs a parent; the first joins it too.
+            if (levels_.size() == level + 1)
+                levels_.emplace_back();
+            const auto &first = levels_[level].pending.front();
+            AddChild(level + 1, ChildRef{first.first_key, first.node.page_id()});
+        }
+        if (count >= 2)
+            AddChild(level + 1, ChildRef{std::move(first_key), page_id});
+        StoreSettled(level);
+    }
+
+    void BPlusTree::BulkLoader::AddChild(size_t level, ChildRef child)
+    {
+        auto &target = levels_[level];
+        if (target.waiting.has_value())
+        {
+            ChildRef first = std::move(*target.waiting);
+            target.waiting.reset();
+            OpenInternalNode(level, std::move(first), std::move(child));
+            return;
+        }
+        if (target.pending.empty())
+        {
+            BPlusTreeNode node = BPlusTreeNode::MakeInternal(tree_.pm_.new_page(PageType::INDEX));
+            node.children().push_back(child.page_id);
+            SetChildParent(level, child.page_id, node.page_id());
+            target.node_bytes = 0;
+            StartNode(level, std::move(child.first_key), std::move(node));
+            return;
+        }
+
+        auto &node = target.pending.back().node;
+        const size_t entry_bytes = BPlusTreeNode::InternalEntrySize(child.first_key.size());
+        // Every node takes at least one separator, so each level shrinks.
+        if (node.key_count() > 0 &&
+            (node.key_count() >= max_keys_ || target.node_bytes + entry_bytes > internal_budget_))
+        {
+            target.waiting = std::move(child);
+            return;
+        }
+        SetChildParent(level, child.page_id, node.page_id());
+        node.children().push_back(child.page_id);
+        node.internal_entries().push_back(BPlusTreeNode::InternalEntry{std::move(child.first_key), child.page_id});
+        target.node_bytes += entry_bytes;
+    }
+
+    void BPlusTree::BulkLoader::OpenInternalNode(size_t level, ChildRef first, ChildRef second)
+    {
+        BPlusTreeNode node = BPlusTreeNode::MakeInternal(tree_.pm_.new_page(PageType::INDEX));
+        node.children().push_back(first.page_id);
+        node.children().push_back(second.page_id);
+        SetChildParent(level, first.page_id, node.page_id());
+        SetChildParent(level, second.page_id, node.page_id());
+        levels_[level].node_bytes = BPlusTreeNode::InternalEntrySize(second.first_key.size());
+        node.internal_entries().push_back(BPlusTreeNode::InternalEntry{std::move(second.first_key), second.page_id});
+        StartNode(level, std::move(first.first_key), std::move(node));
+    }
+
+    void BPlusTree::BulkLoader::SetChildParent(size_t level, page_id_t child, page_id_t parent)
+    {
+        for (auto &pending : levels_[level - 1].pending)
+        {
+            if (pending.node.page_id() == child)
+            {
+                pending.node.set_parent(parent);
+                return;
+            }
+        }
+        KIZUNA_THROW_INDEX(StatusCode::INTERNAL_ERROR, "Bulk load child already written", std::to_string(child));
+    }
+
+    void BPlusTree::BulkLoader::StoreSettled(size_t level)
+    {
+        auto &pending = levels_[level].pending;
+        while (pending.size() > 2)
+        {
+            tree_.StoreNode(pending.front().node);
+            pending.pop_front();
+        }
+    }
+
+    size_t BPlusTree::Height() const
+    {
+        size_t height = 1;
+        page_id_t current = root_page_id_;
+        while (true)
+        {
+            PinnedNode node(pm_, current);
+            if (node.view.is_leaf())
+                return height;
+            current = node.view.ChildAt(0);
+            ++height;
+        }
     }
 
     BPlusTreeNode BPlusTree::LoadNode(page_id_t page_id) const
@@ -175,57 +557,49 @@ namespace kizuna::index
         pm_.unpin(node.page_id(), true);
     }
 
-    size_t BPlusTree::FindLeafIndex(const BPlusTreeNode &leaf, const std::vector<uint8_t> &key) const
+    void BPlusTree::SetParent(page_id_t page_id, page_id_t parent)
     {
-        const auto &entries = leaf.leaf_entries();
-        size_t idx = 0;
-        while (idx < entries.size() && CompareKeys(entries[idx].key, key) < 0)
-        {
-            ++idx;
-        }
-        return idx;
+        PinnedNode node(pm_, page_id);
+        node.view.set_parent(parent);
+        node.pin.mark_dirty();
     }
 
-    size_t BPlusTree::FindInternalChild(const BPlusTreeNode &node, const std::vector<uint8_t> &key) const
+    // Position of the first entry >= key (inclusive) or > key. Equal keys can sit on both
+    // sides of a separator after a split, so an inclusive descent follows LowerBound.
+    std::pair<page_id_t, size_t> BPlusTree::FindLeafPosition(std::span<const uint8_t> key, bool inclusive) const
     {
-        const auto &entries = node.internal_entries();
-        size_t idx = 0;
-        while (idx < entries.size() && CompareKeys(entries[idx].key, key) <= 0)
+        page_id_t current = root_page_id_;
+        while (true)
         {
-            ++idx;
+            PinnedNode node(pm_, current);
+            const size_t index = inclusive ? node.view.LowerBound(key) : node.view.UpperBound(key);
+            if (node.view.is_leaf())
+                return {current, index};
+            current = node.view.ChildAt(index);
         }
-        return idx;
     }
 
-    std::pair<page_id_t, size_t> BPlusTree::FindLeafPosition(const std::vector<uint8_t> &key) const
+    page_id_t BPlusTree::FindLeftmostLeaf() const
     {
         page_id_t current = root_page_id_;
         while (true)
         {
-            BPlusTreeNode node = LoadNode(current);
-            if (node.node_type() == BPlusTreeNode::NodeType::LEAF)
-            {
-                size_t idx = FindLeafIndex(node, key);
-                return {current, idx};
-            }
-            size_t child_index = FindInternalChild(node, key);
-            if (child_index >= node.children().size())
-                child_index = node.children().size() - 1;
-            current = node.children().at(child_index);
+            PinnedNode node(pm_, current);
+            if (node.view.is_leaf())
+                return current;
+            current = node.view.ChildAt(0);
         }
     }
 
-    page_id_t BPlusTree::FindLeftmostLeaf() const
+    page_id_t BPlusTree::FindRightmostLeaf() const
     {
         page_id_t current = root_page_id_;
         while (true)
         {
-            BPlusTreeNode node = LoadNode(current);
-            if (node.node_type() == BPlusTreeNode::NodeType::LEAF)
+            PinnedNode node(pm_, current);
+            if (node.view.is_leaf())
                 return current;
-            if (node.children().empty())
-                return config::INVALID_PAGE_ID;
-            current = node.children().front();
+            current = node.view.ChildAt(node.view.key_count());
         }
     }
 
@@ -235,20 +609,47 @@ namespace kizuna::index
                                     std::optional<std::vector<uint8_t>> &out_promoted_key,
                                     std::optional<page_id_t> &out_new_child)
     {
-        BPlusTreeNode node = LoadNode(page_id);
-        if (node.node_type() == BPlusTreeNode::NodeType::LEAF)
+        out_promoted_key.reset();
+        out_new_child.reset();
+
+        // Common case: the entry fits, so the page is edited in place. Only a node that
+        // has to split is deserialized.
+        bool leaf = false;
+        size_t idx = 0;
+        page_id_t child_page = config::INVALID_PAGE_ID;
         {
-            size_t idx = FindLeafIndex(node, key);
-            if (idx < node.leaf_entries().size() && CompareKeys(node.leaf_entries()[idx].key, key) == 0)
+            PinnedNode pinned(pm_, page_id);
+            auto &view = pinned.view;
+            if (view.is_leaf())
             {
-                if (unique_)
+                leaf = true;
+                idx = view.LowerBound(key);
+                if (idx < view.key_count() && CompareKeys(view.KeyAt(idx), key) == 0)
                 {
-                    KIZUNA_THROW_INDEX(StatusCode::DUPLICATE_KEY, "Duplicate key insertion", "");
+                    if (unique_)
+                    {
+                        KIZUNA_THROW_INDEX(StatusCode::DUPLICATE_KEY, "Duplicate key insertion", "");
+                    }
+                    view.SetValueAt(idx, value);
+                    pinned.pin.mark_dirty();
+                    return;
+                }
+                if (view.InsertLeaf(idx, key, value))
+                {
+                    pinned.pin.mark_dirty();
+                    return;
                 }
-                node.leaf_entries()[idx].value = value;
-                StoreNode(node);
-                return;
             }
+            else
+            {
+                idx = view.UpperBound(key);
+                child_page = view.ChildAt(idx);
+            }
+        }
+
+        if (leaf)
+        {
+            BPlusTreeNode node = LoadNode(page_id);
             node.leaf_entries().insert(node.leaf_entries().begin() + idx,
                                        BPlusTreeNode::LeafEntry{key, value});
 
@@ -264,9 +665,9 @@ namespace kizuna::index
 
                 if (new_leaf.next_leaf() != config::INVALID_PAGE_ID)
                 {
-                    BPlusTreeNode next = LoadNode(new_leaf.next_leaf());
-                    next.set_prev_leaf(new_leaf.page_id());
-                    StoreNode(next);
+                    PinnedNode next(pm_, new_leaf.next_leaf());
+                    next.view.set_prev_leaf(new_leaf.page_id());
+                    next.pin.mark_dirty();
                 }
 
                 out_new_child = new_leaf.page_id();
@@ -280,23 +681,25 @@ namespace kizuna::index
             return;
         }
 
-        size_t child_index = FindInternalChild(node, key);
-        page_id_t child_page = node.children().at(child_index);
-
         std::optional<std::vector<uint8_t>> promoted_key;
         std::optional<page_id_t> promoted_child;
         InsertRecursive(child_page, key, value, promoted_key, promoted_child);
         if (!promoted_key.has_value())
-        {
-            StoreNode(node);
-            out_promoted_key.reset();
-            out_new_child.reset();
             return;
+
+        {
+            PinnedNode pinned(pm_, page_id);
+            if (pinned.view.InsertInternal(idx, *promoted_key, *promoted_child))
+            {
+                pinned.pin.mark_dirty();
+                return;
+            }
         }
 
-        node.internal_entries().insert(node.internal_entries().begin() + child_index,
+        BPlusTreeNode node = LoadNode(page_id);
+        node.internal_entries().insert(node.internal_entries().begin() + idx,
                                         BPlusTreeNode::InternalEntry{*promoted_key, *promoted_child});
-        node.children().insert(node.children().begin() + child_index + 1, *promoted_child);
+        node.children().insert(node.children().begin() + idx + 1, *promoted_child);
 
         if (node.requires_split())
         {
@@ -306,11 +709,7 @@ namespace kizuna::index
             out_new_child = new_internal.page_id();
 
             for (auto child_id : new_internal.children())
-            {
-                BPlusTreeNode child = LoadNode(child_id);
-                child.set_parent(new_internal.page_id());
-                StoreNode(child);
-            }
+                SetParent(child_id, new_internal.page_id());
 
             StoreNode(node);
             StoreNode(new_internal);
@@ -356,20 +755,8 @@ namespace kizuna::index
         }
     }
 
-    int BPlusTree::CompareKeys(const std::vector<uint8_t> &lhs, const std::vector<uint8_t> &rhs)
+    int BPlusTree::CompareKeys(std::span<const uint8_t> lhs, std::span<const uint8_t> rhs)
     {
-        const size_t min_len = std::min(lhs.size(), rhs.size());
-        int cmp = 0;
-        if (min_len > 0)
-        {
-            cmp = std::memcmp(lhs.data(), rhs.data(), min_len);
-            if (cmp != 0)
-                return cmp;
-        }
-        if (lhs.size() < rhs.size())
-            return -1;
-        if (lhs.size() > rhs.size())
-            return 1;
-        return 0;
+        return CompareKeyBytes(lhs, rhs);
     }
 }
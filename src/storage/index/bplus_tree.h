@@ -1,7 +1,9 @@
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <optional>
+#include <span>
 #include <vector>
 
 #include "storage/index/bplus_tree_node.h"
@@ -19,12 +21,137 @@ namespace kizuna::index
             record_id_t value{0};
         };
 
+        /**
+         * Walks leaf entries in key order with only the current leaf pinned. A cursor
+         * opened by SeekRange stops (becomes invalid) when it steps past either bound,
+         * so callers can stop early without materializing the range. The tree must not
+         * be modified while a cursor is open.
+         */
+        class Cursor
+        {
+        public:
+            Cursor(Cursor &&other) noexcept;
+            Cursor &operator=(Cursor &&other) noexcept;
+            Cursor(const Cursor &) = delete;
+            Cursor &operator=(const Cursor &) = delete;
+            ~Cursor();
+
+            bool Valid() const noexcept { return view_.has_value(); }
+            /// The span points into the pinned leaf and is valid until the cursor moves.
+            std::span<const uint8_t> Key() const;
+            record_id_t Value() const;
+
+            void Next();
+            void Prev();
+
+        private:
+            friend class BPlusTree;
+
+            struct Bound
+            {
+                std::vector<uint8_t> key;
+                bool inclusive{true};
+            };
+
+            explicit Cursor(PageManager &pm) : pm_(&pm) {}
+
+            void Pin(page_id_t page_id, size_t index);
+            void Release() noexcept;
+            // Moves across leaf boundaries (skipping empty leaves) until the position
+            // holds an entry or the chain ends.
+            void SettleForward();
+            // Moves to the entry before the position, crossing into earlier leaves.
+            void StepBack();
+            bool AboveLower() const;
+            bool BelowUpper() const;
+
+            PageManager *pm_;
+            page_id_t page_id_{config::INVALID_PAGE_ID};
+            size_t index_{0};
+            std::optional<BPlusTreeNodeView> view_;
+            std::optional<Bound> lower_;
+            std::optional<Bound> upper_;
+        };
+
+        /**
+         * Builds an empty tree bottom-up from entries added in ascending key order.
+         * Leaves are filled to the fill factor one after another, and every level above
+         * grows alongside from the first keys of the level below, so each page is
+         * written once, parent pointer included. Equal keys throw DUPLICATE_KEY on a
+         * unique tree; otherwise the last value wins, as with Insert. The tree must not
+         * be used until Finish returns.
+         */
+        class BulkLoader
+        {
+        public:
+            void Add(std::span<const uint8_t> key, record_id_t value);
+            void Finish();
+
+        private:
+            friend class BPlusTree;
+
+            struct PendingNode
+            {
+                BPlusTreeNode node;
+                std::vector<uint8_t> first_key; // smallest key below the node
+            };
+            struct ChildRef
+            {
+                std::vector<uint8_t> first_key;
+                page_id_t page_id{config::INVALID_PAGE_ID};
+            };
+            // One level of the tree being built (0 = leaves). A node is written once two
+            // later siblings exist: until then closing the level may still move it under
+            // the last parent.
+            struct Level
+            {
+                std::deque<PendingNode> pending;
+                size_t node_count{0};
+                size_t node_bytes{0};
+                // A child that found the last node full; it opens the next node together
+                // with its successor, so no internal node is left without a separator.
+                std::optional<ChildRef> waiting;
+            };
+
+            BulkLoader(BPlusTree &tree, double fill_factor);
+
+            // Appends a started node to `level` and links it into the level above.
+            void StartNode(size_t level, std::vector<uint8_t> first_key, BPlusTreeNode node);
+            // Adds a child (a node of level - 1) to the last node of `level`.
+            void AddChild(size_t level, ChildRef child);
+            void OpenInternalNode(size_t level, ChildRef first, ChildRef second);
+            void SetChildParent(size_t level, page_id_t child, page_id_t parent);
+            // Writes the nodes of `level` that no later step can change.
+            void StoreSettled(size_t level);
+
+            BPlusTree &tree_;
+            size_t max_keys_;
+            size_t leaf_budget_;
+            size_t internal_budget_;
+            size_t leaf_bytes_{0};
+            std::vector<Level> levels_;
+        };
+
         BPlusTree(PageManager &pm, FileManager &fm, page_id_t root_page_id, bool unique);
 
         SearchResult Search(const std::vector<uint8_t> &key);
         void Insert(const std::vector<uint8_t> &key, record_id_t value);
         void Remove(const std::vector<uint8_t> &key, record_id_t value);
 
+        Cursor SeekFirst() const;
+        Cursor SeekLast() const;
+        /// Positioned at the first entry whose key is >= key.
+        Cursor Seek(std::span<const uint8_t> key) const;
+        /// Positioned at the first entry in range, or the last one when reverse is set.
+        Cursor SeekRange(const std::optional<std::vector<uint8_t>> &lower_key,
+                         bool lower_inclusive,
+                         const std::optional<std::vector<uint8_t>> &upper_key,
+                         bool upper_inclusive,
+                         bool reverse = false) const;
+
+        /// The tree must be empty; fill_factor is in (0, 1].
+        BulkLoader StartBulkLoad(double fill_factor = config::BTREE_BULK_FILL_FACTOR);
+
         std::vector<record_id_t> ScanEqual(const std::vector<uint8_t> &key) const;
         std::vector<record_id_t> ScanRange(const std::optional<std::vector<uint8_t>> &lower_key,
                                            bool lower_inclusive,
@@ -32,6 +159,8 @@ namespace kizuna::index
                                            bool upper_inclusive) const;
 
         page_id_t root_page_id() const noexcept { return root_page_id_; }
+        /// Number of levels from the root down to the leaves (1 for a lone leaf).
+        size_t Height() const;
         bool is_unique() const noexcept { return unique_; }
 
     private:
@@ -55,11 +184,11 @@ namespace kizuna::index
         void SplitLeaf(BPlusTreeNode &node, BPlusTreeNode &new_node, std::optional<std::vector<uint8_t>> &promoted_key);
         void SplitInternal(BPlusTreeNode &node, BPlusTreeNode &new_node, std::optional<std::vector<uint8_t>> &promoted_key);
 
-        size_t FindLeafIndex(const BPlusTreeNode &leaf, const std::vector<uint8_t> &key) const;
-        size_t FindInternalChild(const BPlusTreeNode &node, const std::vector<uint8_t> &key) const;
-        std::pair<page_id_t, size_t> FindLeafPosition(const std::vector<uint8_t> &key) const;
+        void SetParent(page_id_t page_id, page_id_t parent);
+        std::pair<page_id_t, size_t> FindLeafPosition(std::span<const uint8_t> key, bool inclusive) const;
         page_id_t FindLeftmostLeaf() const;
+        page_id_t FindRightmostLeaf() const;
 
-        static int CompareKeys(const std::vector<uint8_t> &lhs, const std::vector<uint8_t> &rhs);
+        static int CompareKeys(std::span<const uint8_t> lhs, std::span<const uint8_t> rhs);
     };
 }
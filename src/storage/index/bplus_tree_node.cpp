@@ -1,6 +1,7 @@
 ﻿#include "storage/index/bplus_tree_node.h"
 
 #include <algorithm>
+#include <array>
 #include <cstring>
 
 namespace kizuna::index
@@ -19,6 +20,10 @@ namespace kizuna::index
         {
             return page.data() + kPageHeaderSize;
         }
+
+        // Prefix search narrows by bisection until this many candidates remain, then
+        // counts them in one branch-free pass the compiler can vectorize.
+        constexpr size_t kPrefixScanWindow = 16;
     } // namespace
 
     constexpr size_t BPlusTreeNode::HeaderSize()
@@ -54,38 +59,34 @@ namespace kizuna::index
         if (keys > config::BTREE_MAX_KEYS)
             return true;
 
-        size_t key_bytes = 0;
+        size_t used = 0;
         if (type_ == NodeType::LEAF)
         {
             for (const auto &entry : leaf_entries_)
-                key_bytes += entry.key.size();
+                used += LeafEntrySize(entry.key.size());
         }
         else
         {
             for (const auto &entry : internal_entries_)
-                key_bytes += entry.key.size();
-        }
-
-        size_t pos = kPageHeaderSize + HeaderSize();
-        if (type_ == NodeType::LEAF)
-        {
-            pos += keys * sizeof(record_id_t);
-        }
-        else
-        {
-            pos += children_.size() * sizeof(page_id_t);
+                used += InternalEntrySize(entry.key.size());
         }
+        return used > EntryCapacity(type_);
+    }
 
-        if (pos > Page::page_size())
-            return true;
+    size_t BPlusTreeNode::LeafEntrySize(size_t key_size) noexcept
+    {
+        return sizeof(record_id_t) + sizeof(uint16_t) + sizeof(uint32_t) + sizeof(uint16_t) + key_size;
+    }
 
-        pos += keys * sizeof(uint16_t);
-        if (pos > Page::page_size())
-            return true;
+    size_t BPlusTreeNode::InternalEntrySize(size_t key_size) noexcept
+    {
+        return sizeof(page_id_t) + sizeof(uint16_t) + sizeof(uint32_t) + sizeof(uint16_t) + key_size;
+    }
 
-        const size_t available = Page::page_size() - pos;
-        const size_t required = key_bytes + keys * sizeof(uint16_t);
-        return required > available;
+    size_t BPlusTreeNode::EntryCapacity(NodeType type) noexcept
+    {
+        const size_t fixed = kPageHeaderSize + HeaderSize() + (type == NodeType::INTERNAL ? sizeof(page_id_t) : 0);
+        return kPageSize - fixed;
     }
 
     BPlusTreeNode::RawHeader BPlusTreeNode::ReadHeader(const Page &page)
@@ -142,6 +143,7 @@ namespace kizuna::index
         RawHeader header{};
         header.magic = kNodeMagic;
         header.node_type = static_cast<uint8_t>(type_);
+        header.flags = kFlagKeyPrefixes;
         header.key_count = static_cast<uint16_t>(keys);
         header.parent_page_id = parent_page_id_;
         header.next_leaf_page_id = (type_ == NodeType::LEAF) ? next_leaf_page_id_ : config::INVALID_PAGE_ID;
@@ -202,6 +204,8 @@ namespace kizuna::index
 
         uint16_t *offsets = reinterpret_cast<uint16_t *>(base + pos);
         pos += keys * sizeof(uint16_t);
+        uint8_t *prefixes = base + pos;
+        pos += keys * sizeof(uint32_t);
 
         size_t key_data_ptr = kPageSize;
         for (size_t i = 0; i < keys; ++i)
@@ -221,6 +225,8 @@ namespace kizuna::index
             }
             std::memcpy(base + key_data_ptr, &len, sizeof(uint16_t));
             offsets[i] = static_cast<uint16_t>(key_data_ptr - kPageHeaderSize);
+            const uint32_t prefix = BPlusTreeNodeView::KeyPrefix(key);
+            std::memcpy(prefixes + i * sizeof(uint32_t), &prefix, sizeof(uint32_t));
         }
 
         header.key_data_offset = static_cast<uint16_t>(key_data_ptr - kPageHeaderSize);
@@ -319,4 +325,335 @@ namespace kizuna::index
         return node;
     }
 
+    int CompareKeyBytes(std::span<const uint8_t> lhs, std::span<const uint8_t> rhs) noexcept
+    {
+        const size_t min_len = std::min(lhs.size(), rhs.size());
+        if (min_len > 0)
+        {
+            const int cmp = std::memcmp(lhs.data(), rhs.data(), min_len);
+            if (cmp != 0)
+                return cmp;
+        }
+        if (lhs.size() < rhs.size())
+            return -1;
+        if (lhs.size() > rhs.size())
+            return 1;
+        return 0;
+    }
+
+    BPlusTreeNodeView::BPlusTreeNodeView(Page &page)
+        : page_(page), header_(BPlusTreeNode::ReadHeader(page))
+    {
+    }
+
+    void BPlusTreeNodeView::set_parent(page_id_t parent)
+    {
+        header_.parent_page_id = parent;
+        FlushHeader();
+    }
+
+    void BPlusTreeNodeView::set_next_leaf(page_id_t next)
+    {
+        header_.next_leaf_page_id = next;
+        FlushHeader();
+    }
+
+    void BPlusTreeNodeView::set_prev_leaf(page_id_t prev)
+    {
+        header_.prev_leaf_page_id = prev;
+        FlushHeader();
+    }
+
+    size_t BPlusTreeNodeView::SlotSize() const noexcept
+    {
+        return is_leaf() ? sizeof(record_id_t) : sizeof(page_id_t);
+    }
+
+    size_t BPlusTreeNodeView::SlotCount(size_t keys) const noexcept
+    {
+        return is_leaf() ? keys : keys + 1;
+    }
+
+    size_t BPlusTreeNodeView::OffsetsPos(size_t keys) const noexcept
+    {
+        return kPageHeaderSize + BPlusTreeNode::HeaderSize() + SlotCount(keys) * SlotSize();
+    }
+
+    uint16_t BPlusTreeNodeView::OffsetAt(size_t index) const noexcept
+    {
+        uint16_t offset = 0;
+        std::memcpy(&offset, page_.data() + OffsetsPos(key_count()) + index * sizeof(uint16_t), sizeof(uint16_t));
+        return offset;
+    }
+
+    std::span<const uint8_t> BPlusTreeNodeView::KeyAt(size_t index) const
+    {
+        const size_t key_offset = OffsetAt(index);
+        const size_t node_bytes = kPageSize - kPageHeaderSize;
+        if (key_offset < BPlusTreeNode::HeaderSize() || key_offset + sizeof(uint16_t) > node_bytes)
+        {
+            KIZUNA_THROW_STORAGE(StatusCode::INVALID_RECORD_FORMAT, "Key offset out of range", std::to_string(key_offset));
+        }
+        const uint8_t *key_ptr = page_.data() + kPageHeaderSize + key_offset;
+        uint16_t len = 0;
+        std::memcpy(&len, key_ptr, sizeof(uint16_t));
+        if (len > config::MAX_KEY_LENGTH || key_offset + sizeof(uint16_t) + len > node_bytes)
+        {
+            KIZUNA_THROW_STORAGE(StatusCode::INVALID_RECORD_FORMAT, "Key length invalid", std::to_string(len));
+        }
+        return std::span<const uint8_t>(key_ptr + sizeof(uint16_t), len);
+    }
+
+    record_id_t BPlusTreeNodeView::ValueAt(size_t index) const
+    {
+        record_id_t value = 0;
+        std::memcpy(&value, page_.data() + kPageHeaderSize + BPlusTreeNode::HeaderSize() + index * sizeof(record_id_t), sizeof(record_id_t));
+        return value;
+    }
+
+    void BPlusTreeNodeView::SetValueAt(size_t index, record_id_t value)
+    {
+        std::memcpy(page_.data() + kPageHeaderSize + BPlusTreeNode::HeaderSize() + index * sizeof(record_id_t), &value, sizeof(record_id_t));
+    }
+
+    page_id_t BPlusTreeNodeView::ChildAt(size_t index) const
+    {
+        page_id_t child = config::INVALID_PAGE_ID;
+        std::memcpy(&child, page_.data() + kPageHeaderSize + BPlusTreeNode::HeaderSize() + index * sizeof(page_id_t), sizeof(page_id_t));
+        return child;
+    }
+
+    uint32_t BPlusTreeNodeView::KeyPrefix(std::span<const uint8_t> key) noexcept
+    {
+        uint32_t prefix = 0;
+        for (size_t i = 0; i < sizeof(uint32_t); ++i)
+        {
+            prefix <<= 8;
+            if (i < key.size())
+                prefix |= key[i];
+        }
+        return prefix;
+    }
+
+    size_t BPlusTreeNodeView::PrefixesPos(size_t keys) const noexcept
+    {
+        return OffsetsPos(keys) + keys * sizeof(uint16_t);
+    }
+
+    uint32_t BPlusTreeNodeView::PrefixAt(size_t index) const noexcept
+    {
+        uint32_t prefix = 0;
+        std::memcpy(&prefix, page_.data() + PrefixesPos(key_count()) + index * sizeof(uint32_t), sizeof(uint32_t));
+        return prefix;
+    }
+
+    size_t BPlusTreeNodeView::PrefixRank(uint32_t prefix, bool inclusive) const noexcept
+    {
+        size_t lo = 0;
+        size_t hi = key_count();
+        while (hi - lo > kPrefixScanWindow)
+        {
+            const size_t mid = lo + (hi - lo) / 2;
+            const uint32_t probe = PrefixAt(mid);
+            if (probe < prefix || (inclusive && probe == prefix))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        const uint8_t *window = page_.data() + PrefixesPos(key_count()) + lo * sizeof(uint32_t);
+        size_t below = 0;
+        for (size_t i = 0; i < hi - lo; ++i)
+        {
+            uint32_t probe = 0;
+            std::memcpy(&probe, window + i * sizeof(uint32_t), sizeof(uint32_t));
+            below += static_cast<size_t>(probe < prefix) | static_cast<size_t>(inclusive & (probe == prefix));
+        }
+        return lo + below;
+    }
+
+    size_t BPlusTreeNodeView::SearchKeys(size_t lo, size_t hi, std::span<const uint8_t> key, bool inclusive) const
+    {
+        while (lo < hi)
+        {
+            const size_t mid = lo + (hi - lo) / 2;
+            const int cmp = CompareKeyBytes(KeyAt(mid), key);
+            if (cmp < 0 || (inclusive && cmp == 0))
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    size_t BPlusTreeNodeView::LowerBound(std::span<const uint8_t> key) const
+    {
+        if (!has_key_prefixes())
+            return SearchKeys(0, key_count(), key, false);
+        // Only keys sharing the probe's prefix need a full comparison.
+        const uint32_t prefix = KeyPrefix(key);
+        return SearchKeys(PrefixRank(prefix, false), PrefixRank(prefix, true), key, false);
+    }
+
+    size_t BPlusTreeNodeView::UpperBound(std::span<const uint8_t> key) const
+    {
+        if (!has_key_prefixes())
+            return SearchKeys(0, key_count(), key, true);
+        const uint32_t prefix = KeyPrefix(key);
+        return SearchKeys(PrefixRank(prefix, false), PrefixRank(prefix, true), key, true);
+    }
+
+    bool BPlusTreeNodeView::InsertLeaf(size_t index, std::span<const uint8_t> key, record_id_t value)
+    {
+        if (!OpenGap(index, index, key))
+            return false;
+        SetValueAt(index, value);
+        return true;
+    }
+
+    bool BPlusTreeNodeView::InsertInternal(size_t index, std::span<const uint8_t> key, page_id_t right_child)
+    {
+        if (!OpenGap(index, index + 1, key))
+            return false;
+        std::memcpy(page_.data() + kPageHeaderSize + BPlusTreeNode::HeaderSize() + (index + 1) * sizeof(page_id_t), &right_child, sizeof(page_id_t));
+        return true;
+    }
+
+    void BPlusTreeNodeView::RemoveLeaf(size_t index)
+    {
+        const size_t keys = key_count();
+        if (index >= keys)
+        {
+            KIZUNA_THROW_STORAGE(StatusCode::INVALID_ARGUMENT, "Leaf index out of range", std::to_string(index));
+        }
+
+        // The key bytes become a hole unless they sit at the start of the key area;
+        // holes are reclaimed by Compact() when an insert runs short of space.
+        const std::span<const uint8_t> key = KeyAt(index);
+        if (OffsetAt(index) == header_.key_data_offset)
+            header_.key_data_offset = static_cast<uint16_t>(header_.key_data_offset + sizeof(uint16_t) + key.size());
+
+        uint8_t *base = page_.data();
+        const size_t slots = kPageHeaderSize + BPlusTreeNode::HeaderSize();
+        const size_t slot = SlotSize();
+        std::memmove(base + slots + index * slot, base + slots + (index + 1) * slot, (keys - index - 1) * slot);
+
+        const size_t old_offsets = OffsetsPos(keys);
+        const size_t new_offsets = OffsetsPos(keys - 1);
+        std::memmove(base + new_offsets, base + old_offsets, index * sizeof(uint16_t));
+        std::memmove(base + new_offsets + index * sizeof(uint16_t),
+                     base + old_offsets + (index + 1) * sizeof(uint16_t),
+                     (keys - index - 1) * sizeof(uint16_t));
+        if (has_key_prefixes())
+        {
+            const size_t old_prefixes = PrefixesPos(keys);
+            const size_t new_prefixes = PrefixesPos(keys - 1);
+            std::memmove(base + new_prefixes, base + old_prefixes, index * sizeof(uint32_t));
+            std::memmove(base + new_prefixes + index * sizeof(uint32_t),
+                         base + old_prefixes + (index + 1) * sizeof(uint32_t),
+                         (keys - index - 1) * sizeof(uint32_t));
+        }
+
+        header_.key_count = static_cast<uint16_t>(keys - 1);
+        if (header_.key_count == 0)
+            header_.key_data_offset = static_cast<uint16_t>(kPageSize - kPageHeaderSize);
+        FlushHeader();
+    }
+
+    bool BPlusTreeNodeView::OpenGap(size_t index, size_t slot_index, std::span<const uint8_t> key)
+    {
+        if (key.size() > config::MAX_KEY_LENGTH)
+        {
+            KIZUNA_THROW_STORAGE(StatusCode::INVALID_ARGUMENT, "Key length exceeds limit", std::to_string(key.size()));
+        }
+        const size_t keys = key_count();
+        if (index > keys)
+        {
+            KIZUNA_THROW_STORAGE(StatusCode::INVALID_ARGUMENT, "Insert index out of range", std::to_string(index));
+        }
+        if (keys + 1 > config::BTREE_MAX_KEYS)
+            return false;
+
+        const size_t record_bytes = sizeof(uint16_t) + key.size();
+        const size_t prefix_bytes = has_key_prefixes() ? sizeof(uint32_t) : 0;
+        const size_t arrays_end = OffsetsPos(keys + 1) + (keys + 1) * (sizeof(uint16_t) + prefix_bytes);
+        if (kPageHeaderSize + header_.key_data_offset < arrays_end + record_bytes)
+        {
+            Compact();
+            if (kPageHeaderSize + header_.key_data_offset < arrays_end + record_bytes)
+                return false;
+        }
+
+        uint8_t *base = page_.data();
+        const size_t slots = kPageHeaderSize + BPlusTreeNode::HeaderSize();
+        const size_t slot = SlotSize();
+        const size_t old_offsets = OffsetsPos(keys);
+        const size_t new_offsets = old_offsets + slot;
+
+        // Every array after the slots moves up to make room for the one before it. Go
+        // from the last array to the first, and within each move the part past the gap
+        // first, so nothing is overwritten before it is copied.
+        if (prefix_bytes > 0)
+        {
+            const size_t old_prefixes = PrefixesPos(keys);
+            const size_t new_prefixes = PrefixesPos(keys + 1);
+            std::memmove(base + new_prefixes + (index + 1) * sizeof(uint32_t),
+                         base + old_prefixes + index * sizeof(uint32_t),
+                         (keys - index) * sizeof(uint32_t));
+            std::memmove(base + new_prefixes, base + old_prefixes, index * sizeof(uint32_t));
+            const uint32_t prefix = KeyPrefix(key);
+            std::memcpy(base + new_prefixes + index * sizeof(uint32_t), &prefix, sizeof(uint32_t));
+        }
+        std::memmove(base + new_offsets + (index + 1) * sizeof(uint16_t),
+                     base + old_offsets + index * sizeof(uint16_t),
+                     (keys - index) * sizeof(uint16_t));
+        std::memmove(base + new_offsets, base + old_offsets, index * sizeof(uint16_t));
+        std::memmove(base + slots + (slot_index + 1) * slot,
+                     base + slots + slot_index * slot,
+                     (SlotCount(keys) - slot_index) * slot);
+
+        const size_t key_pos = kPageHeaderSize + header_.key_data_offset - record_bytes;
+        const uint16_t len = static_cast<uint16_t>(key.size());
+        std::memcpy(base + key_pos, &len, sizeof(uint16_t));
+        if (!key.empty())
+            std::memcpy(base + key_pos + sizeof(uint16_t), key.data(), key.size());
+        const uint16_t key_offset = static_cast<uint16_t>(key_pos - kPageHeaderSize);
+        std::memcpy(base + new_offsets + index * sizeof(uint16_t), &key_offset, sizeof(uint16_t));
+
+        header_.key_data_offset = key_offset;
+        header_.key_count = static_cast<uint16_t>(keys + 1);
+        FlushHeader();
+        return true;
+    }
+
+    void BPlusTreeNodeView::Compact()
+    {
+        const size_t keys = key_count();
+        std::array<uint8_t, kPageSize> packed;
+        std::array<uint16_t, config::BTREE_MAX_KEYS> offsets;
+        size_t pos = kPageSize;
+        for (size_t i = 0; i < keys; ++i)
+        {
+            const std::span<const uint8_t> key = KeyAt(i);
+            pos -= key.size();
+            if (!key.empty())
+                std::memcpy(packed.data() + pos, key.data(), key.size());
+            pos -= sizeof(uint16_t);
+            const uint16_t len = static_cast<uint16_t>(key.size());
+            std::memcpy(packed.data() + pos, &len, sizeof(uint16_t));
+            offsets[i] = static_cast<uint16_t>(pos - kPageHeaderSize);
+        }
+
+        // Live keys never need more room than the fragmented area they came from.
+        uint8_t *base = page_.data();
+        std::memcpy(base + pos, packed.data() + pos, kPageSize - pos);
+        std::memcpy(base + OffsetsPos(keys), offsets.data(), keys * sizeof(uint16_t));
+        header_.key_data_offset = static_cast<uint16_t>(pos - kPageHeaderSize);
+        FlushHeader();
+    }
+
+    void BPlusTreeNodeView::FlushHeader()
+    {
+        BPlusTreeNode::WriteHeader(page_, header_);
+    }
+
 } // namespace kizuna::index
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
@@ -39,6 +40,8 @@ namespace kizuna::index
         };
 
         static constexpr uint32_t kNodeMagic = 0x4B5A4958; // 'KZIX'
+        /// Node carries a big-endian 4-byte prefix per key after the offset array.
+        static constexpr uint8_t kFlagKeyPrefixes = 0x01;
 
         static BPlusTreeNode MakeLeaf(page_id_t page_id);
         static BPlusTreeNode MakeInternal(page_id_t page_id);
@@ -71,7 +74,16 @@ namespace kizuna::index
         size_t key_count() const noexcept;
         bool requires_split() const noexcept;
 
+        /// Page bytes a leaf entry takes: value slot, key offset, key prefix and key record.
+        static size_t LeafEntrySize(size_t key_size) noexcept;
+        /// Page bytes an internal entry takes, including the child slot to its right.
+        static size_t InternalEntrySize(size_t key_size) noexcept;
+        /// Bytes left for entries in an empty node (an internal node's first child included).
+        static size_t EntryCapacity(NodeType type) noexcept;
+
     private:
+        friend class BPlusTreeNodeView;
+
         static constexpr size_t HeaderSize();
 
         BPlusTreeNode(NodeType type, page_id_t page_id) noexcept;
@@ -80,7 +92,7 @@ namespace kizuna::index
         {
             uint32_t magic;
             uint8_t node_type;
-            uint8_t reserved;
+            uint8_t flags;
             uint16_t key_count;
             page_id_t parent_page_id;
             page_id_t next_leaf_page_id;
@@ -101,6 +113,70 @@ namespace kizuna::index
         std::vector<page_id_t> children_; // size = key_count + 1 for internal nodes
     };
 
+    /// Byte-wise key order used by the tree: memcmp, shorter key first on a tie.
+    int CompareKeyBytes(std::span<const uint8_t> lhs, std::span<const uint8_t> rhs) noexcept;
+
+    /**
+     * Node access directly on a pinned page in the BPlusTreeNode::Serialize layout.
+     * Keys are binary-searched through the offset array without being copied, and
+     * single-entry inserts and removes shift the arrays in place. Nothing here
+     * allocates; an insert that would need a split reports false instead.
+     */
+    class BPlusTreeNodeView
+    {
+    public:
+        using NodeType = BPlusTreeNode::NodeType;
+
+        explicit BPlusTreeNodeView(Page &page);
+
+        NodeType node_type() const noexcept { return static_cast<NodeType>(header_.node_type); }
+        bool is_leaf() const noexcept { return node_type() == NodeType::LEAF; }
+        bool has_key_prefixes() const noexcept { return (header_.flags & BPlusTreeNode::kFlagKeyPrefixes) != 0; }
+        size_t key_count() const noexcept { return header_.key_count; }
+        page_id_t parent_page_id() const noexcept { return header_.parent_page_id; }
+        page_id_t next_leaf() const noexcept { return header_.next_leaf_page_id; }
+        page_id_t prev_leaf() const noexcept { return header_.prev_leaf_page_id; }
+
+        void set_parent(page_id_t parent);
+        void set_next_leaf(page_id_t next);
+        void set_prev_leaf(page_id_t prev);
+
+        std::span<const uint8_t> KeyAt(size_t index) const;
+        record_id_t ValueAt(size_t index) const;
+        void SetValueAt(size_t index, record_id_t value);
+        page_id_t ChildAt(size_t index) const;
+
+        /// First index whose key is >= key (leaf position).
+        size_t LowerBound(std::span<const uint8_t> key) const;
+        /// First index whose key is > key; for internal nodes this is the child to follow.
+        size_t UpperBound(std::span<const uint8_t> key) const;
+
+        /// Order-preserving 4-byte prefix of a key (big-endian, zero padded).
+        static uint32_t KeyPrefix(std::span<const uint8_t> key) noexcept;
+
+        /// Inserts at index; returns false when the node would overflow and must split.
+        bool InsertLeaf(size_t index, std::span<const uint8_t> key, record_id_t value);
+        /// Inserts key at index with right_child as child index + 1.
+        bool InsertInternal(size_t index, std::span<const uint8_t> key, page_id_t right_child);
+        void RemoveLeaf(size_t index);
+
+    private:
+        size_t SlotSize() const noexcept;
+        size_t SlotCount(size_t keys) const noexcept;
+        size_t OffsetsPos(size_t keys) const noexcept;
+        uint16_t OffsetAt(size_t index) const noexcept;
+        size_t PrefixesPos(size_t keys) const noexcept;
+        uint32_t PrefixAt(size_t index) const noexcept;
+        size_t PrefixRank(uint32_t prefix, bool inclusive) const noexcept;
+        size_t SearchKeys(size_t lo, size_t hi, std::span<const uint8_t> key, bool inclusive) const;
+        bool OpenGap(size_t index, size_t slot_index, std::span<const uint8_t> key);
+        void Compact();
+        void FlushHeader();
+
+        Page &page_;
+        BPlusTreeNode::RawHeader header_{};
+    };
+
 } // namespace kizuna::index
 
 
@@ -1,11 +1,12 @@
 #include "storage/index/index_manager.h"
 
+#include <algorithm>
 #include <system_error>
 
 namespace kizuna::index
 {
-    IndexManager::IndexManager(std::filesystem::path base_dir)
-        : base_dir_(std::move(base_dir))
+    IndexManager::IndexManager(std::filesystem::path base_dir, BufferPool *buffer_pool, std::size_t handle_capacity)
+        : base_dir_(std::move(base_dir)), buffer_pool_(buffer_pool), handle_capacity_(std::max<std::size_t>(1, handle_capacity))
     {
         if (base_dir_.empty())
         {
@@ -15,25 +16,43 @@ namespace kizuna::index
         std::filesystem::create_directories(base_dir_, ec);
     }
 
-    std::unique_ptr<IndexHandle> IndexManager::CreateIndex(const catalog::IndexCatalogEntry &entry)
+    std::shared_ptr<IndexHandle> IndexManager::CreateIndex(const catalog::IndexCatalogEntry &entry)
     {
-        auto handle = MakeHandle(entry, /*create_if_missing=*/true);
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        // A rebuilt index reuses its id; the old handle must go before the file is recreated.
+        Forget(entry.index_id);
+        std::shared_ptr<IndexHandle> handle = MakeHandle(entry, /*create_if_missing=*/true);
 
         BPlusTree &tree = handle->tree();
         if (tree.root_page_id() == config::INVALID_PAGE_ID)
         {
             KIZUNA_THROW_INDEX(StatusCode::INTERNAL_ERROR, "Failed to initialize index root", entry.name);
         }
+        Remember(entry.index_id, handle);
         return handle;
     }
 
-    std::unique_ptr<IndexHandle> IndexManager::OpenIndex(const catalog::IndexCatalogEntry &entry) const
+    std::shared_ptr<IndexHandle> IndexManager::OpenIndex(const catalog::IndexCatalogEntry &entry) const
     {
-        return MakeHandle(entry, /*create_if_missing=*/false);
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        auto it = handles_.find(entry.index_id);
+        if (it != handles_.end())
+        {
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            std::shared_ptr<IndexHandle> handle = it->second.handle;
+            // Handles skipped while in use close once the cache is touched again.
+            CloseIdleHandles();
+            return handle;
+        }
+        std::shared_ptr<IndexHandle> handle = MakeHandle(entry, /*create_if_missing=*/false);
+        Remember(entry.index_id, handle);
+        return handle;
     }
 
     void IndexManager::DropIndex(const catalog::IndexCatalogEntry &entry) const
     {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        Forget(entry.index_id);
         const auto path = FileManager::index_path(entry.index_id, base_dir_);
         if (FileManager::exists(path))
         {
@@ -41,6 +60,46 @@ namespace kizuna::index
         }
     }
 
+    std::size_t IndexManager::cached_handle_count() const
+    {
+        std::lock_guard<std::mutex> lock(cache_mutex_);
+        return handles_.size();
+    }
+
+    void IndexManager::Remember(index_id_t id, const std::shared_ptr<IndexHandle> &handle) const
+    {
+        lru_.push_front(id);
+        handles_[id] = CachedHandle{handle, lru_.begin()};
+        CloseIdleHandles();
+    }
+
+    void IndexManager::Forget(index_id_t id) const
+    {
+        auto it = handles_.find(id);
+        if (it == handles_.end())
+        {
+            return;
+        }
+        lru_.erase(it->second.lru);
+        handles_.erase(it);
+    }
+
+    void IndexManager::CloseIdleHandles() const
+    {
+        // Walk from the cold end; handles a caller still holds stay open.
+        for (auto pos = lru_.end(); handles_.size() > handle_capacity_ && pos != lru_.begin();)
+        {
+            --pos;
+            auto it = handles_.find(*pos);
+            if (it->second.handle.use_count() > 1)
+            {
+                continue;
+            }
+            pos = lru_.erase(pos);
+            handles_.erase(it);
+        }
+    }
+
     std::unique_ptr<IndexHandle> IndexManager::MakeHandle(const catalog::IndexCatalogEntry &entry, bool create_if_missing) const
     {
         const auto path = FileManager::index_path(entry.index_id, base_dir_);
@@ -52,7 +111,8 @@ namespace kizuna::index
         auto fm = std::make_unique<FileManager>(path.string(), create_if_missing);
         fm->open();
 
-        auto pm = std::make_unique<PageManager>(*fm, config::DEFAULT_CACHE_SIZE);
+        auto pm = buffer_pool_ ? std::make_unique<PageManager>(*fm, *buffer_pool_)
+                               : std::make_unique<PageManager>(*fm, config::DEFAULT_CACHE_SIZE);
 
         page_id_t root_page = entry.root_page_id;
         auto tree = std::make_unique<BPlusTree>(*pm, *fm, root_page, entry.is_unique);
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <filesystem>
+#include <list>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <unordered_map>
 
@@ -34,19 +36,45 @@ namespace kizuna::index
         std::unique_ptr<BPlusTree> tree_;
     };
 
+    // Handles stay open in a cache keyed by index_id, so statements reuse the open
+    // file and a warm page cache. CreateIndex replaces the cached handle and DropIndex
+    // evicts it; past `handle_capacity` open handles the least recently used idle one
+    // is closed. A handle still held by a caller is never closed, so one index file is
+    // never open twice. Dirty index pages are written back when a handle is evicted or
+    // the manager is destroyed.
     class IndexManager
     {
     public:
-        IndexManager(std::filesystem::path base_dir = config::default_index_dir());
+        // With a buffer_pool, index pages are cached there (it must outlive the manager);
+        // otherwise every handle gets a private cache of DEFAULT_CACHE_SIZE frames.
+        IndexManager(std::filesystem::path base_dir = config::default_index_dir(), BufferPool *buffer_pool = nullptr,
+                     std::size_t handle_capacity = config::INDEX_HANDLE_CACHE_SIZE);
 
-        std::unique_ptr<IndexHandle> CreateIndex(const catalog::IndexCatalogEntry &entry);
-        std::unique_ptr<IndexHandle> OpenIndex(const catalog::IndexCatalogEntry &entry) const;
+        std::shared_ptr<IndexHandle> CreateIndex(const catalog::IndexCatalogEntry &entry);
+        std::shared_ptr<IndexHandle> OpenIndex(const catalog::IndexCatalogEntry &entry) const;
         void DropIndex(const catalog::IndexCatalogEntry &entry) const;
 
+        std::size_t cached_handle_count() const;
+
     private:
         std::filesystem::path base_dir_;
+        BufferPool *buffer_pool_;
+        std::size_t handle_capacity_;
+
+        struct CachedHandle
+        {
+            std::shared_ptr<IndexHandle> handle;
+            std::list<index_id_t>::iterator lru; // position in lru_
+        };
+        mutable std::mutex cache_mutex_;
+        mutable std::unordered_map<index_id_t, CachedHandle> handles_;
+        mutable std::list<index_id_t> lru_; // most recently used first
 
         std::unique_ptr<IndexHandle> MakeHandle(const catalog::IndexCatalogEntry &entry, bool create_if_missing) const;
+        // The following require cache_mutex_ to be held.
+        void Remember(index_id_t id, const std::shared_ptr<IndexHandle> &handle) const;
+        void Forget(index_id_t id) const;
+        void CloseIdleHandles() const;
     };
 }
 
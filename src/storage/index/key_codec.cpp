@@ -0,0 +1,128 @@
+#include "storage/index/key_codec.h"
+
+#include <bit>
+
+#include "common/exception.h"
+
+namespace kizuna::index
+{
+    void KeyEncoder::append_null()
+    {
+        bytes_.push_back(kNullTag);
+    }
+
+    void KeyEncoder::append_bool(bool value)
+    {
+        bytes_.push_back(kValueTag);
+        bytes_.push_back(value ? 1 : 0);
+    }
+
+    void KeyEncoder::append_int32(int32_t value)
+    {
+        bytes_.push_back(kValueTag);
+        append_big_endian(static_cast<uint32_t>(value) ^ 0x80000000u, sizeof(uint32_t));
+    }
+
+    void KeyEncoder::append_int64(int64_t value)
+    {
+        bytes_.push_back(kValueTag);
+        append_big_endian(static_cast<uint64_t>(value) ^ 0x8000000000000000ull, sizeof(uint64_t));
+    }
+
+    void KeyEncoder::append_double(double value)
+    {
+        if (value == 0.0)
+        {
+            value = 0.0;
+        }
+        uint64_t bits = std::bit_cast<uint64_t>(value);
+        if (bits & 0x8000000000000000ull)
+        {
+            bits = ~bits;
+        }
+        else
+        {
+            bits ^= 0x8000000000000000ull;
+        }
+        bytes_.push_back(kValueTag);
+        append_big_endian(bits, sizeof(uint64_t));
+    }
+
+    void KeyEncoder::append_string(std::string_view value)
+    {
+        bytes_.push_back(kValueTag);
+        bytes_.reserve(bytes_.size() + value.size() + 2);
+        for (char c : value)
+        {
+            const auto byte = static_cast<uint8_t>(c);
+            bytes_.push_back(byte);
+            if (byte == 0x00)
+            {
+                bytes_.push_back(0xFF);
+            }
+        }
+        bytes_.push_back(0x00);
+        bytes_.push_back(0x00);
+    }
+
+    void KeyEncoder::append_value(DataType type, const Value &value)
+    {
+        if (value.is_null())
+        {
+            append_null();
+            return;
+        }
+
+        switch (type)
+        {
+        case DataType::BOOLEAN:
+            append_bool(value.as_bool());
+            break;
+        case DataType::INTEGER:
+            append_int32(value.as_int32());
+            break;
+        case DataType::BIGINT:
+        case DataType::DATE:
+        case DataType::TIMESTAMP:
+            append_int64(value.as_int64());
+            break;
+        case DataType::FLOAT:
+        case DataType::DOUBLE:
+            append_double(value.as_double());
+            break;
+        case DataType::VARCHAR:
+        case DataType::TEXT:
+            append_string(value.as_string());
+            break;
+        default:
+            throw QueryException::unsupported_type("Unsupported index column type");
+        }
+    }
+
+    void KeyEncoder::append_record_id(record_id_t record_id)
+    {
+        append_big_endian(record_id, sizeof(record_id_t));
+    }
+
+    void KeyEncoder::append_big_endian(uint64_t bits, std::size_t width)
+    {
+        for (std::size_t i = width; i-- > 0;)
+        {
+            bytes_.push_back(static_cast<uint8_t>(bits >> (i * 8)));
+        }
+    }
+
+    std::vector<uint8_t> encode_index_key(const std::vector<catalog::ColumnCatalogEntry> &key_columns,
+                                          const std::vector<Value> &values,
+                                          std::optional<record_id_t> record_id)
+    {
+        KeyEncoder key;
+        for (std::size_t i = 0; i < key_columns.size(); ++i)
+        {
+            key.append_value(key_columns[i].column.type, values[i]);
+        }
+        if (record_id)
+            key.append_record_id(*record_id);
+        return key.take();
+    }
+} // namespace kizuna::index
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/types.h"
+#include "common/value.h"
+
+namespace kizuna::index
+{
+    // Builds memcomparable index keys: comparing two encoded keys byte by byte
+    // (CompareKeyBytes) gives the same order as comparing the column values.
+    //
+    // Every column starts with a tag byte, kValueTag or kNullTag, so NULLs sort
+    // after any value of the column, as ORDER BY places them. Changing the byte
+    // layout needs a new catalog::CURRENT_INDEX_KEY_FORMAT so existing indexes are
+    // rebuilt. Values follow the tag:
+    //   - integers: big-endian with the sign bit flipped
+    //   - doubles:  IEEE bits, sign bit flipped for positives, all bits
+    //               inverted for negatives (-0.0 is folded into 0.0)
+    //   - strings:  bytes with 0x00 escaped as 0x00 0xFF, terminated by
+    //               0x00 0x00, so a prefix sorts before its extensions
+    class KeyEncoder
+    {
+    public:
+        static constexpr uint8_t kValueTag = 0x01;
+        static constexpr uint8_t kNullTag = 0x02;
+        // Appended to an encoded key prefix, sorts after every key that extends it.
+        static constexpr uint8_t kPrefixEnd = 0xFF;
+
+        void append_null();
+        void append_bool(bool value);
+        void append_int32(int32_t value);
+        void append_int64(int64_t value);
+        void append_double(double value);
+        void append_string(std::string_view value);
+
+        // Appends a value already coerced to the column type; throws for
+        // types that cannot be indexed.
+        void append_value(DataType type, const Value &value);
+        // Appends the big-endian record id after the columns of a non-unique index
+        // key, so rows with equal values stay distinct, ordered entries.
+        void append_record_id(record_id_t record_id);
+
+        const std::vector<uint8_t> &bytes() const noexcept { return bytes_; }
+        std::vector<uint8_t> take() noexcept { return std::move(bytes_); }
+
+    private:
+        void append_big_endian(uint64_t bits, std::size_t width);
+
+        std::vector<uint8_t> bytes_;
+    };
+
+    // The key of an index over `key_columns` for `values` already coerced to the column
+    // types. Non-unique index keys end with the row's record id; pass it for those.
+    std::vector<uint8_t> encode_index_key(const std::vector<catalog::ColumnCatalogEntry> &key_columns,
+                                          const std::vector<Value> &values,
+                                          std::optional<record_id_t> record_id = std::nullopt);
+} // namespace kizuna::index
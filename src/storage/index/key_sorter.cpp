@@ -0,0 +1,171 @@
+#include "storage/index/key_sorter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <queue>
+#include <string>
+
+#include "common/exception.h"
+#include "storage/index/bplus_tree_node.h"
+
+namespace kizuna::index
+{
+    namespace
+    {
+        std::filesystem::path next_run_path(const void *owner)
+        {
+            static std::atomic<uint64_t> counter{0};
+            const auto tag = std::to_string(reinterpret_cast<uintptr_t>(owner)) + "_" + std::to_string(counter.fetch_add(1));
+            return config::temp_dir() / ("index_sort_" + tag + ".run");
+        }
+
+        // Run files hold [len u16][key bytes][value u64] records in native byte order;
+        // they never outlive the sorter that wrote them.
+        class RunReader
+        {
+        public:
+            explicit RunReader(const std::filesystem::path &path)
+                : in_(path, std::ios::binary)
+            {
+                if (!in_)
+                {
+                    KIZUNA_THROW_IO(StatusCode::READ_ERROR, "Cannot open index sort run", path.string());
+                }
+            }
+
+            bool Next()
+            {
+                uint16_t len = 0;
+                if (!in_.read(reinterpret_cast<char *>(&len), sizeof(len)))
+                    return false;
+                key_.resize(len);
+                if (!in_.read(reinterpret_cast<char *>(key_.data()), len) ||
+                    !in_.read(reinterpret_cast<char *>(&value_), sizeof(value_)))
+                {
+                    KIZUNA_THROW_IO(StatusCode::FILE_CORRUPTED, "Index sort run truncated", "");
+                }
+                return true;
+            }
+
+            std::span<const uint8_t> key() const noexcept { return key_; }
+            record_id_t value() const noexcept { return value_; }
+
+        private:
+            std::ifstream in_;
+            std::vector<uint8_t> key_;
+            record_id_t value_{0};
+        };
+    } // namespace
+
+    KeySorter::KeySorter(size_t memory_budget)
+        : memory_budget_(memory_budget)
+    {
+    }
+
+    KeySorter::~KeySorter()
+    {
+        RemoveRuns();
+    }
+
+    void KeySorter::Add(std::span<const uint8_t> key, record_id_t value)
+    {
+        if (key.size() > std::numeric_limits<uint16_t>::max())
+        {
+            KIZUNA_THROW_INDEX(StatusCode::INVALID_ARGUMENT, "Index key too long", std::to_string(key.size()));
+        }
+        buffer_.push_back(Entry{std::vector<uint8_t>(key.begin(), key.end()), value});
+        buffered_bytes_ += sizeof(Entry) + key.size();
+        if (buffered_bytes_ >= memory_budget_)
+            SpillRun();
+    }
+
+    void KeySorter::Drain(const std::function<void(std::span<const uint8_t>, record_id_t)> &fn)
+    {
+        if (runs_.empty())
+        {
+            SortBuffer();
+            for (const auto &entry : buffer_)
+                fn(entry.key, entry.value);
+            buffer_.clear();
+            buffered_bytes_ = 0;
+            return;
+        }
+
+        if (!buffer_.empty())
+            SpillRun();
+
+        std::vector<std::unique_ptr<RunReader>> readers;
+        readers.reserve(runs_.size());
+        for (const auto &path : runs_)
+            readers.push_back(std::make_unique<RunReader>(path));
+
+        // Min-heap over the head of each run; ties go to the earlier run to keep add order.
+        auto later = [&](size_t lhs, size_t rhs)
+        {
+            int cmp = CompareKeyBytes(readers[lhs]->key(), readers[rhs]->key());
+            return cmp != 0 ? cmp > 0 : lhs > rhs;
+        };
+        std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heads(later);
+        for (size_t i = 0; i < readers.size(); ++i)
+        {
+            if (readers[i]->Next())
+                heads.push(i);
+        }
+        while (!heads.empty())
+        {
+            const size_t run = heads.top();
+            heads.pop();
+            fn(readers[run]->key(), readers[run]->value());
+            if (readers[run]->Next())
+                heads.push(run);
+        }
+
+        readers.clear();
+        RemoveRuns();
+    }
+
+    void KeySorter::SortBuffer()
+    {
+        std::stable_sort(buffer_.begin(), buffer_.end(), [](const Entry &lhs, const Entry &rhs)
+                         { return CompareKeyBytes(lhs.key, rhs.key) < 0; });
+    }
+
+    void KeySorter::SpillRun()
+    {
+        SortBuffer();
+        auto path = next_run_path(this);
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            KIZUNA_THROW_IO(StatusCode::WRITE_ERROR, "Cannot create index sort run", path.string());
+        }
+        runs_.push_back(path);
+        for (const auto &entry : buffer_)
+        {
+            const auto len = static_cast<uint16_t>(entry.key.size());
+            out.write(reinterpret_cast<const char *>(&len), sizeof(len));
+            out.write(reinterpret_cast<const char *>(entry.key.data()), len);
+            out.write(reinterpret_cast<const char *>(&entry.value), sizeof(entry.value));
+        }
+        if (!out.flush())
+        {
+            KIZUNA_THROW_IO(StatusCode::WRITE_ERROR, "Index sort run write failed", path.string());
+        }
+        buffer_.clear();
+        buffered_bytes_ = 0;
+    }
+
+    void KeySorter::RemoveRuns() noexcept
+    {
+        for (const auto &path : runs_)
+        {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+        runs_.clear();
+    }
+} // namespace kizuna::index
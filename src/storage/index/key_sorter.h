@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <vector>
+
+#include "common/config.h"
+#include "common/types.h"
+
+namespace kizuna::index
+{
+    /**
+     * Sorts (key, record id) pairs for an index build. Pairs are buffered up to a
+     * memory budget; a full buffer is sorted and spilled as a run file under
+     * config::temp_dir(), and Drain merges the runs. Equal keys come out in the order
+     * they were added, so a later duplicate still overrides an earlier one.
+     */
+    class KeySorter
+    {
+    public:
+        explicit KeySorter(size_t memory_budget = config::INDEX_BUILD_SORT_MEMORY);
+        ~KeySorter();
+
+        KeySorter(const KeySorter &) = delete;
+        KeySorter &operator=(const KeySorter &) = delete;
+
+        void Add(std::span<const uint8_t> key, record_id_t value);
+        /// Feeds every pair in key order and leaves the sorter empty.
+        void Drain(const std::function<void(std::span<const uint8_t>, record_id_t)> &fn);
+
+        size_t run_count() const noexcept { return runs_.size(); }
+
+    private:
+        struct Entry
+        {
+            std::vector<uint8_t> key;
+            record_id_t value{0};
+        };
+
+        void SortBuffer();
+        void SpillRun();
+        void RemoveRuns() noexcept;
+
+        size_t memory_budget_;
+        size_t buffered_bytes_{0};
+        std::vector<Entry> buffer_;
+        std::vector<std::filesystem::path> runs_;
+    };
+} // namespace kizuna::index
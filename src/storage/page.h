@@ -1,9 +1,13 @@
 #pragma once
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 #include <cstring>
+#include <optional>
+#include <span>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "common/types.h"
@@ -114,29 +118,36 @@ namespace kizuna
                 h.free_space_offset = static_cast<uint16_t>(kHeaderSize);
             }
 
-            const size_t needed = static_cast<size_t>(len) + 2 + slot_size();
-            if (needed > free_bytes())
-                return false;
-
-            const size_t used_slots_after = static_cast<size_t>(h.slot_count + 1) * slot_size();
-            const size_t records_limit = page_size() - used_slots_after;
-            size_t record_start = h.free_space_offset;
-            if (record_start + 2 + static_cast<size_t>(len) > records_limit)
-                return false;
-
-            uint8_t *base = data();
-            base[record_start + 0] = static_cast<uint8_t>(len & 0xFF);
-            base[record_start + 1] = static_cast<uint8_t>((len >> 8) & 0xFF);
-            std::memcpy(base + record_start + 2, payload, len);
+            // A tombstoned slot is reused before the directory grows; RIDs of live rows never move.
+            std::optional<slot_id_t> reuse = first_free_slot();
+            const size_t record_bytes = static_cast<size_t>(len) + 2;
+            if (!fits_contiguous(record_bytes, reuse.has_value()))
+            {
+                if (!fits_after_compaction(record_bytes, reuse.has_value()))
+                    return false;
+                compact();
+                reuse = first_free_slot();
+                if (!fits_contiguous(record_bytes, reuse.has_value()))
+                    return false;
+            }
 
-            uint16_t slot_offset = static_cast<uint16_t>(record_start);
-            const size_t slot_pos = page_size() - ((static_cast<size_t>(h.slot_count) + 1) * slot_size());
-            std::memcpy(base + slot_pos, &slot_offset, sizeof(slot_offset));
+            const size_t record_start = h.free_space_offset;
+            write_record(record_start, payload, len);
 
-            h.slot_count += 1;
+            slot_id_t slot = 0;
+            if (reuse)
+            {
+                slot = *reuse;
+            }
+            else
+            {
+                slot = static_cast<slot_id_t>(h.slot_count);
+                h.slot_count += 1;
+            }
+            set_slot_offset(slot, static_cast<uint16_t>(record_start));
             h.record_count += 1;
-            out_slot = static_cast<slot_id_t>(h.slot_count - 1);
-            h.free_space_offset = static_cast<uint16_t>(record_start + 2 + len);
+            out_slot = slot;
+            h.free_space_offset = static_cast<uint16_t>(record_start + record_bytes);
             return true;
         }
 
@@ -169,6 +180,26 @@ namespace kizuna
             return true;
         }
 
+        // Zero-copy variant of read: out points into this page and is valid only while
+        // the page stays pinned and unmodified.
+        bool view(slot_id_t slot, std::span<const uint8_t> &out) const
+        {
+            const auto &h = header();
+            if (slot >= h.slot_count) return false;
+            const uint16_t record_off = slot_offset(slot);
+            if (record_off == kTombstone) return false;
+            size_t records_end = h.free_space_offset;
+            if (records_end < kHeaderSize || records_end > page_size())
+            {
+                records_end = kHeaderSize;
+            }
+            if (static_cast<size_t>(record_off) + 2 > records_end) return false;
+            const uint16_t len = record_length(record_off);
+            if (static_cast<size_t>(record_off) + 2 + len > records_end) return false;
+            out = std::span<const uint8_t>(data() + record_off + 2, len);
+            return true;
+        }
+
         bool erase(slot_id_t slot)
         {
             auto &h = header();
@@ -233,7 +264,22 @@ namespace kizuna
             if (record_off == 0xFFFF) return false;
             const uint16_t current_len = static_cast<uint16_t>(base[record_off]) | (static_cast<uint16_t>(base[record_off + 1]) << 8);
             if (len > current_len)
-                return false;
+            {
+                // Growing rows move inside the page so the slot (and the RID) stays put.
+                const size_t record_bytes = static_cast<size_t>(len) + 2;
+                if (!fits_contiguous(record_bytes, true))
+                {
+                    const size_t live_after = live_record_bytes() - (static_cast<size_t>(current_len) + 2) + record_bytes;
+                    if (kHeaderSize + live_after + static_cast<size_t>(h.slot_count) * slot_size() > page_size())
+                        return false;
+                    defragment(slot);
+                }
+                const size_t record_start = h.free_space_offset;
+                write_record(record_start, payload, len);
+                set_slot_offset(slot, static_cast<uint16_t>(record_start));
+                h.free_space_offset = static_cast<uint16_t>(record_start + record_bytes);
+                return true;
+            }
             base[record_off + 0] = static_cast<uint8_t>(len & 0xFF);
             base[record_off + 1] = static_cast<uint8_t>((len >> 8) & 0xFF);
             std::memcpy(base + record_off + 2, payload, len);
@@ -244,7 +290,138 @@ namespace kizuna
             return true;
         }
 
+        // Bytes a new record could use once dead space is squeezed out (same slot
+        // accounting as free_bytes, so free_bytes() <= reclaimable_bytes()).
+        size_t reclaimable_bytes() const
+        {
+            const auto &h = header();
+            const size_t used = kHeaderSize + live_record_bytes() + (static_cast<size_t>(h.slot_count) + 1) * slot_size();
+            return used >= page_size() ? 0 : page_size() - used;
+        }
+
+        // Slides live records together at the start of the record area, drops trailing
+        // tombstoned slots and zeroes the reclaimed bytes. Slot numbers are unchanged.
+        void compact()
+        {
+            defragment(kNoSlot);
+            auto &h = header();
+            while (h.slot_count > 0 && slot_offset(static_cast<slot_id_t>(h.slot_count - 1)) == kTombstone)
+            {
+                set_slot_offset(static_cast<slot_id_t>(h.slot_count - 1), 0);
+                h.slot_count -= 1;
+            }
+        }
+
     private:
+        static constexpr uint16_t kTombstone = 0xFFFF;
+        static constexpr size_t kNoSlot = static_cast<size_t>(-1);
+
+        uint16_t slot_offset(slot_id_t slot) const
+        {
+            uint16_t off = 0;
+            std::memcpy(&off, data() + page_size() - ((static_cast<size_t>(slot) + 1) * slot_size()), sizeof(off));
+            return off;
+        }
+
+        void set_slot_offset(slot_id_t slot, uint16_t off)
+        {
+            std::memcpy(data() + page_size() - ((static_cast<size_t>(slot) + 1) * slot_size()), &off, sizeof(off));
+        }
+
+        uint16_t record_length(uint16_t off) const
+        {
+            const uint8_t *base = data();
+            return static_cast<uint16_t>(base[off]) | (static_cast<uint16_t>(base[off + 1]) << 8);
+        }
+
+        void write_record(size_t off, const uint8_t *payload, uint16_t len)
+        {
+            uint8_t *base = data();
+            base[off + 0] = static_cast<uint8_t>(len & 0xFF);
+            base[off + 1] = static_cast<uint8_t>((len >> 8) & 0xFF);
+            std::memcpy(base + off + 2, payload, len);
+        }
+
+        std::optional<slot_id_t> first_free_slot() const
+        {
+            const auto &h = header();
+            if (h.record_count >= h.slot_count)
+                return std::nullopt;
+            for (slot_id_t s = 0; s < h.slot_count; ++s)
+            {
+                if (slot_offset(s) == kTombstone)
+                    return s;
+            }
+            return std::nullopt;
+        }
+
+        size_t live_record_bytes() const
+        {
+            const auto &h = header();
+            size_t total = 0;
+            for (slot_id_t s = 0; s < h.slot_count; ++s)
+            {
+                const uint16_t off = slot_offset(s);
+                if (off == kTombstone)
+                    continue;
+                total += static_cast<size_t>(record_length(off)) + 2;
+            }
+            return total;
+        }
+
+        bool fits_contiguous(size_t record_bytes, bool reuse_slot) const
+        {
+            const auto &h = header();
+            const size_t slots = static_cast<size_t>(h.slot_count) + (reuse_slot ? 0 : 1);
+            const size_t dir_bytes = slots * slot_size();
+            if (dir_bytes > page_size())
+                return false;
+            return h.free_space_offset + record_bytes <= page_size() - dir_bytes;
+        }
+
+        bool fits_after_compaction(size_t record_bytes, bool reuse_slot) const
+        {
+            const auto &h = header();
+            const size_t slots = static_cast<size_t>(h.slot_count) + (reuse_slot ? 0 : 1);
+            return kHeaderSize + live_record_bytes() + record_bytes + slots * slot_size() <= page_size();
+        }
+
+        // Moves every live record except skip_slot down to the start of the record area.
+        // skip_slot keeps its (now stale) offset; the caller rewrites it right after.
+        void defragment(size_t skip_slot)
+        {
+            auto &h = header();
+            std::vector<std::pair<uint16_t, slot_id_t>> live;
+            live.reserve(h.record_count);
+            for (slot_id_t s = 0; s < h.slot_count; ++s)
+            {
+                const uint16_t off = slot_offset(s);
+                if (off == kTombstone || static_cast<size_t>(s) == skip_slot)
+                    continue;
+                live.emplace_back(off, s);
+            }
+            std::sort(live.begin(), live.end());
+
+            uint8_t *base = data();
+            size_t cursor = kHeaderSize;
+            for (const auto &[off, s] : live)
+            {
+                const size_t bytes = static_cast<size_t>(record_length(off)) + 2;
+                if (off != cursor)
+                {
+                    std::memmove(base + cursor, base + off, bytes);
+                    set_slot_offset(s, static_cast<uint16_t>(cursor));
+                }
+                cursor += bytes;
+            }
+            const size_t old_end = h.free_space_offset;
+            if (old_end > cursor)
+            {
+                std::memset(base + cursor, 0, old_end - cursor);
+            }
+            h.free_space_offset = static_cast<uint16_t>(cursor);
+        }
+
         std::array<uint8_t, config::PAGE_SIZE> storage_{};
     };
 }
@@ -4,117 +4,112 @@
 
 namespace kizuna
 {
-    PageManager::PageManager(FileManager &fm, std::size_t capacity)
-        : fm_(fm), capacity_(capacity ? capacity : 1), frames_(capacity_)
+    PageManager::PageManager(FileManager &fm, std::size_t capacity, std::size_t shard_count, ReplacementPolicyKind policy)
+        : fm_(fm),
+          own_pool_(std::make_unique<BufferPool>(capacity, shard_count, policy)),
+          pool_(*own_pool_)
     {
-        init_metadata_if_needed();
-        load_metadata();
+        open();
+    }
+
+    PageManager::PageManager(FileManager &fm, BufferPool &pool)
+        : fm_(fm), pool_(pool)
+    {
+        open();
+    }
+
+    void PageManager::open()
+    {
+        file_id_ = pool_.register_file(*this);
+        try
+        {
+            init_metadata_if_needed();
+            load_metadata();
+        }
+        catch (...)
+        {
+            pool_.unregister_file(*this);
+            throw;
+        }
     }
 
     PageManager::~PageManager()
     {
         try { flush_all(); } catch (...) { /* best-effort */ }
+        pool_.unregister_file(*this);
     }
 
     page_id_t PageManager::new_page(PageType type)
     {
         page_id_t id = 0;
-        if (first_trunk_id_ != 0 && free_count_ > 0)
         {
-            // Try to pop from head trunk
-            page_id_t leaf = 0;
-            if (trunk_pop_leaf(first_trunk_id_, leaf))
+            std::lock_guard<std::mutex> meta_guard(meta_mutex_);
+            if (first_trunk_id_ != 0 && free_count_ > 0)
             {
-                // Got a leaf page id
-                id = leaf;
-                free_count_--;
-                save_metadata();
+                // Try to pop from head trunk
+                page_id_t leaf = 0;
+                if (trunk_pop_leaf(first_trunk_id_, leaf))
+                {
+                    // Got a leaf page id
+                    id = leaf;
+                    free_count_--;
+                    save_metadata();
+                }
+                else
+                {
+                    // Head trunk had no leaves; use trunk page itself
+                    uint32_t next = trunk_next(first_trunk_id_);
+                    id = first_trunk_id_;
+                    first_trunk_id_ = next;
+                    free_count_--;
+                    save_metadata();
+                }
             }
             else
             {
-                // Head trunk had no leaves; use trunk page itself
-                uint32_t next = trunk_next(first_trunk_id_);
-                id = first_trunk_id_;
-                first_trunk_id_ = next;
-                free_count_--;
-                save_metadata();
+                // Append new page at file end
+                id = disk_allocate();
             }
         }
-        else
-        {
-            // Append new page at file end
-            id = fm_.allocate_page();
-        }
 
-        // Get a frame (pinned). Initialize header
-        const std::size_t idx = obtain_frame_for(id, /*pin*/ true);
-        auto &fr = frames_[idx];
-        std::memset(fr.page.data(), 0, config::PAGE_SIZE);
-        fr.page.init(type, id);
-        fr.dirty = true;
-        flush(id);
-        fr.dirty = false;
-        unpin(id, /*dirty*/ false);
+        pool_.create_page(*this, id, type);
         return id;
     }
 
-    Page &PageManager::fetch(page_id_t id, bool pin)
+    Page &PageManager::fetch(page_id_t id, bool pin, BufferAccessStrategy *strategy)
     {
         if (id < config::FIRST_PAGE_ID)
         {
             KIZUNA_THROW_STORAGE(StatusCode::PAGE_NOT_FOUND, "Invalid page id", std::to_string(id));
         }
+        return pool_.fetch(*this, id, pin, strategy);
+    }
 
-        auto it = page_table_.find(id);
-        if (it != page_table_.end())
+    std::size_t PageManager::prefetch(page_id_t first, std::size_t count, BufferAccessStrategy *strategy)
+    {
+        if (first < config::FIRST_PAGE_ID || count == 0)
         {
-            auto &fr = frames_[it->second];
-            if (pin)
-            {
-                if (fr.pin_count == 0 && fr.in_lru)
-                {
-                    lru_.erase(fr.lru_it);
-                    fr.in_lru = false;
-                }
-                fr.pin_count++;
-            }
-            else
-            {
-                // touch LRU if unpinned
-                if (fr.pin_count == 0)
-                {
-                    if (fr.in_lru)
-                    {
-                        lru_.erase(fr.lru_it);
-                    }
-                    lru_.push_front(id);
-                    fr.lru_it = lru_.begin();
-                    fr.in_lru = true;
-                }
-            }
-            return fr.page;
+            return 0;
         }
-
-        // Load from disk into a frame
-        const std::size_t idx = obtain_frame_for(id, pin);
-        auto &fr = frames_[idx];
-        try
+        count = std::min(count, prefetch_limit(strategy));
+        uint64_t file_pages = 0;
         {
-            fm_.read_page(id, fr.page.data());
+            std::lock_guard<std::mutex> io_guard(io_mutex_);
+            file_pages = fm_.page_count();
         }
-        catch (const DBException &)
+        if (first > file_pages)
         {
-            // release the frame since load failed
-            page_table_.erase(id);
-            fr.id = 0;
-            if (fr.pin_count == 0 && fr.in_lru)
-            {
-                lru_.erase(fr.lru_it);
-                fr.in_lru = false;
-            }
-            throw;
+            return 0;
         }
-        return fr.page;
+        count = static_cast<std::size_t>(std::min<uint64_t>(count, file_pages - first + 1));
+        const std::size_t loaded = pool_.load_range(*this, first, count, strategy);
+        fm_.advise_willneed(static_cast<page_id_t>(first + count), count);
+        return loaded;
+    }
+
+    std::size_t PageManager::prefetch_limit(const BufferAccessStrategy *strategy) const noexcept
+    {
+        return pool_.prefetch_limit(strategy);
     }
 
     Page &PageManager::fetch_catalog_root(bool pin)
@@ -129,39 +124,12 @@ namespace kizuna
     }
     void PageManager::unpin(page_id_t id, bool dirty)
     {
-        auto it = page_table_.find(id);
-        if (it == page_table_.end())
-        {
-            KIZUNA_THROW_STORAGE(StatusCode::PAGE_NOT_FOUND, "Unpin unknown page", std::to_string(id));
-        }
-        auto &fr = frames_[it->second];
-        if (fr.pin_count == 0)
-        {
-            KIZUNA_THROW_STORAGE(StatusCode::PAGE_LOCKED, "Unpin already unpinned", std::to_string(id));
-        }
-        fr.pin_count--;
-        if (dirty) fr.dirty = true;
-        if (fr.pin_count == 0)
-        {
-            // move to LRU front
-            if (fr.in_lru)
-            {
-                lru_.erase(fr.lru_it);
-            }
-            lru_.push_front(id);
-            fr.lru_it = lru_.begin();
-            fr.in_lru = true;
-        }
+        pool_.unpin(*this, id, dirty);
     }
 
     void PageManager::mark_dirty(page_id_t id)
     {
-        auto it = page_table_.find(id);
-        if (it == page_table_.end())
-        {
-            KIZUNA_THROW_STORAGE(StatusCode::PAGE_NOT_FOUND, "Mark dirty unknown page", std::to_string(id));
-        }
-        frames_[it->second].dirty = true;
+        pool_.mark_dirty(*this, id);
     }
 
     void PageManager::free_page(page_id_t id)
@@ -170,13 +138,16 @@ namespace kizuna
         {
             KIZUNA_THROW_STORAGE(StatusCode::INVALID_ARGUMENT, "Cannot free reserved page", std::to_string(id));
         }
-        // Mark page as FREE on disk
+        // Mark page as FREE on disk. Write it through now so a later eviction of the
+        // cached copy cannot clobber the trunk header written below.
         {
             Page &pg = fetch(id, /*pin*/ true);
             std::memset(pg.data(), 0, config::PAGE_SIZE);
             pg.init(PageType::FREE, id);
             unpin(id, /*dirty*/ true);
+            flush(id);
         }
+        std::lock_guard<std::mutex> meta_guard(meta_mutex_);
         // Add to freelist: either append to head trunk leaves or create a new head trunk
         if (first_trunk_id_ != 0)
         {
@@ -184,7 +155,7 @@ namespace kizuna
             size_t cap = trunk_capacity();
             // Read current leaf_count
             Page trunk;
-            fm_.read_page(first_trunk_id_, trunk.data());
+            disk_read(first_trunk_id_, trunk.data());
             uint8_t *tb = trunk.data();
             size_t off = sizeof(PageHeader);
             uint32_t next = 0, leaf_count = 0;
@@ -195,7 +166,7 @@ namespace kizuna
                 std::memcpy(tb + off + trunk_header_size() + leaf_count * 4, &id, 4);
                 leaf_count++;
                 std::memcpy(tb + off + 4, &leaf_count, 4);
-                fm_.write_page(first_trunk_id_, trunk.data());
+                disk_write(first_trunk_id_, trunk.data());
             }
             else
             {
@@ -218,97 +189,60 @@ namespace kizuna
 
     void PageManager::flush(page_id_t id)
     {
-        auto it = page_table_.find(id);
-        if (it == page_table_.end())
-        {
-            // Not cached, nothing to do
-            return;
-        }
-        auto &fr = frames_[it->second];
-        if (fr.dirty)
-        {
-            fm_.write_page(fr.id, fr.page.data());
-            fr.dirty = false;
-        }
+        pool_.flush(*this, id);
     }
 
     void PageManager::flush_all()
     {
-        for (auto &kv : page_table_)
-        {
-            auto &fr = frames_[kv.second];
-            if (fr.dirty)
-            {
-                fm_.write_page(fr.id, fr.page.data());
-                fr.dirty = false;
-            }
-        }
+        pool_.flush_file(*this);
+        // flush_all is the durability point: page writes themselves are not synced.
+        std::lock_guard<std::mutex> io_guard(io_mutex_);
+        fm_.sync();
     }
 
-    std::size_t PageManager::find_free_frame() const
+    void PageManager::enable_async_io(std::size_t queue_depth)
     {
-        for (std::size_t i = 0; i < frames_.size(); ++i)
-        {
-            if (frames_[i].id == 0)
-            {
-                return i;
-            }
-        }
-        return static_cast<std::size_t>(-1);
+        std::lock_guard<std::mutex> io_guard(io_mutex_);
+        async_io_ = std::make_unique<AsyncIoEngine>(fm_, queue_depth);
     }
 
-    std::size_t PageManager::evict_frame()
+    void PageManager::disk_read(page_id_t id, uint8_t *out)
     {
-        // Choose LRU tail
-        if (lru_.empty())
+        if (fm_.supports_concurrent_io())
         {
-            KIZUNA_THROW_STORAGE(StatusCode::CACHE_FULL, "No unpinned pages to evict", "");
+            fm_.read_page(id, out);
+            return;
         }
-        const page_id_t victim_id = lru_.back();
-        lru_.pop_back();
+        std::lock_guard<std::mutex> io_guard(io_mutex_);
+        fm_.read_page(id, out);
+    }
 
-        auto it = page_table_.find(victim_id);
-        if (it == page_table_.end())
-        {
-            KIZUNA_THROW_STORAGE(StatusCode::INTERNAL_ERROR, "LRU victim not in page table", std::to_string(victim_id));
-        }
-        std::size_t idx = it->second;
-        auto &fr = frames_[idx];
-        if (fr.pin_count != 0)
-        {
-            KIZUNA_THROW_STORAGE(StatusCode::INTERNAL_ERROR, "Evicting pinned page", std::to_string(victim_id));
-        }
-        if (fr.dirty)
+    void PageManager::disk_write(page_id_t id, const uint8_t *data)
+    {
+        if (fm_.supports_concurrent_io())
         {
-            fm_.write_page(fr.id, fr.page.data());
-            fr.dirty = false;
+            fm_.write_page(id, data);
+            return;
         }
-        page_table_.erase(it);
-        fr.id = 0;
-        fr.in_lru = false;
-        return idx;
+        std::lock_guard<std::mutex> io_guard(io_mutex_);
+        fm_.write_page(id, data);
     }
 
-    std::size_t PageManager::obtain_frame_for(page_id_t id, bool pin)
+    void PageManager::disk_read_pages(page_id_t first, uint8_t *const *out, std::size_t count)
     {
-        auto free_idx = find_free_frame();
-        std::size_t idx = (free_idx == static_cast<std::size_t>(-1)) ? evict_frame() : free_idx;
-        auto &fr = frames_[idx];
-        fr.id = id;
-        fr.dirty = false;
-        fr.pin_count = pin ? 1 : 0;
-        if (!pin)
-        {
-            lru_.push_front(id);
-            fr.lru_it = lru_.begin();
-            fr.in_lru = true;
-        }
-        else
+        if (fm_.supports_concurrent_io())
         {
-            fr.in_lru = false;
+            fm_.read_pages(first, out, count);
+            return;
         }
-        page_table_[id] = idx;
-        return idx;
+        std::lock_guard<std::mutex> io_guard(io_mutex_);
+        fm_.read_pages(first, out, count);
+    }
+
+    page_id_t PageManager::disk_allocate()
+    {
+        std::lock_guard<std::mutex> io_guard(io_mutex_);
+        return fm_.allocate_page();
     }
 
     // --- metadata + free list persistence ---
@@ -317,24 +251,24 @@ namespace kizuna
         if (fm_.page_count() == 0)
         {
             // Create metadata page at id 1
-            const page_id_t meta_id = fm_.allocate_page(); // should be 1
+            const page_id_t meta_id = disk_allocate(); // should be 1
             (void)meta_id;
 
             // Allocate root pages for catalog tables/columns
             Page tables;
-            catalog_tables_root_ = fm_.allocate_page();
+            catalog_tables_root_ = disk_allocate();
             tables.init(PageType::DATA, catalog_tables_root_);
-            fm_.write_page(catalog_tables_root_, tables.data());
+            disk_write(catalog_tables_root_, tables.data());
 
             Page columns;
-            catalog_columns_root_ = fm_.allocate_page();
+            catalog_columns_root_ = disk_allocate();
             columns.init(PageType::DATA, catalog_columns_root_);
-            fm_.write_page(catalog_columns_root_, columns.data());
+            disk_write(catalog_columns_root_, columns.data());
 
             Page indexes;
-            catalog_indexes_root_ = fm_.allocate_page();
+            catalog_indexes_root_ = disk_allocate();
             indexes.init(PageType::DATA, catalog_indexes_root_);
-            fm_.write_page(catalog_indexes_root_, indexes.data());
+            disk_write(catalog_indexes_root_, indexes.data());
 
 
             first_trunk_id_ = 0;
@@ -349,7 +283,7 @@ namespace kizuna
     void PageManager::load_metadata()
     {
         Page meta;
-        fm_.read_page(config::FIRST_PAGE_ID, meta.data());
+        disk_read(config::FIRST_PAGE_ID, meta.data());
         const uint8_t *b = meta.data();
         const size_t off = sizeof(PageHeader);
         uint32_t magic = 0;
@@ -412,25 +346,25 @@ namespace kizuna
         if (catalog_tables_root_ == 0)
         {
             Page tables;
-            catalog_tables_root_ = fm_.allocate_page();
+            catalog_tables_root_ = disk_allocate();
             tables.init(PageType::DATA, catalog_tables_root_);
-            fm_.write_page(catalog_tables_root_, tables.data());
+            disk_write(catalog_tables_root_, tables.data());
             metadata_dirty = true;
         }
         if (catalog_columns_root_ == 0)
         {
             Page columns;
-            catalog_columns_root_ = fm_.allocate_page();
+            catalog_columns_root_ = disk_allocate();
             columns.init(PageType::DATA, catalog_columns_root_);
-            fm_.write_page(catalog_columns_root_, columns.data());
+            disk_write(catalog_columns_root_, columns.data());
             metadata_dirty = true;
         }
         if (catalog_indexes_root_ == 0)
         {
             Page indexes;
-            catalog_indexes_root_ = fm_.allocate_page();
+            catalog_indexes_root_ = disk_allocate();
             indexes.init(PageType::DATA, catalog_indexes_root_);
-            fm_.write_page(catalog_indexes_root_, indexes.data());
+            disk_write(catalog_indexes_root_, indexes.data());
             metadata_dirty = true;
         }
         if (next_table_id_ == 0)
@@ -454,7 +388,7 @@ namespace kizuna
     void PageManager::save_metadata()
     {
         Page meta;
-        fm_.read_page(config::FIRST_PAGE_ID, meta.data());
+        disk_read(config::FIRST_PAGE_ID, meta.data());
         uint8_t *b = meta.data();
         const size_t off = sizeof(PageHeader);
         const uint32_t magic = 0x4B5A464D; // 'KZFM'
@@ -470,52 +404,57 @@ namespace kizuna
         std::memcpy(b + off + 28, &next_table_raw, 4);
         uint32_t next_index_raw = static_cast<uint32_t>(next_index_id_);
         std::memcpy(b + off + 32, &next_index_raw, 4);
-        fm_.write_page(config::FIRST_PAGE_ID, meta.data());
+        disk_write(config::FIRST_PAGE_ID, meta.data());
     }
     void PageManager::set_catalog_tables_root(page_id_t id)
     {
+        std::lock_guard<std::mutex> meta_guard(meta_mutex_);
         catalog_tables_root_ = id;
         save_metadata();
     }
 
     void PageManager::set_catalog_columns_root(page_id_t id)
     {
+        std::lock_guard<std::mutex> meta_guard(meta_mutex_);
         catalog_columns_root_ = id;
         save_metadata();
     }
 
     void PageManager::set_catalog_indexes_root(page_id_t id)
     {
+        std::lock_guard<std::mutex> meta_guard(meta_mutex_);
         catalog_indexes_root_ = id;
         save_metadata();
     }
 
     void PageManager::set_next_index_id(index_id_t id)
     {
+        std::lock_guard<std::mutex> meta_guard(meta_mutex_);
         next_index_id_ = id;
         save_metadata();
     }
 
     void PageManager::set_next_table_id(table_id_t id)
     {
+        std::lock_guard<std::mutex> meta_guard(meta_mutex_);
         next_table_id_ = id;
         save_metadata();
     }
     void PageManager::trunk_write_new(page_id_t trunk_id, uint32_t next_trunk, uint32_t leaf_count)
     {
         Page pg;
-        fm_.read_page(trunk_id, pg.data());
+        disk_read(trunk_id, pg.data());
         uint8_t *b = pg.data();
         const size_t off = sizeof(PageHeader);
         std::memcpy(b + off + 0, &next_trunk, 4);
         std::memcpy(b + off + 4, &leaf_count, 4);
-        fm_.write_page(trunk_id, pg.data());
+        disk_write(trunk_id, pg.data());
     }
 
     void PageManager::trunk_append_leaf(page_id_t trunk_id, page_id_t leaf_id)
     {
         Page pg;
-        fm_.read_page(trunk_id, pg.data());
+        disk_read(trunk_id, pg.data());
         uint8_t *b = pg.data();
         const size_t off = sizeof(PageHeader);
         uint32_t leaf_count = 0;
@@ -527,13 +466,13 @@ namespace kizuna
         std::memcpy(b + off + trunk_header_size() + leaf_count * 4, &leaf_id, 4);
         leaf_count++;
         std::memcpy(b + off + 4, &leaf_count, 4);
-        fm_.write_page(trunk_id, pg.data());
+        disk_write(trunk_id, pg.data());
     }
 
     bool PageManager::trunk_pop_leaf(page_id_t trunk_id, page_id_t &out_leaf)
     {
         Page pg;
-        fm_.read_page(trunk_id, pg.data());
+        disk_read(trunk_id, pg.data());
         uint8_t *b = pg.data();
         const size_t off = sizeof(PageHeader);
         uint32_t leaf_count = 0;
@@ -543,14 +482,14 @@ namespace kizuna
         leaf_count--;
         std::memcpy(&out_leaf, b + off + trunk_header_size() + leaf_count * 4, 4);
         std::memcpy(b + off + 4, &leaf_count, 4);
-        fm_.write_page(trunk_id, pg.data());
+        disk_write(trunk_id, pg.data());
         return true;
     }
 
     uint32_t PageManager::trunk_next(page_id_t trunk_id)
     {
         Page pg;
-        fm_.read_page(trunk_id, pg.data());
+        disk_read(trunk_id, pg.data());
         const uint8_t *b = pg.data();
         const size_t off = sizeof(PageHeader);
         uint32_t next = 0;
@@ -2,24 +2,36 @@
 
 #include <cstddef>
 #include <cstdint>
-#include <unordered_map>
-#include <list>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 #include "common/types.h"
 #include "common/config.h"
 #include "common/exception.h"
 #include "common/logger.h"
+#include "storage/async_io.h"
+#include "storage/buffer_pool.h"
 #include "storage/file_manager.h"
 #include "storage/page.h"
+#include "storage/replacement_policy.h"
 
 namespace kizuna
 {
-    // Minimal page cache with LRU eviction and pin/unpin
+    // Per-file page access: allocation, the on-disk free list and file metadata, with
+    // cached reads and writes going through a BufferPool. By default each PageManager
+    // owns a private pool of `capacity` frames; pass a shared pool to let several files
+    // (tables and indexes) compete for one set of frames. Either way the file registers
+    // with its pool for its lifetime.
     class PageManager
     {
     public:
-        explicit PageManager(FileManager &fm, std::size_t capacity = config::DEFAULT_CACHE_SIZE);
+        explicit PageManager(FileManager &fm,
+                             std::size_t capacity = config::DEFAULT_CACHE_SIZE,
+                             std::size_t shard_count = config::BUFFER_POOL_DEFAULT_SHARDS,
+                             ReplacementPolicyKind policy = ReplacementPolicyKind::LRU);
+        // Caches pages in `pool`, which must outlive this PageManager.
+        PageManager(FileManager &fm, BufferPool &pool);
         ~PageManager();
 
         // Non-copyable
@@ -30,7 +42,15 @@ namespace kizuna
         page_id_t new_page(PageType type);
 
         // Fetch page into cache (pins by default). Throws if not present on disk.
-        Page &fetch(page_id_t id, bool pin = true);
+        // Misses fetched through a strategy are loaded into that strategy's ring.
+        Page &fetch(page_id_t id, bool pin = true, BufferAccessStrategy *strategy = nullptr);
+        // Read-ahead: load the uncached pages of [first, first + count) unpinned, reading
+        // each run of adjacent misses with a single request, and hint the following range
+        // to the OS. Best-effort; the window is clamped so it cannot wash out the cache
+        // (or the strategy's ring). Returns the number of pages loaded.
+        std::size_t prefetch(page_id_t first, std::size_t count, BufferAccessStrategy *strategy = nullptr);
+        // Largest window prefetch() will load for this strategy (or the shared pool).
+        std::size_t prefetch_limit(const BufferAccessStrategy *strategy = nullptr) const noexcept;
         // Shortcut to load the catalog metadata page (page 1).
         Page &fetch_catalog_root(bool pin = true);
 
@@ -59,25 +79,35 @@ namespace kizuna
         void flush(page_id_t id);
         void flush_all();
 
-        std::size_t capacity() const noexcept { return capacity_; }
+        // Route bulk write-back and prefetch() read-ahead through an AsyncIoEngine so many
+        // requests stay in flight. Falls back to synchronous I/O where io_uring is
+        // unavailable; read-ahead then keeps its coalesced reads.
+        void enable_async_io(std::size_t queue_depth = config::ASYNC_IO_QUEUE_DEPTH);
+        bool async_io_enabled() const noexcept { return async_io_ != nullptr; }
+        AsyncIoBackend async_io_backend() const noexcept
+        {
+            return async_io_ ? async_io_->backend() : AsyncIoBackend::SYNC;
+        }
+
+        std::size_t capacity() const noexcept { return pool_.capacity(); }
+        std::size_t shard_count() const noexcept { return pool_.shard_count(); }
+        ReplacementPolicyKind policy() const noexcept { return pool_.policy(); }
+        // Counters of the pool, which include other files' pages when it is shared.
+        BufferPoolStats stats() { return pool_.stats(); }
+        void reset_stats() { pool_.reset_stats(); }
         uint32_t free_count() const noexcept { return free_count_; }
 
-    private:
-        struct Frame
-        {
-            page_id_t id{0};
-            Page page{};
-            bool dirty{false};
-            std::size_t pin_count{0};
-            std::list<page_id_t>::iterator lru_it{};
-            bool in_lru{false};
-        };
+        BufferPool &pool() noexcept { return pool_; }
+        file_id_t file_id() const noexcept { return file_id_; }
 
+    private:
         FileManager &fm_;
-        std::size_t capacity_;
-        std::vector<Frame> frames_;
-        std::unordered_map<page_id_t, std::size_t> page_table_; // id -> frame index
-        std::list<page_id_t> lru_;                               // unpinned pages, front = most recent
+        std::unique_ptr<BufferPool> own_pool_; // set when no shared pool was given
+        BufferPool &pool_;
+        file_id_t file_id_{0};
+        std::mutex meta_mutex_; // metadata fields + freelist trunks
+        std::mutex io_mutex_;   // serializes allocation/sync, and all I/O on the fstream backend
+        std::unique_ptr<AsyncIoEngine> async_io_; // guarded by io_mutex_
         // SQLite-like freelist using trunk pages
         // Metadata (page 1) stores: magic, version, first_trunk_id, free_count
         uint32_t first_trunk_id_{0};
@@ -106,9 +136,15 @@ namespace kizuna
         bool trunk_pop_leaf(page_id_t trunk_id, page_id_t &out_leaf);
         uint32_t trunk_next(page_id_t trunk_id);
 
-        std::size_t obtain_frame_for(page_id_t id, bool pin);
-        std::size_t evict_frame();
-        std::size_t find_free_frame() const;
+        // Disk helpers (serialize access to fm_)
+        void disk_read(page_id_t id, uint8_t *out);
+        void disk_write(page_id_t id, const uint8_t *data);
+        void disk_read_pages(page_id_t first, uint8_t *const *out, std::size_t count);
+        page_id_t disk_allocate();
+
+        void open();
+
+        friend class BufferPool;
     };
 }
 
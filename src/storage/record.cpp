@@ -15,6 +15,11 @@ namespace kizuna::record
             buf.push_back(static_cast<std::uint8_t>((v >> 8) & 0xFF));
         }
 
+        inline std::uint16_t load_u16(const std::uint8_t *p) noexcept
+        {
+            return static_cast<std::uint16_t>(p[0]) | static_cast<std::uint16_t>(static_cast<std::uint16_t>(p[1]) << 8);
+        }
+
         inline bool read_u16(const std::uint8_t *&p, const std::uint8_t *end, std::uint16_t &out)
         {
             if (p + 2 > end) return false;
@@ -49,6 +54,11 @@ namespace kizuna::record
             const std::uint8_t bit = static_cast<std::uint8_t>(1u << (index % 8));
             return (bitmap[byte_index] & bit) != 0;
         }
+
+        // V2 header: [0x8000 | count u16][format u8][reserved u8][fixed_bytes u16][var_count u16]
+        constexpr std::uint16_t kV2Marker = 0x8000;
+        constexpr std::size_t kV2HeaderSize = 8;
+        constexpr std::size_t kV2MaxFields = kV2Marker - 1;
     } // namespace
 
     Field from_null(DataType declared_type)
@@ -122,84 +132,214 @@ namespace kizuna::record
         return f;
     }
 
-    std::vector<std::uint8_t> encode(const std::vector<Field> &fields)
+    namespace
     {
-        const std::size_t count = fields.size();
-        if (count > std::numeric_limits<std::uint16_t>::max())
+        std::vector<std::uint8_t> encode_v1(const std::vector<Field> &fields)
         {
-            KIZUNA_THROW_RECORD(StatusCode::INVALID_ARGUMENT, "Too many fields", std::to_string(count));
-        }
+            const std::size_t count = fields.size();
+            if (count > std::numeric_limits<std::uint16_t>::max())
+            {
+                KIZUNA_THROW_RECORD(StatusCode::INVALID_ARGUMENT, "Too many fields", std::to_string(count));
+            }
 
-        const std::size_t bitmap_len = nullmap_bytes(count);
-        if (bitmap_len > std::numeric_limits<std::uint16_t>::max())
-        {
-            KIZUNA_THROW_RECORD(StatusCode::INVALID_ARGUMENT, "Null bitmap too large", std::to_string(bitmap_len));
-        }
+            const std::size_t bitmap_len = nullmap_bytes(count);
+            if (bitmap_len > std::numeric_limits<std::uint16_t>::max())
+            {
+                KIZUNA_THROW_RECORD(StatusCode::INVALID_ARGUMENT, "Null bitmap too large", std::to_string(bitmap_len));
+            }
 
-        std::vector<std::uint8_t> bitmap(bitmap_len, 0);
-        for (std::size_t i = 0; i < count; ++i)
-        {
-            if (fields[i].is_null)
+            std::vector<std::uint8_t> bitmap(bitmap_len, 0);
+            for (std::size_t i = 0; i < count; ++i)
             {
-                if (!fields[i].payload.empty())
+                if (fields[i].is_null)
                 {
-                    KIZUNA_THROW_RECORD(StatusCode::INVALID_ARGUMENT, "Null field had payload", std::to_string(i));
+                    if (!fields[i].payload.empty())
+                    {
+                        KIZUNA_THROW_RECORD(StatusCode::INVALID_ARGUMENT, "Null field had payload", std::to_string(i));
+                    }
+                    set_null_bit(bitmap, i);
                 }
-                set_null_bit(bitmap, i);
             }
-        }
 
-        std::vector<std::uint8_t> out;
-        out.reserve(4 + bitmap_len + count * 4);
-        append_u16(out, static_cast<std::uint16_t>(count));
-        append_u16(out, static_cast<std::uint16_t>(bitmap_len));
-        out.insert(out.end(), bitmap.begin(), bitmap.end());
-
-        std::size_t total = out.size();
-        for (std::size_t i = 0; i < count; ++i)
-        {
-            const auto &field = fields[i];
-            out.push_back(static_cast<std::uint8_t>(field.type));
-            total += 1;
+            std::vector<std::uint8_t> out;
+            out.reserve(4 + bitmap_len + count * 4);
+            append_u16(out, static_cast<std::uint16_t>(count));
+            append_u16(out, static_cast<std::uint16_t>(bitmap_len));
+            out.insert(out.end(), bitmap.begin(), bitmap.end());
 
-            std::uint16_t len = 0;
-            if (!field.is_null)
+            std::size_t total = out.size();
+            for (std::size_t i = 0; i < count; ++i)
             {
-                if (field.payload.size() > std::numeric_limits<std::uint16_t>::max())
+                const auto &field = fields[i];
+                out.push_back(static_cast<std::uint8_t>(field.type));
+                total += 1;
+
+                std::uint16_t len = 0;
+                if (!field.is_null)
                 {
-                    KIZUNA_THROW_RECORD(StatusCode::RECORD_TOO_LARGE, "Field too large", std::to_string(field.payload.size()));
+                    if (field.payload.size() > std::numeric_limits<std::uint16_t>::max())
+                    {
+                        KIZUNA_THROW_RECORD(StatusCode::RECORD_TOO_LARGE, "Field too large", std::to_string(field.payload.size()));
+                    }
+
+                    const std::size_t expected = get_type_size(field.type);
+                    if (expected > 0 && field.payload.size() != expected)
+                    {
+                        KIZUNA_THROW_RECORD(StatusCode::INVALID_ARGUMENT, "Fixed field wrong size", std::to_string(i));
+                    }
+
+                    len = static_cast<std::uint16_t>(field.payload.size());
                 }
 
-                const std::size_t expected = get_type_size(field.type);
-                if (expected > 0 && field.payload.size() != expected)
+                append_u16(out, len);
+                total += 2;
+
+                if (!field.is_null && len > 0)
                 {
-                    KIZUNA_THROW_RECORD(StatusCode::INVALID_ARGUMENT, "Fixed field wrong size", std::to_string(i));
+                    out.insert(out.end(), field.payload.begin(), field.payload.end());
+                    total += len;
                 }
 
-                len = static_cast<std::uint16_t>(field.payload.size());
+                if (total > config::MAX_RECORD_SIZE)
+                {
+                    KIZUNA_THROW_RECORD(StatusCode::RECORD_TOO_LARGE, "Encoded record too large", std::to_string(total));
+                }
             }
 
-            append_u16(out, len);
-            total += 2;
+            return out;
+        }
 
-            if (!field.is_null && len > 0)
+        std::vector<std::uint8_t> encode_v2(const std::vector<Field> &fields)
+        {
+            const std::size_t count = fields.size();
+            if (count > kV2MaxFields)
             {
-                out.insert(out.end(), field.payload.begin(), field.payload.end());
-                total += len;
+                KIZUNA_THROW_RECORD(StatusCode::INVALID_ARGUMENT, "Too many fields", std::to_string(count));
             }
 
+            const std::size_t bitmap_len = nullmap_bytes(count);
+            std::vector<std::uint8_t> bitmap(bitmap_len, 0);
+            std::size_t fixed_bytes = 0;
+            std::size_t var_count = 0;
+            std::size_t var_bytes = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                const auto &field = fields[i];
+                const std::size_t width = get_type_size(field.type);
+                if (field.is_null)
+                {
+                    if (!field.payload.empty())
+                    {
+                        KIZUNA_THROW_RECORD(StatusCode::INVALID_ARGUMENT, "Null field had payload", std::to_string(i));
+                    }
+                    set_null_bit(bitmap, i);
+                }
+                else if (width > 0 && field.payload.size() != width)
+                {
+                    KIZUNA_THROW_RECORD(StatusCode::INVALID_ARGUMENT, "Fixed field wrong size", std::to_string(i));
+                }
+
+                if (width > 0)
+                {
+                    fixed_bytes += width;
+                }
+                else
+                {
+                    ++var_count;
+                    var_bytes += field.payload.size();
+                }
+            }
+
+            const std::size_t total = kV2HeaderSize + bitmap_len + count + fixed_bytes + var_count * 2 + var_bytes;
             if (total > config::MAX_RECORD_SIZE)
             {
                 KIZUNA_THROW_RECORD(StatusCode::RECORD_TOO_LARGE, "Encoded record too large", std::to_string(total));
             }
+
+            std::vector<std::uint8_t> out;
+            out.reserve(total);
+            append_u16(out, static_cast<std::uint16_t>(kV2Marker | count));
+            out.push_back(static_cast<std::uint8_t>(RecordFormat::V2));
+            out.push_back(0);
+            append_u16(out, static_cast<std::uint16_t>(fixed_bytes));
+            append_u16(out, static_cast<std::uint16_t>(var_count));
+            out.insert(out.end(), bitmap.begin(), bitmap.end());
+            for (const auto &field : fields)
+                out.push_back(static_cast<std::uint8_t>(field.type));
+
+            // Fixed area: NULL fixed-width fields keep their slot, zero-filled, so every
+            // offset depends only on the type array.
+            for (const auto &field : fields)
+            {
+                const std::size_t width = get_type_size(field.type);
+                if (width == 0)
+                    continue;
+                if (field.is_null)
+                    out.insert(out.end(), width, 0);
+                else
+                    out.insert(out.end(), field.payload.begin(), field.payload.end());
+            }
+
+            std::size_t var_end = 0;
+            for (const auto &field : fields)
+            {
+                if (get_type_size(field.type) > 0)
+                    continue;
+                var_end += field.payload.size();
+                append_u16(out, static_cast<std::uint16_t>(var_end));
+            }
+            for (const auto &field : fields)
+            {
+                if (get_type_size(field.type) == 0)
+                    out.insert(out.end(), field.payload.begin(), field.payload.end());
+            }
+
+            return out;
         }
+    } // namespace
+
+    std::vector<std::uint8_t> encode(const std::vector<Field> &fields, RecordFormat format)
+    {
+        if (format == RecordFormat::V2)
+            return encode_v2(fields);
+        return encode_v1(fields);
+    }
 
-        return out;
+    RecordFormat format_of(std::span<const std::uint8_t> payload) noexcept
+    {
+        if (payload.size() >= kV2HeaderSize && (load_u16(payload.data()) & kV2Marker) != 0 &&
+            payload[2] == static_cast<std::uint8_t>(RecordFormat::V2))
+        {
+            return RecordFormat::V2;
+        }
+        return RecordFormat::V1;
     }
 
     bool decode(const std::uint8_t *data, std::size_t len, std::vector<Field> &out_fields)
     {
         out_fields.clear();
+        const std::span<const std::uint8_t> payload(data, len);
+        if (format_of(payload) == RecordFormat::V2)
+        {
+            // Binding a layout checks the header sums against the type array.
+            RecordLayout layout;
+            RowView row(payload, &layout);
+            if (!row.valid()) return false;
+            out_fields.reserve(row.field_count());
+            FieldView view;
+            for (std::size_t i = 0; i < row.field_count(); ++i)
+            {
+                if (!row.field(i, view)) return false;
+                Field f;
+                f.type = view.type;
+                f.is_null = view.is_null;
+                if (!view.is_null)
+                    f.payload.assign(view.bytes.begin(), view.bytes.end());
+                out_fields.emplace_back(std::move(f));
+            }
+            return true;
+        }
+
         const std::uint8_t *p = data;
         const std::uint8_t *end = data + len;
 
@@ -245,6 +385,207 @@ namespace kizuna::record
 
         return p == end;
     }
-}
 
+    namespace
+    {
+        template <typename T>
+        inline T load_pod(std::span<const std::uint8_t> bytes) noexcept
+        {
+            T v{};
+            std::memcpy(&v, bytes.data(), std::min(bytes.size(), sizeof(T)));
+            return v;
+        }
+    } // namespace
+
+    std::int32_t FieldView::as_int32() const noexcept { return load_pod<std::int32_t>(bytes); }
+    std::int64_t FieldView::as_int64() const noexcept { return load_pod<std::int64_t>(bytes); }
+    float FieldView::as_float() const noexcept { return load_pod<float>(bytes); }
+    double FieldView::as_double() const noexcept { return load_pod<double>(bytes); }
 
+    void RecordLayout::bind(std::span<const std::uint8_t> types)
+    {
+        if (types.size() == types_.size() && std::equal(types.begin(), types.end(), types_.begin()))
+            return;
+
+        types_.assign(types.begin(), types.end());
+        locations_.resize(types_.size());
+        std::size_t fixed = 0;
+        std::size_t var = 0;
+        for (std::size_t i = 0; i < types_.size(); ++i)
+        {
+            const std::size_t width = get_type_size(static_cast<DataType>(types_[i]));
+            if (width > 0)
+            {
+                locations_[i] = static_cast<std::uint16_t>(fixed);
+                fixed += width;
+            }
+            else
+            {
+                locations_[i] = static_cast<std::uint16_t>(var);
+                ++var;
+            }
+        }
+        fixed_bytes_ = fixed;
+        var_count_ = var;
+    }
+
+    RowView::RowView(std::span<const std::uint8_t> payload, RecordLayout *layout)
+        : payload_(payload)
+    {
+        if (payload_.size() >= 2 && (load_u16(payload_.data()) & kV2Marker) != 0)
+            open_v2(layout);
+        else
+            open_v1();
+    }
+
+    void RowView::open_v1() noexcept
+    {
+        const std::uint8_t *p = payload_.data();
+        const std::uint8_t *end = p + payload_.size();
+        std::uint16_t count = 0;
+        std::uint16_t bitmap_len = 0;
+        if (!read_u16(p, end, count) || !read_u16(p, end, bitmap_len))
+            return;
+        if (bitmap_len < nullmap_bytes(count) || p + bitmap_len > end)
+            return;
+        bitmap_ = p;
+        bitmap_len_ = bitmap_len;
+        count_ = count;
+        fields_begin_ = p + bitmap_len;
+        cursor_ = fields_begin_;
+        cursor_index_ = 0;
+        valid_ = true;
+    }
+
+    void RowView::open_v2(RecordLayout *layout)
+    {
+        if (payload_.size() < kV2HeaderSize || payload_[2] != static_cast<std::uint8_t>(RecordFormat::V2))
+            return;
+        const std::uint8_t *p = payload_.data();
+        const std::uint8_t *end = p + payload_.size();
+        const std::uint16_t count = static_cast<std::uint16_t>(load_u16(p) & ~kV2Marker);
+        const std::uint16_t fixed_bytes = load_u16(p + 4);
+        const std::uint16_t var_count = load_u16(p + 6);
+        p += kV2HeaderSize;
+
+        const std::size_t bitmap_len = nullmap_bytes(count);
+        const std::size_t sections = bitmap_len + count + fixed_bytes + std::size_t{var_count} * 2;
+        if (static_cast<std::size_t>(end - p) < sections)
+            return;
+
+        bitmap_ = p;
+        p += bitmap_len;
+        types_ = p;
+        p += count;
+        fixed_begin_ = p;
+        p += fixed_bytes;
+        var_ends_ = p;
+        p += std::size_t{var_count} * 2;
+        var_begin_ = p;
+        var_bytes_ = static_cast<std::size_t>(end - p);
+
+        const std::size_t last_end = var_count > 0 ? load_u16(var_ends_ + (var_count - 1) * 2) : 0;
+        if (last_end != var_bytes_)
+            return;
+
+        if (layout)
+        {
+            layout->bind(std::span<const std::uint8_t>(types_, count));
+            if (layout->fixed_bytes_ != fixed_bytes || layout->var_count_ != var_count)
+                return;
+            layout_ = layout;
+        }
+
+        format_ = RecordFormat::V2;
+        bitmap_len_ = static_cast<std::uint16_t>(bitmap_len);
+        count_ = count;
+        fixed_bytes_ = fixed_bytes;
+        var_count_ = var_count;
+        valid_ = true;
+    }
+
+    bool RowView::field(std::size_t index, FieldView &out) const noexcept
+    {
+        if (!valid_ || index >= count_)
+            return false;
+        return format_ == RecordFormat::V2 ? field_v2(index, out) : field_v1(index, out);
+    }
+
+    bool RowView::field_v1(std::size_t index, FieldView &out) const noexcept
+    {
+        if (index < cursor_index_)
+        {
+            cursor_ = fields_begin_;
+            cursor_index_ = 0;
+        }
+
+        const std::uint8_t *end = payload_.data() + payload_.size();
+        while (true)
+        {
+            const std::uint8_t *p = cursor_;
+            if (p >= end) return false;
+            const DataType type = static_cast<DataType>(*p++);
+            std::uint16_t field_len = 0;
+            if (!read_u16(p, end, field_len)) return false;
+            if (p + field_len > end) return false;
+
+            if (cursor_index_ == index)
+            {
+                out.type = type;
+                out.is_null = get_null_bit(bitmap_, bitmap_len_, index);
+                if (out.is_null && field_len != 0) return false;
+                out.bytes = std::span<const std::uint8_t>(p, field_len);
+                return true;
+            }
+            cursor_ = p + field_len;
+            ++cursor_index_;
+        }
+    }
+
+    bool RowView::field_v2(std::size_t index, FieldView &out) const noexcept
+    {
+        const DataType type = static_cast<DataType>(types_[index]);
+        const std::size_t width = get_type_size(type);
+
+        std::size_t location = 0;
+        if (layout_)
+        {
+            location = layout_->locations_[index];
+        }
+        else
+        {
+            if (index < cursor_index_)
+            {
+                cursor_index_ = 0;
+                cursor_fixed_ = 0;
+                cursor_var_ = 0;
+            }
+            for (; cursor_index_ < index; ++cursor_index_)
+            {
+                const std::size_t skipped = get_type_size(static_cast<DataType>(types_[cursor_index_]));
+                if (skipped > 0)
+                    cursor_fixed_ += skipped;
+                else
+                    ++cursor_var_;
+            }
+            location = width > 0 ? cursor_fixed_ : cursor_var_;
+        }
+
+        out.type = type;
+        out.is_null = get_null_bit(bitmap_, bitmap_len_, index);
+        if (width > 0)
+        {
+            if (location + width > fixed_bytes_) return false;
+            out.bytes = out.is_null ? std::span<const std::uint8_t>{} : std::span<const std::uint8_t>(fixed_begin_ + location, width);
+            return true;
+        }
+
+        if (location >= var_count_) return false;
+        const std::size_t begin = location == 0 ? 0 : load_u16(var_ends_ + (location - 1) * 2);
+        const std::size_t finish = load_u16(var_ends_ + location * 2);
+        if (begin > finish || finish > var_bytes_) return false;
+        if (out.is_null && finish != begin) return false;
+        out.bytes = std::span<const std::uint8_t>(var_begin_ + begin, finish - begin);
+        return true;
+    }
+}
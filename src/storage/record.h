@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -28,6 +29,109 @@ namespace kizuna::record
     Field from_date(std::int64_t days_since_epoch);
     Field from_blob(const std::vector<std::uint8_t> &b);
 
-    std::vector<std::uint8_t> encode(const std::vector<Field> &fields);
+    // On-disk row formats. V1 stores (type, length, bytes) per field and must be walked
+    // front to back. V2 sets the top bit of the leading u16 and carries a format byte; it
+    // keeps fixed-width fields at constant offsets after the null bitmap and an end-offset
+    // array for variable-length fields. Only table rows use these formats; index keys are
+    // built by index::KeyEncoder instead.
+    enum class RecordFormat : std::uint8_t
+    {
+        V1 = 1,
+        V2 = 2
+    };
+
+    // Format used for newly written table rows.
+    inline constexpr RecordFormat ROW_FORMAT = RecordFormat::V2;
+
+    std::vector<std::uint8_t> encode(const std::vector<Field> &fields, RecordFormat format = RecordFormat::V1);
     bool decode(const std::uint8_t *data, std::size_t len, std::vector<Field> &out_fields);
+    RecordFormat format_of(std::span<const std::uint8_t> payload) noexcept;
+
+    // A field of an encoded row, borrowed from the row's buffer.
+    struct FieldView
+    {
+        DataType type{DataType::NULL_TYPE};
+        bool is_null{true};
+        std::span<const std::uint8_t> bytes{};
+
+        bool as_bool() const noexcept { return !bytes.empty() && bytes[0] != 0; }
+        std::int32_t as_int32() const noexcept;
+        std::int64_t as_int64() const noexcept;
+        float as_float() const noexcept;
+        double as_double() const noexcept;
+        std::string_view as_string_view() const noexcept
+        {
+            return std::string_view(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+        }
+    };
+
+    // Field positions of a V2 row, derived from its type array. Rows of one table
+    // normally share a type array, so a scan binds the layout once and every RowView
+    // built with it locates any field in O(1).
+    class RecordLayout
+    {
+    public:
+        // Rebuilds the layout unless it already describes this type array.
+        void bind(std::span<const std::uint8_t> types);
+
+        std::size_t field_count() const noexcept { return types_.size(); }
+        std::size_t fixed_bytes() const noexcept { return fixed_bytes_; }
+        std::size_t var_count() const noexcept { return var_count_; }
+
+    private:
+        friend class RowView;
+
+        std::vector<std::uint8_t> types_{};
+        // Offset into the fixed area for fixed-width fields, index into the end-offset
+        // array for variable-length ones.
+        std::vector<std::uint16_t> locations_{};
+        std::size_t fixed_bytes_{0};
+        std::size_t var_count_{0};
+    };
+
+    // Reads fields straight out of an encoded row (for example a span into a pinned
+    // page) without building Field copies. Fields are located on demand; walking them
+    // in ascending order costs one step each. Given a layout, V2 rows skip the walk.
+    class RowView
+    {
+    public:
+        RowView() = default;
+        explicit RowView(std::span<const std::uint8_t> payload, RecordLayout *layout = nullptr);
+
+        bool valid() const noexcept { return valid_; }
+        RecordFormat format() const noexcept { return format_; }
+        std::size_t field_count() const noexcept { return count_; }
+        bool field(std::size_t index, FieldView &out) const noexcept;
+
+    private:
+        void open_v1() noexcept;
+        void open_v2(RecordLayout *layout);
+        bool field_v1(std::size_t index, FieldView &out) const noexcept;
+        bool field_v2(std::size_t index, FieldView &out) const noexcept;
+
+        std::span<const std::uint8_t> payload_{};
+        RecordFormat format_{RecordFormat::V1};
+        const std::uint8_t *bitmap_{nullptr};
+        std::uint16_t bitmap_len_{0};
+        std::uint16_t count_{0};
+        bool valid_{false};
+
+        // V1: start of the (type, length, bytes) sequence.
+        const std::uint8_t *fields_begin_{nullptr};
+
+        // V2 sections.
+        const std::uint8_t *types_{nullptr};
+        const std::uint8_t *fixed_begin_{nullptr};
+        std::uint16_t fixed_bytes_{0};
+        const std::uint8_t *var_ends_{nullptr};
+        std::uint16_t var_count_{0};
+        const std::uint8_t *var_begin_{nullptr};
+        std::size_t var_bytes_{0};
+        const RecordLayout *layout_{nullptr};
+
+        mutable std::size_t cursor_index_{0};
+        mutable const std::uint8_t *cursor_{nullptr};
+        mutable std::size_t cursor_fixed_{0};
+        mutable std::size_t cursor_var_{0};
+    };
 }
@@ -0,0 +1,373 @@
+#include "storage/replacement_policy.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "common/exception.h"
+
+namespace kizuna
+{
+    namespace
+    {
+        constexpr std::size_t kNil = static_cast<std::size_t>(-1);
+
+        // Intrusive doubly linked list over local frame slots; avoids std::list node
+        // allocation on every touch. front = most recent.
+        class FrameList
+        {
+        public:
+            explicit FrameList(std::size_t n) : prev_(n, kNil), next_(n, kNil), linked_(n, false) {}
+
+            bool contains(std::size_t i) const { return linked_[i]; }
+            std::size_t size() const { return size_; }
+            std::size_t back() const { return tail_; }
+            std::size_t prev(std::size_t i) const { return prev_[i]; }
+
+            void push_front(std::size_t i)
+            {
+                prev_[i] = kNil;
+                next_[i] = head_;
+                if (head_ != kNil)
+                    prev_[head_] = i;
+                head_ = i;
+                if (tail_ == kNil)
+                    tail_ = i;
+                linked_[i] = true;
+                ++size_;
+            }
+
+            void unlink(std::size_t i)
+            {
+                if (!linked_[i])
+                    return;
+                if (prev_[i] != kNil)
+                    next_[prev_[i]] = next_[i];
+                else
+                    head_ = next_[i];
+                if (next_[i] != kNil)
+                    prev_[next_[i]] = prev_[i];
+                else
+                    tail_ = prev_[i];
+                prev_[i] = next_[i] = kNil;
+                linked_[i] = false;
+                --size_;
+            }
+
+            void move_to_front(std::size_t i)
+            {
+                unlink(i);
+                push_front(i);
+            }
+
+        private:
+            std::vector<std::size_t> prev_;
+            std::vector<std::size_t> next_;
+            std::vector<bool> linked_;
+            std::size_t head_{kNil};
+            std::size_t tail_{kNil};
+            std::size_t size_{0};
+        };
+
+        class LruPolicy final : public ReplacementPolicy
+        {
+        public:
+            LruPolicy(std::size_t begin, std::size_t count) : begin_(begin), list_(count) {}
+
+            void record_load(std::size_t, page_key_t) override {}
+
+            void record_hit(std::size_t frame) override
+            {
+                const std::size_t i = frame - begin_;
+                if (list_.contains(i))
+                    list_.move_to_front(i);
+            }
+
+            void set_evictable(std::size_t frame, bool evictable) override
+            {
+                const std::size_t i = frame - begin_;
+                if (evictable)
+                    list_.move_to_front(i);
+                else
+                    list_.unlink(i);
+            }
+
+            std::optional<std::size_t> evict() override
+            {
+                if (list_.size() == 0)
+                    return std::nullopt;
+                const std::size_t i = list_.back();
+                list_.unlink(i);
+                return begin_ + i;
+            }
+
+            void remove(std::size_t frame) override { list_.unlink(frame - begin_); }
+
+            std::vector<std::size_t> coldest(std::size_t limit) const override
+            {
+                std::vector<std::size_t> out;
+                for (std::size_t i = list_.back(); i != kNil && out.size() < limit; i = list_.prev(i))
+                    out.push_back(begin_ + i);
+                return out;
+            }
+
+            ReplacementPolicyKind kind() const noexcept override { return ReplacementPolicyKind::LRU; }
+
+        private:
+            std::size_t begin_;
+            FrameList list_;
+        };
+
+        class ClockPolicy final : public ReplacementPolicy
+        {
+        public:
+            ClockPolicy(std::size_t begin, std::size_t count)
+                : begin_(begin), resident_(count, false), evictable_(count, false), referenced_(count, false)
+            {
+            }
+
+            void record_load(std::size_t frame, page_key_t) override
+            {
+                const std::size_t i = frame - begin_;
+                resident_[i] = true;
+                referenced_[i] = true;
+            }
+
+            void record_hit(std::size_t frame) override { referenced_[frame - begin_] = true; }
+
+            void set_evictable(std::size_t frame, bool evictable) override
+            {
+                const std::size_t i = frame - begin_;
+                if (evictable && !evictable_[i])
+                    ++evictable_count_;
+                else if (!evictable && evictable_[i])
+                    --evictable_count_;
+                evictable_[i] = evictable;
+            }
+
+            std::optional<std::size_t> evict() override
+            {
+                if (evictable_count_ == 0)
+                    return std::nullopt;
+                const std::size_t n = resident_.size();
+                // Two full sweeps always suffice: the first clears reference bits.
+                for (std::size_t step = 0; step < 2 * n; ++step)
+                {
+                    const std::size_t i = hand_;
+                    hand_ = (hand_ + 1) % n;
+                    if (!resident_[i] || !evictable_[i])
+                        continue;
+                    if (referenced_[i])
+                    {
+                        referenced_[i] = false;
+                        continue;
+                    }
+                    forget(i);
+                    return begin_ + i;
+                }
+                return std::nullopt;
+            }
+
+            void remove(std::size_t frame) override { forget(frame - begin_); }
+
+            std::vector<std::size_t> coldest(std::size_t limit) const override
+            {
+                // Frames the hand would take on this sweep, then those it would take
+                // after clearing their reference bit.
+                std::vector<std::size_t> out;
+                const std::size_t n = resident_.size();
+                for (int pass = 0; pass < 2; ++pass)
+                {
+                    for (std::size_t step = 0; step < n && out.size() < limit; ++step)
+                    {
+                        const std::size_t i = (hand_ + step) % n;
+                        if (resident_[i] && evictable_[i] && referenced_[i] == (pass == 1))
+                            out.push_back(begin_ + i);
+                    }
+                }
+                return out;
+            }
+
+            ReplacementPolicyKind kind() const noexcept override { return ReplacementPolicyKind::CLOCK; }
+
+        private:
+            void forget(std::size_t i)
+            {
+                if (evictable_[i])
+                    --evictable_count_;
+                resident_[i] = false;
+                evictable_[i] = false;
+                referenced_[i] = false;
+            }
+
+            std::size_t begin_;
+            std::vector<bool> resident_;
+            std::vector<bool> evictable_;
+            std::vector<bool> referenced_;
+            std::size_t evictable_count_{0};
+            std::size_t hand_{0};
+        };
+
+        // Full 2Q (Johnson & Shasha): first-time pages enter the A1in FIFO; only pages
+        // re-requested after leaving A1in (tracked as ghost ids in A1out) reach the Am
+        // LRU. A one-pass scan therefore never displaces the hot Am set.
+        class TwoQueuePolicy final : public ReplacementPolicy
+        {
+        public:
+            TwoQueuePolicy(std::size_t begin, std::size_t count)
+                : begin_(begin),
+                  a1in_(count),
+                  am_(count),
+                  page_keys_(count, 0),
+                  evictable_(count, false),
+                  kin_(std::max<std::size_t>(1, count / 4)),
+                  kout_(std::max<std::size_t>(1, count / 2))
+            {
+            }
+
+            void record_load(std::size_t frame, page_key_t page_key) override
+            {
+                const std::size_t i = frame - begin_;
+                page_keys_[i] = page_key;
+                if (ghosts_.erase(page_key) != 0)
+                {
+                    ghost_fifo_.erase(std::find(ghost_fifo_.begin(), ghost_fifo_.end(), page_key));
+                    am_.push_front(i);
+                }
+                else
+                {
+                    a1in_.push_front(i);
+                }
+            }
+
+            void record_hit(std::size_t frame) override
+            {
+                const std::size_t i = frame - begin_;
+                if (am_.contains(i))
+                    am_.move_to_front(i);
+                // Hits in A1in are treated as correlated references and ignored.
+            }
+
+            void set_evictable(std::size_t frame, bool evictable) override { evictable_[frame - begin_] = evictable; }
+
+            std::optional<std::size_t> evict() override
+            {
+                const bool prefer_a1 = a1in_.size() > kin_ || am_.size() == 0;
+                std::optional<std::size_t> victim = prefer_a1 ? take_oldest(a1in_, true) : take_oldest(am_, false);
+                if (!victim)
+                    victim = prefer_a1 ? take_oldest(am_, false) : take_oldest(a1in_, true);
+                return victim;
+            }
+
+            void remove(std::size_t frame) override
+            {
+                const std::size_t i = frame - begin_;
+                a1in_.unlink(i);
+                am_.unlink(i);
+                evictable_[i] = false;
+            }
+
+            std::vector<std::size_t> coldest(std::size_t limit) const override
+            {
+                const bool prefer_a1 = a1in_.size() > kin_ || am_.size() == 0;
+                std::vector<std::size_t> out;
+                collect_oldest(prefer_a1 ? a1in_ : am_, limit, out);
+                collect_oldest(prefer_a1 ? am_ : a1in_, limit, out);
+                return out;
+            }
+
+            ReplacementPolicyKind kind() const noexcept override { return ReplacementPolicyKind::TWO_Q; }
+
+        private:
+            void collect_oldest(const FrameList &list, std::size_t limit, std::vector<std::size_t> &out) const
+            {
+                for (std::size_t i = list.back(); i != kNil && out.size() < limit; i = list.prev(i))
+                {
+                    if (evictable_[i])
+                        out.push_back(begin_ + i);
+                }
+            }
+
+            std::optional<std::size_t> take_oldest(FrameList &list, bool remember)
+            {
+                for (std::size_t i = list.back(); i != kNil; i = list.prev(i))
+                {
+                    if (!evictable_[i])
+                        continue;
+                    list.unlink(i);
+                    evictable_[i] = false;
+                    if (remember)
+                        remember_ghost(page_keys_[i]);
+                    return begin_ + i;
+                }
+                return std::nullopt;
+            }
+
+            void remember_ghost(page_key_t key)
+            {
+                if (!ghosts_.insert(key).second)
+                    return;
+                ghost_fifo_.push_back(key);
+                if (ghost_fifo_.size() > kout_)
+                {
+                    ghosts_.erase(ghost_fifo_.front());
+                    ghost_fifo_.pop_front();
+                }
+            }
+
+            std::size_t begin_;
+            FrameList a1in_;
+            FrameList am_;
+            std::vector<page_key_t> page_keys_;
+            std::vector<bool> evictable_;
+            std::size_t kin_;
+            std::size_t kout_;
+            std::unordered_set<page_key_t> ghosts_;
+            std::deque<page_key_t> ghost_fifo_;
+        };
+    }
+
+    std::string replacement_policy_to_string(ReplacementPolicyKind kind)
+    {
+        switch (kind)
+        {
+        case ReplacementPolicyKind::LRU:
+            return "LRU";
+        case ReplacementPolicyKind::CLOCK:
+            return "CLOCK";
+        case ReplacementPolicyKind::TWO_Q:
+            return "2Q";
+        }
+        return "UNKNOWN";
+    }
+
+    std::optional<ReplacementPolicyKind> parse_replacement_policy(std::string_view text)
+    {
+        std::string upper(text);
+        std::transform(upper.begin(), upper.end(), upper.begin(), [](unsigned char c)
+                       { return static_cast<char>(std::toupper(c)); });
+        if (upper == "LRU")
+            return ReplacementPolicyKind::LRU;
+        if (upper == "CLOCK")
+            return ReplacementPolicyKind::CLOCK;
+        if (upper == "2Q" || upper == "TWOQ" || upper == "TWO_Q")
+            return ReplacementPolicyKind::TWO_Q;
+        return std::nullopt;
+    }
+
+    std::unique_ptr<ReplacementPolicy> make_replacement_policy(ReplacementPolicyKind kind,
+                                                               std::size_t frame_begin,
+                                                               std::size_t frame_count)
+    {
+        switch (kind)
+        {
+        case ReplacementPolicyKind::LRU:
+            return std::make_unique<LruPolicy>(frame_begin, frame_count);
+        case ReplacementPolicyKind::CLOCK:
+            return std::make_unique<ClockPolicy>(frame_begin, frame_count);
+        case ReplacementPolicyKind::TWO_Q:
+            return std::make_unique<TwoQueuePolicy>(frame_begin, frame_count);
+        }
+        KIZUNA_THROW_STORAGE(StatusCode::INVALID_ARGUMENT, "Unknown replacement policy",
+                             std::to_string(static_cast<int>(kind)));
+    }
+}
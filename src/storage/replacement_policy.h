@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "common/types.h"
+
+namespace kizuna
+{
+    // Page replacement strategies selectable when constructing a PageManager.
+    enum class ReplacementPolicyKind : uint8_t
+    {
+        LRU = 0,   // least recently unpinned page goes first
+        CLOCK = 1, // second-chance sweep over a reference bit, no per-access allocation
+        TWO_Q = 2  // A1in FIFO + Am LRU + A1out ghost ids (scan resistant)
+    };
+
+    std::string replacement_policy_to_string(ReplacementPolicyKind kind);
+    std::optional<ReplacementPolicyKind> parse_replacement_policy(std::string_view text);
+
+    // Bookkeeping for victim selection over a contiguous range of frame slots. The
+    // BufferPool numbers each shard's frames 0..n-1 and builds a new policy when a
+    // resize changes n; the policy only ever sees indices in
+    // [frame_begin, frame_begin + frame_count). Callers serialize access.
+    class ReplacementPolicy
+    {
+    public:
+        virtual ~ReplacementPolicy() = default;
+
+        // A page was read into `frame` (cache miss).
+        virtual void record_load(std::size_t frame, page_key_t page_key) = 0;
+        // A resident page in `frame` was referenced again (cache hit).
+        virtual void record_hit(std::size_t frame) = 0;
+        // Pinned frames are not evictable; unpin to zero makes them evictable again.
+        virtual void set_evictable(std::size_t frame, bool evictable) = 0;
+        // Choose and forget an evictable frame. Returns nullopt if every frame is pinned.
+        virtual std::optional<std::size_t> evict() = 0;
+        // Frame was released without eviction (failed load).
+        virtual void remove(std::size_t frame) = 0;
+        // Up to `limit` evictable frames, roughly in the order evict() would pick them,
+        // without changing any state (the background writer cleans these ahead of time).
+        virtual std::vector<std::size_t> coldest(std::size_t limit) const = 0;
+
+        virtual ReplacementPolicyKind kind() const noexcept = 0;
+    };
+
+    std::unique_ptr<ReplacementPolicy> make_replacement_policy(ReplacementPolicyKind kind,
+                                                               std::size_t frame_begin,
+                                                               std::size_t frame_count);
+}
@@ -76,7 +76,7 @@ namespace kizuna
         }
     }
 
-    TableHeap::TableHeap(PageManager &pm, page_id_t root_page_id)
+    TableHeap::TableHeap(PageManager &pm, page_id_t root_page_id, page_id_t tail_hint, page_id_t fsm_root_page_id)
         : pm_(pm), root_page_id_(root_page_id), tail_page_id_(root_page_id)
     {
         if (!is_valid_page(root_page_id_))
@@ -90,8 +90,12 @@ namespace kizuna
             pm_.unpin(root_page_id_, false);
             KIZUNA_THROW_STORAGE(StatusCode::INVALID_PAGE_TYPE, "Table root is not DATA", std::to_string(root_page_id_));
         }
-        tail_page_id_ = find_tail(root_page_id_);
+        tail_page_id_ = is_tail(tail_hint) ? tail_hint : find_tail(root_page_id_);
         pm_.unpin(root_page_id_, false);
+        if (is_valid_page(fsm_root_page_id))
+        {
+            fsm_.emplace(pm_, fsm_root_page_id);
+        }
     }
 
     TableHeap::RowLocation TableHeap::insert(const std::vector<uint8_t> &payload)
@@ -103,27 +107,25 @@ namespace kizuna
                                  std::to_string(payload.size()));
         }
 
-        page_id_t current = tail_page_id_;
-        while (is_valid_page(current))
+        RowLocation loc;
+        if (try_insert(tail_page_id_, payload, loc))
         {
-            auto &page = pm_.fetch(current, true);
-            slot_id_t slot{};
-            if (page.insert(payload.data(), static_cast<uint16_t>(payload.size()), slot))
-            {
-                pm_.unpin(current, true);
-                tail_page_id_ = current;
-                return RowLocation{current, slot};
-            }
-            page_id_t next = page.next_page_id();
-            pm_.unpin(current, false);
-            if (is_valid_page(next))
+            return loc;
+        }
+        if (fsm_)
+        {
+            // A candidate that turns out too full has its category corrected by
+            // try_insert, so it is not offered again and the loop terminates.
+            const std::size_t needed = payload.size() + 2 + Page::slot_size();
+            while (auto candidate = fsm_->find(needed))
             {
-                current = next;
-                continue;
+                if (try_insert(*candidate, payload, loc))
+                {
+                    return loc;
+                }
             }
-            return append_new_page(current, payload);
         }
-        return append_new_page(root_page_id_, payload);
+        return append_new_page(tail_page_id_, payload);
     }
 
     TableHeap::RowLocation TableHeap::update(const RowLocation &loc, const std::vector<uint8_t> &payload)
@@ -140,10 +142,16 @@ namespace kizuna
         }
 
         auto &page = pm_.fetch(loc.page_id, true);
+        const std::size_t before = page.reclaimable_bytes();
         bool updated = page.update(loc.slot, payload.data(), static_cast<uint16_t>(payload.size()));
+        const std::size_t after = page.reclaimable_bytes();
         pm_.unpin(loc.page_id, updated);
         if (updated)
         {
+            if (fsm_ && FreeSpaceMap::category_for(before) != FreeSpaceMap::category_for(after))
+            {
+                fsm_->update(loc.page_id, after);
+            }
             return loc;
         }
 
@@ -161,7 +169,17 @@ namespace kizuna
             return false;
         auto &page = pm_.fetch(loc.page_id, true);
         bool ok = page.erase(loc.slot);
+        if (ok && page.header().record_count == 0)
+        {
+            // No live rows are left, so no RID can point here: reclaim the whole page.
+            page.compact();
+        }
+        const std::size_t free_bytes = page.reclaimable_bytes();
         pm_.unpin(loc.page_id, ok);
+        if (ok && fsm_)
+        {
+            fsm_->update(loc.page_id, free_bytes);
+        }
         return ok;
     }
 
@@ -185,7 +203,13 @@ namespace kizuna
         root.header().slot_count = 0;
         root.header().free_space_offset = static_cast<uint16_t>(Page::kHeaderSize);
         std::memset(root.data() + Page::kHeaderSize, 0, Page::page_size() - Page::kHeaderSize);
+        const std::size_t root_free = root.free_bytes();
         pm_.unpin(root_page_id_, true);
+        if (fsm_)
+        {
+            fsm_->clear();
+            fsm_->update(root_page_id_, root_free);
+        }
 
         page_id_t current = next;
         while (is_valid_page(current))
@@ -199,9 +223,73 @@ namespace kizuna
         tail_page_id_ = root_page_id_;
     }
 
-    TableHeap::Iterator TableHeap::begin()
+    TableHeap::VacuumStats TableHeap::vacuum()
     {
-        return Iterator(this, root_page_id_, 0, false);
+        VacuumStats stats;
+        page_id_t previous = config::INVALID_PAGE_ID;
+        page_id_t current = root_page_id_;
+        while (is_valid_page(current))
+        {
+            auto &page = pm_.fetch(current, true);
+            const page_id_t next = page.next_page_id();
+            ++stats.pages_scanned;
+
+            if (page.header().record_count == 0 && current != root_page_id_)
+            {
+                // The root anchors the catalog entry; any other empty page leaves the chain.
+                pm_.unpin(current, false);
+                auto &prev_page = pm_.fetch(previous, true);
+                prev_page.set_next_page_id(next);
+                pm_.unpin(previous, true);
+                if (is_valid_page(next))
+                {
+                    auto &next_page = pm_.fetch(next, true);
+                    next_page.set_prev_page_id(previous);
+                    pm_.unpin(next, true);
+                }
+                if (fsm_)
+                {
+                    fsm_->remove(current);
+                }
+                pm_.free_page(current);
+                if (tail_page_id_ == current)
+                {
+                    tail_page_id_ = previous;
+                }
+                ++stats.pages_freed;
+                stats.bytes_reclaimed += Page::page_size();
+                current = next;
+                continue;
+            }
+
+            const std::size_t before = page.free_bytes();
+            bool dirty = false;
+            if (page.reclaimable_bytes() > before)
+            {
+                page.compact();
+                dirty = true;
+                ++stats.pages_compacted;
+                stats.bytes_reclaimed += page.free_bytes() - before;
+            }
+            const std::size_t free_bytes = page.reclaimable_bytes();
+            pm_.unpin(current, dirty);
+            if (fsm_)
+            {
+                fsm_->update(current, free_bytes);
+            }
+            previous = current;
+            current = next;
+        }
+        if (!is_valid_page(tail_page_id_))
+        {
+            tail_page_id_ = root_page_id_;
+        }
+        return stats;
+    }
+
+    TableHeap::Iterator TableHeap::begin(BufferAccessStrategy *strategy)
+    {
+        return Iterator(this, root_page_id_, 0, false, strategy);
     }
 
     TableHeap::Iterator TableHeap::end()
@@ -209,11 +297,50 @@ namespace kizuna
         return Iterator();
     }
 
+    bool TableHeap::is_tail(page_id_t id) const
+    {
+        if (!is_valid_page(id))
+            return false;
+        auto &page = pm_.fetch(id, true);
+        const bool tail = static_cast<PageType>(page.header().page_type) == PageType::DATA &&
+                          !is_valid_page(page.next_page_id());
+        pm_.unpin(id, false);
+        return tail;
+    }
+
+    bool TableHeap::try_insert(page_id_t page_id, const std::vector<uint8_t> &payload, RowLocation &out)
+    {
+        auto &page = pm_.fetch(page_id, true);
+        const std::size_t before = page.reclaimable_bytes();
+        slot_id_t slot{};
+        const bool ok = page.insert(payload.data(), static_cast<uint16_t>(payload.size()), slot);
+        const std::size_t after = page.reclaimable_bytes();
+        pm_.unpin(page_id, ok);
+        if (fsm_ && (!ok || FreeSpaceMap::category_for(before) != FreeSpaceMap::category_for(after)))
+        {
+            fsm_->update(page_id, after);
+        }
+        if (ok)
+        {
+            out = RowLocation{page_id, slot};
+        }
+        return ok;
+    }
+
     page_id_t TableHeap::find_tail(page_id_t start) const
     {
         page_id_t current = start;
+        page_id_t previous = config::INVALID_PAGE_ID;
+        page_id_t readahead_end = config::INVALID_PAGE_ID;
         while (is_valid_page(current))
         {
+            if (current == previous + 1 && current >= readahead_end)
+            {
+                // Same read-ahead as Iterator::read_ahead for contiguous chains.
+                const std::size_t window = std::min(config::PREFETCH_WINDOW_SIZE, pm_.prefetch_limit());
+                pm_.prefetch(current, window);
+                readahead_end = current + static_cast<page_id_t>(window);
+            }
             auto &page = pm_.fetch(current, true);
             page_id_t next = page.next_page_id();
             pm_.unpin(current, false);
@@ -221,6 +348,7 @@ namespace kizuna
             {
                 return current;
             }
+            previous = current;
             current = next;
         }
         return start;
@@ -240,7 +368,12 @@ namespace kizuna
             pm_.free_page(new_page_id);
             KIZUNA_THROW_STORAGE(StatusCode::PAGE_FULL, "Record does not fit in empty page", std::to_string(payload.size()));
         }
+        const std::size_t free_bytes = new_page.reclaimable_bytes();
         pm_.unpin(new_page_id, true);
+        if (fsm_)
+        {
+            fsm_->update(new_page_id, free_bytes);
+        }
 
         auto &prev_page = pm_.fetch(previous_tail, true);
         prev_page.set_next_page_id(new_page_id);
@@ -250,7 +383,51 @@ namespace kizuna
         return RowLocation{new_page_id, slot};
     }
 
-    TableHeap::Iterator::Iterator(TableHeap *heap, page_id_t page, slot_id_t slot, bool end)
+    Page &TableHeap::ScanCursor::fetch(page_id_t page_id, bool entering)
+    {
+        BufferAccessStrategy *ring = strategy();
+        if (entering)
+        {
+            read_ahead(page_id, ring);
+        }
+        return pm_->fetch(page_id, true, ring);
+    }
+
+    void TableHeap::ScanCursor::unpin(page_id_t page_id)
+    {
+        pm_->unpin(page_id, false);
+    }
+
+    void TableHeap::ScanCursor::leave(page_id_t page_id)
+    {
+        last_page_ = page_id;
+        ++pages_visited_;
+    }
+
+    BufferAccessStrategy *TableHeap::ScanCursor::strategy()
+    {
+        if (strategy_ != nullptr)
+            return strategy_;
+        // Small scans stay in the shared cache; large ones move to a private ring.
+        if (!own_ring_ && pages_visited_ > pm_->capacity() / config::BULKREAD_SCAN_THRESHOLD_DIVISOR)
+        {
+            own_ring_ = std::make_shared<BufferAccessStrategy>(*pm_);
+        }
+        return own_ring_.get();
+    }
+
+    void TableHeap::ScanCursor::read_ahead(page_id_t page_id, BufferAccessStrategy *strategy)
+    {
+        // Chains are usually allocated in file order: once the scan steps onto the
+        // adjacent page, load the next window in one read instead of page by page.
+        if (page_id != last_page_ + 1 || page_id < readahead_end_)
+            return;
+        const std::size_t window = std::min(config::PREFETCH_WINDOW_SIZE, pm_->prefetch_limit(strategy));
+        pm_->prefetch(page_id, window, strategy);
+        readahead_end_ = page_id + static_cast<page_id_t>(window);
+    }
+
+    TableHeap::Iterator::Iterator(TableHeap *heap, page_id_t page, slot_id_t slot, bool end, BufferAccessStrategy *strategy)
         : heap_(heap), page_(page), slot_(slot), end_(end)
     {
         if (end_ || heap_ == nullptr)
@@ -264,6 +441,7 @@ namespace kizuna
         }
         else
         {
+            cursor_ = ScanCursor(&heap_->pm_, strategy);
             advance();
         }
     }
@@ -298,28 +476,30 @@ namespace kizuna
 
         while (is_valid_page(page_))
         {
-            auto &page = heap_->pm_.fetch(page_, true);
+            auto &page = cursor_.fetch(page_, slot_ == 0);
             const auto slot_count = page.header().slot_count;
             while (slot_ < slot_count)
             {
-                std::vector<uint8_t> data;
-                if (page.read(slot_, data))
+                std::span<const uint8_t> row;
+                if (page.view(slot_, row))
                 {
                     loc_ = RowLocation{page_, slot_};
-                    payload_ = std::move(data);
+                    payload_.assign(row.begin(), row.end());
                     ++slot_;
-                    heap_->pm_.unpin(page_, false);
+                    cursor_.unpin(page_);
                     end_ = false;
                     return;
                 }
                 ++slot_;
             }
             page_id_t next = page.next_page_id();
-            heap_->pm_.unpin(page_, false);
+            cursor_.unpin(page_);
+            cursor_.leave(page_);
             page_ = next;
             slot_ = 0;
         }
 
+        cursor_.finish();
         heap_ = nullptr;
         page_ = config::INVALID_PAGE_ID;
         slot_ = 0;
@@ -356,11 +536,11 @@ namespace kizuna
         }
 
         page_id_t new_root = pm.new_page(PageType::DATA);
-        pm.unpin(new_root, false);
         TableHeap source(pm, source_root);
         TableHeap dest(pm, new_root);
+        BufferAccessStrategy bulk_read(pm);
 
-        source.scan([&](const TableHeap::RowLocation &, const std::vector<uint8_t> &payload) {
+        source.scan([&](const TableHeap::RowLocation &, std::span<const uint8_t> payload) {
             std::vector<record::Field> decoded;
             if (!record::decode(payload.data(), payload.size(), decoded))
             {
@@ -399,9 +579,9 @@ namespace kizuna
                 new_fields.push_back(record::from_null(column.column.type));
             }
 
-            auto encoded = record::encode(new_fields);
+            auto encoded = record::encode(new_fields, record::ROW_FORMAT);
             dest.insert(encoded);
-        });
+        }, &bulk_read);
 
         return new_root;
     }
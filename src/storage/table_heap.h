@@ -2,7 +2,9 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
+#include <span>
 #include <unordered_map>
 #include <vector>
 
@@ -10,6 +12,7 @@
 #include "common/types.h"
 #include "common/value.h"
 #include "catalog/schema.h"
+#include "storage/free_space_map.h"
 #include "storage/page_manager.h"
 
 namespace kizuna
@@ -28,30 +31,89 @@ namespace kizuna
             }
         };
 
+        struct VacuumStats
+        {
+            std::size_t pages_scanned{0};
+            std::size_t pages_compacted{0};
+            std::size_t pages_freed{0};
+            std::size_t bytes_reclaimed{0};
+        };
+
         class Iterator;
+        class PageScan;
 
-        TableHeap(PageManager &pm, page_id_t root_page_id);
+        // tail_hint and fsm_root_page_id come from the table's catalog entry. A valid tail
+        // hint spares the constructor a walk of the page chain; with a free-space map,
+        // inserts reuse space anywhere in the heap instead of only at the tail.
+        TableHeap(PageManager &pm,
+                  page_id_t root_page_id,
+                  page_id_t tail_hint = config::INVALID_PAGE_ID,
+                  page_id_t fsm_root_page_id = config::INVALID_PAGE_ID);
 
         page_id_t root_page_id() const noexcept { return root_page_id_; }
+        page_id_t tail_page_id() const noexcept { return tail_page_id_; }
+        page_id_t fsm_root_page_id() const noexcept
+        {
+            return fsm_ ? fsm_->root_page_id() : config::INVALID_PAGE_ID;
+        }
 
         RowLocation insert(const std::vector<uint8_t> &payload);
         RowLocation update(const RowLocation &loc, const std::vector<uint8_t> &payload);
         bool erase(const RowLocation &loc);
         bool read(const RowLocation &loc, std::vector<uint8_t> &out) const;
         void truncate();
+        // Compacts every page in the chain and unlinks pages left without live rows.
+        // RIDs of surviving rows do not change, so indexes stay valid.
+        VacuumStats vacuum();
 
+        // Full scans may pass a BufferAccessStrategy to read through a private ring.
+        // Without one, the iterator switches to its own ring once the scan grows large.
+        // fn(RowLocation, std::span<const uint8_t>) sees each row in place: the span points
+        // into the pinned page and is only valid during the call. fn may erase rows but
+        // must not insert, update or vacuum this heap.
         template <typename Fn>
-        void scan(Fn &&fn);
+        void scan(Fn &&fn, BufferAccessStrategy *strategy = nullptr);
 
-        Iterator begin();
+        Iterator begin(BufferAccessStrategy *strategy = nullptr);
         Iterator end();
+        // scan() one page per call, for readers that pull rows on demand.
+        PageScan scan_pages(BufferAccessStrategy *strategy = nullptr);
 
     private:
+        // Page access shared by scan() and Iterator: picks the buffer ring and keeps a
+        // read-ahead window loading in front of contiguous chains.
+        class ScanCursor
+        {
+        public:
+            ScanCursor() = default;
+            ScanCursor(PageManager *pm, BufferAccessStrategy *strategy) : pm_(pm), strategy_(strategy) {}
+
+            // entering is true on the first fetch of a page during this scan.
+            Page &fetch(page_id_t page_id, bool entering);
+            void unpin(page_id_t page_id);
+            void leave(page_id_t page_id);
+            void finish() { own_ring_.reset(); }
+
+        private:
+            BufferAccessStrategy *strategy();
+            void read_ahead(page_id_t page_id, BufferAccessStrategy *strategy);
+
+            PageManager *pm_{nullptr};
+            BufferAccessStrategy *strategy_{nullptr};
+            std::shared_ptr<BufferAccessStrategy> own_ring_{};
+            std::size_t pages_visited_{0};
+            page_id_t last_page_{config::INVALID_PAGE_ID};     // page left by the previous step
+            page_id_t readahead_end_{config::INVALID_PAGE_ID}; // first page past the loaded window
+        };
+
         PageManager &pm_;
         page_id_t root_page_id_;
         page_id_t tail_page_id_;
+        std::optional<FreeSpaceMap> fsm_;
 
         page_id_t find_tail(page_id_t start) const;
+        bool is_tail(page_id_t id) const;
+        bool try_insert(page_id_t page_id, const std::vector<uint8_t> &payload, RowLocation &out);
         RowLocation append_new_page(page_id_t previous_tail, const std::vector<uint8_t> &payload);
 
     public:
@@ -79,7 +141,7 @@ namespace kizuna
             const std::vector<uint8_t> &payload() const noexcept { return payload_; }
 
         private:
-            Iterator(TableHeap *heap, page_id_t page, slot_id_t slot, bool end);
+            Iterator(TableHeap *heap, page_id_t page, slot_id_t slot, bool end, BufferAccessStrategy *strategy);
             void advance();
 
             TableHeap *heap_{nullptr};
@@ -88,6 +150,25 @@ namespace kizuna
             RowLocation loc_{};
             std::vector<uint8_t> payload_{};
             bool end_{true};
+            ScanCursor cursor_{};
+
+            friend class TableHeap;
+        };
+
+        class PageScan
+        {
+        public:
+            // Shows fn the rows of the next page in place, as scan() does, and returns false
+            // once the chain is exhausted. No page stays pinned between calls.
+            template <typename Fn>
+            bool next_page(Fn &&fn);
+
+        private:
+            PageScan(PageManager *pm, page_id_t root, BufferAccessStrategy *strategy)
+                : page_id_(root), cursor_(pm, strategy) {}
+
+            page_id_t page_id_;
+            ScanCursor cursor_;
 
             friend class TableHeap;
         };
@@ -96,6 +177,7 @@ namespace kizuna
     class TableHeapMigration
     {
     public:
+        // Reads rows in any record format and writes them back in record::ROW_FORMAT.
         static page_id_t rewrite(PageManager &pm,
                                  page_id_t source_root,
                                  const std::vector<catalog::ColumnCatalogEntry> &old_schema,
@@ -117,11 +199,71 @@ namespace kizuna
     };
 
     template <typename Fn>
-    inline void TableHeap::scan(Fn &&fn)
+    inline void TableHeap::scan(Fn &&fn, BufferAccessStrategy *strategy)
     {
-        for (auto it = begin(); it != end(); ++it)
+        ScanCursor cursor(&pm_, strategy);
+        page_id_t page_id = root_page_id_;
+        while (page_id >= config::FIRST_PAGE_ID)
+        {
+            Page &page = cursor.fetch(page_id, true);
+            try
+            {
+                // slot_count is re-read every step because fn may erase rows here.
+                for (slot_id_t slot = 0; slot < page.header().slot_count; ++slot)
+                {
+                    std::span<const uint8_t> row;
+                    if (page.view(slot, row))
+                    {
+                        fn(RowLocation{page_id, slot}, row);
+                    }
+                }
+            }
+            catch (...)
+            {
+                cursor.unpin(page_id);
+                throw;
+            }
+            const page_id_t next = page.next_page_id();
+            cursor.unpin(page_id);
+            cursor.leave(page_id);
+            page_id = next;
+        }
+        cursor.finish();
+    }
+
+    inline TableHeap::PageScan TableHeap::scan_pages(BufferAccessStrategy *strategy)
+    {
+        return PageScan(&pm_, root_page_id_, strategy);
+    }
+
+    template <typename Fn>
+    inline bool TableHeap::PageScan::next_page(Fn &&fn)
+    {
+        if (page_id_ < config::FIRST_PAGE_ID)
+            return false;
+        const page_id_t page_id = page_id_;
+        Page &page = cursor_.fetch(page_id, true);
+        try
+        {
+            for (slot_id_t slot = 0; slot < page.header().slot_count; ++slot)
+            {
+                std::span<const uint8_t> row;
+                if (page.view(slot, row))
+                {
+                    fn(RowLocation{page_id, slot}, row);
+                }
+            }
+        }
+        catch (...)
         {
-            fn(it.location(), it.payload());
+            cursor_.unpin(page_id);
+            throw;
         }
+        page_id_ = page.next_page_id();
+        cursor_.unpin(page_id);
+        cursor_.leave(page_id);
+        if (page_id_ < config::FIRST_PAGE_ID)
+            cursor_.finish();
+        return true;
     }
 }
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
 #include <memory>
@@ -13,6 +14,7 @@
 #include "storage/file_manager.h"
 #include "storage/page_manager.h"
 #include "storage/index/index_manager.h"
+#include "storage/index/key_codec.h"
 #include "storage/record.h"
 
 using namespace kizuna;
@@ -52,6 +54,15 @@ namespace
         }
     };
 
+    // Entries whose key starts with the encoded column values; non-unique index
+    // keys carry the record id after them.
+    std::size_t count_index_entries(index::BPlusTree &tree, std::vector<uint8_t> prefix)
+    {
+        auto upper = prefix;
+        upper.push_back(index::KeyEncoder::kPrefixEnd);
+        return tree.ScanRange(prefix, true, upper, true).size();
+    }
+
     constexpr const char *kCreateEmployeesSql = "CREATE TABLE employees (id INTEGER PRIMARY KEY, name VARCHAR(32), active BOOLEAN, age INTEGER, joined DATE, nickname VARCHAR(32));";
     constexpr const char *kSeedEmployeesSql = "INSERT INTO employees (id, name, active, age, joined, nickname) VALUES (1, 'amy', TRUE, 25, '2023-05-01', 'ace'), (2, 'beth', TRUE, 34, '2022-04-15', NULL), (3, 'cora', FALSE, 31, '2020-01-01', 'cee'), (4, 'dina', TRUE, 41, '2019-12-12', NULL);";
 
@@ -300,6 +311,209 @@ namespace
         const std::vector<std::vector<std::string>> expected_filtered = {{"amy"}, {"dina"}};
         assert(join_filtered.rows == expected_filtered);
 
+        // Equi-joins run as hash joins, other conditions as a nested loop; both give the
+        // same rows in the same order.
+        std::vector<engine::JoinReport> reports;
+        dml.set_join_observer([&](const engine::JoinReport &report)
+                              { reports.push_back(report); });
+        const std::string basic_sql =
+            "SELECT e.name, b.badge FROM employees AS e INNER JOIN badges AS b ON e.id = b.employee_id;";
+        const std::vector<std::vector<std::string>> expected_unsorted = {
+            {"amy", "mentor"},
+            {"amy", "coach"},
+            {"beth", "lead"},
+            {"dina", "mentor"}
+        };
+        assert(dml.select(sql::parse_select(basic_sql)).rows == expected_unsorted);
+        assert(reports.size() == 1);
+        assert(reports.back().table == "badges");
+        assert(reports.back().strategy == engine::JoinStrategy::HASH);
+        assert(reports.back().spilled_partitions == 0);
+
+        auto join_residual = dml.select(sql::parse_select(
+            "SELECT e.name FROM employees e INNER JOIN badges b ON b.employee_id = e.id AND b.badge = 'mentor';"));
+        assert(join_residual.rows == expected_filtered);
+        assert(reports.back().strategy == engine::JoinStrategy::HASH);
+
+        auto join_range = dml.select(sql::parse_select(
+            "SELECT e.name, b.badge FROM employees e INNER JOIN badges b ON e.id < b.employee_id;"));
+        const std::vector<std::vector<std::string>> expected_range = {
+            {"amy", "lead"},
+            {"amy", "mentor"},
+            {"beth", "mentor"},
+            {"cora", "mentor"}
+        };
+        assert(join_range.rows == expected_range);
+        assert(reports.back().strategy == engine::JoinStrategy::NESTED_LOOP);
+
+        // With no memory to spare both inputs are partitioned to disk.
+        dml.set_join_memory_limit(1);
+        assert(dml.select(sql::parse_select(basic_sql)).rows == expected_unsorted);
+        assert(reports.back().strategy == engine::JoinStrategy::HASH);
+        assert(reports.back().spilled_partitions > 0);
+        dml.set_join_memory_limit(config::HASH_JOIN_MEMORY);
+
+        return true;
+    }
+
+    // orders(id) -> order_lines(order_id): order i has lines 1..2 unless i % 4 == 0, and
+    // customer 'c<i % 20>'.
+    bool index_join_test()
+    {
+        TestContext ctx("dml_exec_index_join");
+        engine::DDLExecutor ddl(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        ddl.create_table("CREATE TABLE orders (id INTEGER PRIMARY KEY, customer VARCHAR(16));");
+        ddl.create_table("CREATE TABLE order_lines (order_id INTEGER, line INTEGER, item VARCHAR(16));");
+        ddl.execute("CREATE INDEX idx_lines_order ON order_lines(order_id);");
+
+        engine::DMLExecutor dml(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        std::string orders_sql = "INSERT INTO orders (id, customer) VALUES ";
+        std::string lines_sql = "INSERT INTO order_lines (order_id, line, item) VALUES (NULL, 1, 'stray')";
+        for (int i = 0; i < 200; ++i)
+        {
+            orders_sql += (i > 0 ? ", (" : "(") + std::to_string(i) + ", 'c" + std::to_string(i % 20) + "')";
+            for (int line = 1; line <= 2 && i % 4 != 0; ++line)
+                lines_sql += ", (" + std::to_string(i) + ", " + std::to_string(line) + ", 'i" + std::to_string(i) + "_" + std::to_string(line) + "')";
+        }
+        dml.insert_into(sql::parse_insert(orders_sql + ";"));
+        dml.insert_into(sql::parse_insert(lines_sql + ";"));
+
+        std::vector<engine::JoinReport> reports;
+        dml.set_join_observer([&](const engine::JoinReport &report)
+                              { reports.push_back(report); });
+
+        // A filtered outer side probes the inner index once per surviving order.
+        auto filtered = dml.select(sql::parse_select(
+            "SELECT o.id, l.item FROM orders o INNER JOIN order_lines l ON o.id = l.order_id "
+            "WHERE o.customer = 'c7' ORDER BY o.id;"));
+        std::vector<std::vector<std::string>> expected;
+        for (int i = 7; i < 200; i += 20)
+        {
+            for (int line = 1; line <= 2; ++line)
+                expected.push_back({std::to_string(i), "i" + std::to_string(i) + "_" + std::to_string(line)});
+        }
+        if (filtered.rows != expected) return false;
+        if (reports.size() != 1 || reports.back().strategy != engine::JoinStrategy::INDEX_NESTED_LOOP) return false;
+        if (reports.back().index != "idx_lines_order" || reports.back().outer_rows != 10) return false;
+
+        // Residual conditions and later WHERE conjuncts still apply to probed rows; the
+        // unique primary key index serves the reverse direction.
+        auto reverse = dml.select(sql::parse_select(
+            "SELECT l.item, o.customer FROM order_lines l INNER JOIN orders o ON l.order_id = o.id AND l.line > 1 "
+            "WHERE l.order_id < 12 AND o.customer <> 'c9';"));
+        const std::vector<std::vector<std::string>> expected_reverse = {
+            {"i1_2", "c1"}, {"i2_2", "c2"}, {"i3_2", "c3"}, {"i5_2", "c5"},
+            {"i6_2", "c6"}, {"i7_2", "c7"}, {"i10_2", "c10"}, {"i11_2", "c11"}};
+        if (reverse.rows != expected_reverse) return false;
+        if (reports.back().strategy != engine::JoinStrategy::INDEX_NESTED_LOOP) return false;
+        if (reports.back().outer_rows != 18) return false;
+
+        // Every order on the outer side: one pass over the inner table beats 200 probes.
+        auto all = dml.select(sql::parse_select(
+            "SELECT COUNT(*) FROM orders o INNER JOIN order_lines l ON o.id = l.order_id;"));
+        if (all.rows != std::vector<std::vector<std::string>>{{"300"}}) return false;
+        if (reports.back().strategy != engine::JoinStrategy::HASH || reports.back().outer_rows != 200) return false;
+
+        return true;
+    }
+
+    // orders(id) -> order_lines(order_id) as in index_join_test, plus unindexed
+    // returns(order_id): orders 1, 3, 5, ... below 180 are returned twice.
+    bool merge_join_test()
+    {
+        TestContext ctx("dml_exec_merge_join");
+        engine::DDLExecutor ddl(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        ddl.create_table("CREATE TABLE orders (id INTEGER PRIMARY KEY, customer VARCHAR(16));");
+        ddl.create_table("CREATE TABLE order_lines (order_id INTEGER, line INTEGER, item VARCHAR(16));");
+        ddl.create_table("CREATE TABLE returns (order_id INTEGER, reason VARCHAR(16));");
+        ddl.execute("CREATE INDEX idx_lines_order ON order_lines(order_id);");
+
+        engine::DMLExecutor dml(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        std::string orders_sql = "INSERT INTO orders (id, customer) VALUES ";
+        std::string lines_sql = "INSERT INTO order_lines (order_id, line, item) VALUES (NULL, 1, 'stray')";
+        std::string returns_sql = "INSERT INTO returns (order_id, reason) VALUES (NULL, 'unknown')";
+        for (int i = 199; i >= 0; --i)
+        {
+            orders_sql += (i < 199 ? ", (" : "(") + std::to_string(i) + ", 'c" + std::to_string(i % 20) + "')";
+            for (int line = 1; line <= 2 && i % 4 != 0; ++line)
+                lines_sql += ", (" + std::to_string(i) + ", " + std::to_string(line) + ", 'i" + std::to_string(i) + "_" + std::to_string(line) + "')";
+            for (int copy = 0; copy < 2 && i % 2 == 1 && i < 180; ++copy)
+                returns_sql += ", (" + std::to_string(i) + ", 'r" + std::to_string(copy) + "')";
+        }
+        dml.insert_into(sql::parse_insert(orders_sql + ";"));
+        dml.insert_into(sql::parse_insert(lines_sql + ";"));
+        dml.insert_into(sql::parse_insert(returns_sql + ";"));
+
+        std::vector<engine::JoinReport> reports;
+        dml.set_join_observer([&](const engine::JoinReport &report)
+                              { reports.push_back(report); });
+
+        // Both sides indexed on the key: the primary key index orders the outer side and the
+        // result needs no further sort.
+        auto ordered = dml.select(sql::parse_select(
+            "SELECT o.id, l.line FROM orders o INNER JOIN order_lines l ON o.id = l.order_id ORDER BY o.id;"));
+        std::vector<std::vector<std::string>> expected;
+        for (int i = 0; i < 200; ++i)
+        {
+            for (int line = 1; line <= 2 && i % 4 != 0; ++line)
+                expected.push_back({std::to_string(i), std::to_string(line)});
+        }
+        if (ordered.rows != expected) return false;
+        if (reports.back().strategy != engine::JoinStrategy::MERGE || reports.back().sorted_outer) return false;
+        if (reports.back().index != "idx_lines_order") return false;
+
+        // The merge already yields ORDER BY order, so LIMIT reads straight from the join.
+        auto limited = dml.select(sql::parse_select(
+            "SELECT o.id, l.line FROM orders o INNER JOIN order_lines l ON o.id = l.order_id ORDER BY o.id LIMIT 5;"));
+        if (limited.rows != std::vector<std::vector<std::string>>(expected.begin(), expected.begin() + 5)) return false;
+        if (reports.back().strategy != engine::JoinStrategy::MERGE) return false;
+
+        // A small outer side is probed instead; its rows are put in key order first.
+        auto probed = dml.select(sql::parse_select(
+            "SELECT r.order_id FROM returns r INNER JOIN order_lines l ON r.order_id = l.order_id "
+            "WHERE r.order_id < 12 ORDER BY r.order_id LIMIT 5;"));
+        if (probed.rows != std::vector<std::vector<std::string>>{{"1"}, {"1"}, {"1"}, {"1"}, {"3"}}) return false;
+        if (reports.back().strategy != engine::JoinStrategy::INDEX_NESTED_LOOP || !reports.back().sorted_outer) return false;
+        auto probed_descending = dml.select(sql::parse_select(
+            "SELECT r.order_id FROM returns r INNER JOIN order_lines l ON r.order_id = l.order_id "
+            "WHERE r.order_id < 12 ORDER BY l.order_id DESC LIMIT 5;"));
+        if (probed_descending.rows != std::vector<std::vector<std::string>>{{"11"}, {"11"}, {"11"}, {"11"}, {"9"}}) return false;
+
+        // Descending, ordered by the inner key column, with ties broken by a later sort.
+        auto descending = dml.select(sql::parse_select(
+            "SELECT o.id, l.line FROM orders o INNER JOIN order_lines l ON o.id = l.order_id "
+            "WHERE o.id > 100 ORDER BY l.order_id DESC, l.line DESC;"));
+        std::vector<std::vector<std::string>> expected_descending;
+        for (int i = 199; i > 100; --i)
+        {
+            for (int line = 2; line >= 1 && i % 4 != 0; --line)
+                expected_descending.push_back({std::to_string(i), std::to_string(line)});
+        }
+        if (descending.rows != expected_descending) return false;
+        if (reports.back().strategy != engine::JoinStrategy::MERGE) return false;
+
+        // An unindexed outer side is sorted first; duplicate keys on both sides pair up.
+        auto duplicates = dml.select(sql::parse_select(
+            "SELECT r.order_id, r.reason, l.line FROM returns r INNER JOIN order_lines l ON r.order_id = l.order_id "
+            "ORDER BY r.order_id, r.reason, l.line;"));
+        std::vector<std::vector<std::string>> expected_duplicates;
+        for (int i = 1; i < 180; i += 2)
+        {
+            for (int copy = 0; copy < 2; ++copy)
+            {
+                for (int line = 1; line <= 2; ++line)
+                    expected_duplicates.push_back({std::to_string(i), "r" + std::to_string(copy), std::to_string(line)});
+            }
+        }
+        if (duplicates.rows != expected_duplicates) return false;
+        if (reports.back().strategy != engine::JoinStrategy::MERGE || !reports.back().sorted_outer) return false;
+
+        // Without a matching ORDER BY the hash join keeps nested-loop order.
+        auto unordered = dml.select(sql::parse_select(
+            "SELECT COUNT(*) FROM orders o INNER JOIN order_lines l ON o.id = l.order_id;"));
+        if (unordered.rows != std::vector<std::vector<std::string>>{{"300"}}) return false;
+        if (reports.back().strategy != engine::JoinStrategy::HASH) return false;
+
         return true;
     }
 
@@ -418,24 +632,31 @@ namespace
         assert(index_entry.has_value());
 
         auto handle = ctx.index_manager->OpenIndex(*index_entry);
-        std::vector<record::Field> fields;
-        fields.push_back(record::from_string("sku1"));
-        auto key = record::encode(fields);
-        auto lookup = handle->tree().Search(key);
-        assert(lookup.found);
+        index::KeyEncoder key_encoder;
+        key_encoder.append_string("sku1");
+        auto key = key_encoder.take();
+        assert(count_index_entries(handle->tree(), key) == 1);
 
         dml.delete_all(sql::parse_delete("DELETE FROM items WHERE id = 1;"));
 
         index_entry = ctx.catalog->get_index("idx_items_sku");
         assert(index_entry.has_value());
         handle = ctx.index_manager->OpenIndex(*index_entry);
-        lookup = handle->tree().Search(key);
-        assert(!lookup.found);
+        assert(count_index_entries(handle->tree(), key) == 0);
 
         auto remaining = dml.select(sql::parse_select("SELECT sku FROM items;"));
         assert(remaining.rows.size() == 1);
         assert(remaining.rows[0][0] == "sku2");
 
+        // Equal values in a non-unique index stay separate entries.
+        dml.insert_into(sql::parse_insert("INSERT INTO items (id, sku, price) VALUES (3, 'sku2', 300);"));
+        handle = ctx.index_manager->OpenIndex(*ctx.catalog->get_index("idx_items_sku"));
+        index::KeyEncoder dup_encoder;
+        dup_encoder.append_string("sku2");
+        assert(count_index_entries(handle->tree(), dup_encoder.take()) == 2);
+        auto duplicates = dml.select(sql::parse_select("SELECT id FROM items WHERE sku = 'sku2' ORDER BY id;"));
+        assert((duplicates.rows == std::vector<std::vector<std::string>>{{"2"}, {"3"}}));
+
         return true;
     }
 
@@ -456,19 +677,17 @@ namespace
         assert(index_entry.has_value());
         auto handle = ctx.index_manager->OpenIndex(*index_entry);
 
-        std::vector<record::Field> composite;
-        composite.push_back(record::from_string("skuA"));
-        composite.push_back(record::from_string("north"));
-        auto composite_key = record::encode(composite);
-        auto found = handle->tree().Search(composite_key);
-        assert(found.found);
+        index::KeyEncoder composite;
+        composite.append_string("skuA");
+        composite.append_string("north");
+        auto composite_key = composite.take();
+        assert(count_index_entries(handle->tree(), composite_key) == 1);
 
-        std::vector<record::Field> alt_key_fields;
-        alt_key_fields.push_back(record::from_string("skuB"));
-        alt_key_fields.push_back(record::from_string("north"));
-        auto alt_key = record::encode(alt_key_fields);
-        auto alt_lookup = handle->tree().Search(alt_key);
-        assert(alt_lookup.found);
+        index::KeyEncoder alt_key_fields;
+        alt_key_fields.append_string("skuB");
+        alt_key_fields.append_string("north");
+        auto alt_key = alt_key_fields.take();
+        assert(count_index_entries(handle->tree(), alt_key) == 1);
 
         dml.delete_all(sql::parse_delete("DELETE FROM inventory WHERE id = 1;"));
 
@@ -476,11 +695,8 @@ namespace
         assert(index_entry.has_value());
         handle = ctx.index_manager->OpenIndex(*index_entry);
 
-        found = handle->tree().Search(composite_key);
-        assert(!found.found);
-
-        alt_lookup = handle->tree().Search(alt_key);
-        assert(alt_lookup.found);
+        assert(count_index_entries(handle->tree(), composite_key) == 0);
+        assert(count_index_entries(handle->tree(), alt_key) == 1);
 
         auto remaining = dml.select(sql::parse_select("SELECT sku, vendor FROM inventory;"));
         assert(remaining.rows.size() == 2);
@@ -516,17 +732,15 @@ namespace
         assert(index_entry.has_value());
         auto handle = ctx.index_manager->OpenIndex(*index_entry);
 
-        std::vector<record::Field> fields;
-        fields.push_back(record::from_string("sku1"));
-        auto old_key = record::encode(fields);
-        auto lookup_old = handle->tree().ScanEqual(old_key);
-        assert(lookup_old.empty());
+        index::KeyEncoder old_fields;
+        old_fields.append_string("sku1");
+        auto old_key = old_fields.take();
+        assert(count_index_entries(handle->tree(), old_key) == 0);
 
-        fields.clear();
-        fields.push_back(record::from_string("sku9"));
-        auto new_key = record::encode(fields);
-        auto lookup_new = handle->tree().ScanEqual(new_key);
-        assert(lookup_new.size() == 1);
+        index::KeyEncoder new_fields;
+        new_fields.append_string("sku9");
+        auto new_key = new_fields.take();
+        assert(count_index_entries(handle->tree(), new_key) == 1);
 
         auto rows = dml.select(sql::parse_select("SELECT sku FROM items WHERE id = 1;"));
         assert(rows.rows.size() == 1);
@@ -535,6 +749,152 @@ namespace
         return true;
     }
 
+    bool vacuum_test()
+    {
+        TestContext ctx("dml_exec_vacuum");
+        engine::DDLExecutor ddl(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        ddl.create_table("CREATE TABLE notes (id INTEGER, body VARCHAR(64));");
+        ddl.execute("CREATE INDEX idx_notes_body ON notes(body);");
+
+        engine::DMLExecutor dml(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        for (int batch = 0; batch < 10; ++batch)
+        {
+            std::string sql = "INSERT INTO notes (id, body) VALUES ";
+            for (int i = 0; i < 50; ++i)
+            {
+                const int id = batch * 50 + i;
+                if (i > 0)
+                    sql += ", ";
+                sql += "(" + std::to_string(id) + ", 'note number " + std::to_string(id) + " padded out')";
+            }
+            sql += ";";
+            dml.insert_into(sql::parse_insert(sql));
+        }
+
+        auto deleted = dml.delete_all(sql::parse_delete("DELETE FROM notes WHERE id > 20 AND id < 480;"));
+        if (deleted.rows_deleted != 459) return false;
+
+        auto result = dml.vacuum(sql::parse_vacuum("VACUUM notes;"));
+        if (result.pages_freed == 0) return false;
+        if (dml.execute("VACUUM notes;") != "Pages compacted: 0, pages freed: 0") return false;
+
+        auto rows = dml.select(sql::parse_select("SELECT id FROM notes WHERE body = 'note number 490 padded out';"));
+        if (rows.rows != std::vector<std::vector<std::string>>{{"490"}}) return false;
+        auto all = dml.select(sql::parse_select("SELECT id FROM notes;"));
+        if (all.rows.size() != 41) return false;
+
+        dml.insert_into(sql::parse_insert("INSERT INTO notes (id, body) VALUES (1000, 'after vacuum');"));
+        auto after = dml.select(sql::parse_select("SELECT id FROM notes WHERE id >= 490;"));
+        if (after.rows.size() != 11) return false;
+
+        bool caught = false;
+        try
+        {
+            dml.vacuum(sql::parse_vacuum("VACUUM missing;"));
+        }
+        catch (const QueryException &ex)
+        {
+            caught = ex.code() == StatusCode::TABLE_NOT_FOUND;
+        }
+        return caught;
+    }
+
+    bool late_decode_test()
+    {
+        TestContext ctx("dml_exec_late_decode");
+        engine::DDLExecutor ddl(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        ddl.create_table("CREATE TABLE wide (id INTEGER, a VARCHAR(16), b INTEGER, c VARCHAR(16), d INTEGER, e BOOLEAN);");
+
+        engine::DMLExecutor dml(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        std::string sql = "INSERT INTO wide (id, a, b, c, d, e) VALUES ";
+        for (int i = 0; i < 40; ++i)
+        {
+            if (i > 0)
+                sql += ", ";
+            sql += "(" + std::to_string(i) + ", 'a" + std::to_string(i) + "', " + std::to_string(i % 5) + ", " +
+                   (i % 3 == 0 ? std::string("NULL") : "'c" + std::to_string(i) + "'") + ", " + std::to_string(i * 10) + ", " +
+                   (i % 2 == 0 ? "TRUE" : "FALSE") + ")";
+        }
+        sql += ";";
+        dml.insert_into(sql::parse_insert(sql));
+
+        // Filter on one column, project another and sort on a third.
+        auto projected = dml.select(sql::parse_select("SELECT c FROM wide WHERE b = 2 AND e = TRUE ORDER BY id DESC;"));
+        if (projected.rows != std::vector<std::vector<std::string>>{{"c32"}, {"c22"}, {"NULL"}, {"c2"}}) return false;
+
+        auto star = dml.select(sql::parse_select("SELECT * FROM wide WHERE c IS NULL AND b = 4;"));
+        if (star.rows.size() != 3 || star.rows[0].size() != 6) return false;
+        if (star.rows[0][0] != "9" || star.rows[0][1] != "a9" || star.rows[0][5] != "FALSE") return false;
+
+        auto aggregate = dml.select(sql::parse_select("SELECT COUNT(*), SUM(b), MAX(a) FROM wide WHERE e = FALSE;"));
+        if (aggregate.rows != std::vector<std::vector<std::string>>{{"20", "40", "a9"}}) return false;
+
+        auto updated = dml.update_all(sql::parse_update("UPDATE wide SET a = 'z' WHERE b = 0;"));
+        if (updated.rows_updated != 8) return false;
+        auto after_update = dml.select(sql::parse_select("SELECT id, c FROM wide WHERE a = 'z' AND id < 10;"));
+        if (after_update.rows != std::vector<std::vector<std::string>>{{"0", "NULL"}, {"5", "c5"}}) return false;
+
+        auto deleted = dml.delete_all(sql::parse_delete("DELETE FROM wide WHERE d > 295;"));
+        if (deleted.rows_deleted != 10) return false;
+        auto remaining = dml.select(sql::parse_select("SELECT COUNT(*) FROM wide;"));
+        return remaining.rows == std::vector<std::vector<std::string>>{{"30"}};
+    }
+
+    bool vectorized_filter_test()
+    {
+        TestContext ctx("dml_exec_vectorized_filter");
+        engine::DDLExecutor ddl(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        ddl.create_table("CREATE TABLE readings (id INTEGER, sensor VARCHAR(16), value INTEGER, ok BOOLEAN, taken DATE);");
+
+        engine::DMLExecutor dml(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        // Enough rows for several column batches, with NULLs in every column but id.
+        for (int start = 0; start < 3000; start += 500)
+        {
+            std::string sql = "INSERT INTO readings (id, sensor, value, ok, taken) VALUES ";
+            for (int i = start; i < start + 500; ++i)
+            {
+                if (i > start)
+                    sql += ", ";
+                sql += "(" + std::to_string(i) + ", " +
+                       (i % 7 == 0 ? std::string("NULL") : "'s" + std::to_string(i % 13) + "'") + ", " +
+                       (i % 11 == 0 ? std::string("NULL") : std::to_string(i % 100)) + ", " +
+                       (i % 5 == 0 ? "NULL" : (i % 2 == 0 ? "TRUE" : "FALSE")) + ", " +
+                       (i % 17 == 0 ? std::string("NULL") : "'2024-01-" + std::to_string(10 + i % 20) + "'") + ")";
+            }
+            dml.insert_into(sql::parse_insert(sql + ";"));
+        }
+
+        // Each query runs through the batch kernels and row by row, with the same result.
+        const std::vector<std::string> queries = {
+            "SELECT id FROM readings WHERE value > 50 AND sensor = 's3';",
+            "SELECT id, ok FROM readings WHERE NOT (ok = TRUE) OR value IS NULL;",
+            "SELECT COUNT(*) FROM readings WHERE sensor IS NOT NULL AND NOT (id >= 1500);",
+            "SELECT id FROM readings WHERE taken <= '2024-01-12' OR sensor < 's10' ORDER BY id DESC LIMIT 25;",
+            "SELECT DISTINCT sensor FROM readings WHERE ok;",
+            "SELECT id FROM readings WHERE value = id OR NULL;",
+        };
+        for (const auto &query : queries)
+        {
+            dml.set_vectorized_filters(true);
+            auto batched = dml.select(sql::parse_select(query));
+            dml.set_vectorized_filters(false);
+            auto row_at_a_time = dml.select(sql::parse_select(query));
+            if (batched.rows != row_at_a_time.rows || batched.rows.empty()) return false;
+        }
+        dml.set_vectorized_filters(true);
+
+        // A predicate the kernels cannot run still reports its error from the row path.
+        try
+        {
+            dml.select(sql::parse_select("SELECT id FROM readings WHERE sensor = 5;"));
+            return false;
+        }
+        catch (const QueryException &)
+        {
+        }
+        return true;
+    }
+
     bool index_usage_select_test()
     {
         TestContext ctx("dml_exec_index_usage");
@@ -560,6 +920,264 @@ namespace
 
         return true;
     }
+
+    bool index_range_order_test()
+    {
+        TestContext ctx("dml_exec_index_range");
+        engine::DDLExecutor ddl(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        ddl.create_table("CREATE TABLE points (id INTEGER PRIMARY KEY, label VARCHAR(16));");
+
+        engine::DMLExecutor dml(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        dml.insert_into(sql::parse_insert("INSERT INTO points (id, label) VALUES "
+                                          "(-300, 'a'), (-2, 'b'), (-1, 'c'), (0, 'd'), (1, 'e'), (255, 'f'), (256, 'g'), (70000, 'h');"));
+
+        bool index_used = false;
+        dml.set_index_usage_observer([&](const catalog::IndexCatalogEntry &entry,
+                                         const std::vector<record_id_t> &)
+                                     {
+                                         if (entry.is_primary)
+                                             index_used = true;
+                                     });
+
+        // Little-endian keys put 256 before 255 and negatives after positives.
+        auto rows = dml.select(sql::parse_select("SELECT label FROM points WHERE id >= -2 AND id <= 256;"));
+        assert(index_used);
+        std::vector<std::string> labels;
+        for (const auto &row : rows.rows)
+            labels.push_back(row[0]);
+        std::sort(labels.begin(), labels.end());
+        assert((labels == std::vector<std::string>{"b", "c", "d", "e", "f", "g"}));
+
+        rows = dml.select(sql::parse_select("SELECT id FROM points WHERE id > 255;"));
+        assert(rows.rows.size() == 2);
+
+        return true;
+    }
+
+    bool index_cursor_limit_test()
+    {
+        TestContext ctx("dml_exec_index_cursor");
+        engine::DDLExecutor ddl(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        ddl.create_table("CREATE TABLE scores (id INTEGER PRIMARY KEY, score INTEGER);");
+        ddl.execute("CREATE INDEX idx_scores_score ON scores(score);");
+
+        engine::DMLExecutor dml(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        std::string insert_sql = "INSERT INTO scores (id, score) VALUES ";
+        for (int i = 1; i <= 200; ++i)
+        {
+            if (i > 1)
+                insert_sql += ", ";
+            const std::string score = (i % 50 == 0) ? "NULL" : std::to_string(1000 - i);
+            insert_sql += "(" + std::to_string(i) + ", " + score + ")";
+        }
+        dml.insert_into(sql::parse_insert(insert_sql + ";"));
+
+        std::size_t visited = 0;
+        dml.set_index_usage_observer([&](const catalog::IndexCatalogEntry &,
+                                         const std::vector<record_id_t> &ids)
+                                     { visited = ids.size(); });
+
+        // Index order plus LIMIT reads only as many entries as rows returned.
+        auto top = dml.select(sql::parse_select("SELECT id FROM scores ORDER BY id DESC LIMIT 3;"));
+        assert((top.rows == std::vector<std::vector<std::string>>{{"200"}, {"199"}, {"198"}}));
+        assert(visited == 3);
+
+        auto ranged = dml.select(sql::parse_select("SELECT id FROM scores WHERE id > 10 ORDER BY id LIMIT 2;"));
+        assert((ranged.rows == std::vector<std::vector<std::string>>{{"11"}, {"12"}}));
+        assert(visited == 2);
+
+        auto unordered = dml.select(sql::parse_select("SELECT id FROM scores WHERE id >= 150 LIMIT 4;"));
+        assert(unordered.rows.size() == 4);
+        assert(visited == 4);
+
+        // Index keys sort NULLs last, as ORDER BY does.
+        auto ascending = dml.select(sql::parse_select("SELECT score FROM scores ORDER BY score;"));
+        assert(ascending.rows.size() == 200);
+        assert(ascending.rows.front()[0] == "801");
+        for (std::size_t i = 196; i < 200; ++i)
+            assert(ascending.rows[i][0] == "NULL");
+
+        auto descending = dml.select(sql::parse_select("SELECT score FROM scores ORDER BY score DESC LIMIT 2;"));
+        assert((descending.rows == std::vector<std::vector<std::string>>{{"999"}, {"998"}}));
+
+        return true;
+    }
+
+    bool create_index_on_existing_rows_test()
+    {
+        TestContext ctx("dml_exec_index_bulk");
+        engine::DDLExecutor ddl(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        ddl.create_table("CREATE TABLE parts (id INTEGER PRIMARY KEY, code VARCHAR(16), bin INTEGER);");
+
+        engine::DMLExecutor dml(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        std::string insert_sql = "INSERT INTO parts (id, code, bin) VALUES ";
+        for (int i = 1; i <= 600; ++i)
+        {
+            if (i > 1)
+                insert_sql += ", ";
+            insert_sql += "(" + std::to_string(i) + ", 'p" + std::to_string(i) + "', " + std::to_string(i % 7) + ")";
+        }
+        dml.insert_into(sql::parse_insert(insert_sql + ";"));
+
+        // The index is built from the rows already in the table.
+        ddl.execute("CREATE UNIQUE INDEX idx_parts_code ON parts(code);");
+        bool index_used = false;
+        dml.set_index_usage_observer([&](const catalog::IndexCatalogEntry &entry,
+                                         const std::vector<record_id_t> &)
+                                     {
+                                         if (entry.name == "idx_parts_code")
+                                             index_used = true;
+                                     });
+        auto rows = dml.select(sql::parse_select("SELECT id FROM parts WHERE code = 'p417';"));
+        assert(index_used);
+        assert((rows.rows == std::vector<std::vector<std::string>>{{"417"}}));
+
+        // Duplicate values make a unique build fail and leave nothing behind.
+        bool threw = false;
+        try
+        {
+            ddl.execute("CREATE UNIQUE INDEX idx_parts_bin ON parts(bin);");
+        }
+        catch (const DBException &ex)
+        {
+            threw = ex.code() == StatusCode::DUPLICATE_KEY;
+        }
+        assert(threw);
+        assert(!ctx.catalog->get_index("idx_parts_bin").has_value());
+
+        // Later inserts land in the bulk-built tree.
+        dml.insert_into(sql::parse_insert("INSERT INTO parts (id, code, bin) VALUES (601, 'p0', 0);"));
+        rows = dml.select(sql::parse_select("SELECT id FROM parts WHERE code = 'p0';"));
+        assert((rows.rows == std::vector<std::vector<std::string>>{{"601"}}));
+
+        return true;
+    }
+
+    bool legacy_index_upgrade_test()
+    {
+        catalog::IndexCatalogEntry legacy;
+        legacy.index_id = 7;
+        legacy.table_id = 3;
+        legacy.name = "idx_legacy";
+        legacy.column_ids = {1};
+        auto bytes = legacy.serialize();
+        bytes.pop_back(); // entries written before the key format byte
+        std::size_t consumed = 0;
+        auto decoded = catalog::IndexCatalogEntry::deserialize(bytes.data(), bytes.size(), consumed);
+        assert(consumed == bytes.size());
+        assert(decoded.key_format == catalog::IndexKeyFormat::RECORD);
+
+        TestContext ctx("dml_exec_index_upgrade");
+        engine::DDLExecutor ddl(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        ddl.create_table("CREATE TABLE items (id INTEGER PRIMARY KEY, sku VARCHAR(16));");
+        ddl.execute("CREATE INDEX idx_items_sku ON items(sku);");
+
+        engine::DMLExecutor dml(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        dml.insert_into(sql::parse_insert("INSERT INTO items (id, sku) VALUES (-1, 'neg'), (1, 'pos'), (256, 'big');"));
+
+        auto index_entry = ctx.catalog->get_index("idx_items_sku");
+        assert(index_entry.has_value());
+        assert(index_entry->key_format == catalog::CURRENT_INDEX_KEY_FORMAT);
+
+        // Rewrite the index as it was stored before memcomparable keys: one record::encode
+        // V1 key per value, which does not sort in value order.
+        const std::vector<std::string> skus{"neg", "pos", "big"};
+        std::vector<record_id_t> record_ids;
+        {
+            auto handle = ctx.index_manager->OpenIndex(*index_entry);
+            for (const auto &sku : skus)
+            {
+                index::KeyEncoder key;
+                key.append_string(sku);
+                auto prefix = key.take();
+                auto upper = prefix;
+                upper.push_back(index::KeyEncoder::kPrefixEnd);
+                auto ids = handle->tree().ScanRange(prefix, true, upper, true);
+                assert(ids.size() == 1);
+                record_ids.push_back(ids.front());
+            }
+        }
+        auto legacy_key = [](const std::string &sku)
+        { return record::encode({record::from_string(sku)}, record::RecordFormat::V1); };
+        ctx.index_manager->DropIndex(*index_entry);
+        catalog::IndexCatalogEntry legacy_entry = *index_entry;
+        legacy_entry.root_page_id = config::INVALID_PAGE_ID;
+        legacy_entry.key_format = catalog::IndexKeyFormat::RECORD;
+        {
+            auto handle = ctx.index_manager->CreateIndex(legacy_entry);
+            for (std::size_t i = 0; i < skus.size(); ++i)
+                handle->tree().Insert(legacy_key(skus[i]), record_ids[i]);
+            ctx.catalog->set_index_root(index_entry->index_id, handle->tree().root_page_id());
+        }
+        ctx.catalog->set_index_key_format(index_entry->index_id, catalog::IndexKeyFormat::RECORD);
+
+        // The first query through the table's indexes spots the legacy format and rebuilds.
+        auto rows = dml.select(sql::parse_select("SELECT id FROM items WHERE sku = 'big';"));
+        assert(rows.rows.size() == 1);
+        assert(rows.rows[0][0] == "256");
+        for (const auto &entry : ctx.catalog->get_indexes(index_entry->table_id))
+            assert(entry.key_format == catalog::CURRENT_INDEX_KEY_FORMAT);
+
+        index_entry = ctx.catalog->get_index("idx_items_sku");
+        auto handle = ctx.index_manager->OpenIndex(*index_entry);
+        for (std::size_t i = 0; i < skus.size(); ++i)
+        {
+            index::KeyEncoder key;
+            key.append_string(skus[i]);
+            assert(count_index_entries(handle->tree(), key.take()) == 1);
+            assert(handle->tree().ScanEqual(legacy_key(skus[i])).empty());
+        }
+
+        return true;
+    }
+
+    // Memcomparable indexes from before NULLs sorted last carry a 0x00 NULL tag and are
+    // rebuilt like RECORD ones; read as they are, ORDER BY would put NULL first.
+    bool nulls_first_index_upgrade_test()
+    {
+        TestContext ctx("dml_exec_nulls_first_upgrade");
+        engine::DDLExecutor ddl(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        ddl.create_table("CREATE TABLE tags (id INTEGER PRIMARY KEY, label VARCHAR(16));");
+        ddl.execute("CREATE INDEX idx_tags_label ON tags(label);");
+        engine::DMLExecutor dml(*ctx.catalog, *ctx.pm, ctx.fm, *ctx.index_manager);
+        dml.insert_into(sql::parse_insert("INSERT INTO tags (id, label) VALUES (1, 'b'), (2, NULL), (3, 'a');"));
+
+        auto index_entry = ctx.catalog->get_index("idx_tags_label");
+        assert(index_entry.has_value());
+        std::vector<std::pair<std::vector<uint8_t>, record_id_t>> entries;
+        {
+            auto handle = ctx.index_manager->OpenIndex(*index_entry);
+            for (auto cursor = handle->tree().SeekFirst(); cursor.Valid(); cursor.Next())
+            {
+                std::vector<uint8_t> key(cursor.Key().begin(), cursor.Key().end());
+                if (key.front() == index::KeyEncoder::kNullTag)
+                    key.front() = 0x00;
+                entries.emplace_back(std::move(key), cursor.Value());
+            }
+        }
+        assert(entries.size() == 3);
+        ctx.index_manager->DropIndex(*index_entry);
+        catalog::IndexCatalogEntry old_entry = *index_entry;
+        old_entry.root_page_id = config::INVALID_PAGE_ID;
+        old_entry.key_format = catalog::IndexKeyFormat::MEMCOMPARABLE;
+        {
+            auto handle = ctx.index_manager->CreateIndex(old_entry);
+            for (const auto &[key, record_id] : entries)
+                handle->tree().Insert(key, record_id);
+            ctx.catalog->set_index_root(index_entry->index_id, handle->tree().root_page_id());
+        }
+        ctx.catalog->set_index_key_format(index_entry->index_id, catalog::IndexKeyFormat::MEMCOMPARABLE);
+
+        auto rows = dml.select(sql::parse_select("SELECT id FROM tags ORDER BY label;"));
+        assert((rows.rows == std::vector<std::vector<std::string>>{{"3"}, {"1"}, {"2"}}));
+        index_entry = ctx.catalog->get_index("idx_tags_label");
+        assert(index_entry->key_format == catalog::CURRENT_INDEX_KEY_FORMAT);
+        auto handle = ctx.index_manager->OpenIndex(*index_entry);
+        auto last = handle->tree().SeekLast();
+        assert(last.Valid() && last.Key().front() == index::KeyEncoder::kNullTag);
+
+        return true;
+    }
 }
 
 bool index_maintenance_tests()
@@ -570,5 +1188,8 @@ bool index_maintenance_tests()
 bool dml_executor_tests()
 {
     return basic_flow() && projection_limit_tests() && predicate_null_tests() && order_by_tests() && distinct_tests() &&
-           aggregate_tests() && join_tests() && error_reporting_tests() && index_usage_select_test() && index_maintenance_tests();
+           aggregate_tests() && join_tests() && index_join_test() && merge_join_test() && error_reporting_tests() && index_usage_select_test() && index_maintenance_tests() &&
+           index_range_order_test() && index_cursor_limit_test() && create_index_on_existing_rows_test() &&
+           legacy_index_upgrade_test() && nulls_first_index_upgrade_test() &&
+           vacuum_test() && late_decode_test() && vectorized_filter_test();
 }
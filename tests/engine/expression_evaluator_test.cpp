@@ -131,6 +131,16 @@ bool expression_evaluator_tests()
     null_name[1] = Value::null(DataType::VARCHAR);
     assert(evaluator.evaluate_predicate(*name_equals_alice, null_name) == TriBool::Unknown);
 
+    // Column collection drives late row decoding: only these slots are decoded before WHERE.
+    std::vector<std::size_t> referenced;
+    evaluator.collect_columns(*combined, referenced);
+    evaluator.collect_columns(*active_or_null, referenced);
+    assert((referenced == std::vector<std::size_t>{3, 2, 2, 4}));
+    std::vector<Value> sparse_row(row.size(), Value::null());
+    for (std::size_t index : referenced)
+        sparse_row[index] = row[index];
+    assert(evaluator.evaluate_predicate(*combined, sparse_row) == evaluator.evaluate_predicate(*combined, row));
+
     bool exception_caught = false;
     try
     {
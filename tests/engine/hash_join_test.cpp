@@ -0,0 +1,179 @@
+#include <algorithm>
+#include <cassert>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "engine/hash_join.h"
+#include "sql/dml_parser.h"
+
+using namespace kizuna;
+using namespace kizuna::engine;
+
+namespace
+{
+    using Row = HashJoin::Row;
+    using Pairs = std::vector<std::pair<std::size_t, std::size_t>>;
+
+    std::size_t partition_files_on_disk()
+    {
+        std::size_t files = 0;
+        for (const auto &entry : std::filesystem::directory_iterator(config::temp_dir()))
+        {
+            if (entry.path().filename().string().rfind("hash_join_", 0) == 0)
+                ++files;
+        }
+        return files;
+    }
+
+    ExpressionEvaluator::BindingEntry binding(std::string table, std::string column, std::size_t index, DataType type)
+    {
+        ExpressionEvaluator::BindingEntry entry;
+        entry.column_name = std::move(column);
+        entry.index = index;
+        entry.type = type;
+        entry.qualifiers.push_back(std::move(table));
+        return entry;
+    }
+
+    // a(id INTEGER, name VARCHAR) joined to b(a_id BIGINT, label VARCHAR, score DOUBLE, flag BOOLEAN).
+    void check_key_detection()
+    {
+        const ExpressionEvaluator evaluator(std::vector<ExpressionEvaluator::BindingEntry>{
+            binding("a", "id", 0, DataType::INTEGER),
+            binding("a", "name", 1, DataType::VARCHAR),
+            binding("b", "a_id", 2, DataType::BIGINT),
+            binding("b", "label", 3, DataType::VARCHAR),
+            binding("b", "score", 4, DataType::DOUBLE),
+            binding("b", "flag", 5, DataType::BOOLEAN),
+        });
+        auto keys_for = [&](const std::string &on)
+        {
+            auto stmt = sql::parse_select("SELECT * FROM a INNER JOIN b ON " + on + ";");
+            return find_equi_join_keys(*stmt.joins[0].condition, evaluator, 2, "JOIN condition");
+        };
+
+        // Either operand order; numeric types of different widths still hash together.
+        auto keys = keys_for("b.label = a.name AND a.id = b.a_id AND b.score > 1");
+        assert(keys.has_value());
+        assert((keys->left == std::vector<std::size_t>{1, 0}));
+        assert((keys->right == std::vector<std::size_t>{1, 0}));
+        assert(keys->residual.size() == 1);
+
+        // Same-side equalities, OR, and types that cannot compare are left to the nested loop.
+        assert(!keys_for("a.id = a.id").has_value());
+        assert(!keys_for("a.id = b.a_id OR a.name = b.label").has_value());
+        assert(!keys_for("a.name = b.flag").has_value());
+        // Resolution errors surface from the nested loop instead.
+        assert(!keys_for("a.id = b.missing").has_value());
+    }
+
+    struct Input
+    {
+        std::vector<Row> rows;
+        HashJoin::RowSource source() const
+        {
+            return [this](const HashJoin::RowSink &sink)
+            {
+                for (const auto &row : rows)
+                    sink(Row(row));
+            };
+        }
+    };
+
+    // Left rows are (key INTEGER, tag VARCHAR); right rows are (tag VARCHAR, key BIGINT).
+    // Every `null_every`-th row has a NULL key.
+    Input make_left(std::size_t count, std::size_t distinct, std::size_t null_every)
+    {
+        Input input;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Value key = i % null_every == 0 ? Value::null(DataType::INTEGER)
+                                            : Value::int32(static_cast<int32_t>((i * 7) % distinct));
+            input.rows.push_back({key, Value::string("left_" + std::to_string(i))});
+        }
+        return input;
+    }
+
+    Input make_right(std::size_t count, std::size_t distinct, std::size_t null_every)
+    {
+        Input input;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Value key = i % null_every == 0 ? Value::null(DataType::BIGINT)
+                                            : Value::int64(static_cast<int64_t>((i * 3) % distinct));
+            input.rows.push_back({Value::string("right_" + std::to_string(i)), key});
+        }
+        return input;
+    }
+
+    Pairs nested_loop(const Input &left, const Input &right)
+    {
+        Pairs pairs;
+        for (std::size_t l = 0; l < left.rows.size(); ++l)
+        {
+            for (std::size_t r = 0; r < right.rows.size(); ++r)
+            {
+                if (compare(left.rows[l][0], right.rows[r][1]) == CompareResult::Equal)
+                    pairs.emplace_back(l, r);
+            }
+        }
+        return pairs;
+    }
+
+    Pairs hash_join(HashJoin &join, const Input &left, const Input &right)
+    {
+        Pairs pairs;
+        join.run(left.source(), right.source(),
+                 [&](std::size_t l, const Row &left_row, std::size_t r, const Row &right_row)
+                 {
+                     assert(left_row[1].as_string() == "left_" + std::to_string(l));
+                     assert(right_row[0].as_string() == "right_" + std::to_string(r));
+                     pairs.emplace_back(l, r);
+                 });
+        return pairs;
+    }
+
+    void check_join(const Input &left, const Input &right, std::size_t memory_limit,
+                    bool expect_spill, bool expect_ordered)
+    {
+        const std::size_t files_before = partition_files_on_disk();
+        const Pairs expected = nested_loop(left, right);
+        Pairs actual;
+        {
+            HashJoin join({0}, {1}, memory_limit);
+            actual = hash_join(join, left, right);
+            assert((join.spilled_partitions() > 0) == expect_spill);
+            assert(join.ordered() == expect_ordered);
+            if (join.ordered())
+                assert(actual == expected);
+        }
+        std::sort(actual.begin(), actual.end());
+        assert(actual == expected);
+        assert(partition_files_on_disk() == files_before);
+    }
+}
+
+bool hash_join_tests()
+{
+    std::filesystem::create_directories(config::temp_dir());
+    check_key_detection();
+
+    // In memory: a smaller right input is the build side and the output keeps
+    // nested-loop order; a smaller left input is built on instead.
+    check_join(make_left(300, 40, 11), make_right(90, 40, 7), config::HASH_JOIN_MEMORY, false, true);
+    check_join(make_left(60, 40, 11), make_right(500, 40, 7), config::HASH_JOIN_MEMORY, false, false);
+
+    // Both inputs past the limit spill to partitions; so does a left input alone.
+    check_join(make_left(3000, 500, 13), make_right(2500, 500, 9), 16 * 1024, true, false);
+    check_join(make_left(3000, 500, 13), make_right(40, 500, 9), 16 * 1024, true, false);
+
+    // Few distinct keys: partitions stay oversized through every level and are joined anyway.
+    check_join(make_left(800, 2, 50), make_right(600, 2, 50), 4 * 1024, true, false);
+
+    // Empty inputs.
+    check_join(Input{}, make_right(50, 10, 7), config::HASH_JOIN_MEMORY, false, false);
+    check_join(make_left(50, 10, 7), Input{}, config::HASH_JOIN_MEMORY, false, true);
+    return true;
+}
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "engine/merge_join.h"
+
+using namespace kizuna;
+using namespace kizuna::engine;
+
+namespace
+{
+    using Row = MergeJoin::Row;
+    using Pairs = std::vector<std::pair<std::size_t, std::size_t>>;
+
+    // Left rows are (key INTEGER, ordinal BIGINT); right rows are (ordinal BIGINT, key BIGINT).
+    // Every `null_every`-th row has a NULL key.
+    std::vector<Row> make_left(std::size_t count, std::size_t distinct, std::size_t null_every)
+    {
+        std::vector<Row> rows;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Value key = i % null_every == 0 ? Value::null(DataType::INTEGER)
+                                            : Value::int32(static_cast<int32_t>((i * 7) % distinct));
+            rows.push_back({key, Value::int64(static_cast<int64_t>(i))});
+        }
+        return rows;
+    }
+
+    std::vector<Row> make_right(std::size_t count, std::size_t distinct, std::size_t null_every)
+    {
+        std::vector<Row> rows;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            Value key = i % null_every == 0 ? Value::null(DataType::BIGINT)
+                                            : Value::int64(static_cast<int64_t>((i * 3) % distinct));
+            rows.push_back({Value::int64(static_cast<int64_t>(i)), key});
+        }
+        return rows;
+    }
+
+    // The right input as an index would deliver it: non-NULL keys in order, NULLs after
+    // them ascending and before them descending, ties in their original order.
+    std::vector<Row> index_order(std::vector<Row> rows, bool descending)
+    {
+        std::stable_sort(rows.begin(), rows.end(), [&](const Row &lhs, const Row &rhs)
+                         {
+                             if (lhs[1].is_null() || rhs[1].is_null())
+                                 return rhs[1].is_null() != descending && lhs[1].is_null() == descending;
+                             const auto cmp = compare(lhs[1], rhs[1]);
+                             return descending ? cmp == CompareResult::Greater : cmp == CompareResult::Less; });
+        return rows;
+    }
+
+    MergeJoin::RowSource source(const std::vector<Row> &rows)
+    {
+        return [&rows](const MergeJoin::RowSink &sink)
+        {
+            for (const auto &row : rows)
+                sink(Row(row));
+        };
+    }
+
+    Pairs nested_loop(const std::vector<Row> &left, const std::vector<Row> &right)
+    {
+        Pairs pairs;
+        for (const auto &l : left)
+        {
+            for (const auto &r : right)
+            {
+                if (compare(l[0], r[1]) == CompareResult::Equal)
+                    pairs.emplace_back(l[1].as_int64(), r[0].as_int64());
+            }
+        }
+        return pairs;
+    }
+
+    void check_join(std::vector<Row> left, const std::vector<Row> &right, bool descending)
+    {
+        Pairs expected = nested_loop(left, right);
+        // Only one key's right rows are held at a time.
+        std::size_t expect_group = 0;
+        for (const auto &r : right)
+        {
+            if (r[1].is_null())
+                continue;
+            const auto same = std::count_if(right.begin(), right.end(), [&](const Row &other)
+                                            { return compare(other[1], r[1]) == CompareResult::Equal; });
+            expect_group = std::max(expect_group, static_cast<std::size_t>(same));
+        }
+        MergeJoin join({0}, {1}, descending);
+        join.sort_left(left);
+        assert(join.left_sorted(left));
+        const auto ordered_right = index_order(right, descending);
+
+        Pairs actual;
+        const Value *previous = nullptr;
+        join.run(left, source(ordered_right), [&](const Row &l, const Row &r)
+                 {
+                     assert(compare(l[0], r[1]) == CompareResult::Equal);
+                     // Key order, then left order, then right order.
+                     if (previous && compare(*previous, l[0]) != CompareResult::Equal)
+                         assert(compare(*previous, l[0]) == (descending ? CompareResult::Greater : CompareResult::Less));
+                     previous = &l[0];
+                     actual.emplace_back(l[1].as_int64(), r[0].as_int64()); });
+        assert(join.max_group() == expect_group);
+
+        std::sort(actual.begin(), actual.end());
+        std::sort(expected.begin(), expected.end());
+        assert(actual == expected);
+    }
+}
+
+bool merge_join_tests()
+{
+    // Sorting keeps ties in input order and moves NULL keys to the end.
+    MergeJoin sorter({0}, {1});
+    auto left = make_left(20, 5, 6);
+    assert(!sorter.left_sorted(left));
+    sorter.sort_left(left);
+    assert(sorter.left_sorted(left));
+    assert(left.back()[0].is_null() && !left[left.size() - 5][0].is_null());
+    assert(left[0][0].as_int32() == 0 && left[0][1].as_int64() == 5 && left[1][1].as_int64() == 10);
+
+    // Duplicate keys on both sides, in both directions; right keys missing on the left.
+    check_join(make_left(300, 40, 11), make_right(200, 60, 7), false);
+    check_join(make_left(300, 40, 11), make_right(200, 60, 7), true);
+    // Unique keys on one side.
+    check_join(make_left(50, 50, 1000), make_right(400, 50, 9), false);
+    // Empty inputs.
+    check_join({}, make_right(50, 10, 7), false);
+    check_join(make_left(50, 10, 7), {}, false);
+
+    // A right input out of key order is rejected rather than joined wrongly.
+    MergeJoin join({0}, {1});
+    const std::vector<Row> unordered = {{Value::int64(0), Value::int64(3)}, {Value::int64(1), Value::int64(1)}};
+    bool threw = false;
+    try
+    {
+        join.run(make_left(10, 5, 100), source(unordered), [](const Row &, const Row &) {});
+    }
+    catch (const DBException &)
+    {
+        threw = true;
+    }
+    assert(threw);
+    return true;
+}
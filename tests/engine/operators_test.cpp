@@ -0,0 +1,194 @@
+#include <cassert>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "engine/operators.h"
+
+using namespace kizuna;
+using namespace kizuna::engine;
+
+namespace
+{
+    using Row = Operator::Row;
+
+    // Yields fixed rows and counts how many were pulled and how often it was opened and closed.
+    class RowsSource : public Operator
+    {
+    public:
+        struct Stats
+        {
+            std::size_t pulled{0};
+            std::size_t opened{0};
+            std::size_t closed{0};
+        };
+
+        RowsSource(std::vector<Row> rows, Stats &stats) : rows_(std::move(rows)), stats_(stats) {}
+
+        void open() override
+        {
+            ++stats_.opened;
+            position_ = 0;
+        }
+        bool next(Row &row) override
+        {
+            if (position_ == rows_.size())
+                return false;
+            ++stats_.pulled;
+            row = rows_[position_++];
+            return true;
+        }
+        void close() override { ++stats_.closed; }
+
+    private:
+        std::vector<Row> rows_;
+        Stats &stats_;
+        std::size_t position_{0};
+    };
+
+    // Rows are (id, group): ids 0..count-1, group id % groups.
+    std::vector<Row> make_rows(std::size_t count, std::size_t groups)
+    {
+        std::vector<Row> rows;
+        for (std::size_t i = 0; i < count; ++i)
+            rows.push_back({Value::int32(static_cast<int32_t>(i)), Value::int32(static_cast<int32_t>(i % groups))});
+        return rows;
+    }
+
+    std::vector<Row> drain(Operator &op)
+    {
+        std::vector<Row> rows;
+        op.open();
+        Row row;
+        while (op.next(row))
+            rows.push_back(row);
+        op.close();
+        return rows;
+    }
+
+    class SumAccumulator : public Accumulator
+    {
+    public:
+        explicit SumAccumulator(std::size_t column) : column_(column) {}
+        void add(const Row &row) override { sum_ += row[column_].as_int32(); }
+        Value result() const override { return Value::int64(sum_); }
+
+    private:
+        std::size_t column_;
+        int64_t sum_{0};
+    };
+}
+
+bool operators_tests()
+{
+    // LIMIT stops pulling its input once it has its rows.
+    {
+        RowsSource::Stats stats;
+        Limit limit(std::make_unique<RowsSource>(make_rows(100, 7), stats), 5);
+        auto rows = drain(limit);
+        assert(rows.size() == 5 && rows.back()[0].as_int32() == 4);
+        assert(stats.pulled == 5 && stats.opened == 1 && stats.closed == 1);
+    }
+
+    // Filter, then a projection that swaps the two columns.
+    {
+        RowsSource::Stats stats;
+        auto filter = std::make_unique<Filter>(std::make_unique<RowsSource>(make_rows(20, 4), stats), [](const Row &row)
+                                               { return row[1].as_int32() == 3; });
+        Project project(std::move(filter), {1, 0});
+        auto rows = drain(project);
+        assert(rows.size() == 5);
+        assert(rows[0][0].as_int32() == 3 && rows[0][1].as_int32() == 3 && rows[4][1].as_int32() == 19);
+    }
+
+    // Sort is stable.
+    {
+        RowsSource::Stats stats;
+        auto by_group = [](const Row &lhs, const Row &rhs)
+        { return lhs[1].as_int32() < rhs[1].as_int32(); };
+        Sort sort(std::make_unique<RowsSource>(make_rows(12, 3), stats), by_group);
+        auto rows = drain(sort);
+        assert(rows[0][0].as_int32() == 0 && rows[1][0].as_int32() == 3 && rows[4][0].as_int32() == 1);
+
+        Sort sorted(std::make_unique<RowsSource>(rows, stats), by_group);
+        auto again = drain(sorted);
+        for (std::size_t i = 0; i < rows.size(); ++i)
+            assert(again[i][0].as_int32() == rows[i][0].as_int32());
+    }
+
+    // DISTINCT keeps the first row of each key.
+    {
+        RowsSource::Stats stats;
+        Distinct distinct(std::make_unique<RowsSource>(make_rows(30, 4), stats), [](const Row &row)
+                          { return row[1].to_string(); });
+        auto rows = drain(distinct);
+        assert(rows.size() == 4);
+        for (std::size_t i = 0; i < rows.size(); ++i)
+            assert(rows[i][0].as_int32() == static_cast<int32_t>(i));
+    }
+
+    // A per-row join streams each left row's matches; an all-rows join sees the whole left input.
+    {
+        const auto right = make_rows(6, 3);
+        auto pair_up = [&](const Row &left, const Join::Sink &sink)
+        {
+            for (const auto &r : right)
+            {
+                if (compare(r[1], left[1]) == CompareResult::Equal)
+                    sink(Row{left[0], r[0]});
+            }
+        };
+
+        RowsSource::Stats stats;
+        std::size_t planned_rows = 0;
+        Join per_row(std::make_unique<RowsSource>(make_rows(4, 3), stats), [&](std::vector<Row> &left)
+                     {
+                         planned_rows = left.size();
+                         Join::Strategy strategy;
+                         strategy.per_row = pair_up;
+                         return strategy; });
+        auto rows = drain(per_row);
+        assert(planned_rows == 4 && rows.size() == 8);
+        assert(rows[0][0].as_int32() == 0 && rows[1][1].as_int32() == 3 && rows[7][0].as_int32() == 3);
+
+        Join all_rows(std::make_unique<RowsSource>(make_rows(4, 3), stats), [&](std::vector<Row> &)
+                      {
+                          Join::Strategy strategy;
+                          strategy.all_rows = [&](std::vector<Row> &left, const Join::Sink &sink)
+                          {
+                              for (auto it = left.rbegin(); it != left.rend(); ++it)
+                                  pair_up(*it, sink);
+                          };
+                          return strategy; });
+        rows = drain(all_rows);
+        assert(rows.size() == 8 && rows[0][0].as_int32() == 3);
+
+        // An empty left input never reaches the planner.
+        bool planned = false;
+        Join empty(std::make_unique<RowsSource>(std::vector<Row>{}, stats), [&](std::vector<Row> &)
+                   {
+                       planned = true;
+                       return Join::Strategy{}; });
+        assert(drain(empty).empty() && !planned);
+    }
+
+    // Aggregate folds its input into one row, and LIMIT 0 never runs it.
+    {
+        RowsSource::Stats stats;
+        std::vector<std::unique_ptr<Accumulator>> sums;
+        sums.push_back(std::make_unique<SumAccumulator>(0));
+        sums.push_back(std::make_unique<SumAccumulator>(1));
+        Aggregate aggregate(std::make_unique<RowsSource>(make_rows(10, 2), stats), std::move(sums));
+        auto rows = drain(aggregate);
+        assert(rows.size() == 1 && rows[0][0].as_int64() == 45 && rows[0][1].as_int64() == 5);
+
+        RowsSource::Stats limited;
+        std::vector<std::unique_ptr<Accumulator>> none;
+        none.push_back(std::make_unique<SumAccumulator>(0));
+        Limit limit(std::make_unique<Aggregate>(std::make_unique<RowsSource>(make_rows(10, 2), limited), std::move(none)), 0);
+        assert(drain(limit).empty() && limited.pulled == 0 && limited.opened == 0 && limited.closed == 0);
+    }
+
+    return true;
+}
@@ -0,0 +1,125 @@
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/file_manager.h"
+
+using namespace kizuna;
+namespace fs = std::filesystem;
+
+namespace
+{
+    std::vector<std::uint8_t> pattern_for(page_id_t id)
+    {
+        std::vector<std::uint8_t> buf(config::PAGE_SIZE);
+        for (std::size_t i = 0; i < buf.size(); ++i)
+            buf[i] = static_cast<std::uint8_t>((i + id * 31) & 0xFF);
+        return buf;
+    }
+
+    bool roundtrip(FileBackend backend)
+    {
+        const std::string db_path = (config::temp_dir() / ("fm_backend_" + file_backend_to_string(backend) + config::DB_FILE_EXTENSION)).string();
+        std::error_code ec;
+        fs::create_directories(config::temp_dir(), ec);
+        fs::remove(db_path, ec);
+
+        std::vector<page_id_t> ids;
+        {
+            FileManager fm(db_path, true, backend);
+            fm.open();
+            if (!fm.is_open()) return false;
+            for (int i = 0; i < 16; ++i)
+            {
+                const page_id_t id = fm.allocate_page();
+                fm.write_page(id, pattern_for(id).data());
+                ids.push_back(id);
+            }
+            if (fm.page_count() != 16) return false;
+            fm.sync();
+
+            std::vector<std::uint8_t> out(config::PAGE_SIZE);
+            bool threw = false;
+            try
+            {
+                fm.read_page(17, out.data());
+            }
+            catch (const DBException &)
+            {
+                threw = true;
+            }
+            if (!threw) return false;
+            fm.close();
+            if (fm.is_open()) return false;
+        }
+
+        // Reopen without create and verify, reading concurrently when supported.
+        FileManager fm(db_path, false, backend);
+        fm.open();
+        const int readers = fm.supports_concurrent_io() ? 4 : 1;
+        std::atomic<int> errors{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < readers; ++t)
+        {
+            threads.emplace_back([&]()
+                                 {
+                                     std::vector<std::uint8_t> out(config::PAGE_SIZE);
+                                     try
+                                     {
+                                         for (int round = 0; round < 8; ++round)
+                                         {
+                                             for (auto id : ids)
+                                             {
+                                                 fm.read_page(id, out.data());
+                                                 if (out != pattern_for(id)) ++errors;
+                                             }
+                                         }
+                                     }
+                                     catch (...)
+                                     {
+                                         ++errors;
+                                     }
+                                 });
+        }
+        for (auto &t : threads) t.join();
+        fm.close();
+        fs::remove(db_path, ec);
+        return errors.load() == 0;
+    }
+}
+
+bool file_manager_backend_tests()
+{
+    try
+    {
+        if (!roundtrip(FileBackend::FSTREAM)) return false;
+        if (!roundtrip(FileBackend::POSIX)) return false;
+
+        // Opening a missing file without create must fail on every backend.
+        const std::string missing = (config::temp_dir() / "fm_backend_missing.kz").string();
+        std::error_code ec;
+        fs::remove(missing, ec);
+        for (auto backend : {FileBackend::FSTREAM, FileBackend::POSIX})
+        {
+            FileManager fm(missing, false, backend);
+            bool threw = false;
+            try
+            {
+                fm.open();
+            }
+            catch (const DBException &)
+            {
+                threw = true;
+            }
+            if (!threw) return false;
+        }
+    }
+    catch (...)
+    {
+        return false;
+    }
+    return true;
+}
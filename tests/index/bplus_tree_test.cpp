@@ -133,6 +133,251 @@ namespace
             std::filesystem::remove(path);
         return true;
     }
+
+    bool in_place_insert_remove_many()
+    {
+        const std::string path = (config::temp_dir() / "bplus_tree_in_place.kzi").string();
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+        if (std::filesystem::exists(path))
+            std::filesystem::remove(path);
+
+        FileManager fm(path, true);
+        fm.open();
+        PageManager pm(fm, 64);
+
+        BPlusTree tree(pm, fm, config::INVALID_PAGE_ID, true);
+        auto key_for = [](size_t i)
+        {
+            std::string text = std::to_string(100000 + i);
+            text.resize(40, '.');
+            return to_key(text);
+        };
+
+        // A stride walk visits every key once in scattered order, so inserts land in the
+        // middle of nodes and split at several levels.
+        const size_t count = 3000;
+        for (size_t n = 0, i = 0; n < count; ++n, i = (i + 1237) % count)
+            tree.Insert(key_for(i), static_cast<record_id_t>(i));
+
+        for (size_t i = 0; i < count; i += 2)
+            tree.Remove(key_for(i), static_cast<record_id_t>(i));
+        for (size_t i = 0; i < count; i += 4)
+            tree.Insert(key_for(i), static_cast<record_id_t>(i + count));
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto res = tree.Search(key_for(i));
+            const bool expected = (i % 2 == 1) || (i % 4 == 0);
+            if (res.found != expected)
+                return false;
+            if (expected && res.value != static_cast<record_id_t>(i % 4 == 0 ? i + count : i))
+                return false;
+        }
+
+        auto all = tree.ScanRange(std::nullopt, false, std::nullopt, false);
+        if (all.size() != count / 2 + count / 4)
+            return false;
+        auto middle = tree.ScanRange(key_for(1000), true, key_for(1010), false);
+        // 1000, 1001, 1003, 1004, 1005, 1007, 1008, 1009
+        if (middle.size() != 8 || middle.front() != 1000 + count || middle.back() != 1009)
+            return false;
+
+        pm.flush_all();
+        fm.close();
+        if (std::filesystem::exists(path))
+            std::filesystem::remove(path);
+        return true;
+    }
+
+    bool cursor_walks_both_directions()
+    {
+        const std::string path = (config::temp_dir() / "bplus_tree_cursor.kzi").string();
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+        if (std::filesystem::exists(path))
+            std::filesystem::remove(path);
+
+        FileManager fm(path, true);
+        fm.open();
+        PageManager pm(fm, 64);
+
+        BPlusTree tree(pm, fm, config::INVALID_PAGE_ID, true);
+        auto key_for = [](size_t i)
+        {
+            std::string text = std::to_string(100000 + i);
+            text.resize(40, '.');
+            return to_key(text);
+        };
+
+        // Even keys only, with every fourth removed again so some leaves thin out.
+        const size_t count = 2000;
+        for (size_t n = 0, i = 0; n < count; ++n, i = (i + 777) % count)
+        {
+            if (i % 2 == 0)
+                tree.Insert(key_for(i), static_cast<record_id_t>(i));
+        }
+        for (size_t i = 0; i < count; i += 4)
+            tree.Remove(key_for(i), static_cast<record_id_t>(i));
+        assert(tree.Height() > 1);
+
+        std::vector<record_id_t> forward;
+        for (auto cursor = tree.SeekFirst(); cursor.Valid(); cursor.Next())
+            forward.push_back(cursor.Value());
+        assert(forward.size() == count / 4);
+        for (size_t n = 0; n < forward.size(); ++n)
+            assert(forward[n] == 2 + 4 * n);
+
+        std::vector<record_id_t> backward;
+        for (auto cursor = tree.SeekLast(); cursor.Valid(); cursor.Prev())
+            backward.push_back(cursor.Value());
+        assert(std::vector<record_id_t>(backward.rbegin(), backward.rend()) == forward);
+
+        // Seek lands on the next present key; stepping back and forth returns to it.
+        auto cursor = tree.Seek(key_for(1001));
+        assert(cursor.Valid() && cursor.Value() == 1002);
+        cursor.Prev();
+        assert(cursor.Valid() && cursor.Value() == 998);
+        assert(cursor.Key().size() == 40);
+        cursor.Next();
+        assert(cursor.Valid() && cursor.Value() == 1002);
+
+        // Bounds on absent and present keys, both directions.
+        auto collect = [&](size_t lo, bool lo_inc, size_t hi, bool hi_inc, bool reverse)
+        {
+            std::vector<record_id_t> out;
+            auto c = tree.SeekRange(key_for(lo), lo_inc, key_for(hi), hi_inc, reverse);
+            for (; c.Valid(); reverse ? c.Prev() : c.Next())
+                out.push_back(c.Value());
+            return out;
+        };
+        assert((collect(1002, true, 1014, true, false) == std::vector<record_id_t>{1002, 1006, 1010, 1014}));
+        assert((collect(1002, false, 1014, false, false) == std::vector<record_id_t>{1006, 1010}));
+        assert((collect(1002, true, 1014, true, true) == std::vector<record_id_t>{1014, 1010, 1006, 1002}));
+        assert((collect(1002, false, 1014, false, true) == std::vector<record_id_t>{1010, 1006}));
+        assert((collect(1003, true, 1005, true, true).empty()));
+        assert((collect(1003, true, 1005, true, false).empty()));
+
+        auto tail = tree.SeekRange(key_for(1990), true, std::nullopt, false, true);
+        assert(tail.Valid() && tail.Value() == 1998);
+
+        // Moving a cursor keeps its position; the moved-from one is empty.
+        auto moved = std::move(tail);
+        assert(!tail.Valid());
+        moved.Prev();
+        assert(moved.Valid() && moved.Value() == 1994);
+        moved.Prev();
+        assert(moved.Valid() && moved.Value() == 1990);
+        moved.Prev();
+        assert(!moved.Valid());
+
+        pm.flush_all();
+        fm.close();
+        if (std::filesystem::exists(path))
+            std::filesystem::remove(path);
+        return true;
+    }
+
+    bool bulk_load_builds_searchable_tree()
+    {
+        const std::string path = (config::temp_dir() / "bplus_tree_bulk.kzi").string();
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+
+        auto key_for = [](size_t i)
+        {
+            std::string text = std::to_string(1000000 + i);
+            text.resize(24, '.');
+            return to_key(text);
+        };
+
+        const size_t count = 20000;
+        for (double fill : {0.3, 0.9, 1.0})
+        {
+            if (std::filesystem::exists(path))
+                std::filesystem::remove(path);
+            FileManager fm(path, true);
+            fm.open();
+            PageManager pm(fm, 64);
+
+            BPlusTree tree(pm, fm, config::INVALID_PAGE_ID, true);
+            pm.reset_stats();
+            auto loader = tree.StartBulkLoad(fill);
+            for (size_t i = 0; i < count; i += 2)
+                loader.Add(key_for(i), static_cast<record_id_t>(i));
+            loader.Finish();
+            assert(tree.Height() >= 2);
+            // Each page is written once, parent included: no evicted leaf is read back to
+            // fix up its parent pointer, only internal nodes held open while the load ran.
+            assert(pm.stats().misses * 10 < fm.page_count());
+
+            for (size_t i = 0; i < count; ++i)
+            {
+                auto res = tree.Search(key_for(i));
+                assert(res.found == (i % 2 == 0));
+                if (res.found)
+                    assert(res.value == static_cast<record_id_t>(i));
+            }
+            size_t seen = 0;
+            for (auto cursor = tree.SeekLast(); cursor.Valid(); cursor.Prev())
+            {
+                assert(cursor.Value() == count - 2 - 2 * seen);
+                ++seen;
+            }
+            assert(seen == count / 2);
+
+            // Bulk-built nodes split and shrink like inserted ones.
+            for (size_t i = 1; i < count; i += 2)
+                tree.Insert(key_for(i), static_cast<record_id_t>(i));
+            for (size_t i = 0; i < count; i += 3)
+                tree.Remove(key_for(i), static_cast<record_id_t>(i));
+            auto all = tree.ScanRange(std::nullopt, false, std::nullopt, false);
+            assert(all.size() == count - (count + 2) / 3);
+            for (size_t n = 1; n < all.size(); ++n)
+                assert(all[n - 1] < all[n]);
+
+            pm.flush_all();
+            fm.close();
+        }
+
+        if (std::filesystem::exists(path))
+            std::filesystem::remove(path);
+        FileManager fm(path, true);
+        fm.open();
+        PageManager pm(fm, 32);
+
+        auto throws_code = [](auto &&fn, StatusCode code)
+        {
+            try
+            {
+                fn();
+            }
+            catch (const DBException &ex)
+            {
+                return ex.code() == code;
+            }
+            return false;
+        };
+
+        BPlusTree unique_tree(pm, fm, config::INVALID_PAGE_ID, true);
+        auto unique_loader = unique_tree.StartBulkLoad();
+        unique_loader.Add(key_for(5), 5);
+        assert(throws_code([&] { unique_loader.Add(key_for(5), 6); }, StatusCode::DUPLICATE_KEY));
+        assert(throws_code([&] { unique_loader.Add(key_for(4), 4); }, StatusCode::INVALID_ARGUMENT));
+
+        BPlusTree plain_tree(pm, fm, config::INVALID_PAGE_ID, false);
+        auto plain_loader = plain_tree.StartBulkLoad();
+        plain_loader.Add(key_for(7), 1);
+        plain_loader.Add(key_for(7), 2);
+        plain_loader.Finish();
+        assert(plain_tree.Search(key_for(7)).value == 2);
+        assert(throws_code([&] { plain_tree.StartBulkLoad(); }, StatusCode::INVALID_ARGUMENT));
+        assert(throws_code([&] { BPlusTree(pm, fm, config::INVALID_PAGE_ID, false).StartBulkLoad(0.0); },
+                           StatusCode::INVALID_ARGUMENT));
+
+        pm.flush_all();
+        fm.close();
+        if (std::filesystem::exists(path))
+            std::filesystem::remove(path);
+        return true;
+    }
 }
 
 bool bplus_tree_tests()
@@ -141,5 +386,8 @@ bool bplus_tree_tests()
     ok &= basic_insert_search_unique();
     ok &= duplicate_allowed_when_not_unique();
     ok &= range_query_tests();
+    ok &= in_place_insert_remove_many();
+    ok &= cursor_walks_both_directions();
+    ok &= bulk_load_builds_searchable_tree();
     return ok;
 }
@@ -1,6 +1,7 @@
 #include <cassert>
 #include <filesystem>
 #include <string>
+#include <vector>
 
 #include "storage/index/index_manager.h"
 #include "catalog/schema.h"
@@ -51,9 +52,58 @@ bool index_manager_tests()
         assert(lookup.value == 111);
     }
 
+    {
+        // Reopening hits the cached handle, pages still resident.
+        auto first = manager.OpenIndex(entry);
+        auto second = manager.OpenIndex(entry);
+        assert(first == second);
+        assert(manager.cached_handle_count() == 1);
+        auto lookup = second->tree().Search(std::vector<uint8_t>{'a'});
+        assert(lookup.found);
+
+        // Recreating the index replaces the cached handle.
+        auto recreated = manager.CreateIndex(entry);
+        assert(recreated != first);
+        assert(manager.OpenIndex(entry) == recreated);
+        entry.root_page_id = recreated->tree().root_page_id();
+    }
+
     manager.DropIndex(entry);
+    assert(manager.cached_handle_count() == 0);
     assert(!FileManager::exists(FileManager::index_path(entry.index_id, base_dir)));
 
+    {
+        // Past its capacity the cache closes the least recently used idle handle.
+        IndexManager capped(base_dir, nullptr, /*handle_capacity*/ 2);
+        std::vector<catalog::IndexCatalogEntry> entries;
+        for (index_id_t id = 20; id < 23; ++id)
+        {
+            entries.push_back(make_entry(id, 10, false));
+            auto handle = capped.CreateIndex(entries.back());
+            handle->tree().Insert(std::vector<uint8_t>{static_cast<uint8_t>(id)}, id);
+            entries.back().root_page_id = handle->tree().root_page_id();
+        }
+        assert(capped.cached_handle_count() == 2);
+
+        // The closed index reopens from its file; a handle in use is never closed.
+        auto held = capped.OpenIndex(entries[1]);
+        auto reopened = capped.OpenIndex(entries[0]);
+        assert(reopened->tree().Search(std::vector<uint8_t>{20}).found);
+        assert(capped.cached_handle_count() == 2);
+        assert(capped.OpenIndex(entries[1]) == held);
+        auto third = capped.OpenIndex(entries[2]);
+        assert(capped.cached_handle_count() == 3);
+        third.reset();
+        reopened.reset();
+        held.reset();
+        capped.OpenIndex(entries[2]);
+        assert(capped.cached_handle_count() == 2);
+
+        for (const auto &e : entries)
+            capped.DropIndex(e);
+        assert(capped.cached_handle_count() == 0);
+    }
+
     std::filesystem::remove_all(base_dir, ec);
     return true;
 }
@@ -0,0 +1,127 @@
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "storage/index/bplus_tree_node.h"
+#include "storage/index/key_codec.h"
+
+using namespace kizuna;
+using namespace kizuna::index;
+
+namespace
+{
+    // Each list is in ascending value order; the encoded keys must compare the same way.
+    template <typename T, typename Append>
+    void check_ascending(const std::vector<T> &values, Append append)
+    {
+        std::vector<std::vector<uint8_t>> keys;
+        for (const auto &value : values)
+        {
+            KeyEncoder encoder;
+            append(encoder, value);
+            keys.push_back(encoder.take());
+        }
+        for (std::size_t i = 1; i < keys.size(); ++i)
+        {
+            assert(CompareKeyBytes(keys[i - 1], keys[i]) < 0);
+        }
+    }
+
+    void check_integers()
+    {
+        check_ascending<int32_t>({std::numeric_limits<int32_t>::min(), -70000, -256, -1, 0, 1, 255, 256, 70000,
+                                  std::numeric_limits<int32_t>::max()},
+                                 [](KeyEncoder &e, int32_t v) { e.append_int32(v); });
+        check_ascending<int64_t>({std::numeric_limits<int64_t>::min(), -(int64_t{1} << 40), -1, 0, 1, int64_t{1} << 40,
+                                  std::numeric_limits<int64_t>::max()},
+                                 [](KeyEncoder &e, int64_t v) { e.append_int64(v); });
+    }
+
+    void check_doubles()
+    {
+        check_ascending<double>({-std::numeric_limits<double>::infinity(), -1e300, -2.5, -1.0, -1e-300, 0.0, 1e-300, 1.0,
+                                 2.5, 1e300, std::numeric_limits<double>::infinity()},
+                                [](KeyEncoder &e, double v) { e.append_double(v); });
+
+        KeyEncoder negative_zero;
+        negative_zero.append_double(-0.0);
+        KeyEncoder zero;
+        zero.append_double(0.0);
+        assert(negative_zero.bytes() == zero.bytes());
+    }
+
+    void check_strings()
+    {
+        check_ascending<std::string>({"", std::string(1, '\0'), std::string("\0\0", 2), std::string("\0a", 2), "a",
+                                      std::string("a\0", 2), std::string("a\0b", 3), "ab", "abc", "b", "\xff"},
+                                     [](KeyEncoder &e, const std::string &v) { e.append_string(v); });
+    }
+
+    void check_composites_and_nulls()
+    {
+        // A shorter first column must not bleed into the second column's bytes.
+        KeyEncoder ab_z;
+        ab_z.append_string("ab");
+        ab_z.append_string("z");
+        KeyEncoder abc_a;
+        abc_a.append_string("abc");
+        abc_a.append_string("a");
+        assert(CompareKeyBytes(ab_z.bytes(), abc_a.bytes()) < 0);
+
+        KeyEncoder null_key;
+        null_key.append_null();
+        KeyEncoder max_key;
+        max_key.append_int32(std::numeric_limits<int32_t>::max());
+        KeyEncoder high_string;
+        high_string.append_string("\xff\xff");
+        assert(CompareKeyBytes(max_key.bytes(), null_key.bytes()) < 0);
+        assert(CompareKeyBytes(high_string.bytes(), null_key.bytes()) < 0);
+
+        KeyEncoder seven_null;
+        seven_null.append_int32(7);
+        seven_null.append_null();
+        auto extended = seven_null.bytes();
+        KeyEncoder prefix;
+        prefix.append_int32(7);
+        auto bound = prefix.take();
+        bound.push_back(KeyEncoder::kPrefixEnd);
+        assert(CompareKeyBytes(extended, bound) < 0);
+
+        KeyEncoder from_value;
+        from_value.append_value(DataType::INTEGER, Value::int32(-3));
+        from_value.append_value(DataType::VARCHAR, Value::null());
+        KeyEncoder direct;
+        direct.append_int32(-3);
+        direct.append_null();
+        assert(from_value.bytes() == direct.bytes());
+
+        // Record ids order equal values by row and stay below the next value and the prefix end.
+        KeyEncoder first_row;
+        first_row.append_int32(7);
+        first_row.append_record_id((record_id_t{1} << 32) | 2);
+        KeyEncoder second_row;
+        second_row.append_int32(7);
+        second_row.append_record_id(record_id_t{2} << 32);
+        KeyEncoder next_value;
+        next_value.append_int32(8);
+        next_value.append_record_id(0);
+        assert(CompareKeyBytes(first_row.bytes(), second_row.bytes()) < 0);
+        assert(CompareKeyBytes(second_row.bytes(), next_value.bytes()) < 0);
+        KeyEncoder seven;
+        seven.append_int32(7);
+        auto prefix_end = seven.take();
+        prefix_end.push_back(KeyEncoder::kPrefixEnd);
+        assert(CompareKeyBytes(second_row.bytes(), prefix_end) < 0);
+    }
+}
+
+bool key_codec_tests()
+{
+    check_integers();
+    check_doubles();
+    check_strings();
+    check_composites_and_nulls();
+    return true;
+}
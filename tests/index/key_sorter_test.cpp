@@ -0,0 +1,74 @@
+#include <cassert>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "storage/index/bplus_tree_node.h"
+#include "storage/index/key_sorter.h"
+
+using namespace kizuna;
+using namespace kizuna::index;
+
+namespace
+{
+    std::vector<uint8_t> to_key(const std::string &text)
+    {
+        return std::vector<uint8_t>(text.begin(), text.end());
+    }
+
+    size_t run_files_on_disk()
+    {
+        size_t runs = 0;
+        for (const auto &entry : std::filesystem::directory_iterator(config::temp_dir()))
+        {
+            if (entry.path().filename().string().rfind("index_sort_", 0) == 0)
+                ++runs;
+        }
+        return runs;
+    }
+
+    // Feeds count keys in scattered order, each key twice with the later value last.
+    void check_sorted(size_t memory_budget, size_t count, bool expect_runs)
+    {
+        const size_t runs_before = run_files_on_disk();
+        {
+            KeySorter sorter(memory_budget);
+            for (size_t n = 0, i = 0; n < count; ++n, i = (i + 7919) % count)
+            {
+                sorter.Add(to_key("key_" + std::to_string(100000 + i)), i);
+                sorter.Add(to_key("key_" + std::to_string(100000 + i)), i + count);
+            }
+            assert((sorter.run_count() > 0) == expect_runs);
+
+            std::vector<uint8_t> previous;
+            size_t seen = 0;
+            sorter.Drain([&](std::span<const uint8_t> key, record_id_t value)
+                         {
+                             std::vector<uint8_t> current(key.begin(), key.end());
+                             if (seen % 2 == 0)
+                             {
+                                 assert(seen == 0 || CompareKeyBytes(previous, current) < 0);
+                                 assert(value < count);
+                             }
+                             else
+                             {
+                                 assert(current == previous);
+                                 assert(value >= count);
+                             }
+                             previous = std::move(current);
+                             ++seen; });
+            assert(seen == 2 * count);
+            assert(sorter.run_count() == 0);
+        }
+        assert(run_files_on_disk() == runs_before);
+    }
+}
+
+bool key_sorter_tests()
+{
+    std::filesystem::create_directories(config::temp_dir());
+    check_sorted(config::INDEX_BUILD_SORT_MEMORY, 1000, false);
+    check_sorted(16 * 1024, 5000, true);
+    return true;
+}
@@ -0,0 +1,106 @@
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/file_manager.h"
+#include "storage/page_manager.h"
+
+using namespace kizuna;
+namespace fs = std::filesystem;
+
+bool page_manager_sharded_tests()
+{
+    const std::string db_path = (config::temp_dir() / (std::string("pm_sharded") + config::DB_FILE_EXTENSION)).string();
+    std::error_code ec;
+    fs::create_directories(config::temp_dir(), ec);
+    fs::remove(db_path, ec);
+
+    try
+    {
+        std::vector<page_id_t> ids;
+        {
+            FileManager fm(db_path, true);
+            fm.open();
+            PageManager pm(fm, /*capacity*/ 32, /*shard_count*/ 4);
+            if (pm.shard_count() != 4) return false;
+
+            // More pages than frames so every shard has to evict.
+            for (int i = 0; i < 96; ++i)
+            {
+                page_id_t id = pm.new_page(PageType::DATA);
+                auto &page = pm.fetch(id, true);
+                const uint32_t marker = id * 7u;
+                slot_id_t slot{};
+                if (!page.insert(reinterpret_cast<const uint8_t *>(&marker), sizeof(marker), slot)) return false;
+                pm.unpin(id, /*dirty*/ true);
+                ids.push_back(id);
+            }
+
+            std::atomic<int> errors{0};
+            std::vector<std::thread> workers;
+            for (int t = 0; t < 4; ++t)
+            {
+                workers.emplace_back([&, t]()
+                                     {
+                                         std::mt19937 rng(static_cast<unsigned int>(t + 1));
+                                         std::uniform_int_distribution<std::size_t> pick(0, ids.size() - 1);
+                                         std::vector<uint8_t> out;
+                                         try
+                                         {
+                                             for (int op = 0; op < 2000; ++op)
+                                             {
+                                                 const page_id_t id = ids[pick(rng)];
+                                                 auto &page = pm.fetch(id, true);
+                                                 uint32_t marker = 0;
+                                                 if (page.header().page_id != id || !page.read(0, out) || out.size() != sizeof(marker))
+                                                 {
+                                                     ++errors;
+                                                 }
+                                                 else
+                                                 {
+                                                     std::memcpy(&marker, out.data(), sizeof(marker));
+                                                     if (marker != id * 7u) ++errors;
+                                                 }
+                                                 pm.unpin(id, false);
+                                             }
+                                         }
+                                         catch (...)
+                                         {
+                                             ++errors;
+                                         }
+                                     });
+            }
+            for (auto &w : workers) w.join();
+            if (errors.load() != 0) return false;
+
+            // Freed pages are recycled through the shared freelist.
+            pm.free_page(ids.back());
+            if (pm.new_page(PageType::DATA) != ids.back()) return false;
+            ids.pop_back();
+            pm.flush_all();
+        }
+
+        // Contents survive reopen with a single-shard pool.
+        FileManager fm(db_path, false);
+        fm.open();
+        PageManager pm(fm, 8);
+        std::vector<uint8_t> out;
+        for (auto id : ids)
+        {
+            auto &page = pm.fetch(id, true);
+            uint32_t marker = 0;
+            if (!page.read(0, out) || out.size() != sizeof(marker)) return false;
+            std::memcpy(&marker, out.data(), sizeof(marker));
+            pm.unpin(id, false);
+            if (marker != id * 7u) return false;
+        }
+    }
+    catch (...)
+    {
+        return false;
+    }
+    return true;
+}
@@ -53,6 +53,128 @@ static bool check_erase()
     return true;
 }
 
+static bool check_slot_reuse()
+{
+    Page p;
+    p.init(PageType::DATA, 5);
+
+    std::vector<uint8_t> data = {1, 2, 3, 4};
+    slot_id_t s0 = 0, s1 = 0, s2 = 0;
+    if (!p.insert(data.data(), static_cast<uint16_t>(data.size()), s0)) return false;
+    if (!p.insert(data.data(), static_cast<uint16_t>(data.size()), s1)) return false;
+    if (!p.insert(data.data(), static_cast<uint16_t>(data.size()), s2)) return false;
+    if (!p.erase(s1)) return false;
+
+    std::vector<uint8_t> other = {9, 9};
+    slot_id_t reused = 0;
+    if (!p.insert(other.data(), static_cast<uint16_t>(other.size()), reused)) return false;
+    if (reused != s1) return false;
+    if (p.header().slot_count != 3) return false;
+
+    std::vector<uint8_t> out;
+    if (!p.read(reused, out) || out != other) return false;
+    if (!p.read(s2, out) || out != data) return false;
+    return true;
+}
+
+static bool check_compact_keeps_slots()
+{
+    Page p;
+    p.init(PageType::DATA, 6);
+
+    std::vector<slot_id_t> slots;
+    for (uint8_t i = 0; i < 40; ++i)
+    {
+        std::vector<uint8_t> data(50, i);
+        slot_id_t s = 0;
+        if (!p.insert(data.data(), static_cast<uint16_t>(data.size()), s)) return false;
+        slots.push_back(s);
+    }
+    for (std::size_t i = 0; i < slots.size(); i += 2)
+    {
+        if (!p.erase(slots[i])) return false;
+    }
+    if (!p.erase(slots.back())) return false;
+
+    const size_t before = p.free_bytes();
+    const size_t reclaimable = p.reclaimable_bytes();
+    if (reclaimable <= before) return false;
+    p.compact();
+    if (p.free_bytes() != p.reclaimable_bytes()) return false;
+    if (p.free_bytes() < reclaimable) return false;
+    if (p.header().slot_count != slots.size() - 2) return false;
+
+    std::vector<uint8_t> out;
+    for (std::size_t i = 1; i + 1 < slots.size(); i += 2)
+    {
+        if (!p.read(slots[i], out)) return false;
+        if (out != std::vector<uint8_t>(50, static_cast<uint8_t>(i))) return false;
+    }
+    if (p.read(slots.back(), out)) return false;
+    return true;
+}
+
+static bool check_insert_compacts_when_fragmented()
+{
+    Page p;
+    p.init(PageType::DATA, 7);
+
+    std::vector<uint8_t> small(100, 7);
+    std::vector<slot_id_t> slots;
+    slot_id_t s = 0;
+    while (p.insert(small.data(), static_cast<uint16_t>(small.size()), s))
+    {
+        slots.push_back(s);
+    }
+    for (std::size_t i = 0; i < slots.size(); i += 2)
+    {
+        if (!p.erase(slots[i])) return false;
+    }
+
+    // No contiguous gap can hold this record, but the scattered holes can.
+    std::vector<uint8_t> big(300, 3);
+    if (p.free_bytes() >= big.size() + 2) return false;
+    slot_id_t big_slot = 0;
+    if (!p.insert(big.data(), static_cast<uint16_t>(big.size()), big_slot)) return false;
+
+    std::vector<uint8_t> out;
+    if (!p.read(big_slot, out) || out != big) return false;
+    for (std::size_t i = 1; i < slots.size(); i += 2)
+    {
+        if (!p.read(slots[i], out) || out != small) return false;
+    }
+    return true;
+}
+
+static bool check_update_grows_in_page()
+{
+    Page p;
+    p.init(PageType::DATA, 8);
+
+    std::vector<uint8_t> small(100, 1);
+    std::vector<slot_id_t> slots;
+    slot_id_t s = 0;
+    while (p.insert(small.data(), static_cast<uint16_t>(small.size()), s))
+    {
+        slots.push_back(s);
+    }
+    if (slots.size() < 4) return false;
+
+    std::vector<uint8_t> grown(150, 2);
+    if (p.update(slots[1], grown.data(), static_cast<uint16_t>(grown.size()))) return false;
+
+    if (!p.erase(slots[0])) return false;
+    if (!p.update(slots[1], grown.data(), static_cast<uint16_t>(grown.size()))) return false;
+
+    std::vector<uint8_t> out;
+    if (!p.read(slots[1], out) || out != grown) return false;
+    for (std::size_t i = 2; i < slots.size(); ++i)
+    {
+        if (!p.read(slots[i], out) || out != small) return false;
+    }
+    return true;
+}
+
 bool page_tests()
 {
     auto check_fill_many = []() -> bool {
@@ -110,5 +232,7 @@ bool page_tests()
         return true;
     };
 
-    return check_insert_read() && check_erase() && check_fill_many() && check_invalid_slot();
+    return check_insert_read() && check_erase() && check_fill_many() && check_invalid_slot() &&
+           check_slot_reuse() && check_compact_keeps_slots() && check_insert_compacts_when_fragmented() &&
+           check_update_grows_in_page();
 }
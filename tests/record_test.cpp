@@ -1,5 +1,7 @@
 #include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstring>
 
@@ -63,7 +65,148 @@ static bool check_encode_too_large()
     return false;
 }
 
+static bool check_row_view()
+{
+    std::vector<record::Field> fields;
+    fields.push_back(record::from_bool(true));
+    fields.push_back(record::from_int32(-7));
+    fields.push_back(record::from_int64(4567890123LL));
+    fields.push_back(record::from_double(2.5));
+    fields.push_back(record::from_string("alpha"));
+    fields.push_back(record::from_null(DataType::VARCHAR));
+    auto payload = record::encode(fields);
+
+    record::RowView row(payload);
+    if (!row.valid() || row.field_count() != fields.size()) return false;
+
+    record::FieldView f;
+    if (!row.field(0, f) || f.is_null || !f.as_bool()) return false;
+    if (!row.field(1, f) || f.type != DataType::INTEGER || f.as_int32() != -7) return false;
+    if (!row.field(2, f) || f.as_int64() != 4567890123LL) return false;
+    if (!row.field(3, f) || f.as_double() != 2.5) return false;
+    if (!row.field(4, f) || f.as_string_view() != "alpha") return false;
+    // The view borrows the encoded bytes rather than copying them.
+    if (f.bytes.data() < payload.data() || f.bytes.data() + f.bytes.size() > payload.data() + payload.size()) return false;
+    if (!row.field(5, f) || !f.is_null || !f.bytes.empty()) return false;
+    if (row.field(6, f)) return false;
+
+    // Going backwards restarts the walk from the first field.
+    if (!row.field(1, f) || f.as_int32() != -7) return false;
+    if (!row.field(4, f) || f.as_string_view() != "alpha") return false;
+    return true;
+}
+
+static bool check_row_view_truncated()
+{
+    std::vector<record::Field> fields;
+    fields.push_back(record::from_int32(1));
+    fields.push_back(record::from_string("hello"));
+    auto payload = record::encode(fields);
+
+    record::RowView header_only(std::span<const std::uint8_t>(payload.data(), 3));
+    if (header_only.valid()) return false;
+
+    record::RowView cut(std::span<const std::uint8_t>(payload.data(), payload.size() - 2));
+    record::FieldView f;
+    if (!cut.valid() || !cut.field(0, f) || f.as_int32() != 1) return false;
+    if (cut.field(1, f)) return false;
+    return true;
+}
+
+static std::vector<record::Field> mixed_fields(std::string_view name, bool null_score)
+{
+    std::vector<record::Field> fields;
+    fields.push_back(record::from_int32(42));
+    fields.push_back(record::from_string(name));
+    fields.push_back(null_score ? record::from_null(DataType::DOUBLE) : record::from_double(9.5));
+    fields.push_back(record::from_null(DataType::VARCHAR));
+    fields.push_back(record::from_int64(-3));
+    fields.push_back(record::from_string("tail"));
+    return fields;
+}
+
+static bool same_fields(const std::vector<record::Field> &lhs, const std::vector<record::Field> &rhs)
+{
+    if (lhs.size() != rhs.size()) return false;
+    for (std::size_t i = 0; i < lhs.size(); ++i)
+    {
+        if (lhs[i].type != rhs[i].type || lhs[i].is_null != rhs[i].is_null || lhs[i].payload != rhs[i].payload)
+            return false;
+    }
+    return true;
+}
+
+static bool check_v2_matches_v1()
+{
+    auto fields = mixed_fields("alpha", true);
+    auto v1 = record::encode(fields);
+    auto v2 = record::encode(fields, record::RecordFormat::V2);
+    if (record::format_of(v1) != record::RecordFormat::V1) return false;
+    if (record::format_of(v2) != record::RecordFormat::V2) return false;
+
+    std::vector<record::Field> from_v1;
+    std::vector<record::Field> from_v2;
+    if (!record::decode(v1.data(), v1.size(), from_v1)) return false;
+    if (!record::decode(v2.data(), v2.size(), from_v2)) return false;
+    return same_fields(fields, from_v1) && same_fields(fields, from_v2);
+}
+
+static bool check_v2_fixed_offsets()
+{
+    auto short_row = record::encode(mixed_fields("a", false), record::RecordFormat::V2);
+    auto long_row = record::encode(mixed_fields("a much longer name", true), record::RecordFormat::V2);
+
+    // Fixed-width fields sit at the same offset whatever the variable-length values are.
+    record::RecordLayout layout;
+    record::RowView first(short_row, &layout);
+    record::RowView second(long_row, &layout);
+    if (!first.valid() || !second.valid() || second.format() != record::RecordFormat::V2) return false;
+    if (layout.field_count() != 6 || layout.var_count() != 3) return false;
+
+    record::FieldView a;
+    record::FieldView b;
+    if (!first.field(4, a) || !second.field(4, b)) return false;
+    if (a.as_int64() != -3 || b.as_int64() != -3) return false;
+    if (a.bytes.data() - short_row.data() != b.bytes.data() - long_row.data()) return false;
+
+    if (!second.field(2, b) || !b.is_null || !b.bytes.empty()) return false;
+    if (!first.field(2, a) || a.is_null || a.as_double() != 9.5) return false;
+    if (!second.field(5, b) || b.as_string_view() != "tail") return false;
+    if (!second.field(1, b) || b.as_string_view() != "a much longer name") return false;
+    if (!second.field(3, b) || !b.is_null) return false;
+
+    // Without a layout the view walks the type array and lands on the same bytes.
+    record::RowView walked(long_row);
+    record::FieldView c;
+    if (!walked.field(5, c) || c.as_string_view() != "tail") return false;
+    if (!walked.field(0, c) || c.as_int32() != 42) return false;
+
+    // A row with a different type array rebinds the layout.
+    std::vector<record::Field> other;
+    other.push_back(record::from_string("x"));
+    other.push_back(record::from_bool(true));
+    auto other_row = record::encode(other, record::RecordFormat::V2);
+    record::RowView third(other_row, &layout);
+    if (!third.valid() || layout.fixed_bytes() != 1 || !third.field(1, c) || !c.as_bool()) return false;
+    return true;
+}
+
+static bool check_v2_truncated()
+{
+    auto payload = record::encode(mixed_fields("alpha", false), record::RecordFormat::V2);
+    for (std::size_t cut = 0; cut < payload.size(); ++cut)
+    {
+        std::span<const std::uint8_t> prefix(payload.data(), cut);
+        record::RowView row(prefix);
+        std::vector<record::Field> out;
+        if (row.valid() || record::decode(prefix.data(), prefix.size(), out)) return false;
+    }
+    return true;
+}
+
 bool record_tests()
 {
-    return check_encode_decode_basic() && check_encode_too_large() && check_date_roundtrip();
+    return check_encode_decode_basic() && check_encode_too_large() && check_date_roundtrip() &&
+           check_row_view() && check_row_view_truncated() && check_v2_matches_v1() &&
+           check_v2_fixed_offsets() && check_v2_truncated();
 }
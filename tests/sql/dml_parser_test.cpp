@@ -212,11 +212,23 @@ static void check_truncate()
     assert(trunc.table_name == "users");
 }
 
+static void check_vacuum()
+{
+    auto vacuum = sql::parse_vacuum("VACUUM users;");
+    assert(vacuum.table_name == "users");
+    auto with_table = sql::parse_vacuum("VACUUM TABLE users;");
+    assert(with_table.table_name == "users");
+}
+
 static void check_parse_dml_switch()
 {
     auto parsed = sql::parse_dml("UPDATE accounts SET balance = 100;");
     assert(parsed.kind == sql::DMLStatementKind::UPDATE);
     assert(parsed.update.assignments.size() == 1);
+
+    auto vacuum = sql::parse_dml("VACUUM accounts;");
+    assert(vacuum.kind == sql::DMLStatementKind::VACUUM);
+    assert(vacuum.vacuum.table_name == "accounts");
 }
 
 static void check_invalid_count_distinct_star()
@@ -255,6 +267,7 @@ bool sql_dml_parser_tests()
     check_delete_where();
     check_update_parse();
     check_truncate();
+    check_vacuum();
     check_parse_dml_switch();
     check_invalid_count_distinct_star();
     check_nested_select_error();
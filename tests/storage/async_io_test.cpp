@@ -0,0 +1,188 @@
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/async_io.h"
+#include "storage/file_manager.h"
+#include "storage/page_manager.h"
+
+using namespace kizuna;
+namespace fs = std::filesystem;
+
+namespace
+{
+    std::string temp_db(const std::string &name)
+    {
+        const std::string path = (config::temp_dir() / (name + config::DB_FILE_EXTENSION)).string();
+        std::error_code ec;
+        fs::create_directories(config::temp_dir(), ec);
+        fs::remove(path, ec);
+        return path;
+    }
+
+    uint8_t fill_for(page_id_t id) { return static_cast<uint8_t>(id * 13 + 1); }
+
+    // Writes then reads back 40 pages with a depth-8 queue.
+    bool roundtrip(FileBackend file_backend, bool prefer_io_uring)
+    {
+        const std::string path = temp_db("async_io_" + file_backend_to_string(file_backend) + (prefer_io_uring ? "_ring" : "_sync"));
+        FileManager fm(path, true, file_backend);
+        fm.open();
+        const int pages = 40;
+        for (int i = 0; i < pages; ++i) fm.allocate_page();
+
+        AsyncIoEngine engine(fm, 8, prefer_io_uring);
+        if (!prefer_io_uring && engine.backend() != AsyncIoBackend::SYNC) return false;
+        if (file_backend == FileBackend::FSTREAM && engine.backend() != AsyncIoBackend::SYNC) return false;
+
+        std::vector<std::vector<uint8_t>> buffers(pages, std::vector<uint8_t>(config::PAGE_SIZE));
+        std::vector<IoCompletion> done;
+        for (int i = 0; i < pages; ++i)
+        {
+            const page_id_t id = static_cast<page_id_t>(i + 1);
+            std::fill(buffers[i].begin(), buffers[i].end(), fill_for(id));
+            while (!engine.submit_write(id, buffers[i].data(), static_cast<uint64_t>(i)))
+            {
+                if (engine.poll(done, 1) == 0) return false;
+            }
+            if (engine.in_flight() > engine.queue_depth()) return false;
+        }
+        engine.drain(done);
+        if (done.size() != static_cast<std::size_t>(pages) || engine.in_flight() != 0) return false;
+        for (const auto &c : done)
+        {
+            if (!c.ok() || !c.is_write) return false;
+        }
+
+        for (auto &b : buffers) std::fill(b.begin(), b.end(), 0);
+        done.clear();
+        for (int i = 0; i < pages; ++i)
+        {
+            while (!engine.submit_read(static_cast<page_id_t>(i + 1), buffers[i].data(), static_cast<uint64_t>(i)))
+            {
+                engine.poll(done, 1);
+            }
+        }
+        engine.drain(done);
+        if (done.size() != static_cast<std::size_t>(pages)) return false;
+        for (const auto &c : done)
+        {
+            if (!c.ok() || c.is_write || c.page_id != static_cast<page_id_t>(c.user_data + 1)) return false;
+            const auto &b = buffers[c.user_data];
+            if (b.front() != fill_for(c.page_id) || b.back() != fill_for(c.page_id)) return false;
+        }
+
+        // Reads past EOF complete with an error instead of throwing.
+        std::vector<uint8_t> scratch(config::PAGE_SIZE);
+        done.clear();
+        engine.submit_read(static_cast<page_id_t>(pages + 5), scratch.data(), 99);
+        engine.drain(done);
+        if (done.size() != 1 || done[0].ok()) return false;
+
+        fm.close();
+        std::error_code ec;
+        fs::remove(path, ec);
+        return true;
+    }
+
+    bool page_manager_async_write_back()
+    {
+        const std::string path = temp_db("async_io_pm");
+        std::vector<page_id_t> ids;
+        {
+            FileManager fm(path, true);
+            fm.open();
+            PageManager pm(fm, 64);
+            pm.enable_async_io(4);
+            if (!pm.async_io_enabled()) return false;
+            for (int i = 0; i < 20; ++i)
+            {
+                const page_id_t id = pm.new_page(PageType::DATA);
+                auto &page = pm.fetch(id, true);
+                page.data()[config::PAGE_SIZE - 1] = fill_for(id);
+                pm.unpin(id, true);
+                ids.push_back(id);
+            }
+            pm.flush_all();
+        }
+        FileManager fm(path, false);
+        fm.open();
+        std::vector<uint8_t> buf(config::PAGE_SIZE);
+        for (auto id : ids)
+        {
+            fm.read_page(id, buf.data());
+            if (buf[config::PAGE_SIZE - 1] != fill_for(id)) return false;
+        }
+        return true;
+    }
+
+    // prefetch() through the engine while another thread fetches the same pages: the
+    // fetches wait for the in-flight reads and see the written bytes.
+    bool page_manager_async_read_ahead(FileBackend file_backend)
+    {
+        const std::string path = temp_db("async_io_pm_read_" + file_backend_to_string(file_backend));
+        std::vector<page_id_t> ids;
+        {
+            FileManager fm(path, true, file_backend);
+            fm.open();
+            PageManager pm(fm, 64);
+            for (int i = 0; i < 24; ++i)
+            {
+                const page_id_t id = pm.new_page(PageType::DATA);
+                auto &page = pm.fetch(id, true);
+                page.data()[config::PAGE_SIZE - 1] = fill_for(id);
+                pm.unpin(id, true);
+                ids.push_back(id);
+            }
+            pm.flush_all();
+        }
+        FileManager fm(path, false, file_backend);
+        fm.open();
+        PageManager pm(fm, 128);
+        pm.enable_async_io(4);
+        if (pm.prefetch_limit() < ids.size()) return false;
+        pm.reset_stats();
+
+        bool fetched_ok = true;
+        std::thread reader([&]()
+                           {
+                               for (auto it = ids.rbegin(); it != ids.rend(); ++it)
+                               {
+                                   auto &page = pm.fetch(*it, true);
+                                   fetched_ok = fetched_ok && page.data()[config::PAGE_SIZE - 1] == fill_for(*it);
+                                   pm.unpin(*it);
+                               } });
+        const std::size_t loaded = pm.prefetch(ids.front(), ids.size());
+        reader.join();
+        if (!fetched_ok || loaded > ids.size()) return false;
+
+        const auto stats = pm.stats();
+        if (stats.prefetched != loaded || stats.misses + loaded != ids.size()) return false;
+        for (auto id : ids)
+        {
+            auto &page = pm.fetch(id, false);
+            if (page.data()[config::PAGE_SIZE - 1] != fill_for(id)) return false;
+        }
+        return pm.stats().misses == stats.misses;
+    }
+}
+
+bool async_io_tests()
+{
+    try
+    {
+        if (!roundtrip(FileBackend::POSIX, true)) return false;
+        if (!roundtrip(FileBackend::POSIX, false)) return false;
+        if (!roundtrip(FileBackend::FSTREAM, true)) return false;
+        if (!page_manager_async_write_back()) return false;
+        if (!page_manager_async_read_ahead(FileBackend::POSIX)) return false;
+        if (!page_manager_async_read_ahead(FileBackend::FSTREAM)) return false;
+    }
+    catch (...)
+    {
+        return false;
+    }
+    return true;
+}
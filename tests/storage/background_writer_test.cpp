@@ -0,0 +1,195 @@
+#include <chrono>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "storage/background_writer.h"
+#include "storage/buffer_pool.h"
+#include "storage/file_manager.h"
+#include "storage/page_manager.h"
+#include "pool_test_util.h"
+
+using namespace kizuna;
+using namespace kizuna::test;
+
+namespace
+{
+    uint8_t disk_tag(FileManager &fm, page_id_t id)
+    {
+        Page page;
+        fm.read_page(id, page.data());
+        return page.data()[sizeof(PageHeader)];
+    }
+
+    std::vector<page_id_t> make_pages(PageManager &pm, std::size_t count)
+    {
+        std::vector<page_id_t> ids;
+        for (std::size_t i = 0; i < count; ++i)
+            ids.push_back(pm.new_page(PageType::DATA));
+        return ids;
+    }
+
+    bool test_cold_pages_cleaned_ahead()
+    {
+        BufferPool pool(/*capacity*/ 16);
+        PoolFile file("bgwriter_cold", pool);
+        PageManager &pm = *file.pm;
+        const auto ids = make_pages(pm, 24);
+        for (std::size_t i = 0; i < 16; ++i)
+            write_tag(pm, ids[i], static_cast<uint8_t>(i + 1));
+        pool.reset_stats();
+
+        // The four coldest pages (a quarter of the pool) are cleaned, oldest first.
+        if (pool.write_back_cold(100) != 4) return false;
+        if (pool.stats().background_writes != 4) return false;
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            if (disk_tag(file.fm, ids[i]) != i + 1) return false;
+        }
+        if (disk_tag(file.fm, ids[4]) != 0) return false;
+
+        // Evicting them costs the query no writes; the next victim is still dirty.
+        for (std::size_t i = 16; i < 20; ++i)
+            read_tag(pm, ids[i]);
+        if (pool.stats().foreground_writes != 0) return false;
+        read_tag(pm, ids[20]);
+        if (pool.stats().foreground_writes != 1) return false;
+
+        for (std::size_t i = 0; i < 16; ++i)
+        {
+            if (read_tag(pm, ids[i]) != i + 1) return false;
+        }
+        return true;
+    }
+
+    // The budget is shared out across shards: one shard's cold pages cannot use it all.
+    bool test_cold_budget_split_across_shards()
+    {
+        BufferPool pool(/*capacity*/ 64, /*shards*/ 4);
+        PoolFile file("bgwriter_shards", pool);
+        PageManager &pm = *file.pm;
+        const auto ids = make_pages(pm, 16);
+        std::set<std::size_t> shards;
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            write_tag(pm, ids[i], static_cast<uint8_t>(i + 1));
+            shards.insert(pool.shard_of(pm, ids[i]));
+        }
+        if (shards.size() != 4) return false;
+
+        if (pool.write_back_cold(4) != 4) return false;
+        std::set<std::size_t> cleaned;
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            if (disk_tag(file.fm, ids[i]) != 0)
+                cleaned.insert(pool.shard_of(pm, ids[i]));
+        }
+        return cleaned.size() == 4;
+    }
+
+    bool test_checkpoint_writes_everything()
+    {
+        BufferPool pool(/*capacity*/ 64);
+        PoolFile file("bgwriter_checkpoint", pool);
+        PageManager &pm = *file.pm;
+        const auto ids = make_pages(pm, 20);
+        for (std::size_t i = 0; i < ids.size(); ++i)
+            write_tag(pm, ids[i], static_cast<uint8_t>(0x40 + i));
+        // A pinned page is written as it is.
+        pm.fetch(ids[3], true);
+
+        if (pool.checkpoint() < ids.size()) return false;
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            if (disk_tag(file.fm, ids[i]) != 0x40 + i) return false;
+        }
+        pm.unpin(ids[3], false);
+        const auto stats = pool.stats();
+        if (stats.checkpoints != 1 || stats.checkpoint_writes < ids.size()) return false;
+        return pool.checkpoint() == 0;
+    }
+
+    bool test_writer_thread()
+    {
+        BufferPool pool(/*capacity*/ 16);
+        PoolFile file("bgwriter_thread", pool);
+        PageManager &pm = *file.pm;
+        const auto ids = make_pages(pm, 64);
+        std::vector<uint8_t> expected(ids.size(), 0);
+        {
+            BackgroundWriter writer(pool, std::chrono::milliseconds(1), 8, std::chrono::milliseconds(0));
+            // Keep dirtying pages through a pool a quarter of their size while the writer
+            // cleans behind the queries.
+            for (std::size_t round = 0; round < 2000; ++round)
+            {
+                const std::size_t i = (round * 7) % ids.size();
+                expected[i] = static_cast<uint8_t>(round);
+                write_tag(pm, ids[i], expected[i]);
+                if (round % 50 == 0)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            for (int wait = 0; wait < 2000 && pool.stats().background_writes == 0; ++wait)
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            if (pool.stats().background_writes == 0) return false;
+
+            writer.request_checkpoint();
+            if (writer.checkpoints() != 1) return false;
+            for (std::size_t i = 0; i < ids.size(); ++i)
+            {
+                if (disk_tag(file.fm, ids[i]) != expected[i]) return false;
+            }
+        }
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            if (read_tag(pm, ids[i]) != expected[i]) return false;
+        }
+        return true;
+    }
+
+    // flush_all() through the async engine on the fstream backend while the writer
+    // cleans the same file: both sides take a frame's io_latch and the file's I/O mutex.
+    bool test_writer_with_async_flush()
+    {
+        BufferPool pool(/*capacity*/ 16);
+        PoolFile file("bgwriter_async_flush", pool, FileBackend::FSTREAM);
+        PageManager &pm = *file.pm;
+        pm.enable_async_io(4);
+        const auto ids = make_pages(pm, 48);
+        std::vector<uint8_t> expected(ids.size(), 0);
+        {
+            BackgroundWriter writer(pool, std::chrono::milliseconds(0), 8, std::chrono::milliseconds(0));
+            for (std::size_t round = 0; round < 3000; ++round)
+            {
+                const std::size_t i = (round * 5) % ids.size();
+                expected[i] = static_cast<uint8_t>(round);
+                write_tag(pm, ids[i], expected[i]);
+                if (round % 10 == 0)
+                    pm.flush_all();
+            }
+            pm.flush_all();
+        }
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            if (disk_tag(file.fm, ids[i]) != expected[i]) return false;
+        }
+        return true;
+    }
+}
+
+bool background_writer_tests()
+{
+    try
+    {
+        if (!test_cold_pages_cleaned_ahead()) return false;
+        if (!test_cold_budget_split_across_shards()) return false;
+        if (!test_checkpoint_writes_everything()) return false;
+        if (!test_writer_thread()) return false;
+        if (!test_writer_with_async_flush()) return false;
+    }
+    catch (...)
+    {
+        return false;
+    }
+    return true;
+}
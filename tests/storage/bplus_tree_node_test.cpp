@@ -1,4 +1,6 @@
-﻿#include <cassert>
+﻿#include <algorithm>
+#include <cassert>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -122,6 +124,174 @@ namespace
         }
         return threw;
     }
+
+    std::string key_string(std::span<const uint8_t> key)
+    {
+        return std::string(key.begin(), key.end());
+    }
+
+    bool view_search_and_edit_leaf()
+    {
+        Page page;
+        page.init(PageType::INDEX, 50);
+
+        auto node = BPlusTreeNode::MakeLeaf(50);
+        node.set_next_leaf(51);
+        for (const char *key : {"b", "d", "f"})
+            node.leaf_entries().push_back(BPlusTreeNode::LeafEntry{make_key(key), static_cast<record_id_t>(key[0])});
+        node.Serialize(page);
+
+        BPlusTreeNodeView view(page);
+        assert(view.is_leaf());
+        assert(view.key_count() == 3);
+        assert(view.next_leaf() == 51);
+        assert(view.LowerBound(make_key("a")) == 0);
+        assert(view.LowerBound(make_key("d")) == 1);
+        assert(view.UpperBound(make_key("d")) == 2);
+        assert(view.LowerBound(make_key("z")) == 3);
+        assert(key_string(view.KeyAt(2)) == "f");
+
+        // Keys are borrowed from the page, not copied.
+        auto borrowed = view.KeyAt(0);
+        assert(borrowed.data() > page.data() && borrowed.data() < page.data() + Page::page_size());
+
+        assert(view.InsertLeaf(view.LowerBound(make_key("c")), make_key("c"), 'c'));
+        assert(view.InsertLeaf(view.LowerBound(make_key("a")), make_key("a"), 'a'));
+        assert(view.InsertLeaf(view.LowerBound(make_key("g")), make_key("g"), 'g'));
+        view.RemoveLeaf(view.LowerBound(make_key("d")));
+        view.SetValueAt(0, 1000);
+
+        auto decoded = BPlusTreeNode::Deserialize(page);
+        const std::vector<std::string> expected_keys{"a", "b", "c", "f", "g"};
+        const std::vector<record_id_t> expected_values{1000, 'b', 'c', 'f', 'g'};
+        assert(decoded.leaf_entries().size() == expected_keys.size());
+        for (size_t i = 0; i < expected_keys.size(); ++i)
+        {
+            const auto &entry = decoded.leaf_entries()[i];
+            assert(std::string(entry.key.begin(), entry.key.end()) == expected_keys[i]);
+            assert(entry.value == expected_values[i]);
+        }
+        assert(decoded.next_leaf() == 51);
+        return true;
+    }
+
+    bool view_insert_internal()
+    {
+        Page page;
+        page.init(PageType::INDEX, 60);
+
+        auto node = BPlusTreeNode::MakeInternal(60);
+        node.children() = {1, 3};
+        node.internal_entries().push_back(BPlusTreeNode::InternalEntry{make_key("m"), 3});
+        node.Serialize(page);
+
+        BPlusTreeNodeView view(page);
+        assert(view.ChildAt(view.UpperBound(make_key("a"))) == 1);
+        assert(view.ChildAt(view.UpperBound(make_key("m"))) == 3);
+
+        // Child 1 split at "g": the new right sibling 2 goes after the separator.
+        assert(view.InsertInternal(view.UpperBound(make_key("g")), make_key("g"), 2));
+        assert(view.key_count() == 2);
+        assert(view.ChildAt(view.UpperBound(make_key("a"))) == 1);
+        assert(view.ChildAt(view.UpperBound(make_key("h"))) == 2);
+        assert(view.ChildAt(view.UpperBound(make_key("x"))) == 3);
+
+        auto decoded = BPlusTreeNode::Deserialize(page);
+        assert(decoded.children() == (std::vector<page_id_t>{1, 2, 3}));
+        assert(decoded.internal_entries().size() == 2);
+        assert(decoded.internal_entries()[0].child == 2);
+        assert(decoded.internal_entries()[1].child == 3);
+        return true;
+    }
+
+    bool view_reuses_removed_key_space()
+    {
+        Page page;
+        page.init(PageType::INDEX, 70);
+        BPlusTreeNode::MakeLeaf(70).Serialize(page);
+
+        BPlusTreeNodeView view(page);
+        auto key_for = [](size_t i)
+        {
+            std::string key = std::to_string(1000 + i);
+            key.resize(96, 'k');
+            return std::vector<uint8_t>(key.begin(), key.end());
+        };
+
+        size_t inserted = 0;
+        while (view.InsertLeaf(inserted, key_for(inserted), inserted))
+            ++inserted;
+        assert(inserted > 4);
+
+        // Removing from the middle leaves holes; the next insert compacts them away.
+        view.RemoveLeaf(1);
+        view.RemoveLeaf(1);
+        assert(view.InsertLeaf(1, key_for(1), 1));
+        assert(view.InsertLeaf(2, key_for(2), 2));
+        assert(!view.InsertLeaf(inserted, key_for(inserted), inserted));
+
+        auto decoded = BPlusTreeNode::Deserialize(page);
+        assert(decoded.leaf_entries().size() == inserted);
+        for (size_t i = 0; i < inserted; ++i)
+        {
+            assert(decoded.leaf_entries()[i].key == key_for(i));
+            assert(decoded.leaf_entries()[i].value == i);
+        }
+        return true;
+    }
+
+    bool view_prefix_search_matches_linear()
+    {
+        // Keys sharing 4-byte prefixes, short keys, embedded zero bytes and the empty key.
+        std::vector<std::vector<uint8_t>> keys{{}, {0}, {0, 0}, {0, 0, 0, 0, 1}, make_key("a"), make_key("ab")};
+        for (int i = 0; i < 60; ++i)
+            keys.push_back(make_key("user" + std::to_string(100 + i)));
+        for (int i = 0; i < 30; ++i)
+            keys.push_back(make_key(std::string(1, static_cast<char>('b' + i % 20)) + std::to_string(i)));
+        std::sort(keys.begin(), keys.end(), [](const auto &l, const auto &r)
+                  { return CompareKeyBytes(l, r) < 0; });
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+        Page page;
+        page.init(PageType::INDEX, 80);
+        auto node = BPlusTreeNode::MakeLeaf(80);
+        for (size_t i = 0; i < keys.size(); ++i)
+            node.leaf_entries().push_back(BPlusTreeNode::LeafEntry{keys[i], i});
+        node.Serialize(page);
+
+        std::vector<std::vector<uint8_t>> probes = keys;
+        for (const char *extra : {"", "a0", "user", "user1000", "user15", "zzz", "b", "c3x"})
+            probes.push_back(make_key(extra));
+        probes.push_back({0, 0, 0});
+        probes.push_back({0xFF});
+
+        auto check = [&](const BPlusTreeNodeView &view)
+        {
+            for (const auto &probe : probes)
+            {
+                size_t lower = 0;
+                while (lower < keys.size() && CompareKeyBytes(keys[lower], probe) < 0)
+                    ++lower;
+                size_t upper = lower;
+                while (upper < keys.size() && CompareKeyBytes(keys[upper], probe) <= 0)
+                    ++upper;
+                if (view.LowerBound(probe) != lower || view.UpperBound(probe) != upper)
+                    return false;
+            }
+            return true;
+        };
+
+        BPlusTreeNodeView view(page);
+        assert(view.has_key_prefixes());
+        assert(check(view));
+
+        // Nodes written before the prefix array existed fall back to plain bisection.
+        page.data()[Page::kHeaderSize + 5] = 0;
+        BPlusTreeNodeView legacy(page);
+        assert(!legacy.has_key_prefixes());
+        assert(check(legacy));
+        return true;
+    }
 }
 
 bool bplus_tree_node_tests()
@@ -131,5 +301,9 @@ bool bplus_tree_node_tests()
     ok &= internal_roundtrip();
     ok &= oversized_key_rejected();
     ok &= invalid_magic_detection();
+    ok &= view_search_and_edit_leaf();
+    ok &= view_insert_internal();
+    ok &= view_reuses_removed_key_space();
+    ok &= view_prefix_search_matches_linear();
     return ok;
 }
@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "storage/file_manager.h"
+#include "storage/page_manager.h"
+#include "storage/record.h"
+#include "storage/table_heap.h"
+
+using namespace kizuna;
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct RingContext
+    {
+        std::string db_path;
+        FileManager fm;
+        std::unique_ptr<PageManager> pm;
+
+        RingContext(const std::string &name, std::size_t capacity)
+            : db_path((config::temp_dir() / (name + config::DB_FILE_EXTENSION)).string()),
+              fm(db_path, true)
+        {
+            std::error_code ec;
+            fs::create_directories(config::temp_dir(), ec);
+            fs::remove(db_path, ec);
+            fm.open();
+            pm = std::make_unique<PageManager>(fm, capacity);
+        }
+
+        ~RingContext()
+        {
+            pm.reset();
+            fm.close();
+            std::error_code ec;
+            fs::remove(db_path, ec);
+        }
+    };
+
+    bool all_cached(PageManager &pm, const std::vector<page_id_t> &ids)
+    {
+        pm.reset_stats();
+        for (auto id : ids)
+        {
+            pm.fetch(id, true);
+            pm.unpin(id, false);
+        }
+        return pm.stats().misses == 0;
+    }
+
+    bool test_ring_protects_cache()
+    {
+        RingContext ctx("ring_protect", 16);
+        auto &pm = *ctx.pm;
+        std::vector<page_id_t> ids;
+        for (int i = 0; i < 64; ++i)
+        {
+            ids.push_back(pm.new_page(PageType::DATA));
+        }
+        pm.flush_all();
+
+        std::vector<page_id_t> hot(ids.begin(), ids.begin() + 4);
+        all_cached(pm, hot); // warm
+        if (!all_cached(pm, hot)) return false;
+
+        {
+            BufferAccessStrategy ring(pm, 4);
+            pm.reset_stats();
+            for (auto id : ids)
+            {
+                auto &page = pm.fetch(id, true, &ring);
+                const bool ok = page.header().page_id == id;
+                pm.unpin(id, false);
+                if (!ok) return false;
+            }
+            if (pm.stats().ring_reuses == 0) return false;
+            if (pm.stats().evictions > 4) return false;
+        }
+
+        // The scan went through the ring, so the hot set is still resident.
+        return all_cached(pm, hot);
+    }
+
+    bool test_ring_page_adopted_on_shared_access()
+    {
+        RingContext ctx("ring_adopt", 16);
+        auto &pm = *ctx.pm;
+        std::vector<page_id_t> ids;
+        // More pages than frames, so the first ones are no longer cached.
+        for (int i = 0; i < 40; ++i)
+        {
+            ids.push_back(pm.new_page(PageType::DATA));
+        }
+        pm.flush_all();
+
+        const page_id_t shared = ids[0];
+        {
+            BufferAccessStrategy ring(pm, 2);
+            auto &page = pm.fetch(shared, true, &ring);
+            std::memcpy(page.data() + config::PAGE_SIZE - 4, "ring", 4);
+            pm.unpin(shared, true);
+            // A regular fetch moves the page into the shared pool.
+            pm.fetch(shared, true);
+            pm.unpin(shared, false);
+        }
+        if (!all_cached(pm, {shared})) return false;
+        auto &page = pm.fetch(shared, true);
+        const bool ok = std::memcmp(page.data() + config::PAGE_SIZE - 4, "ring", 4) == 0;
+        pm.unpin(shared, false);
+        return ok;
+    }
+
+    bool test_large_heap_scan_uses_ring()
+    {
+        RingContext ctx("ring_heap_scan", 16);
+        auto &pm = *ctx.pm;
+        page_id_t root = pm.new_page(PageType::DATA);
+        TableHeap heap(pm, root);
+        std::vector<record::Field> fields;
+        fields.push_back(record::from_int32(0));
+        fields.push_back(record::from_string(std::string(200, 'x')));
+        const auto payload = record::encode(fields);
+        const int rows = 600; // ~40 pages
+        for (int i = 0; i < rows; ++i)
+        {
+            heap.insert(payload);
+        }
+        pm.flush_all();
+
+        page_id_t hot = pm.new_page(PageType::DATA);
+        if (!all_cached(pm, {hot})) return false;
+
+        int count = 0;
+        heap.scan([&](const TableHeap::RowLocation &, std::span<const uint8_t> data)
+                  {
+                      if (std::equal(data.begin(), data.end(), payload.begin(), payload.end())) ++count;
+                  });
+        if (count != rows) return false;
+        return all_cached(pm, {hot});
+    }
+}
+
+bool buffer_access_strategy_tests()
+{
+    try
+    {
+        if (!test_ring_protects_cache()) return false;
+        if (!test_ring_page_adopted_on_shared_access()) return false;
+        if (!test_large_heap_scan_uses_ring()) return false;
+    }
+    catch (...)
+    {
+        return false;
+    }
+    return true;
+}
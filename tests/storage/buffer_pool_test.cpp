@@ -0,0 +1,162 @@
+#include <string>
+#include <vector>
+
+#include "storage/buffer_pool.h"
+#include "storage/file_manager.h"
+#include "storage/page_manager.h"
+#include "pool_test_util.h"
+
+using namespace kizuna;
+using namespace kizuna::test;
+
+namespace
+{
+    bool test_files_share_frames()
+    {
+        BufferPool pool(/*capacity*/ 8);
+        {
+            PoolFile table("buffer_pool_table", pool);
+            PoolFile index("buffer_pool_index", pool);
+            if (pool.file_count() != 2) return false;
+            if (table.pm->file_id() == index.pm->file_id()) return false;
+
+            // Both files allocate the same page ids; the pool must keep them apart.
+            std::vector<page_id_t> ids;
+            for (int i = 0; i < 12; ++i)
+            {
+                const page_id_t id = table.pm->new_page(PageType::DATA);
+                if (index.pm->new_page(PageType::INDEX) != id) return false;
+                ids.push_back(id);
+            }
+            for (auto id : ids)
+            {
+                write_tag(*table.pm, id, static_cast<uint8_t>(id));
+                write_tag(*index.pm, id, static_cast<uint8_t>(0x80 | id));
+            }
+
+            // 24 pages through 8 frames: evictions write each page back to its own file.
+            if (pool.resident_pages(*table.pm) + pool.resident_pages(*index.pm) > pool.capacity()) return false;
+            if (pool.stats().evictions == 0) return false;
+            for (auto id : ids)
+            {
+                if (read_tag(*table.pm, id) != static_cast<uint8_t>(id)) return false;
+                if (read_tag(*index.pm, id) != static_cast<uint8_t>(0x80 | id)) return false;
+            }
+
+            // A file touched after the other takes over the shared frames.
+            for (auto id : ids)
+                read_tag(*index.pm, id);
+            if (pool.resident_pages(*index.pm) != pool.capacity()) return false;
+            if (pool.resident_pages(*table.pm) != 0) return false;
+
+            // Closing a file hands its frames back to the pool.
+            index.pm.reset();
+            if (pool.file_count() != 1) return false;
+            for (std::size_t i = 0; i < pool.capacity(); ++i)
+                read_tag(*table.pm, ids[i]);
+            if (pool.resident_pages(*table.pm) != pool.capacity()) return false;
+        }
+        return pool.file_count() == 0;
+    }
+
+    bool test_resize_in_place()
+    {
+        BufferPool pool(/*capacity*/ 16);
+        PoolFile file("buffer_pool_resize", pool);
+        PageManager &pm = *file.pm;
+        std::vector<page_id_t> ids;
+        for (std::size_t i = 0; i < config::BUFFER_POOL_CHUNK_FRAMES + 88; ++i)
+        {
+            ids.push_back(pm.new_page(PageType::DATA));
+            write_tag(pm, ids.back(), static_cast<uint8_t>(i));
+        }
+
+        // Growing maps new chunks; every page fits afterwards.
+        const std::size_t grown = 2 * config::BUFFER_POOL_CHUNK_FRAMES + 16;
+        if (pool.resize(grown) != grown || pool.capacity() != grown) return false;
+        if (pool.mapped_bytes() < grown * config::PAGE_SIZE) return false;
+        pool.reset_stats();
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            if (read_tag(pm, ids[i]) != static_cast<uint8_t>(i)) return false;
+        }
+        if (pool.resident_pages(pm) < ids.size()) return false;
+        if (pool.stats().evictions != 0) return false;
+
+        // Shrinking around a pinned page leaves it where it is; the rest is written back.
+        // The page was loaded after the first chunk filled up, so its frame sits in the second.
+        const page_id_t hot = ids[ids.size() - 20];
+        Page &pinned = pm.fetch(hot, true);
+        pinned.data()[sizeof(PageHeader) + 1] = 0x5A;
+        const std::size_t mapped_before = pool.mapped_bytes();
+        if (pool.resize(8) != 8) return false;
+        if (pool.mapped_bytes() >= mapped_before) return false;
+        if (pool.resident_pages(pm) > 8) return false;
+        if (&pm.fetch(hot, false) != &pinned) return false;
+        if (pinned.data()[sizeof(PageHeader) + 1] != 0x5A) return false;
+        pm.unpin(hot, true);
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            if (read_tag(pm, ids[i]) != static_cast<uint8_t>(i)) return false;
+        }
+        if (pool.resident_pages(pm) > pool.capacity()) return false;
+
+        // A shrink cannot reclaim pinned frames and stops short until they are released.
+        std::vector<Page *> held;
+        for (std::size_t i = 0; i < 6; ++i)
+        {
+            held.push_back(&pm.fetch(ids[i], true));
+        }
+        if (pool.resize(2) != 6) return false;
+        for (std::size_t i = 0; i < held.size(); ++i)
+        {
+            if (&pm.fetch(ids[i], false) != held[i]) return false;
+            pm.unpin(ids[i], false);
+        }
+        if (pool.resize(2) != 2) return false;
+
+        // Budgets are given in bytes.
+        if (pool.set_memory_budget(64 * config::PAGE_SIZE + 100) != 64 * config::PAGE_SIZE) return false;
+        if (pool.capacity() != 64 || pool.memory_bytes() != 64 * config::PAGE_SIZE) return false;
+        return read_tag(pm, ids[7]) == 7;
+    }
+
+    bool test_resize_sharded()
+    {
+        BufferPool pool(/*capacity*/ 32, /*shards*/ 4, ReplacementPolicyKind::TWO_Q);
+        PoolFile file("buffer_pool_resize_sharded", pool);
+        std::vector<page_id_t> ids;
+        for (std::size_t i = 0; i < 80; ++i)
+        {
+            ids.push_back(file.pm->new_page(PageType::DATA));
+            write_tag(*file.pm, ids.back(), static_cast<uint8_t>(i));
+        }
+        if (pool.resize(100) != 100) return false;
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            if (read_tag(*file.pm, ids[i]) != static_cast<uint8_t>(i)) return false;
+        }
+        // Every shard keeps one frame.
+        if (pool.resize(1) != pool.shard_count()) return false;
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            if (read_tag(*file.pm, ids[i]) != static_cast<uint8_t>(i)) return false;
+        }
+        return pool.resident_pages(*file.pm) <= pool.shard_count();
+    }
+}
+
+bool buffer_pool_tests()
+{
+    try
+    {
+        if (!test_files_share_frames()) return false;
+        if (!test_resize_in_place()) return false;
+        if (!test_resize_sharded()) return false;
+    }
+    catch (...)
+    {
+        return false;
+    }
+    return true;
+}
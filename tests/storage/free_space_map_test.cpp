@@ -0,0 +1,213 @@
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catalog/catalog_manager.h"
+#include "catalog/schema.h"
+#include "engine/ddl_executor.h"
+#include "engine/dml_executor.h"
+#include "sql/dml_parser.h"
+#include "storage/file_manager.h"
+#include "storage/free_space_map.h"
+#include "storage/index/index_manager.h"
+#include "storage/page_manager.h"
+#include "storage/record.h"
+#include "storage/table_heap.h"
+
+using namespace kizuna;
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct FsmContext
+    {
+        std::string db_path;
+        FileManager fm;
+        std::unique_ptr<PageManager> pm;
+
+        explicit FsmContext(const std::string &name)
+            : db_path((config::temp_dir() / (name + config::DB_FILE_EXTENSION)).string()),
+              fm(db_path, true)
+        {
+            std::error_code ec;
+            fs::create_directories(config::temp_dir(), ec);
+            fs::remove(db_path, ec);
+            fm.open();
+            pm = std::make_unique<PageManager>(fm, 64);
+        }
+
+        ~FsmContext()
+        {
+            pm.reset();
+            fm.close();
+            std::error_code ec;
+            fs::remove(db_path, ec);
+        }
+    };
+
+    std::vector<uint8_t> make_row(int id)
+    {
+        std::vector<record::Field> fields;
+        fields.push_back(record::from_int32(id));
+        fields.push_back(record::from_string(std::string(200, 'f')));
+        return record::encode(fields);
+    }
+
+    bool test_map_tracks_categories()
+    {
+        FsmContext ctx("fsm_categories");
+        auto &pm = *ctx.pm;
+        FreeSpaceMap fsm(pm, FreeSpaceMap::create(pm));
+
+        // Enough entries to spill onto a second FSM page.
+        const page_id_t first = 1000;
+        const std::size_t count = 1500;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            fsm.update(static_cast<page_id_t>(first + i), 0);
+        }
+        if (fsm.tracked_pages() != count) return false;
+        if (fsm.find(64).has_value()) return false;
+
+        const page_id_t roomy = static_cast<page_id_t>(first + count - 3);
+        fsm.update(roomy, 1024);
+        if (fsm.tracked_pages() != count) return false;
+        auto hit = fsm.find(1000);
+        if (!hit || *hit != roomy) return false;
+        if (fsm.find(2000).has_value()) return false;
+
+        // Categories round down, so a page is never offered more than it has.
+        fsm.update(roomy, 1023);
+        if (fsm.find(1023).has_value()) return false;
+        if (!fsm.find(1008).has_value()) return false;
+
+        if (!fsm.remove(roomy)) return false;
+        if (fsm.remove(roomy)) return false;
+        if (fsm.find(16).has_value()) return false;
+        if (fsm.tracked_pages() != count - 1) return false;
+
+        const uint32_t free_before = pm.free_count();
+        fsm.clear();
+        if (fsm.tracked_pages() != 0) return false;
+        return pm.free_count() > free_before;
+    }
+
+    bool test_heap_reuses_deleted_page()
+    {
+        FsmContext ctx("fsm_heap_reuse");
+        auto &pm = *ctx.pm;
+        const page_id_t root = pm.new_page(PageType::DATA);
+        const page_id_t fsm_root = FreeSpaceMap::build(pm, root);
+        TableHeap heap(pm, root, config::INVALID_PAGE_ID, fsm_root);
+
+        std::vector<TableHeap::RowLocation> locations;
+        for (int i = 0; i < 60; ++i) // several pages
+        {
+            locations.push_back(heap.insert(make_row(i)));
+        }
+        const page_id_t tail = heap.tail_page_id();
+        if (tail == root) return false;
+
+        // Empty the root page completely; its space goes back to the map.
+        for (const auto &loc : locations)
+        {
+            if (loc.page_id == root && !heap.erase(loc)) return false;
+        }
+        // Once the tail is full, the next row lands in the emptied page, not a new one.
+        TableHeap::RowLocation reused;
+        do
+        {
+            reused = heap.insert(make_row(1000));
+        } while (reused.page_id == tail);
+        if (reused.page_id != root || reused.slot != 0) return false;
+        if (heap.tail_page_id() != tail) return false;
+
+        std::vector<uint8_t> out;
+        if (!heap.read(reused, out) || out != make_row(1000)) return false;
+        return FreeSpaceMap(pm, fsm_root).tracked_pages() >= 3;
+    }
+
+    bool test_tail_hint()
+    {
+        FsmContext ctx("fsm_tail_hint");
+        auto &pm = *ctx.pm;
+        const page_id_t root = pm.new_page(PageType::DATA);
+        page_id_t tail = config::INVALID_PAGE_ID;
+        {
+            TableHeap heap(pm, root);
+            for (int i = 0; i < 60; ++i)
+            {
+                heap.insert(make_row(i));
+            }
+            tail = heap.tail_page_id();
+        }
+        if (TableHeap(pm, root, tail).tail_page_id() != tail) return false;
+        // A stale hint (not the end of the chain) falls back to walking from the root.
+        if (TableHeap(pm, root, root).tail_page_id() != tail) return false;
+
+        TableHeap heap(pm, root, tail);
+        const auto loc = heap.insert(make_row(99));
+        return loc.page_id == tail || heap.tail_page_id() == loc.page_id;
+    }
+
+    bool test_drop_table_frees_map()
+    {
+        FsmContext ctx("fsm_drop_table");
+        auto &pm = *ctx.pm;
+        catalog::CatalogManager catalog(pm, ctx.fm);
+        index::IndexManager index_manager;
+        engine::DDLExecutor ddl(catalog, pm, ctx.fm, index_manager);
+        engine::DMLExecutor dml(catalog, pm, ctx.fm, index_manager);
+        ddl.create_table("CREATE TABLE t (id INTEGER, note VARCHAR(200));");
+        dml.insert_into(sql::parse_insert("INSERT INTO t (id, note) VALUES (1, 'a'), (2, 'b');"));
+
+        const auto entry = catalog.get_table("t");
+        if (!entry || entry->fsm_root_page_id == config::INVALID_PAGE_ID) return false;
+        const page_id_t fsm_root = entry->fsm_root_page_id;
+        const uint32_t free_before = pm.free_count();
+
+        ddl.drop_table("DROP TABLE t;");
+        // The heap root and the map's page both go back to the free list.
+        if (pm.free_count() < free_before + 2) return false;
+        auto &page = pm.fetch(fsm_root, false);
+        return page.header().page_type == static_cast<uint8_t>(PageType::FREE);
+    }
+
+    bool test_catalog_entry_storage_fields()
+    {
+        catalog::TableCatalogEntry entry;
+        entry.table_id = 7;
+        entry.root_page_id = 12;
+        entry.name = "t";
+        entry.create_sql = "CREATE TABLE t (id INTEGER);";
+        entry.tail_page_id = 40;
+        entry.fsm_root_page_id = 13;
+        auto bytes = entry.serialize();
+        std::size_t consumed = 0;
+        auto decoded = catalog::TableCatalogEntry::deserialize(bytes.data(), bytes.size(), consumed);
+        if (decoded.tail_page_id != 40 || decoded.fsm_root_page_id != 13 || consumed != bytes.size()) return false;
+
+        // Entries written before these fields existed decode with both unset.
+        bytes.resize(bytes.size() - 8);
+        auto legacy = catalog::TableCatalogEntry::deserialize(bytes.data(), bytes.size(), consumed);
+        return legacy.tail_page_id == 0 && legacy.fsm_root_page_id == 0 && legacy.next_column_id == entry.next_column_id;
+    }
+}
+
+bool free_space_map_tests()
+{
+    try
+    {
+        if (!test_map_tracks_categories()) return false;
+        if (!test_heap_reuses_deleted_page()) return false;
+        if (!test_tail_hint()) return false;
+        if (!test_drop_table_frees_map()) return false;
+        if (!test_catalog_entry_storage_fields()) return false;
+    }
+    catch (...)
+    {
+        return false;
+    }
+    return true;
+}
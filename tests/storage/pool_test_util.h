@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#include "storage/buffer_pool.h"
+#include "storage/file_manager.h"
+#include "storage/page_manager.h"
+
+// Fixtures shared by the buffer pool and background writer tests.
+namespace kizuna::test
+{
+    // A scratch database file in the temp dir whose PageManager caches through `pool`.
+    struct PoolFile
+    {
+        std::string path;
+        FileManager fm;
+        std::unique_ptr<PageManager> pm;
+
+        PoolFile(const std::string &name, BufferPool &pool, FileBackend backend = default_file_backend())
+            : path((config::temp_dir() / (name + config::DB_FILE_EXTENSION)).string()),
+              fm(path, true, backend)
+        {
+            std::error_code ec;
+            std::filesystem::create_directories(config::temp_dir(), ec);
+            std::filesystem::remove(path, ec);
+            fm.open();
+            pm = std::make_unique<PageManager>(fm, pool);
+        }
+
+        ~PoolFile()
+        {
+            pm.reset();
+            fm.close();
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+        }
+    };
+
+    // Tags live in the first payload byte, past the page header.
+    inline void write_tag(PageManager &pm, page_id_t id, uint8_t tag)
+    {
+        auto &page = pm.fetch(id, true);
+        page.data()[sizeof(PageHeader)] = tag;
+        pm.unpin(id, true);
+    }
+
+    inline uint8_t read_tag(PageManager &pm, page_id_t id)
+    {
+        auto &page = pm.fetch(id, true);
+        const uint8_t tag = page.data()[sizeof(PageHeader)];
+        pm.unpin(id, false);
+        return tag;
+    }
+}
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "storage/file_manager.h"
+#include "storage/page_manager.h"
+#include "storage/record.h"
+#include "storage/table_heap.h"
+
+using namespace kizuna;
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct PrefetchContext
+    {
+        std::string db_path;
+        FileManager fm;
+        std::size_t capacity;
+        std::unique_ptr<PageManager> pm;
+
+        PrefetchContext(const std::string &name, std::size_t cap, FileBackend backend = default_file_backend())
+            : db_path((config::temp_dir() / (name + config::DB_FILE_EXTENSION)).string()),
+              fm(db_path, true, backend), capacity(cap)
+        {
+            std::error_code ec;
+            fs::create_directories(config::temp_dir(), ec);
+            fs::remove(db_path, ec);
+            fm.open();
+            pm = std::make_unique<PageManager>(fm, capacity);
+        }
+
+        // Flush and start over with an empty cache.
+        void reopen()
+        {
+            pm.reset();
+            pm = std::make_unique<PageManager>(fm, capacity);
+        }
+
+        ~PrefetchContext()
+        {
+            pm.reset();
+            fm.close();
+            std::error_code ec;
+            fs::remove(db_path, ec);
+        }
+    };
+
+    std::vector<page_id_t> make_marked_pages(PageManager &pm, int count)
+    {
+        std::vector<page_id_t> ids;
+        for (int i = 0; i < count; ++i)
+        {
+            const page_id_t id = pm.new_page(PageType::DATA);
+            auto &page = pm.fetch(id, true);
+            std::memcpy(page.data() + config::PAGE_SIZE - sizeof(id), &id, sizeof(id));
+            pm.unpin(id, true);
+            ids.push_back(id);
+        }
+        return ids;
+    }
+
+    bool marked(Page &page, page_id_t id)
+    {
+        page_id_t stored = 0;
+        std::memcpy(&stored, page.data() + config::PAGE_SIZE - sizeof(stored), sizeof(stored));
+        return stored == id && page.header().page_id == id;
+    }
+
+    bool test_prefetch_loads_window()
+    {
+        PrefetchContext ctx("prefetch_window", 64);
+        const auto ids = make_marked_pages(*ctx.pm, 40);
+        ctx.reopen();
+        auto &pm = *ctx.pm;
+
+        if (pm.prefetch(ids[2], 8) != 8) return false;
+        if (pm.stats().prefetched != 8) return false;
+        pm.reset_stats();
+        for (std::size_t i = 2; i < 10; ++i)
+        {
+            auto &page = pm.fetch(ids[i], true);
+            const bool ok = marked(page, ids[i]);
+            pm.unpin(ids[i], false);
+            if (!ok) return false;
+        }
+        if (pm.stats().misses != 0) return false;
+
+        // Cached pages are skipped and the window stops at end of file.
+        if (pm.prefetch(ids[2], 8) != 0) return false;
+        if (pm.prefetch(ids.back(), 8) != 1) return false;
+        if (pm.prefetch(ids.back() + 5, 8) != 0) return false;
+        return true;
+    }
+
+    bool test_prefetch_window_is_clamped()
+    {
+        PrefetchContext ctx("prefetch_clamp", 16);
+        const auto ids = make_marked_pages(*ctx.pm, 40);
+        ctx.reopen();
+        auto &pm = *ctx.pm;
+
+        const std::size_t loaded = pm.prefetch(ids[0], 32);
+        if (loaded == 0 || loaded > 4) return false;
+        {
+            BufferAccessStrategy ring(pm, 4);
+            const std::size_t ring_loaded = pm.prefetch(ids[10], 32, &ring);
+            if (ring_loaded == 0 || ring_loaded > 2) return false;
+            auto &page = pm.fetch(ids[10], true, &ring);
+            const bool ok = marked(page, ids[10]);
+            pm.unpin(ids[10], false);
+            if (!ok) return false;
+        }
+        return true;
+    }
+
+    bool cold_heap_scan(FileBackend backend, std::size_t capacity)
+    {
+        PrefetchContext ctx("prefetch_heap_" + file_backend_to_string(backend), capacity, backend);
+        page_id_t root = ctx.pm->new_page(PageType::DATA);
+        std::vector<uint8_t> payload;
+        {
+            TableHeap heap(*ctx.pm, root);
+            std::vector<record::Field> fields;
+            fields.push_back(record::from_int32(7));
+            fields.push_back(record::from_string(std::string(200, 'r')));
+            payload = record::encode(fields);
+            for (int i = 0; i < 600; ++i) // ~40 pages
+            {
+                heap.insert(payload);
+            }
+        }
+        ctx.reopen();
+        auto &pm = *ctx.pm;
+        TableHeap heap(pm, root);
+
+        int count = 0;
+        heap.scan([&](const TableHeap::RowLocation &, std::span<const uint8_t> data)
+                  {
+                      if (std::equal(data.begin(), data.end(), payload.begin(), payload.end())) ++count;
+                  });
+        if (count != 600) return false;
+        const auto stats = pm.stats();
+        // Most pages arrive through read-ahead rather than one miss each.
+        return stats.prefetched > 0 && stats.misses * 4 < stats.prefetched;
+    }
+}
+
+bool prefetch_tests()
+{
+    try
+    {
+        if (!test_prefetch_loads_window()) return false;
+        if (!test_prefetch_window_is_clamped()) return false;
+        if (!cold_heap_scan(default_file_backend(), 64)) return false;
+        if (!cold_heap_scan(default_file_backend(), 16)) return false;
+        if (!cold_heap_scan(FileBackend::FSTREAM, 64)) return false;
+    }
+    catch (...)
+    {
+        return false;
+    }
+    return true;
+}
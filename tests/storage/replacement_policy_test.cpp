@@ -0,0 +1,156 @@
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "storage/file_manager.h"
+#include "storage/page_manager.h"
+#include "storage/replacement_policy.h"
+
+using namespace kizuna;
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct PolicyContext
+    {
+        std::string db_path;
+        FileManager fm;
+        std::unique_ptr<PageManager> pm;
+
+        PolicyContext(const std::string &name, std::size_t capacity, ReplacementPolicyKind policy)
+            : db_path((config::temp_dir() / (name + config::DB_FILE_EXTENSION)).string()),
+              fm(db_path, true)
+        {
+            std::error_code ec;
+            fs::create_directories(config::temp_dir(), ec);
+            fs::remove(db_path, ec);
+            fm.open();
+            pm = std::make_unique<PageManager>(fm, capacity, /*shard_count*/ 1, policy);
+        }
+
+        ~PolicyContext()
+        {
+            pm.reset();
+            fm.close();
+            std::error_code ec;
+            fs::remove(db_path, ec);
+        }
+    };
+
+    std::vector<page_id_t> allocate_pages(PageManager &pm, int count)
+    {
+        std::vector<page_id_t> ids;
+        for (int i = 0; i < count; ++i)
+        {
+            ids.push_back(pm.new_page(PageType::DATA));
+        }
+        return ids;
+    }
+
+    void touch(PageManager &pm, page_id_t id)
+    {
+        pm.fetch(id, true);
+        pm.unpin(id, false);
+    }
+
+    bool test_basic_eviction(ReplacementPolicyKind kind)
+    {
+        PolicyContext ctx("policy_basic_" + replacement_policy_to_string(kind), 4, kind);
+        auto &pm = *ctx.pm;
+        if (pm.policy() != kind) return false;
+        auto ids = allocate_pages(pm, 8);
+
+        // Every page must come back intact regardless of which frames got recycled.
+        for (int round = 0; round < 3; ++round)
+        {
+            for (auto id : ids)
+            {
+                auto &page = pm.fetch(id, true);
+                const bool ok = page.header().page_id == id;
+                pm.unpin(id, false);
+                if (!ok) return false;
+            }
+        }
+        const auto stats = pm.stats();
+        if (stats.misses == 0 || stats.evictions == 0) return false;
+        if (stats.hits + stats.misses != 24) return false;
+
+        // With every frame pinned nothing can be evicted.
+        for (int i = 0; i < 4; ++i) pm.fetch(ids[i], true);
+        bool threw = false;
+        try
+        {
+            pm.fetch(ids[5], true);
+        }
+        catch (const DBException &)
+        {
+            threw = true;
+        }
+        for (int i = 0; i < 4; ++i) pm.unpin(ids[i], false);
+        if (!threw) return false;
+
+        pm.reset_stats();
+        touch(pm, ids[0]);
+        touch(pm, ids[0]);
+        const auto after = pm.stats();
+        return after.hits >= 1 && after.hits + after.misses == 2;
+    }
+
+    // A page re-referenced after leaving A1in is promoted to Am and must survive a
+    // long one-pass scan under 2Q, while plain LRU loses it.
+    bool hot_page_survives_scan(ReplacementPolicyKind kind)
+    {
+        PolicyContext ctx("policy_scan_" + replacement_policy_to_string(kind), 16, kind);
+        auto &pm = *ctx.pm;
+        auto ids = allocate_pages(pm, 160);
+        const page_id_t hot = ids[0];
+
+        touch(pm, hot);
+        for (std::size_t i = 1; i <= 20; ++i) touch(pm, ids[i]);
+        touch(pm, hot);
+
+        for (std::size_t i = 21; i < ids.size(); ++i) touch(pm, ids[i]);
+
+        pm.reset_stats();
+        touch(pm, hot);
+        return pm.stats().hits == 1;
+    }
+
+    // coldest() previews victims without consuming them and skips pinned frames.
+    bool coldest_previews_evict(ReplacementPolicyKind kind)
+    {
+        auto policy = make_replacement_policy(kind, 0, 8);
+        for (std::size_t frame = 0; frame < 8; ++frame)
+        {
+            policy->record_load(frame, frame + 1);
+            policy->set_evictable(frame, frame != 2);
+        }
+        const auto cold = policy->coldest(8);
+        if (cold.size() != 7) return false;
+        for (auto frame : cold)
+        {
+            if (frame == 2) return false;
+        }
+        if (policy->coldest(8) != cold) return false;
+        const auto victim = policy->evict();
+        return victim && *victim == cold.front();
+    }
+}
+
+bool replacement_policy_tests()
+{
+    if (!parse_replacement_policy("clock") || *parse_replacement_policy("clock") != ReplacementPolicyKind::CLOCK) return false;
+    if (!parse_replacement_policy("2q") || *parse_replacement_policy("2q") != ReplacementPolicyKind::TWO_Q) return false;
+    if (parse_replacement_policy("mru")) return false;
+
+    for (auto kind : {ReplacementPolicyKind::LRU, ReplacementPolicyKind::CLOCK, ReplacementPolicyKind::TWO_Q})
+    {
+        if (!test_basic_eviction(kind)) return false;
+        if (!coldest_previews_evict(kind)) return false;
+    }
+
+    if (!hot_page_survives_scan(ReplacementPolicyKind::TWO_Q)) return false;
+    if (hot_page_survives_scan(ReplacementPolicyKind::LRU)) return false;
+    return true;
+}
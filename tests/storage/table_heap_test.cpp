@@ -1,5 +1,6 @@
 #include <filesystem>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 #include <string_view>
@@ -74,7 +75,7 @@ namespace
         return true;
     }
 
-    bool decode_int(const std::vector<uint8_t> &payload, int &out)
+    bool decode_int(std::span<const uint8_t> payload, int &out)
     {
         std::vector<record::Field> fields;
         if (!record::decode(payload.data(), payload.size(), fields))
@@ -89,7 +90,6 @@ namespace
     {
         TestContext ctx("table_heap_basic");
         page_id_t root = ctx.pm->new_page(PageType::DATA);
-        ctx.pm->unpin(root, false);
 
         TableHeap heap(*ctx.pm, root);
         const auto p1 = heap.insert(make_payload(1));
@@ -112,7 +112,6 @@ namespace
     {
         TestContext ctx("table_heap_overflow");
         page_id_t root = ctx.pm->new_page(PageType::DATA);
-        ctx.pm->unpin(root, false);
 
         TableHeap heap(*ctx.pm, root);
         std::vector<uint8_t> big_payload(1500, 0xAB);
@@ -154,7 +153,6 @@ namespace
     {
         TestContext ctx("table_heap_erase");
         page_id_t root = ctx.pm->new_page(PageType::DATA);
-        ctx.pm->unpin(root, false);
 
         TableHeap heap(*ctx.pm, root);
         auto loc1 = heap.insert(make_payload(10));
@@ -184,7 +182,6 @@ namespace
     {
         TestContext ctx("table_heap_truncate");
         page_id_t root = ctx.pm->new_page(PageType::DATA);
-        ctx.pm->unpin(root, false);
 
         TableHeap heap(*ctx.pm, root);
         for (int i = 0; i < 12; ++i)
@@ -209,7 +206,6 @@ namespace
     {
         TestContext ctx("table_heap_update_same");
         page_id_t root = ctx.pm->new_page(PageType::DATA);
-        ctx.pm->unpin(root, false);
 
         TableHeap heap(*ctx.pm, root);
         auto original = heap.insert(make_payload_with_label(10, "same"));
@@ -226,14 +222,41 @@ namespace
         return true;
     }
 
-    bool update_relocates_to_new_slot()
+    bool update_grows_in_place()
     {
         TestContext ctx("table_heap_update_grow");
         page_id_t root = ctx.pm->new_page(PageType::DATA);
-        ctx.pm->unpin(root, false);
 
         TableHeap heap(*ctx.pm, root);
         auto original = heap.insert(make_payload_with_label(5, "tiny"));
+        auto neighbour = heap.insert(make_payload_with_label(7, "next"));
+
+        auto updated = heap.update(original, make_payload_with_label(6, "this string is definitely longer"));
+        if (!(updated == original)) return false;
+
+        std::vector<uint8_t> out;
+        if (!heap.read(updated, out)) return false;
+        int value = 0;
+        std::string text;
+        if (!decode_payload(out, value, text)) return false;
+        if (value != 6 || text != "this string is definitely longer") return false;
+
+        if (!heap.read(neighbour, out)) return false;
+        if (!decode_payload(out, value, text)) return false;
+        if (value != 7 || text != "next") return false;
+        return true;
+    }
+
+    bool update_relocates_when_page_full()
+    {
+        TestContext ctx("table_heap_update_relocate");
+        page_id_t root = ctx.pm->new_page(PageType::DATA);
+
+        TableHeap heap(*ctx.pm, root);
+        auto original = heap.insert(make_payload_with_label(5, "tiny"));
+        while (heap.insert(make_payload_with_label(1, "filler")).page_id == root)
+        {
+        }
 
         auto updated = heap.update(original, make_payload_with_label(6, "this string is definitely longer"));
         if (updated == original) return false;
@@ -250,11 +273,72 @@ namespace
         return true;
     }
 
+    bool vacuum_compacts_and_frees()
+    {
+        TestContext ctx("table_heap_vacuum");
+        page_id_t root = ctx.pm->new_page(PageType::DATA);
+
+        TableHeap heap(*ctx.pm, root);
+        std::vector<TableHeap::RowLocation> locations;
+        for (int i = 0; i < 600; ++i)
+        {
+            locations.push_back(heap.insert(make_payload_with_label(i, "row-" + std::to_string(i))));
+        }
+        const page_id_t second = locations[0].page_id == locations[300].page_id ? config::INVALID_PAGE_ID
+                                                                                  : locations[300].page_id;
+        if (!is_valid_page_id(second)) return false;
+
+        // Empty every page except the root and the tail, and thin out the root.
+        std::vector<TableHeap::RowLocation> kept;
+        for (std::size_t i = 0; i < locations.size(); ++i)
+        {
+            const auto &loc = locations[i];
+            const bool middle = loc.page_id != root && loc.page_id != heap.tail_page_id();
+            if (middle || (loc.page_id == root && i % 2 == 0))
+            {
+                if (!heap.erase(loc)) return false;
+            }
+            else
+            {
+                kept.push_back(loc);
+            }
+        }
+
+        auto stats = heap.vacuum();
+        if (stats.pages_freed == 0 || stats.pages_compacted == 0) return false;
+
+        std::vector<uint8_t> out;
+        for (const auto &loc : kept)
+        {
+            if (!heap.read(loc, out)) return false;
+        }
+
+        std::size_t rows = 0;
+        std::size_t pages = 0;
+        page_id_t current = root;
+        page_id_t previous = config::INVALID_PAGE_ID;
+        while (is_valid_page_id(current))
+        {
+            auto &page = ctx.pm->fetch(current, true);
+            const page_id_t next = page.next_page_id();
+            const bool linked = current == root || page.prev_page_id() == previous;
+            const bool empty = page.header().record_count == 0 && current != root;
+            ctx.pm->unpin(current, false);
+            if (!linked || empty) return false;
+            ++pages;
+            previous = current;
+            current = next;
+        }
+        if (previous != heap.tail_page_id()) return false;
+        if (pages + stats.pages_freed != stats.pages_scanned) return false;
+        heap.scan([&](const TableHeap::RowLocation &, std::span<const uint8_t>) { ++rows; });
+        return rows == kept.size();
+    }
+
     bool scan_helper_visits_all_rows()
     {
         TestContext ctx("table_heap_scan_helper");
         page_id_t root = ctx.pm->new_page(PageType::DATA);
-        ctx.pm->unpin(root, false);
 
         TableHeap heap(*ctx.pm, root);
         heap.insert(make_payload(1));
@@ -262,7 +346,7 @@ namespace
         heap.insert(make_payload(3));
 
         std::vector<int> seen;
-        heap.scan([&](const TableHeap::RowLocation &, const std::vector<uint8_t> &payload) {
+        heap.scan([&](const TableHeap::RowLocation &, std::span<const uint8_t> payload) {
             int v = 0;
             if (decode_int(payload, v))
             {
@@ -273,6 +357,46 @@ namespace
         return seen == std::vector<int>{1, 2, 3};
     }
 
+    bool scan_erases_in_place()
+    {
+        TestContext ctx("table_heap_scan_erase");
+        page_id_t root = ctx.pm->new_page(PageType::DATA);
+
+        TableHeap heap(*ctx.pm, root);
+        for (int i = 0; i < 400; ++i)
+        {
+            heap.insert(make_payload(i));
+        }
+
+        // Rows arrive as spans into the pinned page; erasing from the callback (as DELETE
+        // does) must neither skip nor revisit rows, even when a page empties out.
+        std::size_t visited = 0;
+        heap.scan([&](const TableHeap::RowLocation &loc, std::span<const uint8_t> payload) {
+            ++visited;
+            int v = 0;
+            if (decode_int(payload, v) && (v < 300 || v % 2 == 0))
+            {
+                heap.erase(loc);
+            }
+        });
+        if (visited != 400) return false;
+
+        std::vector<int> left;
+        heap.scan([&](const TableHeap::RowLocation &, std::span<const uint8_t> payload) {
+            int v = 0;
+            if (decode_int(payload, v))
+            {
+                left.push_back(v);
+            }
+        });
+        if (left.size() != 50) return false;
+        for (std::size_t i = 0; i < left.size(); ++i)
+        {
+            if (left[i] != 301 + static_cast<int>(i) * 2) return false;
+        }
+        return true;
+    }
+
     catalog::ColumnCatalogEntry make_column_entry(table_id_t table_id,
                                                   column_id_t column_id,
                                                   uint32_t ordinal,
@@ -299,7 +423,6 @@ namespace
     {
         TestContext ctx("table_heap_migration");
         page_id_t root = ctx.pm->new_page(PageType::DATA);
-        ctx.pm->unpin(root, false);
 
         TableHeap heap(*ctx.pm, root);
 
@@ -329,9 +452,11 @@ namespace
         TableHeap heap_after_add(*ctx.pm, root);
         int expected = 1;
         bool add_ok = true;
-        heap_after_add.scan([&](const TableHeap::RowLocation &, const std::vector<uint8_t> &payload) {
+        heap_after_add.scan([&](const TableHeap::RowLocation &, std::span<const uint8_t> payload) {
+            // The source rows were written as V1; the rewrite upgrades them.
             std::vector<record::Field> fields;
-            if (!record::decode(payload.data(), payload.size(), fields))
+            if (record::format_of(payload) != record::RecordFormat::V2 ||
+                !record::decode(payload.data(), payload.size(), fields))
             {
                 add_ok = false;
                 return;
@@ -362,7 +487,7 @@ namespace
         TableHeap heap_after_drop(*ctx.pm, root);
         int check_id = 1;
         bool drop_ok = true;
-        heap_after_drop.scan([&](const TableHeap::RowLocation &, const std::vector<uint8_t> &payload) {
+        heap_after_drop.scan([&](const TableHeap::RowLocation &, std::span<const uint8_t> payload) {
             std::vector<record::Field> fields;
             if (!record::decode(payload.data(), payload.size(), fields))
             {
@@ -392,6 +517,6 @@ namespace
 bool table_heap_tests()
 {
     return basic_insert_scan() && overflow_insert() && erase_skip() && truncate_resets() &&
-           update_in_place_success() && update_relocates_to_new_slot() && scan_helper_visits_all_rows() &&
-           migration_add_drop_column();
+           update_in_place_success() && update_grows_in_place() && update_relocates_when_page_full() &&
+           scan_helper_visits_all_rows() && scan_erases_in_place() && vacuum_compacts_and_frees() && migration_add_drop_column();
 }
@@ -11,20 +11,35 @@ bool exception_tests();
 bool logger_tests();
 bool file_manager_tests();
 bool file_manager_edge_tests();
+bool file_manager_backend_tests();
 bool page_tests();
 bool page_manager_tests();
 bool record_tests();
 bool value_tests();
 bool page_manager_freelist_tests();
+bool page_manager_sharded_tests();
 bool table_heap_tests();
+bool replacement_policy_tests();
+bool buffer_access_strategy_tests();
+bool buffer_pool_tests();
+bool background_writer_tests();
+bool async_io_tests();
+bool prefetch_tests();
+bool free_space_map_tests();
 bool bplus_tree_tests();
 bool bplus_tree_node_tests();
 bool index_manager_tests();
+bool key_codec_tests();
+bool key_sorter_tests();
 bool sql_dml_parser_tests();
 bool sql_ddl_parser_tests();
 bool catalog_manager_ddl_tests();
 bool dml_executor_tests();
 bool expression_evaluator_tests();
+bool hash_join_tests();
+bool merge_join_tests();
+bool operators_tests();
+bool batch_predicate_tests();
 
 int main()
 {
@@ -33,18 +48,33 @@ int main()
         {"logger_tests", &logger_tests},
         {"file_manager_tests", &file_manager_tests},
         {"file_manager_edge_tests", &file_manager_edge_tests},
+        {"file_manager_backend_tests", &file_manager_backend_tests},
         {"page_tests", &page_tests},
         {"record_tests", &record_tests},
         {"value_tests", &value_tests},
         {"page_manager_tests", &page_manager_tests},
         {"page_manager_freelist_tests", &page_manager_freelist_tests},
+        {"page_manager_sharded_tests", &page_manager_sharded_tests},
         {"table_heap_tests", &table_heap_tests},
+        {"replacement_policy_tests", &replacement_policy_tests},
+        {"buffer_access_strategy_tests", &buffer_access_strategy_tests},
+        {"buffer_pool_tests", &buffer_pool_tests},
+        {"background_writer_tests", &background_writer_tests},
+        {"async_io_tests", &async_io_tests},
+        {"prefetch_tests", &prefetch_tests},
+        {"free_space_map_tests", &free_space_map_tests},
         {"bplus_tree_tests", &bplus_tree_tests},
         {"index_manager_tests", &index_manager_tests},
+        {"key_codec_tests", &key_codec_tests},
+        {"key_sorter_tests", &key_sorter_tests},
         {"bplus_tree_node_tests", &bplus_tree_node_tests},
         {"sql_dml_parser_tests", &sql_dml_parser_tests},
         {"sql_ddl_parser_tests", &sql_ddl_parser_tests},
         {"expression_evaluator_tests", &expression_evaluator_tests},
+        {"hash_join_tests", &hash_join_tests},
+        {"merge_join_tests", &merge_join_tests},
+        {"operators_tests", &operators_tests},
+        {"batch_predicate_tests", &batch_predicate_tests},
         {"dml_executor_tests", &dml_executor_tests},
         {"catalog_manager_ddl_tests", &catalog_manager_ddl_tests},
     };